@@ -68,4 +68,23 @@ macro(createTraceLevelOptions)
   endif(OpENer_TRACE_LEVEL_INFO)
   
   add_definitions(-DOPENER_TRACE_LEVEL=${TRACE_LEVEL})
+
+  foreach(module CIP ENCAP PORT APPLICATION)
+    set( OpENer_TRACE_${module}_LEVEL "" CACHE STRING "Trace levels compiled into the ${module} module (1 error, 2 warning, 4 state, 8 info), empty for the levels above" )
+    if(NOT OpENer_TRACE_${module}_LEVEL STREQUAL "")
+      add_definitions(-DOPENER_TRACE_${module}_LEVEL=${OpENer_TRACE_${module}_LEVEL})
+    endif(NOT OpENer_TRACE_${module}_LEVEL STREQUAL "")
+  endforeach(module)
+
+  set( OpENer_TRACE_RUNTIME_MASK OFF CACHE BOOL "Allow switching the compiled in trace levels per module at runtime" )
+  if(OpENer_TRACE_RUNTIME_MASK)
+    add_definitions( -DOPENER_TRACE_RUNTIME_MASK )
+  endif(OpENer_TRACE_RUNTIME_MASK)
 endmacro(createTraceLevelOptions)
+
+#######################################
+# Assigns a library to a trace module #
+#######################################
+macro(opener_trace_module TARGET MODULE)
+  set_property( TARGET ${TARGET} APPEND PROPERTY COMPILE_DEFINITIONS OPENER_TRACE_MODULE=OPENER_TRACE_MODULE_${MODULE} )
+endmacro(opener_trace_module)
@@ -11,37 +11,7 @@
 #include "cipconnectionmanager.h"
 #include "opener_api.h"
 #include "assert.h"
-
-
-/** @brief External globals needed from connectionmanager.c */
-extern ConnectionObject *g_active_connection_list;
-
-typedef struct {
-  unsigned int output_assembly; /**< the O-to-T point for the connection */
-  unsigned int input_assembly; /**< the T-to-O point for the connection */
-  unsigned int config_assembly; /**< the config point for the connection */
-  ConnectionObject connection_data; /**< the connection data, only one connection is allowed per O-to-T point*/
-} ExclusiveOwnerConnection;
-
-typedef struct {
-  unsigned int output_assembly; /**< the O-to-T point for the connection */
-  unsigned int input_assembly; /**< the T-to-O point for the connection */
-  unsigned int config_assembly; /**< the config point for the connection */
-  ConnectionObject connection_data[OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH]; /*< the connection data */
-} InputOnlyConnection;
-
-typedef struct {
-  unsigned int output_assembly; /**< the O-to-T point for the connection */
-  unsigned int input_assembly; /**< the T-to-O point for the connection */
-  unsigned int config_assembly; /**< the config point for the connection */
-  ConnectionObject connection_data[OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH]; /**< the connection data */
-} ListenOnlyConnection;
-
-ExclusiveOwnerConnection g_exlusive_owner_connections[OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS];
-
-InputOnlyConnection g_input_only_connections[OPENER_CIP_NUM_INPUT_ONLY_CONNS];
-
-ListenOnlyConnection g_listen_only_connections[OPENER_CIP_NUM_LISTEN_ONLY_CONNS];
+#include "opener_stack.h"
 
 ConnectionObject *GetExclusiveOwnerConnection(
     ConnectionObject *connection_object, EipUint16 *extended_error);
@@ -57,11 +27,11 @@ void ConfigureExclusiveOwnerConnectionPoint(unsigned int connection_number,
                                             unsigned int input_assembly,
                                             unsigned int config_assembly) {
   if (OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS > connection_number) {
-    g_exlusive_owner_connections[connection_number].output_assembly =
+    g_opener_stack->exclusive_owner_connections[connection_number].output_assembly =
         output_assembly;
-    g_exlusive_owner_connections[connection_number].input_assembly =
+    g_opener_stack->exclusive_owner_connections[connection_number].input_assembly =
         input_assembly;
-    g_exlusive_owner_connections[connection_number].config_assembly =
+    g_opener_stack->exclusive_owner_connections[connection_number].config_assembly =
         config_assembly;
   }
 }
@@ -71,10 +41,10 @@ void ConfigureInputOnlyConnectionPoint(unsigned int connection_number,
                                        unsigned int input_assembly,
                                        unsigned int config_assembly) {
   if (OPENER_CIP_NUM_INPUT_ONLY_CONNS > connection_number) {
-    g_input_only_connections[connection_number].output_assembly =
+    g_opener_stack->input_only_connections[connection_number].output_assembly =
         output_assembly;
-    g_input_only_connections[connection_number].input_assembly = input_assembly;
-    g_input_only_connections[connection_number].config_assembly =
+    g_opener_stack->input_only_connections[connection_number].input_assembly = input_assembly;
+    g_opener_stack->input_only_connections[connection_number].config_assembly =
         config_assembly;
   }
 }
@@ -84,11 +54,11 @@ void ConfigureListenOnlyConnectionPoint(unsigned int connection_number,
                                         unsigned int input_assembly,
                                         unsigned int config_assembly) {
   if (OPENER_CIP_NUM_LISTEN_ONLY_CONNS > connection_number) {
-    g_listen_only_connections[connection_number].output_assembly =
+    g_opener_stack->listen_only_connections[connection_number].output_assembly =
         output_assembly;
-    g_listen_only_connections[connection_number].input_assembly =
+    g_opener_stack->listen_only_connections[connection_number].input_assembly =
         input_assembly;
-    g_listen_only_connections[connection_number].config_assembly =
+    g_opener_stack->listen_only_connections[connection_number].config_assembly =
         config_assembly;
   }
 }
@@ -139,11 +109,11 @@ ConnectionObject *GetExclusiveOwnerConnection(
   int i;
 
   for (i = 0; i < OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS; i++) {
-    if ((g_exlusive_owner_connections[i].output_assembly
+    if ((g_opener_stack->exclusive_owner_connections[i].output_assembly
         == connection_object->connection_path.connection_point[0])
-        && (g_exlusive_owner_connections[i].input_assembly
+        && (g_opener_stack->exclusive_owner_connections[i].input_assembly
             == connection_object->connection_path.connection_point[1])
-        && (g_exlusive_owner_connections[i].config_assembly
+        && (g_opener_stack->exclusive_owner_connections[i].config_assembly
             == connection_object->connection_path.connection_point[2])) {
 
       /* check if on other connection point with the same output assembly is currently connected */
@@ -153,7 +123,7 @@ ConnectionObject *GetExclusiveOwnerConnection(
         *extended_error = kConnectionManagerStatusCodeErrorOwnershipConflict;
         break;
       }
-      exclusive_owner_connection = &(g_exlusive_owner_connections[i]
+      exclusive_owner_connection = &(g_opener_stack->exclusive_owner_connections[i]
           .connection_data);
       break;
     }
@@ -167,15 +137,15 @@ ConnectionObject *GetInputOnlyConnection(ConnectionObject *connection_object,
   int i, j;
 
   for (i = 0; i < OPENER_CIP_NUM_INPUT_ONLY_CONNS; i++) {
-    if (g_input_only_connections[i].output_assembly
+    if (g_opener_stack->input_only_connections[i].output_assembly
         == connection_object->connection_path.connection_point[0]) { /* we have the same output assembly */
-      if (g_input_only_connections[i].input_assembly
+      if (g_opener_stack->input_only_connections[i].input_assembly
           != connection_object->connection_path.connection_point[1]) {
         *extended_error =
             kConnectionManagerStatusCodeInvalidProducingApplicationPath;
         break;
       }
-      if (g_input_only_connections[i].config_assembly
+      if (g_opener_stack->input_only_connections[i].config_assembly
           != connection_object->connection_path.connection_point[2]) {
         *extended_error =
             kConnectionManagerStatusCodeInconsistentApplicationPathCombo;
@@ -184,8 +154,8 @@ ConnectionObject *GetInputOnlyConnection(ConnectionObject *connection_object,
 
       for (j = 0; j < OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH; j++) {
         if (kConnectionStateNonExistent
-            == g_input_only_connections[i].connection_data[j].state) {
-          return &(g_input_only_connections[i].connection_data[j]);
+            == g_opener_stack->input_only_connections[i].connection_data[j].state) {
+          return &(g_opener_stack->input_only_connections[i].connection_data[j]);
         }
       }
       *extended_error =
@@ -211,15 +181,15 @@ ConnectionObject *GetListenOnlyConnection(ConnectionObject *connection_object,
   }
 
   for (i = 0; i < OPENER_CIP_NUM_LISTEN_ONLY_CONNS; i++) {
-    if (g_listen_only_connections[i].output_assembly
+    if (g_opener_stack->listen_only_connections[i].output_assembly
         == connection_object->connection_path.connection_point[0]) { /* we have the same output assembly */
-      if (g_listen_only_connections[i].input_assembly
+      if (g_opener_stack->listen_only_connections[i].input_assembly
           != connection_object->connection_path.connection_point[1]) {
         *extended_error =
             kConnectionManagerStatusCodeInvalidProducingApplicationPath;
         break;
       }
-      if (g_listen_only_connections[i].config_assembly
+      if (g_opener_stack->listen_only_connections[i].config_assembly
           != connection_object->connection_path.connection_point[2]) {
         *extended_error =
             kConnectionManagerStatusCodeInconsistentApplicationPathCombo;
@@ -236,8 +206,8 @@ ConnectionObject *GetListenOnlyConnection(ConnectionObject *connection_object,
 
       for (j = 0; j < OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH; j++) {
         if (kConnectionStateNonExistent
-            == g_listen_only_connections[i].connection_data[j].state) {
-          return &(g_listen_only_connections[i].connection_data[j]);
+            == g_opener_stack->listen_only_connections[i].connection_data[j].state) {
+          return &(g_opener_stack->listen_only_connections[i].connection_data[j]);
         }
       }
       *extended_error =
@@ -249,19 +219,17 @@ ConnectionObject *GetListenOnlyConnection(ConnectionObject *connection_object,
 }
 
 ConnectionObject *GetExistingProducerMulticastConnection(EipUint32 input_point) {
-  ConnectionObject *producer_multicast_connection = g_active_connection_list;
+  ConnectionObject *producer_multicast_connection =
+      GetFirstConnectionOfInputPoint(input_point);
 
   while (NULL != producer_multicast_connection) {
     if ((kConnectionTypeIoExclusiveOwner
         == producer_multicast_connection->instance_type)
         || (kConnectionTypeIoInputOnly
             == producer_multicast_connection->instance_type)) {
-      if ((input_point
-          == producer_multicast_connection->connection_path.connection_point[1])
-          && (kRoutingTypeMulticastConnection
-              == (producer_multicast_connection
-                  ->t_to_o_network_connection_parameter
-                  & kRoutingTypeMulticastConnection))
+      if ((kRoutingTypeMulticastConnection
+          == (producer_multicast_connection->t_to_o_network_connection_parameter
+              & kRoutingTypeMulticastConnection))
           && (kEipInvalidSocket
               != producer_multicast_connection->socket[kUdpCommuncationDirectionProducing])) {
         /* we have a connection that produces the same input assembly,
@@ -271,27 +239,24 @@ ConnectionObject *GetExistingProducerMulticastConnection(EipUint32 input_point)
       }
     }
     producer_multicast_connection = producer_multicast_connection
-        ->next_connection_object;
+        ->next_connection_of_input_point;
   }
   return producer_multicast_connection;
 }
 
 ConnectionObject *GetNextNonControlMasterConnection(EipUint32 input_point) {
   ConnectionObject *next_non_control_master_connection =
-      g_active_connection_list;
+      GetFirstConnectionOfInputPoint(input_point);
 
   while (NULL != next_non_control_master_connection) {
     if ((kConnectionTypeIoExclusiveOwner
         == next_non_control_master_connection->instance_type)
         || (kConnectionTypeIoInputOnly
             == next_non_control_master_connection->instance_type)) {
-      if ((input_point
-          == next_non_control_master_connection->connection_path
-              .connection_point[1])
-          && (kRoutingTypeMulticastConnection
-              == (next_non_control_master_connection
-                  ->t_to_o_network_connection_parameter
-                  & kRoutingTypeMulticastConnection))
+      if ((kRoutingTypeMulticastConnection
+          == (next_non_control_master_connection
+              ->t_to_o_network_connection_parameter
+              & kRoutingTypeMulticastConnection))
           && (kEipInvalidSocket
               == next_non_control_master_connection->socket[kUdpCommuncationDirectionProducing])) {
         /* we have a connection that produces the same input assembly,
@@ -301,21 +266,20 @@ ConnectionObject *GetNextNonControlMasterConnection(EipUint32 input_point) {
       }
     }
     next_non_control_master_connection = next_non_control_master_connection
-        ->next_connection_object;
+        ->next_connection_of_input_point;
   }
   return next_non_control_master_connection;
 }
 
 void CloseAllConnectionsForInputWithSameType(EipUint32 input_point,
                                              ConnectionType instance_type) {
-  ConnectionObject *connection = g_active_connection_list;
+  ConnectionObject *connection = GetFirstConnectionOfInputPoint(input_point);
   ConnectionObject *connection_to_delete;
 
   while (NULL != connection) {
-    if ((instance_type == connection->instance_type)
-        && (input_point == connection->connection_path.connection_point[1])) {
+    if (instance_type == connection->instance_type) {
       connection_to_delete = connection;
-      connection = connection->next_connection_object;
+      connection = connection->next_connection_of_input_point;
       CheckIoConnectionEvent(
           connection_to_delete->connection_path.connection_point[0],
           connection_to_delete->connection_path.connection_point[1],
@@ -324,13 +288,13 @@ void CloseAllConnectionsForInputWithSameType(EipUint32 input_point,
       assert(connection_to_delete->connection_close_function != NULL);
       connection_to_delete->connection_close_function(connection_to_delete);
     } else {
-      connection = connection->next_connection_object;
+      connection = connection->next_connection_of_input_point;
     }
   }
 }
 
 void CloseAllConnections(void) {
-  ConnectionObject *connection = g_active_connection_list;
+  ConnectionObject *connection = g_opener_stack->active_connection_list;
   while (NULL != connection) {
     assert(connection->connection_close_function != NULL);
     connection->connection_close_function(connection);
@@ -338,13 +302,13 @@ void CloseAllConnections(void) {
     /* Close connection will remove the connection from the list therefore we
      * need to get again the start until there is no connection left
      */
-    connection = g_active_connection_list;
+    connection = g_opener_stack->active_connection_list;
   }
 
 }
 
 EipBool8 ConnectionWithSameConfigPointExists(EipUint32 config_point) {
-  ConnectionObject *connection = g_active_connection_list;
+  ConnectionObject *connection = g_opener_stack->active_connection_list;
 
   while (NULL != connection) {
     if (config_point == connection->connection_path.connection_point[2]) {
@@ -356,10 +320,10 @@ EipBool8 ConnectionWithSameConfigPointExists(EipUint32 config_point) {
 }
 
 void InitializeIoConnectionData(void) {
-  memset(g_exlusive_owner_connections, 0,
+  memset(g_opener_stack->exclusive_owner_connections, 0,
   OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS * sizeof(ExclusiveOwnerConnection));
-  memset(g_input_only_connections, 0,
+  memset(g_opener_stack->input_only_connections, 0,
   OPENER_CIP_NUM_INPUT_ONLY_CONNS * sizeof(InputOnlyConnection));
-  memset(g_listen_only_connections, 0,
+  memset(g_opener_stack->listen_only_connections, 0,
   OPENER_CIP_NUM_LISTEN_ONLY_CONNS * sizeof(ListenOnlyConnection));
 }
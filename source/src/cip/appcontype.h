@@ -8,6 +8,33 @@
 
 #include "cipconnectionmanager.h"
 
+/** @brief Connection point configuration and connection of an exclusive
+ * owner connection */
+typedef struct {
+  unsigned int output_assembly; /**< the O-to-T point for the connection */
+  unsigned int input_assembly; /**< the T-to-O point for the connection */
+  unsigned int config_assembly; /**< the config point for the connection */
+  ConnectionObject connection_data; /**< the connection data, only one connection is allowed per O-to-T point*/
+} ExclusiveOwnerConnection;
+
+/** @brief Connection point configuration and connections of an input only
+ * connection */
+typedef struct {
+  unsigned int output_assembly; /**< the O-to-T point for the connection */
+  unsigned int input_assembly; /**< the T-to-O point for the connection */
+  unsigned int config_assembly; /**< the config point for the connection */
+  ConnectionObject connection_data[OPENER_CIP_NUM_INPUT_ONLY_CONNS_PER_CON_PATH]; /*< the connection data */
+} InputOnlyConnection;
+
+/** @brief Connection point configuration and connections of a listen only
+ * connection */
+typedef struct {
+  unsigned int output_assembly; /**< the O-to-T point for the connection */
+  unsigned int input_assembly; /**< the T-to-O point for the connection */
+  unsigned int config_assembly; /**< the config point for the connection */
+  ConnectionObject connection_data[OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH]; /**< the connection data */
+} ListenOnlyConnection;
+
 void InitializeIoConnectionData(void);
 
 /** @brief check if for the given connection data received in a forward_open request
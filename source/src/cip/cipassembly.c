@@ -12,6 +12,8 @@
 #include "opener_api.h"
 #include "trace.h"
 #include "cipconnectionmanager.h"
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /** @brief Implementation of the SetAttributeSingle CIP service for Assembly
  *          Objects.
@@ -103,6 +105,7 @@ EipStatus NotifyAssemblyConnectedDataReceived(CipInstance *instance,
   assembly_byte_array = (CipByteArray *) instance->attributes->data;
   if (assembly_byte_array->length != data_length) {
     OPENER_TRACE_ERR("wrong amount of data arrived for assembly object\n");
+    g_opener_stack->opener_statistics.io_packets_wrong_size++;
     return kEipStatusError; /*TODO question should we notify the application that wrong data has been received???*/
   } else {
     memcpy(assembly_byte_array->data, data, data_length);
@@ -7,14 +7,10 @@
 #include <string.h>
 
 #include "cipclass3connection.h"
+#include "opener_stack.h"
 
 ConnectionObject *GetFreeExplicitConnection(void);
 
-/**** Global variables ****/
-
-/** @brief Array of the available explicit connections */
-ConnectionObject g_explicit_connections[OPENER_CIP_NUM_EXPLICIT_CONNS];
-
 /**** Implementation ****/
 EipStatus EstablishClass3Connection(ConnectionObject *connection_object,
                               EipUint16 *extended_error) {
@@ -54,13 +50,13 @@ EipStatus EstablishClass3Connection(ConnectionObject *connection_object,
 ConnectionObject *GetFreeExplicitConnection(void) {
   int i;
   for (i = 0; i < OPENER_CIP_NUM_EXPLICIT_CONNS; i++) {
-    if (g_explicit_connections[i].state == kConnectionStateNonExistent)
-      return &(g_explicit_connections[i]);
+    if (g_opener_stack->explicit_connections[i].state == kConnectionStateNonExistent)
+      return &(g_opener_stack->explicit_connections[i]);
   }
   return NULL;
 }
 
 void InitializeClass3ConnectionData(void) {
-  memset(g_explicit_connections, 0,
+  memset(g_opener_stack->explicit_connections, 0,
   OPENER_CIP_NUM_EXPLICIT_CONNS * sizeof(ConnectionObject));
 }
@@ -12,6 +12,7 @@
 #include "cipidentity.h"
 #include "ciptcpipinterface.h"
 #include "cipethernetlink.h"
+#include "cipstatistics.h"
 #include "cipconnectionmanager.h"
 #include "endianconv.h"
 #include "encap.h"
@@ -21,15 +22,147 @@
 #include "cpf.h"
 #include "trace.h"
 #include "appcontype.h"
-
-/* global public variables */
-EipUint8 g_message_data_reply_buffer[OPENER_MESSAGE_DATA_REPLY_BUFFER];
+#include "opener_stack.h"
 
 const EipUint16 kCipUintZero = 0;
 
+/* global public variables */
+OpenerStack g_default_opener_stack = {
+    .last_connection_id = 18,
+    .time_to_live_value = 1,
+    .multicast_configuration = { 0, /* us the default allocation algorithm */
+        0, /* reserved */
+        1, /* we currently use only one multicast address */
+        0 /* the multicast address will be allocated on ip address configuration */
+    } };
+
+OPENER_THREAD_LOCAL OpenerStack *g_opener_stack = &g_default_opener_stack;
+
+#if defined(OPENER_TRACE_ENABLED) && defined(OPENER_TRACE_RUNTIME_MASK)
+EipUint32 g_opener_trace_mask = OPENER_TRACE_MASK_ALL;
+#endif
+
 /* private functions*/
 int EncodeEPath(CipEpath *epath, EipUint8 **message);
 
+/** @brief Create the metaclass of a class with the standard class attributes
+ * and services
+ *
+ * @param class the class the metaclass is created for, its name has to be set
+ * @param number_of_class_attributes number of non-standard class attributes
+ * @param get_all_class_attributes_mask mask of which attributes are included
+ * in the class getAttributeAll
+ * @param number_of_class_services number of non-standard class services
+ */
+void CreateMetaClass(CipClass *class, int number_of_class_attributes,
+                     EipUint32 get_all_class_attributes_mask,
+                     int number_of_class_services);
+
+/** @brief Function encoding a value of a CIP data type onto a message
+ *
+ * @param data pointer to the value
+ * @param message pointer to the message buffer, advanced by the encoded length
+ * @return number of bytes written
+ */
+typedef int (*CipDataEncodeFunction)(const void *data, EipUint8 **message);
+
+/** @brief Function decoding a value of a CIP data type from a message
+ *
+ * @param data pointer to the value to be written
+ * @param message pointer to the message buffer, advanced by the decoded length
+ * @return number of bytes taken from the message
+ */
+typedef int (*CipDataDecodeFunction)(void *data, EipUint8 **message);
+
+/** @brief Function returning the encoded length of a value of a variable width
+ * CIP data type
+ */
+typedef int (*CipDataEncodedSizeFunction)(const void *data);
+
+/** @brief Encoding of a CIP data type
+ *
+ * EncodeData, DecodeData and GetEncodedDataSize dispatch through a table of
+ * these descriptors instead of switching over the type code.
+ */
+typedef struct cip_type_descriptor {
+  EipUint8 size; /**< encoded length of fixed width types, 0 otherwise */
+  EipBool8 fixed_width; /**< all values are encoded with size bytes */
+  CipDataEncodeFunction encode;
+  CipDataDecodeFunction decode; /**< NULL if the type can not be decoded */
+  CipDataEncodedSizeFunction encoded_size; /**< encoded length of variable width types */
+} CipTypeDescriptor;
+
+/** @brief Get the descriptor of a CIP data type
+ *
+ * @param cip_type the CIP data type code
+ * @return the descriptor, NULL if OpENer can not encode the type
+ */
+const CipTypeDescriptor *GetCipTypeDescriptor(EipUint8 cip_type);
+
+/* encoders, decoders and encoded sizes of the types in the descriptor table */
+int EncodeCipUsint(const void *data, EipUint8 **message);
+int EncodeCipUint(const void *data, EipUint8 **message);
+int EncodeCipUdint(const void *data, EipUint8 **message);
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+int EncodeCipUlint(const void *data, EipUint8 **message);
+#endif
+int EncodeCipString(const void *data, EipUint8 **message);
+int EncodeCipShortString(const void *data, EipUint8 **message);
+int EncodeCipEpath(const void *data, EipUint8 **message);
+int EncodeCipRevision(const void *data, EipUint8 **message);
+int EncodeCipTcpIpNetworkInterfaceConfiguration(const void *data,
+                                                EipUint8 **message);
+int EncodeCip6Usint(const void *data, EipUint8 **message);
+int EncodeCipByteArray(const void *data, EipUint8 **message);
+int EncodeCip11Udint(const void *data, EipUint8 **message);
+int EncodeCip12Udint(const void *data, EipUint8 **message);
+int EncodeInternalUint6(const void *data, EipUint8 **message);
+
+int DecodeCipUsint(void *data, EipUint8 **message);
+int DecodeCipUint(void *data, EipUint8 **message);
+int DecodeCipUdint(void *data, EipUint8 **message);
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+int DecodeCipUlint(void *data, EipUint8 **message);
+#endif
+int DecodeCipString(void *data, EipUint8 **message);
+int DecodeCipShortString(void *data, EipUint8 **message);
+
+int GetEncodedCipStringSize(const void *data);
+int GetEncodedCipShortStringSize(const void *data);
+int GetEncodedCipEpathSize(const void *data);
+int GetEncodedCipTcpIpNetworkInterfaceConfigurationSize(const void *data);
+int GetEncodedCipByteArraySize(const void *data);
+
+OpenerStack *CreateOpenerStack(void) {
+  OpenerStack *stack = (OpenerStack *) CipCalloc(1, sizeof(OpenerStack));
+  if (NULL != stack) {
+    /* the non-zero values g_default_opener_stack starts with */
+    stack->last_connection_id = 18;
+    stack->time_to_live_value = 1;
+    stack->multicast_configuration.number_of_allocated_multicast_addresses = 1;
+  }
+  return stack;
+}
+
+void DestroyOpenerStack(OpenerStack *stack) {
+  if (&g_default_opener_stack == stack) {
+    OPENER_TRACE_ERR("the default stack can not be destroyed\n");
+    return;
+  }
+  if (g_opener_stack == stack) {
+    g_opener_stack = &g_default_opener_stack;
+  }
+  CipFree(stack);
+}
+
+void SetActiveOpenerStack(OpenerStack *stack) {
+  g_opener_stack = (NULL != stack) ? stack : &g_default_opener_stack;
+}
+
+OpenerStack *GetActiveOpenerStack(void) {
+  return g_opener_stack;
+}
+
 void CipStackInit(EipUint16 unique_connection_id) {
   EipStatus eip_status;
   EncapsulationInit();
@@ -42,6 +175,8 @@ void CipStackInit(EipUint16 unique_connection_id) {
   OPENER_ASSERT(kEipStatusOk == eip_status);
   eip_status = CipEthernetLinkInit();
   OPENER_ASSERT(kEipStatusOk == eip_status);
+  eip_status = CipStatisticsInit();
+  OPENER_ASSERT(kEipStatusOk == eip_status);
   eip_status = ConnectionManagerInit(unique_connection_id);
   OPENER_ASSERT(kEipStatusOk == eip_status);
   eip_status = CipAssemblyInitialize();
@@ -54,6 +189,13 @@ void CipStackInit(EipUint16 unique_connection_id) {
 void ShutdownCipStack(void) {
   /* First close all connections */
   CloseAllConnections();
+  OPENER_TRACE_STATE(
+      "connection manager: %"PRIu32" forward opens, %"PRIu32" refused, latency p50 %llu us p90 %llu us p99 %llu us max %llu us\n",
+      GetForwardOpenStatistics()->requests,
+      GetForwardOpenStatistics()->rejected_requests,
+      GetForwardOpenLatencyPercentile(50), GetForwardOpenLatencyPercentile(90),
+      GetForwardOpenLatencyPercentile(99),
+      GetForwardOpenStatistics()->max_latency);
   /* Than free the sockets of currently active encapsulation sessions */
   EncapsulationShutDown();
   /*clean the data needed for the assembly object's attribute 3*/
@@ -70,7 +212,7 @@ EipStatus NotifyClass(CipClass *cip_class,
                       CipMessageRouterResponse *message_router_response) {
   int i;
   CipInstance *instance;
-  CipServiceStruct *service;
+  const CipServiceStruct *service;
   unsigned instance_number; /* my instance number */
 
   /* find the instance: if instNr==0, the class is addressed, else find the instance */
@@ -123,6 +265,11 @@ CipInstance *AddCipInstances(CipClass *cip_class, int number_of_instances) {
 
   OPENER_TRACE_INFO("adding %d instances to class %s\n", number_of_instances,
                     cip_class->class_name);
+  if (NULL != cip_class->definition) { /* a class created from a definition has exactly one instance */
+    OPENER_TRACE_ERR("can not add instances to class %s\n",
+                     cip_class->class_name);
+    return NULL;
+  }
 
   next_instance = &cip_class->instances; /* get address of pointer to head of chain */
   while (*next_instance) /* as long as what pp points to is not zero */
@@ -178,7 +325,6 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
                          int number_of_instances, char *name,
                          EipUint16 revision) {
   CipClass *class; /* pointer to the class struct */
-  CipClass *meta_class; /* pointer to the metaclass struct */
 
   OPENER_TRACE_INFO("creating class '%s' with id: 0x%"PRIX32"\n", name,
                     class_id);
@@ -187,14 +333,7 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
   OPENER_ASSERT(NULL == class);
   /* should never try to redefine a class*/
 
-  /* a metaClass is a class that holds the class attributes and services
-   CIP can talk to an instance, therefore an instance has a pointer to its class
-   CIP can talk to a class, therefore a class struct is a subclass of the instance struct,
-   and contains a pointer to a metaclass
-   CIP never explicitly addresses a metaclass*/
-
   class = (CipClass*) CipCalloc(1, sizeof(CipClass)); /* create the class object*/
-  meta_class = (CipClass*) CipCalloc(1, sizeof(CipClass)); /* create the metaclass object*/
 
   /* initialize the class-specific fields of the Class struct*/
   class->class_id = class_id; /* the class remembers the class ID */
@@ -207,6 +346,104 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
       + ((0 == get_all_instance_attributes_mask) ? 1 : 2); /* the class manages the behavior of the instances */
   class->services = 0;
   class->class_name = name; /* initialize the class-specific fields of the metaClass struct */
+  class->definition = NULL;
+
+  CreateMetaClass(class, number_of_class_attributes,
+                  get_all_class_attributes_mask, number_of_class_services);
+
+  class->services = (CipServiceStruct *) CipCalloc(class->number_of_services,
+                                                   sizeof(CipServiceStruct));
+
+  if (number_of_instances > 0) {
+    AddCipInstances(class, number_of_instances); /*TODO handle return value and clean up if necessary*/
+  }
+
+  if ((RegisterCipClass(class)) == kEipStatusError) { /* no memory to register class in Message Router */
+    return 0; /*TODO handle return value and clean up if necessary*/
+  }
+
+  /* create the standard instance services*/
+  if (0 != get_all_instance_attributes_mask) { /*only if the mask has values add the get_attribute_all service */
+    InsertService(class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll"); /* bind instance services to the class*/
+  }
+  InsertService(class, kGetAttributeSingle, &GetAttributeSingle,
+                "GetAttributeSingle");
+
+  return class;
+}
+
+CipClass *CreateCipClassFromDefinition(const CipClassDefinition *definition) {
+  CipClass *class; /* pointer to the class struct */
+  CipInstance *instance; /* the one instance of the class */
+
+  OPENER_TRACE_INFO("creating class '%s' with id: 0x%"PRIX32" from definition\n",
+                    definition->class_name, definition->class_id);
+
+  class = GetCipClass(definition->class_id); /* check if an class with the ClassID already exists */
+  if (NULL != class) { /* should never try to redefine a class*/
+    OPENER_TRACE_ERR("class 0x%"PRIX32" already exists\n", definition->class_id);
+    return 0;
+  }
+
+  class = (CipClass*) CipCalloc(1, sizeof(CipClass)); /* create the class object*/
+  instance = (CipInstance *) CipCalloc(1, sizeof(CipInstance)); /* and its instance */
+
+  /* the instance services are used directly from the definition */
+  class->class_id = definition->class_id;
+  class->revision = definition->revision;
+  class->number_of_instances = 1;
+  class->instances = instance;
+  class->number_of_attributes = definition->number_of_instance_attributes;
+  class->highest_attribute_number = definition
+      ->highest_instance_attribute_number;
+  class->get_attribute_all_mask = definition->instance_get_attribute_all_mask;
+  class->number_of_services = definition->number_of_instance_services;
+  class->services = definition->instance_services;
+  class->class_name = definition->class_name;
+  class->definition = definition;
+
+  instance->instance_number = 1;
+  /* the attributes point to the data of the active stack */
+  CipAttributeStruct *attributes = (CipAttributeStruct *) CipCalloc(
+      definition->number_of_instance_attributes, sizeof(CipAttributeStruct));
+  for (int i = 0; i < definition->number_of_instance_attributes; i++) {
+    const CipAttributeDefinition *attribute_definition = &definition
+        ->instance_attributes[i];
+    attributes[i].attribute_number = attribute_definition->attribute_number;
+    attributes[i].type = attribute_definition->type;
+    attributes[i].attribute_flags = attribute_definition->attribute_flags;
+    attributes[i].data =
+        (NULL != attribute_definition->data) ?
+            attribute_definition->data :
+            (EipUint8 *) g_opener_stack
+                + attribute_definition->stack_data_offset;
+  }
+  instance->attributes = attributes;
+  instance->cip_class = class;
+  instance->next = 0;
+
+  CreateMetaClass(class, 0, definition->class_get_attribute_all_mask, 0);
+
+  if ((RegisterCipClass(class)) == kEipStatusError) { /* no memory to register class in Message Router */
+    return 0; /*TODO handle return value and clean up if necessary*/
+  }
+
+  return class;
+}
+
+void CreateMetaClass(CipClass *class, int number_of_class_attributes,
+                     EipUint32 get_all_class_attributes_mask,
+                     int number_of_class_services) {
+  CipClass *meta_class; /* pointer to the metaclass struct */
+
+  /* a metaClass is a class that holds the class attributes and services
+   CIP can talk to an instance, therefore an instance has a pointer to its class
+   CIP can talk to a class, therefore a class struct is a subclass of the instance struct,
+   and contains a pointer to a metaclass
+   CIP never explicitly addresses a metaclass*/
+
+  meta_class = (CipClass*) CipCalloc(1, sizeof(CipClass)); /* create the metaclass object*/
+
   meta_class->class_id = 0xffffffff; /* set metaclass ID (this should never be referenced) */
   meta_class->number_of_instances = 1; /* the class object is the only instance of the metaclass */
   meta_class->instances = (CipInstance *) class;
@@ -214,10 +451,10 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
   meta_class->get_attribute_all_mask = get_all_class_attributes_mask; /* indicate which attributes are included in class getAttributeAll*/
   meta_class->number_of_services = number_of_class_services
       + ((0 == get_all_class_attributes_mask) ? 1 : 2); /* the metaclass manages the behavior of the class itself */
-  class->services = 0;
-  meta_class->class_name = (char *) CipCalloc(1, strlen(name) + 6); /* fabricate the name "meta<classname>"*/
+  meta_class->class_name = (char *) CipCalloc(1, strlen(class->class_name) + 6); /* fabricate the name "meta<classname>"*/
   strcpy(meta_class->class_name, "meta-");
-  strcat(meta_class->class_name, name);
+  strcat(meta_class->class_name, class->class_name);
+  meta_class->definition = NULL;
 
   /* initialize the instance-specific fields of the Class struct*/
   class->m_stSuper.instance_number = 0; /* the class object is instance zero of the class it describes (weird, but that's the spec)*/
@@ -239,17 +476,6 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
   meta_class->services = (CipServiceStruct *) CipCalloc(
       meta_class->number_of_services, sizeof(CipServiceStruct));
 
-  class->services = (CipServiceStruct *) CipCalloc(class->number_of_services,
-                                                   sizeof(CipServiceStruct));
-
-  if (number_of_instances > 0) {
-    AddCipInstances(class, number_of_instances); /*TODO handle return value and clean up if necessary*/
-  }
-
-  if ((RegisterCipClass(class)) == kEipStatusError) { /* no memory to register class in Message Router */
-    return 0; /*TODO handle return value and clean up if necessary*/
-  }
-
   /* create the standard class attributes*/
   InsertAttribute((CipInstance *) class, 1, kCipUint, (void *) &class->revision,
                   kGetableSingleAndAll); /* revision */
@@ -275,25 +501,25 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
   }
   InsertService(meta_class, kGetAttributeSingle, &GetAttributeSingle,
                 "GetAttributeSingle");
-
-  /* create the standard instance services*/
-  if (0 != get_all_instance_attributes_mask) { /*only if the mask has values add the get_attribute_all service */
-    InsertService(class, kGetAttributeAll, &GetAttributeAll, "GetAttributeAll"); /* bind instance services to the class*/
-  }
-  InsertService(class, kGetAttributeSingle, &GetAttributeSingle,
-                "GetAttributeSingle");
-
-  return class;
 }
 
-void InsertAttribute(CipInstance *instance, EipUint16 attribute_number,
-                     EipUint8 cip_type, void *data, EipByte cip_flags) {
+EipStatus InsertAttribute(CipInstance *instance, EipUint16 attribute_number,
+                          EipUint8 cip_type, void *data, EipByte cip_flags) {
   int i;
   CipAttributeStruct *attribute;
 
-  attribute = instance->attributes;
-  OPENER_ASSERT(NULL != attribute);
-  /* adding a attribute to a class that was not declared to have any attributes is not allowed */
+  if (((0 != instance->instance_number)
+      && (NULL != instance->cip_class->definition))
+      || (NULL == instance->attributes)) {
+    /* the attributes of an instance created from a definition are fixed by it and
+     adding a attribute to a class that was not declared to have any attributes is not allowed */
+    OPENER_TRACE_ERR(
+        "Can not insert attribute %d into class: %"PRIu32", instance %"PRIu32"\n",
+        attribute_number, instance->cip_class->m_stSuper.instance_number,
+        instance->instance_number);
+    return kEipStatusError;
+  }
+  attribute = instance->attributes; /* allocated by AddCipInstances or CreateMetaClass */
   for (i = 0; i < instance->cip_class->number_of_attributes; i++) {
     if (attribute->data == NULL) { /* found non set attribute */
       attribute->attribute_number = attribute_number;
@@ -305,7 +531,7 @@ void InsertAttribute(CipInstance *instance, EipUint16 attribute_number,
       {
         instance->cip_class->highest_attribute_number = attribute_number;
       }
-      return;
+      return kEipStatusOk;
     }
     attribute++;
   }
@@ -314,18 +540,23 @@ void InsertAttribute(CipInstance *instance, EipUint16 attribute_number,
       "Tried to insert to many attributes into class: %"PRIu32", instance %"PRIu32"\n",
       instance->cip_class->m_stSuper.instance_number,
       instance->instance_number);
-  OPENER_ASSERT(0);
-  /* trying to insert too many attributes*/
+  return kEipStatusError; /* trying to insert too many attributes*/
 }
 
-void InsertService(CipClass * class, EipUint8 service_number,
-                   CipServiceFunction service_function, char *service_name) {
+EipStatus InsertService(CipClass * class, EipUint8 service_number,
+                        CipServiceFunction service_function,
+                        char *service_name) {
   int i;
   CipServiceStruct *p;
 
-  p = class->services; /* get a pointer to the service array*/
-  OPENER_ASSERT(p != 0);
-  /* adding a service to a class that was not declared to have services is not allowed*/
+  if ((NULL != class->definition) || (NULL == class->services)) {
+    /* the services of a class created from a definition are constant and
+     adding a service to a class that was not declared to have services is not allowed*/
+    OPENER_TRACE_ERR("Can not insert service 0x%x into class %s\n",
+                     service_number, class->class_name);
+    return kEipStatusError;
+  }
+  p = (CipServiceStruct *) class->services; /* get a pointer to the service array allocated by CreateCipClass or CreateMetaClass*/
   for (i = 0; i < class->number_of_services; i++) /* Iterate over all service slots attached to the class */
   {
     if (p->service_number == service_number || p->service_function == NULL) /* found undefined service slot*/
@@ -333,12 +564,13 @@ void InsertService(CipClass * class, EipUint8 service_number,
       p->service_number = service_number; /* fill in service number*/
       p->service_function = service_function; /* fill in function address*/
       p->name = service_name;
-      return;
+      return kEipStatusOk;
     }
     p++;
   }
-  OPENER_ASSERT(0);
-  /* adding more services than were declared is a no-no*/
+  OPENER_TRACE_ERR("Tried to insert to many services into class %s\n",
+                   class->class_name);
+  return kEipStatusError; /* adding more services than were declared is a no-no*/
 }
 
 CipAttributeStruct *GetCipAttribute(CipInstance * instance,
@@ -357,7 +589,21 @@ CipAttributeStruct *GetCipAttribute(CipInstance * instance,
   return 0;
 }
 
-/* TODO this needs to check for buffer overflow*/
+const CipAttributeDefinition *GetCipAttributeDefinition(
+    const CipClass *cip_class, EipUint16 attribute_number) {
+  const CipClassDefinition *definition = cip_class->definition;
+
+  if (NULL != definition) {
+    for (int i = 0; i < definition->number_of_instance_attributes; i++) {
+      if (attribute_number
+          == definition->instance_attributes[i].attribute_number) {
+        return &definition->instance_attributes[i];
+      }
+    }
+  }
+  return 0;
+}
+
 EipStatus GetAttributeSingle(CipInstance *instance,
                              CipMessageRouterRequest *message_router_request,
                              CipMessageRouterResponse *message_router_response) {
@@ -366,7 +612,7 @@ EipStatus GetAttributeSingle(CipInstance *instance,
 
   CipAttributeStruct *attribute = GetCipAttribute(
       instance, message_router_request->request_path.attribute_number);
-  EipByte *message = message_router_response->data;
+  CipResponseWriter writer;
 
   message_router_response->data_length = 0;
   message_router_response->reply_service = (0x80
@@ -399,251 +645,392 @@ EipStatus GetAttributeSingle(CipInstance *instance,
         BeforeAssemblyDataSend(instance);
       }
 
-      message_router_response->data_length = EncodeData(attribute->type,
-                                                        attribute->data,
-                                                        &message);
-      message_router_response->general_status = kCipErrorSuccess;
+      InitializeResponseWriter(&writer, message_router_response);
+      if (0 > WriteResponseData(&writer, attribute->type, attribute->data)) {
+        OPENER_TRACE_WARN("getAttribute %d: reply data too large\n",
+                          message_router_request->request_path.attribute_number);
+        message_router_response->general_status = kCipErrorReplyDataTooLarge;
+      } else {
+        message_router_response->data_length = GetResponseWriterLength(
+            &writer);
+        message_router_response->general_status = kCipErrorSuccess;
+      }
     }
   }
 
   return kEipStatusOkSend;
 }
 
+/** @brief Look up the descriptor of a CIP data type
+ *
+ * Only the CIP data types from kCipUsintUsint to kInternalUint6 are described,
+ * the table is indexed by the type code relative to kCipUsintUsint.
+ */
+#define CIP_TYPE_DESCRIPTOR_INDEX(cip_type) ((cip_type) - kCipUsintUsint)
+
+static const CipTypeDescriptor kCipTypeDescriptors[CIP_TYPE_DESCRIPTOR_INDEX(
+    kInternalUint6) + 1] = {
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipBool)] = { 1, true, EncodeCipUsint,
+      DecodeCipUsint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipSint)] = { 1, true, EncodeCipUsint,
+      DecodeCipUsint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUsint)] = { 1, true, EncodeCipUsint,
+      DecodeCipUsint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipByte)] = { 1, true, EncodeCipUsint,
+      DecodeCipUsint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipInt)] = { 2, true, EncodeCipUint,
+      DecodeCipUint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUint)] = { 2, true, EncodeCipUint,
+      DecodeCipUint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipWord)] = { 2, true, EncodeCipUint,
+      DecodeCipUint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipDint)] = { 4, true, EncodeCipUdint,
+      DecodeCipUdint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUdint)] = { 4, true, EncodeCipUdint,
+      DecodeCipUdint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipDword)] = { 4, true, EncodeCipUdint,
+      DecodeCipUdint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipReal)] = { 4, true, EncodeCipUdint,
+      DecodeCipUdint, NULL },
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipLint)] = { 8, true, EncodeCipUlint,
+      DecodeCipUlint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUlint)] = { 8, true, EncodeCipUlint,
+      DecodeCipUlint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipLword)] = { 8, true, EncodeCipUlint,
+      DecodeCipUlint, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipLreal)] = { 8, true, EncodeCipUlint,
+      DecodeCipUlint, NULL },
+#endif
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipString)] = { 0, false, EncodeCipString,
+      DecodeCipString, GetEncodedCipStringSize },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipShortString)] = { 0, false,
+      EncodeCipShortString, DecodeCipShortString,
+      GetEncodedCipShortStringSize },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipEpath)] = { 0, false, EncodeCipEpath, NULL,
+      GetEncodedCipEpathSize },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUsintUsint)] = { 2, true, EncodeCipRevision,
+      NULL, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipUdintUdintUdintUdintUdintString)] = { 0,
+      false, EncodeCipTcpIpNetworkInterfaceConfiguration, NULL,
+      GetEncodedCipTcpIpNetworkInterfaceConfigurationSize },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCip6Usint)] = { 6, true, EncodeCip6Usint, NULL,
+      NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCipByteArray)] = { 0, false, EncodeCipByteArray,
+      NULL, GetEncodedCipByteArraySize },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCip11Udint)] = { 44, true, EncodeCip11Udint,
+      NULL, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kCip12Udint)] = { 48, true, EncodeCip12Udint,
+      NULL, NULL },
+  [CIP_TYPE_DESCRIPTOR_INDEX(kInternalUint6)] = { 12, true,
+      EncodeInternalUint6, NULL, NULL }, };
+
+const CipTypeDescriptor *GetCipTypeDescriptor(EipUint8 cip_type) {
+  if ((cip_type < kCipUsintUsint) || (cip_type > kInternalUint6)) {
+    return NULL;
+  }
+  const CipTypeDescriptor *descriptor =
+      &kCipTypeDescriptors[CIP_TYPE_DESCRIPTOR_INDEX(cip_type)];
+  return (NULL != descriptor->encode) ? descriptor : NULL;
+}
+
 int EncodeData(EipUint8 cip_type, void *data, EipUint8 **message) {
-  int counter = 0;
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_type);
 
-  switch (cip_type)
-  /* check the data type of attribute */
-  {
-    case (kCipBool):
-    case (kCipSint):
-    case (kCipUsint):
-    case (kCipByte):
-      **message = *(EipUint8 *) (data);
-      ++(*message);
-      counter = 1;
-      break;
+  if (NULL == descriptor) {
+    return 0;
+  }
+  return descriptor->encode(data, message);
+}
 
-    case (kCipInt):
-    case (kCipUint):
-    case (kCipWord):
-      AddIntToMessage(*(EipUint16 *) (data), message);
-      counter = 2;
-      break;
+int DecodeData(EipUint8 cip_type, void *data, EipUint8 **message) {
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_type);
 
-    case (kCipDint):
-    case (kCipUdint):
-    case (kCipDword):
-    case (kCipReal):
-      AddDintToMessage(*(EipUint32 *) (data), message);
-      counter = 4;
-      break;
+  if ((NULL == descriptor) || (NULL == descriptor->decode)) {
+    return -1;
+  }
+  return descriptor->decode(data, message);
+}
+
+int GetEncodedDataSize(EipUint8 cip_type, const void *data) {
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_type);
+
+  if (NULL == descriptor) {
+    return 0;
+  }
+  if (descriptor->fixed_width) {
+    return descriptor->size;
+  }
+  return descriptor->encoded_size(data);
+}
 
+int EncodeDataArray(EipUint8 cip_type, const void *data,
+                    size_t number_of_elements, EipUint8 **message) {
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_type);
+
+  /* only the elementary types are stored as plain arrays of host integers */
+  if ((NULL == descriptor) || (cip_type < kCipBool)) {
+    return -1;
+  }
+
+  switch (descriptor->size) {
+    case 1:
+      return AddSintArrayToMessage(data, number_of_elements, message);
+    case 2:
+      return AddIntArrayToMessage(data, number_of_elements, message);
+    case 4:
+      return AddDintArrayToMessage(data, number_of_elements, message);
 #ifdef OPENER_SUPPORT_64BIT_DATATYPES
-    case (kCipLint):
-    case (kCipUlint):
-    case (kCipLword):
-    case (kCipLreal):
-      AddLintToMessage(*(EipUint64 *) (data), message);
-      counter = 8;
-      break;
+    case 8:
+      return AddLintArrayToMessage(data, number_of_elements, message);
 #endif
+    default:
+      return -1;
+  }
+}
 
-    case (kCipStime):
-    case (kCipDate):
-    case (kCipTimeOfDay):
-    case (kCipDateAndTime):
-      break;
-    case (kCipString): {
-      CipString *string = (CipString *) data;
+int DecodeDataArray(EipUint8 cip_type, void *data, size_t number_of_elements,
+                    EipUint8 **message) {
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_type);
 
-      AddIntToMessage(*(EipUint16 *) &(string->length), message);
-      memcpy(*message, string->string, string->length);
-      *message += string->length;
+  if ((NULL == descriptor) || (cip_type < kCipBool)) {
+    return -1;
+  }
 
-      counter = string->length + 2; /* we have a two byte length field */
-      if (counter & 0x01) {
-        /* we have an odd byte count */
-        **message = 0;
-        ++(*message);
-        counter++;
-      }
+  switch (descriptor->size) {
+    case 1:
+      memcpy(data, *message, number_of_elements);
+      *message += number_of_elements;
       break;
-    }
-    case (kCipString2):
-    case (kCipFtime):
-    case (kCipLtime):
-    case (kCipItime):
-    case (kCipStringN):
+    case 2:
+      GetIntArrayFromMessage(data, number_of_elements, message);
       break;
+    case 4:
+      GetDintArrayFromMessage(data, number_of_elements, message);
+      break;
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+    case 8:
+      GetLintArrayFromMessage(data, number_of_elements, message);
+      break;
+#endif
+    default:
+      return -1;
+  }
+  return descriptor->size * number_of_elements;
+}
 
-    case (kCipShortString): {
-      CipShortString *short_string = (CipShortString *) data;
+void InitializeResponseWriter(CipResponseWriter *writer,
+                              CipMessageRouterResponse *message_router_response) {
+  writer->start = message_router_response->data;
+  writer->current_position = message_router_response->data;
+  writer->end = message_router_response->data_end;
+  writer->overflow = false;
+}
 
-      **message = short_string->length;
-      ++(*message);
+int WriteResponseData(CipResponseWriter *writer, EipUint8 cip_data_type,
+                      const void *cip_data) {
+  int encoded_size = GetEncodedDataSize(cip_data_type, cip_data);
 
-      memcpy(*message, short_string->string, short_string->length);
-      *message += short_string->length;
+  if (writer->end - writer->current_position < encoded_size) {
+    writer->overflow = true;
+    return -1;
+  }
+  return EncodeData(cip_data_type, (void *) cip_data,
+                    &writer->current_position);
+}
 
-      counter = short_string->length + 1;
-      break;
-    }
+int WriteResponseDataArray(CipResponseWriter *writer, EipUint8 cip_data_type,
+                           const void *cip_data, size_t number_of_elements) {
+  const CipTypeDescriptor *descriptor = GetCipTypeDescriptor(cip_data_type);
 
-    case (kCipTime):
-      break;
+  if ((NULL == descriptor) || !descriptor->fixed_width) {
+    return -1;
+  }
+  if ((size_t) (writer->end - writer->current_position)
+      < descriptor->size * number_of_elements) {
+    writer->overflow = true;
+    return -1;
+  }
+  return EncodeDataArray(cip_data_type, cip_data, number_of_elements,
+                         &writer->current_position);
+}
 
-    case (kCipEpath):
-      counter = EncodeEPath((CipEpath *) data, message);
-      break;
+EipInt16 GetResponseWriterLength(const CipResponseWriter *writer) {
+  return (EipInt16) (writer->current_position - writer->start);
+}
 
-    case (kCipEngUnit):
-      break;
+int EncodeCipUsint(const void *data, EipUint8 **message) {
+  return AddSintToMessage(*(const EipUint8 *) data, message);
+}
 
-    case (kCipUsintUsint): {
-      CipRevision *revision = (CipRevision *) data;
+int EncodeCipUint(const void *data, EipUint8 **message) {
+  return AddIntToMessage(*(const EipUint16 *) data, message);
+}
 
-      **message = revision->major_revision;
-      ++(*message);
-      **message = revision->minor_revision;
-      ++(*message);
-      counter = 2;
-      break;
-    }
+int EncodeCipUdint(const void *data, EipUint8 **message) {
+  return AddDintToMessage(*(const EipUint32 *) data, message);
+}
 
-    case (kCipUdintUdintUdintUdintUdintString): {
-      /* TCP/IP attribute 5 */
-      CipTcpIpNetworkInterfaceConfiguration *tcp_ip_network_interface_configuration =
-          (CipTcpIpNetworkInterfaceConfiguration *) data;
-      counter += AddDintToMessage(
-          ntohl(tcp_ip_network_interface_configuration->ip_address), message);
-      counter += AddDintToMessage(
-          ntohl(tcp_ip_network_interface_configuration->network_mask), message);
-      counter += AddDintToMessage(ntohl(tcp_ip_network_interface_configuration->gateway),
-                       message);
-      counter += AddDintToMessage(
-          ntohl(tcp_ip_network_interface_configuration->name_server), message);
-      counter += AddDintToMessage(
-          ntohl(tcp_ip_network_interface_configuration->name_server_2),
-          message);
-      counter += EncodeData(
-          kCipString, &(tcp_ip_network_interface_configuration->domain_name),
-          message);
-      break;
-    }
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+int EncodeCipUlint(const void *data, EipUint8 **message) {
+  return AddLintToMessage(*(const EipUint64 *) data, message);
+}
+#endif
 
-    case (kCip6Usint): {
-      EipUint8 *p = (EipUint8 *) data;
-      memcpy(*message, p, 6);
-      counter = 6;
-      break;
-    }
+int EncodeCipString(const void *data, EipUint8 **message) {
+  const CipString *string = (const CipString *) data;
 
-    case (kCipMemberList):
-      break;
+  int encoded_length = AddIntToMessage(string->length, message);
+  memcpy(*message, string->string, string->length);
+  *message += string->length;
+  encoded_length += string->length;
 
-    case (kCipByteArray): {
-      CipByteArray *cip_byte_array;
-      OPENER_TRACE_INFO(" -> get attribute byte array\r\n");
-      cip_byte_array = (CipByteArray *) data;
-      memcpy(*message, cip_byte_array->data, cip_byte_array->length);
-      *message += cip_byte_array->length;
-      counter = cip_byte_array->length;
-    }
-      break;
+  if (encoded_length & 0x01) {
+    /* we have an odd byte count */
+    encoded_length += AddSintToMessage(0, message);
+  }
+  return encoded_length;
+}
 
-    case (kInternalUint6): /* TODO for port class attribute 9, hopefully we can find a better way to do this*/
-    {
-      EipUint16 *internal_unit16_6 = (EipUint16 *) data;
-
-      AddIntToMessage(internal_unit16_6[0], message);
-      AddIntToMessage(internal_unit16_6[1], message);
-      AddIntToMessage(internal_unit16_6[2], message);
-      AddIntToMessage(internal_unit16_6[3], message);
-      AddIntToMessage(internal_unit16_6[4], message);
-      AddIntToMessage(internal_unit16_6[5], message);
-      counter = 12;
-      break;
-    }
-    default:
-      break;
+int EncodeCipShortString(const void *data, EipUint8 **message) {
+  const CipShortString *short_string = (const CipShortString *) data;
 
-  }
+  AddSintToMessage(short_string->length, message);
+  memcpy(*message, short_string->string, short_string->length);
+  *message += short_string->length;
+  return short_string->length + 1;
+}
 
-  return counter;
+int EncodeCipEpath(const void *data, EipUint8 **message) {
+  return EncodeEPath((CipEpath *) data, message);
 }
 
-int DecodeData(EipUint8 cip_type, void *data, EipUint8 **message) {
-  int number_of_decoded_bytes = -1;
+int EncodeCipRevision(const void *data, EipUint8 **message) {
+  const CipRevision *revision = (const CipRevision *) data;
 
-  switch (cip_type)
-  /* check the data type of attribute */
-  {
-    case (kCipBool):
-    case (kCipSint):
-    case (kCipUsint):
-    case (kCipByte):
-      *(EipUint8 *) (data) = **message;
-      ++(*message);
-      number_of_decoded_bytes = 1;
-      break;
+  AddSintToMessage(revision->major_revision, message);
+  AddSintToMessage(revision->minor_revision, message);
+  return 2;
+}
 
-    case (kCipInt):
-    case (kCipUint):
-    case (kCipWord):
-      (*(EipUint16 *) (data)) = GetIntFromMessage(message);
-      number_of_decoded_bytes = 2;
-      break;
+int EncodeCipTcpIpNetworkInterfaceConfiguration(const void *data,
+                                                EipUint8 **message) {
+  /* TCP/IP attribute 5 */
+  const CipTcpIpNetworkInterfaceConfiguration *tcp_ip_network_interface_configuration =
+      (const CipTcpIpNetworkInterfaceConfiguration *) data;
+  int encoded_length = 0;
+
+  encoded_length += AddDintToMessage(
+      ntohl(tcp_ip_network_interface_configuration->ip_address), message);
+  encoded_length += AddDintToMessage(
+      ntohl(tcp_ip_network_interface_configuration->network_mask), message);
+  encoded_length += AddDintToMessage(
+      ntohl(tcp_ip_network_interface_configuration->gateway), message);
+  encoded_length += AddDintToMessage(
+      ntohl(tcp_ip_network_interface_configuration->name_server), message);
+  encoded_length += AddDintToMessage(
+      ntohl(tcp_ip_network_interface_configuration->name_server_2), message);
+  encoded_length += EncodeCipString(
+      &(tcp_ip_network_interface_configuration->domain_name), message);
+  return encoded_length;
+}
 
-    case (kCipDint):
-    case (kCipUdint):
-    case (kCipDword):
-      (*(EipUint32 *) (data)) = GetDintFromMessage(message);
-      number_of_decoded_bytes = 4;
-      break;
+int EncodeCip6Usint(const void *data, EipUint8 **message) {
+  return AddSintArrayToMessage((const EipUint8 *) data, 6, message);
+}
+
+int EncodeCipByteArray(const void *data, EipUint8 **message) {
+  const CipByteArray *cip_byte_array = (const CipByteArray *) data;
+
+  OPENER_TRACE_INFO(" -> get attribute byte array\r\n");
+  return AddSintArrayToMessage(cip_byte_array->data, cip_byte_array->length,
+                               message);
+}
+
+int EncodeCip11Udint(const void *data, EipUint8 **message) {
+  return AddDintArrayToMessage((const EipUint32 *) data, 11, message);
+}
+
+int EncodeCip12Udint(const void *data, EipUint8 **message) {
+  return AddDintArrayToMessage((const EipUint32 *) data, 12, message);
+}
+
+int EncodeInternalUint6(const void *data, EipUint8 **message) {
+  /* TODO for port class attribute 9, hopefully we can find a better way to do this*/
+  return AddIntArrayToMessage((const EipUint16 *) data, 6, message);
+}
+
+int DecodeCipUsint(void *data, EipUint8 **message) {
+  *(EipUint8 *) data = GetSintFromMessage(message);
+  return 1;
+}
+
+int DecodeCipUint(void *data, EipUint8 **message) {
+  *(EipUint16 *) data = GetIntFromMessage(message);
+  return 2;
+}
+
+int DecodeCipUdint(void *data, EipUint8 **message) {
+  *(EipUint32 *) data = GetDintFromMessage(message);
+  return 4;
+}
 
 #ifdef OPENER_SUPPORT_64BIT_DATATYPES
-    case (kCipLint):
-    case (kCipUlint):
-    case (kCipLword): {
-      (*(EipUint64 *) (data)) = GetLintFromMessage(message);
-      number_of_decoded_bytes = 8;
-    }
-      break;
+int DecodeCipUlint(void *data, EipUint8 **message) {
+  *(EipUint64 *) data = GetLintFromMessage(message);
+  return 8;
+}
 #endif
 
-    case (kCipString): {
-      CipString *string = (CipString *) data;
-      string->length = GetIntFromMessage(message);
-      memcpy(string->string, *message, string->length);
-      *message += string->length;
+int DecodeCipString(void *data, EipUint8 **message) {
+  CipString *string = (CipString *) data;
 
-      number_of_decoded_bytes = string->length + 2; /* we have a two byte length field */
-      if (number_of_decoded_bytes & 0x01) {
-        /* we have an odd byte count */
-        ++(*message);
-        number_of_decoded_bytes++;
-      }
-    }
-      break;
-    case (kCipShortString): {
-      CipShortString *short_string = (CipShortString *) data;
+  string->length = GetIntFromMessage(message);
+  memcpy(string->string, *message, string->length);
+  *message += string->length;
 
-      short_string->length = **message;
-      ++(*message);
+  int number_of_decoded_bytes = string->length + 2; /* we have a two byte length field */
+  if (number_of_decoded_bytes & 0x01) {
+    /* we have an odd byte count */
+    ++(*message);
+    number_of_decoded_bytes++;
+  }
+  return number_of_decoded_bytes;
+}
 
-      memcpy(short_string->string, *message, short_string->length);
-      *message += short_string->length;
+int DecodeCipShortString(void *data, EipUint8 **message) {
+  CipShortString *short_string = (CipShortString *) data;
 
-      number_of_decoded_bytes = short_string->length + 1;
-      break;
-    }
+  short_string->length = GetSintFromMessage(message);
+  memcpy(short_string->string, *message, short_string->length);
+  *message += short_string->length;
+  return short_string->length + 1;
+}
 
-    default:
-      break;
-  }
+int GetEncodedCipStringSize(const void *data) {
+  const CipString *string = (const CipString *) data;
+  /* two byte length field and a pad byte for odd lengths */
+  return 2 + string->length + (string->length & 0x01);
+}
 
-  return number_of_decoded_bytes;
+int GetEncodedCipShortStringSize(const void *data) {
+  return 1 + ((const CipShortString *) data)->length;
+}
+
+int GetEncodedCipEpathSize(const void *data) {
+  return 2 + ((const CipEpath *) data)->path_size * 2;
+}
+
+int GetEncodedCipTcpIpNetworkInterfaceConfigurationSize(const void *data) {
+  const CipTcpIpNetworkInterfaceConfiguration *tcp_ip_network_interface_configuration =
+      (const CipTcpIpNetworkInterfaceConfiguration *) data;
+  return 5 * 4
+      + GetEncodedCipStringSize(
+          &(tcp_ip_network_interface_configuration->domain_name));
+}
+
+int GetEncodedCipByteArraySize(const void *data) {
+  return ((const CipByteArray *) data)->length;
 }
 
 EipStatus GetAttributeAll(CipInstance *instance,
@@ -652,7 +1039,7 @@ EipStatus GetAttributeAll(CipInstance *instance,
   int i, j;
   EipUint8 *reply;
   CipAttributeStruct *attribute;
-  CipServiceStruct *service;
+  const CipServiceStruct *service;
 
   reply = message_router_response->data; /* pointer into the reply */
   attribute = instance->attributes; /* pointer to list of attributes*/
@@ -686,6 +1073,12 @@ EipStatus GetAttributeAll(CipInstance *instance,
               message_router_response->data = reply;
               return kEipStatusError;
             }
+            if (kCipErrorReplyDataTooLarge
+                == message_router_response->general_status) {
+              message_router_response->data_length = 0;
+              message_router_response->data = reply;
+              return kEipStatusOkSend;
+            }
             message_router_response->data += message_router_response
                 ->data_length;
           }
@@ -13,14 +13,6 @@
 #include "typedefs.h"
 #include "ciptypes.h"
 
-/** A buffer for holding the replay generated by explicit message requests
- *  or producing I/O connections. These will use this buffer in the following
- *  ways:
- *    1. Explicit messages will use this buffer to store the data generated by the request
- *    2. I/O Connections will use this buffer for the produced data
- */
-extern EipUint8 g_message_data_reply_buffer[];
-
 /** @brief Check if requested service present in class/instance and call appropriate service.
  *
  * @param class class receiving the message
@@ -23,6 +23,8 @@
 #include "appcontype.h"
 #include "encap.h"
 #include "generic_networkhandler.h"
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /* values needed from the CIP identity object */
 extern EipUint16 vendor_id_;
@@ -32,40 +34,40 @@ extern CipRevision revision_;
 
 #define CIP_CONN_TYPE_MASK 0x6000   /**< Bit mask filter on bit 13 & 14 */
 
+/** @brief Length of the CPF header of a class 0/1 I/O message: item count,
+ * sequenced address item and the header of the connected data item */
+static const int kIoMessageHeaderLength = 18;
+
 const int g_kForwardOpenHeaderLength = 36; /**< the length in bytes of the forward open command specific data till the start of the connection path (including con path size)*/
 
 /** @brief Compares the logical path on equality */
 #define EQLOGICALPATH(x,y) (((x)&0xfc)==(y))
 
-static const int g_kNumberOfConnectableObjects = 2
-    + OPENER_CIP_NUM_APPLICATION_SPECIFIC_CONNECTABLE_OBJECTS;
-
-typedef struct {
-  EipUint32 class_id;
-  OpenConnectionFunction open_connection_function;
-} ConnectionManagementHandling;
-
-/* global variables private */
-/** List holding information on the object classes and open/close function
- * pointers to which connections may be established.
- */
-ConnectionManagementHandling g_astConnMgmList[2
-    + OPENER_CIP_NUM_APPLICATION_SPECIFIC_CONNECTABLE_OBJECTS];
-
-/** List holding all currently active connections*/
-/*@null@*/ConnectionObject *g_active_connection_list = NULL;
-
-/** buffer connection object needed for forward open */
-ConnectionObject g_dummy_connection_object;
-
-/** @brief Holds the connection ID's "incarnation ID" in the upper 16 bits */
-EipUint32 g_incarnation_id;
-
 /* private functions */
 EipStatus ForwardOpen(CipInstance *instance,
                       CipMessageRouterRequest *message_router_request,
                       CipMessageRouterResponse *message_router_response);
 
+/** @brief Process a forward open request
+ *
+ * Does the actual work of the ForwardOpen service, which measures the
+ * processing time of this function.
+ */
+EipStatus HandleForwardOpenRequest(
+    CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response);
+
+/** @brief Admission control of forward open requests
+ *
+ * Limits the number of forward open requests accepted per timer tick in total
+ * and per originator.
+ *
+ * @param connection_object connection object holding the originator's vendor
+ *                          ID and serial number
+ * @return true if the request may be processed, false if it has to be refused
+ */
+EipBool8 AdmitForwardOpen(ConnectionObject *connection_object);
+
 EipStatus ForwardClose(CipInstance *instance,
                        CipMessageRouterRequest *message_router_request,
                        CipMessageRouterResponse *message_router_response);
@@ -86,6 +88,35 @@ EipStatus AssembleForwardCloseResponse(
     CipMessageRouterResponse *message_router_response,
     EipUint16 extended_error_code);
 
+/** @brief Account a consumed packet in the receive statistics of the connection
+ *
+ *  @param connection_object the connection the packet has been received for
+ *  @param receive_time time of arrival of the packet
+ */
+void UpdateReceiveStatistics(ConnectionObject *connection_object,
+                             MicroSeconds receive_time);
+
+/** @brief Hand data received for a connection to the connection
+ *
+ *  Checks the originator's address and the sequence number, updates the
+ *  watchdog and the receive statistics and passes the data on to the
+ *  connection's receive function.
+ *
+ *  @param connection_object the connection the data has been received for
+ *  @param sequence_number EtherNet/IP level sequence number of the data
+ *  @param data pointer to the connected data
+ *  @param data_length length of the connected data
+ *  @param from_address address the data has been received from
+ *  @param receive_time time of arrival of the data
+ *  @return result of the receive function, kEipStatusOk if the data was
+ *  discarded
+ */
+EipStatus HandleConsumedDataOfConnection(ConnectionObject *connection_object,
+                                         EipUint32 sequence_number,
+                                         EipUint8 *data, EipUint16 data_length,
+                                         struct sockaddr_in *from_address,
+                                         MicroSeconds receive_time);
+
 /** @brief check if the data given in the connection object match with an already established connection
  * 
  * The comparison is done according to the definitions in the CIP specification Section 3-5.5.2:
@@ -125,10 +156,66 @@ EipUint8 ParseConnectionPath(ConnectionObject *connection_object,
                              CipMessageRouterRequest *message_router_request,
                              EipUint16 *extended_error);
 
+/** @brief Search the connection path cache for the path of a forward open request
+ *
+ * @param connection_object connection object holding the already parsed
+ *                          forward open header
+ * @param path pointer to the path bytes following the path size
+ * @return the cache entry with the identical path, NULL if there is none
+ */
+ConnectionPathCacheEntry *FindConnectionPathCacheEntry(
+    ConnectionObject *connection_object, EipUint8 *path);
+
+/** @brief Store the result of a successfully parsed connection path in the cache
+ *
+ * @param connection_object connection object holding the parse results
+ * @param path pointer to the path bytes following the path size
+ * @param parsed_length number of bytes the parser consumed from the path
+ */
+void StoreConnectionPathCacheEntry(ConnectionObject *connection_object,
+                                   EipUint8 *path, unsigned int parsed_length);
+
+/** @brief Get the assembly index entry of an assembly
+ *
+ * @param assembly instance number of the assembly
+ * @param create_entry if true an unused entry is taken for an assembly not
+ *                     in the index yet
+ * @return the index entry, NULL if there is none
+ */
+AssemblyIndexEntry *GetAssemblyIndexEntry(EipUint32 assembly,
+                                          EipBool8 create_entry);
+
+/** @brief Release an assembly index entry no connection uses anymore
+ *
+ * Entries following it in the same probe sequence are moved up, so that
+ * lookups can stop at the first unused slot.
+ *
+ * @param entry the entry to release, it may be reused by another assembly
+ *              afterwards
+ */
+void FreeAssemblyIndexEntry(AssemblyIndexEntry *entry);
+
+/** @brief Add an I/O connection to the assembly index entries of its
+ * connection points */
+void AddToAssemblyIndex(ConnectionObject *connection_object);
+
+/** @brief Remove an I/O connection from the assembly index entries of its
+ * connection points */
+void RemoveFromAssemblyIndex(ConnectionObject *connection_object);
+
 ConnectionManagementHandling* GetConnMgmEntry(EipUint32 class_id);
 
 void InitializeConnectionManagerData(void);
 
+/** @brief Account a refused forward open request in the counters of the
+ * Connection Manager object
+ *
+ * @param general_status general status of the reply
+ * @param extended_status extended status of the reply
+ */
+void CountRejectedForwardOpen(EipUint8 general_status,
+                              EipUint16 extended_status);
+
 void AddNullAddressItem(
     CipCommonPacketFormatData* common_data_packet_format_data);
 
@@ -159,35 +246,59 @@ unsigned int GetPaddedLogicalPath(unsigned char **logical_path_segment) {
  * @return new connection id
  */
 EipUint32 GetConnectionId(void) {
-  static EipUint32 connection_id = 18;
-  connection_id++;
-  return (g_incarnation_id | (connection_id & 0x0000FFFF));
+  g_opener_stack->last_connection_id++;
+  return (g_opener_stack->incarnation_id
+      | (g_opener_stack->last_connection_id & 0x0000FFFF));
 }
 
+/** @brief Attributes of the Connection Manager object instance */
+static const CipAttributeDefinition kConnectionManagerInstanceAttributes[] = {
+    CIP_STACK_ATTRIBUTE(1, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.open_requests),
+    CIP_STACK_ATTRIBUTE(2, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.open_format_rejects),
+    CIP_STACK_ATTRIBUTE(3, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.open_resource_rejects),
+    CIP_STACK_ATTRIBUTE(4, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.open_other_rejects),
+    CIP_STACK_ATTRIBUTE(5, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.close_requests),
+    CIP_STACK_ATTRIBUTE(6, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.close_format_rejects),
+    CIP_STACK_ATTRIBUTE(7, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.close_other_rejects),
+    CIP_STACK_ATTRIBUTE(8, kCipUint, kGetableSingleAndAll,
+        connection_manager_counters.connection_timeouts) };
+
+/** @brief Services of the Connection Manager object instance */
+static const CipServiceStruct kConnectionManagerInstanceServices[] = {
+    { kGetAttributeAll, &GetAttributeAll, "GetAttributeAll" },
+    { kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle" },
+    { kForwardOpen, &ForwardOpen, "ForwardOpen" },
+    { kForwardClose, &ForwardClose, "ForwardClose" },
+    { kGetConnectionOwner, &GetConnectionOwner, "GetConnectionOwner" } };
+
+/** @brief Definition of the Connection Manager object */
+static const CipClassDefinition kConnectionManagerClassDefinition = {
+    g_kCipConnectionManagerClassCode, /* class ID */
+    "connection manager", /* class name */
+    1, /* class revision */
+    0xC6, /* class getAttributeAll mask */
+    kConnectionManagerInstanceAttributes,
+    CIP_TABLE_ENTRIES(kConnectionManagerInstanceAttributes),
+    8, /* highest instance attribute number */
+    0xffffffff, /* instance getAttributeAll mask */
+    kConnectionManagerInstanceServices,
+    CIP_TABLE_ENTRIES(kConnectionManagerInstanceServices) };
+
 EipStatus ConnectionManagerInit(EipUint16 unique_connection_id) {
   InitializeConnectionManagerData();
 
-  CipClass *connection_manager = CreateCipClass(
-      g_kCipConnectionManagerClassCode, /* class ID */
-      0, /* # of class attributes */
-      0xC6, /* class getAttributeAll mask */
-      0, /* # of class services */
-      0, /* # of instance attributes */
-      0xffffffff, /* instance getAttributeAll mask */
-      3, /* # of instance services */
-      1, /* # of instances */
-      "connection manager", /* class name */
-      1); /* revision */
-  if (connection_manager == NULL)
+  if (NULL == CreateCipClassFromDefinition(&kConnectionManagerClassDefinition)) {
     return kEipStatusError;
+  }
 
-  InsertService(connection_manager, kForwardOpen, &ForwardOpen, "ForwardOpen");
-  InsertService(connection_manager, kForwardClose, &ForwardClose,
-                "ForwardClose");
-  InsertService(connection_manager, kGetConnectionOwner, &GetConnectionOwner,
-                "GetConnectionOwner");
-
-  g_incarnation_id = ((EipUint32) unique_connection_id) << 16;
+  g_opener_stack->incarnation_id = ((EipUint32) unique_connection_id) << 16;
 
   AddConnectableObject(kCipMessageRouterClassCode, EstablishClass3Connection);
   AddConnectableObject(kCipAssemblyClassCode, EstablishIoConnction);
@@ -195,56 +306,145 @@ EipStatus ConnectionManagerInit(EipUint16 unique_connection_id) {
   return kEipStatusOk;
 }
 
+void UpdateReceiveStatistics(ConnectionObject *connection_object,
+                             MicroSeconds receive_time) {
+  ConnectionReceiveStatistics *statistics = &connection_object
+      ->receive_statistics;
+
+  if ((0 != statistics->received_packets)
+      && (receive_time >= statistics->last_receive_time)) {
+    MicroSeconds inter_arrival_time = receive_time
+        - statistics->last_receive_time;
+    MicroSeconds requested_packet_interval = connection_object
+        ->o_to_t_requested_packet_interval;
+    MicroSeconds rpi_deviation =
+        (inter_arrival_time > requested_packet_interval) ?
+            inter_arrival_time - requested_packet_interval :
+            requested_packet_interval - inter_arrival_time;
+
+    if ((1 == statistics->received_packets)
+        || (inter_arrival_time < statistics->min_inter_arrival_time)) {
+      statistics->min_inter_arrival_time = inter_arrival_time;
+    }
+    if (inter_arrival_time > statistics->max_inter_arrival_time) {
+      statistics->max_inter_arrival_time = inter_arrival_time;
+    }
+    if (rpi_deviation > statistics->max_rpi_deviation) {
+      statistics->max_rpi_deviation = rpi_deviation;
+    }
+    statistics->total_rpi_deviation += rpi_deviation;
+
+    size_t bin = OPENER_RECEIVE_HISTOGRAM_BINS - 1;
+    if (0 != requested_packet_interval) {
+      MicroSeconds quarters = inter_arrival_time * 4 / requested_packet_interval;
+      if (quarters < bin) {
+        bin = quarters;
+      }
+    }
+    statistics->inter_arrival_histogram[bin]++;
+  }
+  statistics->last_receive_time = receive_time;
+  statistics->received_packets++;
+}
+
+EipStatus HandleConsumedDataOfConnection(ConnectionObject *connection_object,
+                                         EipUint32 sequence_number,
+                                         EipUint8 *data, EipUint16 data_length,
+                                         struct sockaddr_in *from_address,
+                                         MicroSeconds receive_time) {
+  /* only handle the data if it is coming from the originator */
+  if (connection_object->originator_address.sin_addr.s_addr
+      != from_address->sin_addr.s_addr) {
+    OPENER_TRACE_WARN(
+        "Connected Message Data Received with wrong address information\n");
+    connection_object->packet_statistics.wrong_originator_packets++;
+    g_opener_stack->opener_statistics.io_packets_wrong_originator++;
+    return kEipStatusOk;
+  }
+
+  if (SEQ_GT32(sequence_number,
+               connection_object->eip_level_sequence_count_consuming)) {
+    /* reset the watchdog timer */
+    connection_object->inactivity_watchdog_timer = (connection_object
+        ->o_to_t_requested_packet_interval / 1000)
+        << (2 + connection_object->connection_timeout_multiplier);
+
+    UpdateReceiveStatistics(connection_object, receive_time);
+    g_opener_stack->opener_statistics.io_packets_consumed++;
+
+    /* only inform assembly object if the sequence counter is greater or equal */
+    connection_object->eip_level_sequence_count_consuming = sequence_number;
+
+    if (NULL != connection_object->connection_receive_data_function) {
+      return connection_object->connection_receive_data_function(
+          connection_object, data, data_length);
+    }
+  } else {
+    connection_object->packet_statistics.duplicate_packets++;
+  }
+  return kEipStatusOk;
+}
+
 EipStatus HandleReceivedConnectedData(EipUint8 *data, int data_length,
-                                      struct sockaddr_in *from_address) {
+                                      struct sockaddr_in *from_address,
+                                      MicroSeconds receive_time) {
+  CipCommonPacketFormatData common_packet_format_data;
+
+  /* fast path for the fixed layout of class 0/1 I/O messages: item count 2,
+   * sequenced address item, connected data item filling the rest */
+  if (data_length >= kIoMessageHeaderLength) {
+    EipUint8 *message = data;
+    EipUint16 item_count = GetIntFromMessage(&message);
+    EipUint16 address_item_type_id = GetIntFromMessage(&message);
+    EipUint16 address_item_length = GetIntFromMessage(&message);
+    EipUint32 connection_id = GetDintFromMessage(&message);
+    EipUint32 sequence_number = GetDintFromMessage(&message);
+    EipUint16 data_item_type_id = GetIntFromMessage(&message);
+    EipUint16 data_item_length = GetIntFromMessage(&message);
+
+    if ((2 == item_count)
+        && (kCipItemIdSequencedAddressItem == address_item_type_id)
+        && (8 == address_item_length)
+        && (kCipItemIdConnectedDataItem == data_item_type_id)
+        && (data_length - kIoMessageHeaderLength == data_item_length)) {
+      ConnectionObject *connection_object = GetConnectedObject(connection_id);
+      if (NULL == connection_object) {
+        g_opener_stack->opener_statistics.io_packets_unknown_connection++;
+        return kEipStatusError;
+      }
+      return HandleConsumedDataOfConnection(connection_object, sequence_number,
+                                            message, data_item_length,
+                                            from_address, receive_time);
+    }
+  }
 
   if ((CreateCommonPacketFormatStructure(data, data_length,
-                                         &g_common_packet_format_data_item))
+                                         &common_packet_format_data))
       == kEipStatusError) {
     return kEipStatusError;
   } else {
     /* check if connected address item or sequenced address item  received, otherwise it is no connected message and should not be here */
-    if ((g_common_packet_format_data_item.address_item.type_id
+    if ((common_packet_format_data.address_item.type_id
         == kCipItemIdConnectionAddress)
-        || (g_common_packet_format_data_item.address_item.type_id
+        || (common_packet_format_data.address_item.type_id
             == kCipItemIdSequencedAddressItem)) { /* found connected address item or found sequenced address item -> for now the sequence number will be ignored */
-      if (g_common_packet_format_data_item.data_item.type_id
+      if (common_packet_format_data.data_item.type_id
           == kCipItemIdConnectedDataItem) { /* connected data item received */
 
         ConnectionObject *connection_object = GetConnectedObject(
-            g_common_packet_format_data_item.address_item.data
+            common_packet_format_data.address_item.data
                 .connection_identifier);
-        if (connection_object == NULL)
+        if (connection_object == NULL) {
+          g_opener_stack->opener_statistics.io_packets_unknown_connection++;
           return kEipStatusError;
-
-        /* only handle the data if it is coming from the originator */
-        if (connection_object->originator_address.sin_addr.s_addr
-            == from_address->sin_addr.s_addr) {
-
-          if (SEQ_GT32(
-              g_common_packet_format_data_item.address_item.data.sequence_number,
-              connection_object->eip_level_sequence_count_consuming)) {
-            /* reset the watchdog timer */
-            connection_object->inactivity_watchdog_timer = (connection_object
-                ->o_to_t_requested_packet_interval / 1000)
-                << (2 + connection_object->connection_timeout_multiplier);
-
-            /* only inform assembly object if the sequence counter is greater or equal */
-            connection_object->eip_level_sequence_count_consuming =
-                g_common_packet_format_data_item.address_item.data
-                    .sequence_number;
-
-            if (NULL != connection_object->connection_receive_data_function) {
-              return connection_object->connection_receive_data_function(
-                  connection_object,
-                  g_common_packet_format_data_item.data_item.data,
-                  g_common_packet_format_data_item.data_item.length);
-            }
-          }
-        } else {
-          OPENER_TRACE_WARN(
-              "Connected Message Data Received with wrong address information\n");
         }
+
+        return HandleConsumedDataOfConnection(
+            connection_object,
+            common_packet_format_data.address_item.data.sequence_number,
+            common_packet_format_data.data_item.data,
+            common_packet_format_data.data_item.length, from_address,
+            receive_time);
       }
     }
   }
@@ -261,123 +461,154 @@ EipStatus HandleReceivedConnectedData(EipUint8 *data, int data_length,
 EipStatus ForwardOpen(CipInstance *instance,
                       CipMessageRouterRequest *message_router_request,
                       CipMessageRouterResponse *message_router_response) {
+  (void) instance; /*suppress compiler warning */
+
+  MicroSeconds start_time = GetMicroSeconds();
+  EipStatus eip_status = HandleForwardOpenRequest(message_router_request,
+                                                  message_router_response);
+  MicroSeconds latency = GetMicroSeconds() - start_time;
+
+  g_opener_stack->forward_open_statistics.requests++;
+  g_opener_stack->connection_manager_counters.open_requests++;
+  if (latency > g_opener_stack->forward_open_statistics.max_latency) {
+    g_opener_stack->forward_open_statistics.max_latency = latency;
+  }
+  int bin = 0;
+  while ((bin < OPENER_FORWARD_OPEN_LATENCY_BINS - 1)
+      && (latency >= ((MicroSeconds) 1 << bin))) {
+    bin++;
+  }
+  g_opener_stack->forward_open_statistics.latency_histogram[bin]++;
+
+  return eip_status;
+}
+
+EipStatus HandleForwardOpenRequest(
+    CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response) {
   EipUint16 connection_status = kConnectionManagerStatusCodeSuccess;
   ConnectionManagementHandling *connection_management_entry;
 
-  (void) instance; /*suppress compiler warning */
-
   /*first check if we have already a connection with the given params */
-  g_dummy_connection_object.priority_timetick = *message_router_request->data++;
-  g_dummy_connection_object.timeout_ticks = *message_router_request->data++;
+  g_opener_stack->dummy_connection_object.priority_timetick = *message_router_request->data++;
+  g_opener_stack->dummy_connection_object.timeout_ticks = *message_router_request->data++;
   /* O_to_T Conn ID */
-  g_dummy_connection_object.consumed_connection_id = GetDintFromMessage(
+  g_opener_stack->dummy_connection_object.consumed_connection_id = GetDintFromMessage(
       &message_router_request->data);
   /* T_to_O Conn ID */
-  g_dummy_connection_object.produced_connection_id = GetDintFromMessage(
+  g_opener_stack->dummy_connection_object.produced_connection_id = GetDintFromMessage(
       &message_router_request->data);
-  g_dummy_connection_object.connection_serial_number = GetIntFromMessage(
+  g_opener_stack->dummy_connection_object.connection_serial_number = GetIntFromMessage(
       &message_router_request->data);
-  g_dummy_connection_object.originator_vendor_id = GetIntFromMessage(
+  g_opener_stack->dummy_connection_object.originator_vendor_id = GetIntFromMessage(
       &message_router_request->data);
-  g_dummy_connection_object.originator_serial_number = GetDintFromMessage(
+  g_opener_stack->dummy_connection_object.originator_serial_number = GetDintFromMessage(
       &message_router_request->data);
 
-  if ((NULL != CheckForExistingConnection(&g_dummy_connection_object))) {
+  if ((NULL != CheckForExistingConnection(&g_opener_stack->dummy_connection_object))) {
     /* TODO this test is  incorrect, see CIP spec 3-5.5.2 re: duplicate forward open
      it should probably be testing the connection type fields
      TODO think on how a reconfiguration request could be handled correctly */
-    if ((0 == g_dummy_connection_object.consumed_connection_id)
-        && (0 == g_dummy_connection_object.produced_connection_id)) {
+    if ((0 == g_opener_stack->dummy_connection_object.consumed_connection_id)
+        && (0 == g_opener_stack->dummy_connection_object.produced_connection_id)) {
       /*TODO implement reconfiguration of connection*/
 
       OPENER_TRACE_ERR(
           "this looks like a duplicate forward open -- I can't handle this yet, sending a CIP_CON_MGR_ERROR_CONNECTION_IN_USE response\n");
     }
     return AssembleForwardOpenResponse(
-        &g_dummy_connection_object, message_router_response,
+        &g_opener_stack->dummy_connection_object, message_router_response,
         kCipErrorConnectionFailure,
         kConnectionManagerStatusCodeErrorConnectionInUse);
   }
+  if (false == AdmitForwardOpen(&g_opener_stack->dummy_connection_object)) {
+    g_opener_stack->forward_open_statistics.rejected_requests++;
+    return AssembleForwardOpenResponse(
+        &g_opener_stack->dummy_connection_object, message_router_response,
+        kCipErrorConnectionFailure,
+        kConnectionManagerStatusCodeErrorNoMoreConnectionsAvailable);
+  }
+
   /* keep it to none existent till the setup is done this eases error handling and
    * the state changes within the forward open request can not be detected from
    * the application or from outside (reason we are single threaded)*/
-  g_dummy_connection_object.state = kConnectionStateNonExistent;
-  g_dummy_connection_object.sequence_count_producing = 0; /* set the sequence count to zero */
+  g_opener_stack->dummy_connection_object.state = kConnectionStateNonExistent;
+  g_opener_stack->dummy_connection_object.sequence_count_producing = 0; /* set the sequence count to zero */
 
-  g_dummy_connection_object.connection_timeout_multiplier =
+  g_opener_stack->dummy_connection_object.connection_timeout_multiplier =
       *message_router_request->data++;
   message_router_request->data += 3; /* reserved */
   /* the requested packet interval parameter needs to be a multiple of TIMERTICK from the header file */
   OPENER_TRACE_INFO(
       "ForwardOpen: ConConnID %"PRIu32", ProdConnID %"PRIu32", ConnSerNo %u\n",
-      g_dummy_connection_object.consumed_connection_id,
-      g_dummy_connection_object.produced_connection_id,
-      g_dummy_connection_object.connection_serial_number);
+      g_opener_stack->dummy_connection_object.consumed_connection_id,
+      g_opener_stack->dummy_connection_object.produced_connection_id,
+      g_opener_stack->dummy_connection_object.connection_serial_number);
 
-  g_dummy_connection_object.o_to_t_requested_packet_interval =
+  g_opener_stack->dummy_connection_object.o_to_t_requested_packet_interval =
       GetDintFromMessage(&message_router_request->data);
 
-  g_dummy_connection_object.o_to_t_network_connection_parameter =
+  g_opener_stack->dummy_connection_object.o_to_t_network_connection_parameter =
       GetIntFromMessage(&message_router_request->data);
-  g_dummy_connection_object.t_to_o_requested_packet_interval =
+  g_opener_stack->dummy_connection_object.t_to_o_requested_packet_interval =
       GetDintFromMessage(&message_router_request->data);
 
-  EipUint32 temp = g_dummy_connection_object.t_to_o_requested_packet_interval
+  EipUint32 temp = g_opener_stack->dummy_connection_object.t_to_o_requested_packet_interval
       % (kOpenerTimerTickInMilliSeconds * 1000);
   if (temp > 0) {
-    g_dummy_connection_object.t_to_o_requested_packet_interval =
-        (EipUint32) (g_dummy_connection_object.t_to_o_requested_packet_interval
+    g_opener_stack->dummy_connection_object.t_to_o_requested_packet_interval =
+        (EipUint32) (g_opener_stack->dummy_connection_object.t_to_o_requested_packet_interval
             / (kOpenerTimerTickInMilliSeconds * 1000))
             * (kOpenerTimerTickInMilliSeconds * 1000)
             + (kOpenerTimerTickInMilliSeconds * 1000);
   }
 
-  g_dummy_connection_object.t_to_o_network_connection_parameter =
+  g_opener_stack->dummy_connection_object.t_to_o_network_connection_parameter =
       GetIntFromMessage(&message_router_request->data);
 
   /*check if Network connection parameters are ok */
   if (CIP_CONN_TYPE_MASK
-      == (g_dummy_connection_object.o_to_t_network_connection_parameter
+      == (g_opener_stack->dummy_connection_object.o_to_t_network_connection_parameter
           & CIP_CONN_TYPE_MASK)) {
     return AssembleForwardOpenResponse(
-        &g_dummy_connection_object, message_router_response,
+        &g_opener_stack->dummy_connection_object, message_router_response,
         kCipErrorConnectionFailure,
         kConnectionManagerStatusCodeErrorInvalidOToTConnectionType);
   }
 
   if (CIP_CONN_TYPE_MASK
-      == (g_dummy_connection_object.t_to_o_network_connection_parameter
+      == (g_opener_stack->dummy_connection_object.t_to_o_network_connection_parameter
           & CIP_CONN_TYPE_MASK)) {
     return AssembleForwardOpenResponse(
-        &g_dummy_connection_object, message_router_response,
+        &g_opener_stack->dummy_connection_object, message_router_response,
         kCipErrorConnectionFailure,
         kConnectionManagerStatusCodeErrorInvalidTToOConnectionType);
   }
 
-  g_dummy_connection_object.transport_type_class_trigger =
+  g_opener_stack->dummy_connection_object.transport_type_class_trigger =
       *message_router_request->data++;
   /*check if the trigger type value is ok */
-  if (0x40 & g_dummy_connection_object.transport_type_class_trigger) {
+  if (0x40 & g_opener_stack->dummy_connection_object.transport_type_class_trigger) {
     return AssembleForwardOpenResponse(
-        &g_dummy_connection_object, message_router_response,
+        &g_opener_stack->dummy_connection_object, message_router_response,
         kCipErrorConnectionFailure,
         kConnectionManagerStatusCodeErrorTransportTriggerNotSupported);
   }
 
-  temp = ParseConnectionPath(&g_dummy_connection_object, message_router_request,
+  temp = ParseConnectionPath(&g_opener_stack->dummy_connection_object, message_router_request,
                              &connection_status);
   if (kEipStatusOk != temp) {
-    return AssembleForwardOpenResponse(&g_dummy_connection_object,
+    return AssembleForwardOpenResponse(&g_opener_stack->dummy_connection_object,
                                        message_router_response, temp,
                                        connection_status);
   }
 
   /*parsing is now finished all data is available and check now establish the connection */
   connection_management_entry = GetConnMgmEntry(
-      g_dummy_connection_object.connection_path.class_id);
+      g_opener_stack->dummy_connection_object.connection_path.class_id);
   if (NULL != connection_management_entry) {
     temp = connection_management_entry->open_connection_function(
-        &g_dummy_connection_object, &connection_status);
+        &g_opener_stack->dummy_connection_object, &connection_status);
   } else {
     temp = kEipStatusError;
     connection_status =
@@ -387,18 +618,118 @@ EipStatus ForwardOpen(CipInstance *instance,
   if (kEipStatusOk != temp) {
     OPENER_TRACE_INFO("connection manager: connect failed\n");
     /* in case of error the dummy objects holds all necessary information */
-    return AssembleForwardOpenResponse(&g_dummy_connection_object,
+    return AssembleForwardOpenResponse(&g_opener_stack->dummy_connection_object,
                                        message_router_response, temp,
                                        connection_status);
   } else {
     OPENER_TRACE_INFO("connection manager: connect succeeded\n");
     /* in case of success the g_pstActiveConnectionList points to the new connection */
-    return AssembleForwardOpenResponse(g_active_connection_list,
+    return AssembleForwardOpenResponse(g_opener_stack->active_connection_list,
                                        message_router_response,
                                        kCipErrorSuccess, 0);
   }
 }
 
+void CountRejectedForwardOpen(EipUint8 general_status,
+                              EipUint16 extended_status) {
+  switch (general_status) {
+    case kCipErrorResourceUnavailable:
+      g_opener_stack->connection_manager_counters.open_resource_rejects++;
+      return;
+    case kCipErrorPathSegmentError:
+    case kCipErrorNotEnoughData:
+    case kCipErrorTooMuchData:
+      g_opener_stack->connection_manager_counters.open_format_rejects++;
+      return;
+    case kCipErrorConnectionFailure:
+      break;
+    default:
+      g_opener_stack->connection_manager_counters.open_other_rejects++;
+      return;
+  }
+
+  switch (extended_status) {
+    case kConnectionManagerStatusCodeErrorNoMoreConnectionsAvailable:
+    case kConnectionManagerStatusCodeTargetObjectOutOfConnections:
+      g_opener_stack->connection_manager_counters.open_resource_rejects++;
+      break;
+    case kConnectionManagerStatusCodeErrorInvalidOToTConnectionType:
+    case kConnectionManagerStatusCodeErrorInvalidTToOConnectionType:
+    case kConnectionManagerStatusCodeErrorInvalidSegmentTypeInPath:
+      g_opener_stack->connection_manager_counters.open_format_rejects++;
+      break;
+    default:
+      g_opener_stack->connection_manager_counters.open_other_rejects++;
+      break;
+  }
+}
+
+EipBool8 AdmitForwardOpen(ConnectionObject *connection_object) {
+  if (g_opener_stack->forward_opens_in_timer_tick >= kOpenerForwardOpensPerTimerTick) {
+    OPENER_TRACE_WARN("ForwardOpen: too many requests in this timer tick\n");
+    return false;
+  }
+
+  ForwardOpenAdmission *admission = NULL;
+  for (int i = 0; i < g_opener_stack->number_of_forward_open_admissions; i++) {
+    if ((connection_object->originator_vendor_id
+        == g_opener_stack->forward_open_admissions[i].vendor_id)
+        && (connection_object->originator_serial_number
+            == g_opener_stack->forward_open_admissions[i].serial_number)) {
+      admission = &g_opener_stack->forward_open_admissions[i];
+      break;
+    }
+  }
+
+  if (NULL == admission) {
+    if (g_opener_stack->number_of_forward_open_admissions
+        < OPENER_FORWARD_OPEN_ADMISSION_ORIGINATORS) {
+      admission = &g_opener_stack->forward_open_admissions[
+          g_opener_stack->number_of_forward_open_admissions++];
+      admission->vendor_id = connection_object->originator_vendor_id;
+      admission->serial_number = connection_object->originator_serial_number;
+      admission->accepted_requests = 0;
+    }
+  } else if (admission->accepted_requests
+      >= kOpenerForwardOpensPerOriginatorPerTimerTick) {
+    OPENER_TRACE_WARN(
+        "ForwardOpen: too many requests of originator %u/%"PRIu32" in this timer tick\n",
+        connection_object->originator_vendor_id,
+        connection_object->originator_serial_number);
+    return false;
+  }
+
+  if (NULL != admission) {
+    admission->accepted_requests++;
+  }
+  g_opener_stack->forward_opens_in_timer_tick++;
+  return true;
+}
+
+MicroSeconds GetForwardOpenLatencyPercentile(unsigned int percentile) {
+  if (0 == g_opener_stack->forward_open_statistics.requests) {
+    return 0;
+  }
+
+  /* number of requests that have to be within the percentile, rounded up */
+  EipUint32 requests = (EipUint32) (((unsigned long long) g_opener_stack
+      ->forward_open_statistics.requests * percentile + 99) / 100);
+  EipUint32 counted_requests = 0;
+  for (int i = 0; i < OPENER_FORWARD_OPEN_LATENCY_BINS - 1; i++) {
+    counted_requests += g_opener_stack->forward_open_statistics.latency_histogram[i];
+    if (counted_requests >= requests) {
+      MicroSeconds bin_limit = (MicroSeconds) 1 << i;
+      return (bin_limit < g_opener_stack->forward_open_statistics.max_latency) ?
+          bin_limit : g_opener_stack->forward_open_statistics.max_latency;
+    }
+  }
+  return g_opener_stack->forward_open_statistics.max_latency;
+}
+
+const ForwardOpenStatistics *GetForwardOpenStatistics(void) {
+  return &g_opener_stack->forward_open_statistics;
+}
+
 void GeneralConnectionConfiguration(ConnectionObject *connection_object) {
   if (kRoutingTypePointToPointConnection
       == (connection_object->o_to_t_network_connection_parameter
@@ -423,6 +754,13 @@ void GeneralConnectionConfiguration(ConnectionObject *connection_object) {
   connection_object->eip_level_sequence_count_consuming = 0;
   connection_object->sequence_count_consuming = 0;
 
+  memset(&connection_object->receive_statistics, 0,
+         sizeof(connection_object->receive_statistics));
+  memset(&connection_object->packet_statistics, 0,
+         sizeof(connection_object->packet_statistics));
+  connection_object->produced_data_checksum = 0;
+  connection_object->change_of_state_check_timer = 0;
+
   connection_object->watchdog_timeout_action = kWatchdogTimeoutActionAutoDelete; /* the default for all connections on EIP*/
 
   connection_object->expected_packet_rate = 0; /* default value */
@@ -467,11 +805,11 @@ EipStatus ForwardClose(CipInstance *instance,
   /* check connection_serial_number && originator_vendor_id && originator_serial_number if connection is established */
   ConnectionManagerStatusCode connection_status =
       kConnectionManagerStatusCodeErrorConnectionNotFoundAtTargetApplication;
-  ConnectionObject *connection_object = g_active_connection_list;
+  ConnectionObject *connection_object = g_opener_stack->active_connection_list;
 
   /* set AddressInfo Items to invalid TypeID to prevent assembleLinearMsg to read them */
-  g_common_packet_format_data_item.address_info_item[0].type_id = 0;
-  g_common_packet_format_data_item.address_info_item[1].type_id = 0;
+  g_opener_stack->common_packet_format_data->address_info_item[0].type_id = 0;
+  g_opener_stack->common_packet_format_data->address_info_item[1].type_id = 0;
 
   message_router_request->data += 2; /* ignore Priority/Time_tick and Time-out_ticks */
 
@@ -483,6 +821,7 @@ EipStatus ForwardClose(CipInstance *instance,
       &message_router_request->data);
 
   OPENER_TRACE_INFO("ForwardClose: ConnSerNo %d\n", connection_serial_number);
+  g_opener_stack->connection_manager_counters.close_requests++;
 
   while (NULL != connection_object) {
     /* this check should not be necessary as only established connections should be in the active connection list */
@@ -502,6 +841,9 @@ EipStatus ForwardClose(CipInstance *instance,
     }
     connection_object = connection_object->next_connection_object;
   }
+  if (kConnectionManagerStatusCodeSuccess != connection_status) {
+    g_opener_stack->connection_manager_counters.close_other_rejects++;
+  }
 
   return AssembleForwardCloseResponse(connection_serial_number,
                                       originator_vendor_id,
@@ -524,14 +866,25 @@ EipStatus GetConnectionOwner(CipInstance *instance,
 }
 
 EipStatus ManageConnections(MilliSeconds elapsed_time) {
-  EipStatus eip_status;
-  ConnectionObject *connection_object;
+  /* a new timer tick, start the forward open admission control again */
+  g_opener_stack->forward_opens_in_timer_tick = 0;
+  g_opener_stack->number_of_forward_open_admissions = 0;
 
   /*Inform application that it can execute */
   HandleApplication();
   ManageEncapsulationMessages(elapsed_time);
 
-  connection_object = g_active_connection_list;
+#ifndef OPENER_BUSY_POLL
+  ManageConnectionTimers(elapsed_time);
+#endif
+  return kEipStatusOk;
+}
+
+void ManageConnectionTimers(MilliSeconds elapsed_time) {
+  EipStatus eip_status;
+  ConnectionObject *connection_object;
+
+  connection_object = g_opener_stack->active_connection_list;
   while (NULL != connection_object) {
     if (connection_object->state == kConnectionStateEstablished) {
       if ((0 != connection_object->consuming_instance) || /* we have a consuming connection check inactivity watchdog timer */
@@ -542,6 +895,8 @@ EipStatus ManageConnections(MilliSeconds elapsed_time) {
         if (connection_object->inactivity_watchdog_timer <= 0) {
           /* we have a timed out connection perform watchdog time out action*/
           OPENER_TRACE_INFO(">>>>>>>>>>Connection timed out\n");
+          g_opener_stack->opener_statistics.connection_timeouts++;
+          g_opener_stack->connection_manager_counters.connection_timeouts++;
           OPENER_ASSERT(NULL != connection_object->connection_timeout_function);
           connection_object->connection_timeout_function(connection_object);
         }
@@ -561,6 +916,26 @@ EipStatus ManageConnections(MilliSeconds elapsed_time) {
               connection_object->production_inhibit_timer -=
                   elapsed_time;
             }
+            /* change of state connections compare their data when the
+             * production inhibit timer expired and then once per production
+             * inhibit time, changed data is produced right away */
+            if ((kConnectionTriggerTypeChangeOfStateTriggeredConnection
+                == (connection_object->transport_type_class_trigger
+                    & kConnectionTriggerTypeProductionTriggerMask))
+                && (0 >= connection_object->production_inhibit_timer)) {
+              connection_object->change_of_state_check_timer -= elapsed_time;
+              if (0 >= connection_object->change_of_state_check_timer) {
+                if (true == HasProducedDataChanged(connection_object)) {
+                  connection_object->transmission_trigger_timer = 0;
+                } else {
+                  connection_object->change_of_state_check_timer =
+                      (kOpenerTimerTickInMilliSeconds
+                          < connection_object->production_inhibit_time) ?
+                          connection_object->production_inhibit_time :
+                          kOpenerTimerTickInMilliSeconds;
+                }
+              }
+            }
           }
           connection_object->transmission_trigger_timer -=
               elapsed_time;
@@ -582,6 +957,8 @@ EipStatus ManageConnections(MilliSeconds elapsed_time) {
               /* non cyclic connections have to reload the production inhibit timer */
               connection_object->production_inhibit_timer = connection_object
                   ->production_inhibit_time;
+              /* compare again as soon as the production inhibit timer expired */
+              connection_object->change_of_state_check_timer = 0;
             }
           }
         }
@@ -589,7 +966,6 @@ EipStatus ManageConnections(MilliSeconds elapsed_time) {
     }
     connection_object = connection_object->next_connection_object;
   }
-  return kEipStatusOk;
 }
 
 /* TODO: Update Documentation  INT8 assembleFWDOpenResponse(S_CIP_ConnectionObject *pa_pstConnObj, S_CIP_MR_Response * pa_MRResponse, EIP_UINT8 pa_nGeneralStatus, EIP_UINT16 pa_nExtendedStatus,
@@ -612,7 +988,7 @@ EipStatus AssembleForwardOpenResponse(
     EipUint16 extended_status) {
   /* write reply information in CPF struct dependent of pa_status */
   CipCommonPacketFormatData *cip_common_packet_format_data =
-      &g_common_packet_format_data_item;
+      g_opener_stack->common_packet_format_data;
   EipByte *message = message_router_response->data;
   cip_common_packet_format_data->item_count = 2;
   cip_common_packet_format_data->data_item.type_id =
@@ -640,6 +1016,7 @@ EipStatus AssembleForwardOpenResponse(
   } else {
     /* we have an connection creation error */
     OPENER_TRACE_INFO("assembleFWDOpenResponse: sending error response\n");
+    CountRejectedForwardOpen(general_status, extended_status);
     connection_object->state = kConnectionStateNonExistent;
     message_router_response->data_length = 10;
 
@@ -735,7 +1112,7 @@ EipStatus AssembleForwardCloseResponse(
     EipUint16 extended_error_code) {
   /* write reply information in CPF struct dependent of pa_status */
   CipCommonPacketFormatData *common_data_packet_format_data =
-      &g_common_packet_format_data_item;
+      g_opener_stack->common_packet_format_data;
   EipByte *message = message_router_response->data;
   common_data_packet_format_data->item_count = 2;
   common_data_packet_format_data->data_item.type_id =
@@ -771,7 +1148,7 @@ EipStatus AssembleForwardCloseResponse(
 
 ConnectionObject* GetConnectedObject(EipUint32 connection_id) {
   ConnectionObject* active_connection_object_list_item =
-      g_active_connection_list;
+      g_opener_stack->active_connection_list;
   while (NULL != active_connection_object_list_item) {
     if (active_connection_object_list_item->state
         == kConnectionStateEstablished) {
@@ -786,18 +1163,14 @@ ConnectionObject* GetConnectedObject(EipUint32 connection_id) {
 }
 
 ConnectionObject *GetConnectedOutputAssembly(EipUint32 output_assembly_id) {
-  ConnectionObject *active_connection_object_list_item =
-      g_active_connection_list;
+  ConnectionObject *connection_object = GetFirstConnectionOfOutputPoint(
+      output_assembly_id);
 
-  while (NULL != active_connection_object_list_item) {
-    if (active_connection_object_list_item->state
-        == kConnectionStateEstablished) {
-      if (active_connection_object_list_item->connection_path.connection_point[0]
-          == output_assembly_id)
-        return active_connection_object_list_item;
+  while (NULL != connection_object) {
+    if (kConnectionStateEstablished == connection_object->state) {
+      return connection_object;
     }
-    active_connection_object_list_item = active_connection_object_list_item
-        ->next_connection_object;
+    connection_object = connection_object->next_connection_of_output_point;
   }
   return NULL;
 }
@@ -805,7 +1178,7 @@ ConnectionObject *GetConnectedOutputAssembly(EipUint32 output_assembly_id) {
 ConnectionObject *CheckForExistingConnection(
     ConnectionObject *connection_object) {
   ConnectionObject *active_connection_object_list_item =
-      g_active_connection_list;
+      g_opener_stack->active_connection_list;
 
   while (NULL != active_connection_object_list_item) {
     if (active_connection_object_list_item->state
@@ -922,6 +1295,27 @@ EipUint8 ParseConnectionPath(ConnectionObject *connection_object,
     return kCipErrorNotEnoughData;
   }
 
+  EipUint8 *path = message;
+  ConnectionPathCacheEntry *cache_entry = FindConnectionPathCacheEntry(
+      connection_object, path);
+  if (NULL != cache_entry) {
+    /* identical path has been parsed and validated before */
+    if (cache_entry->has_electronic_key) {
+      connection_object->electronic_key = cache_entry->electronic_key;
+    }
+    connection_object->connection_path = cache_entry->connection_path;
+    connection_object->production_inhibit_time = cache_entry
+        ->production_inhibit_time;
+    if (0x03 != (connection_object->transport_type_class_trigger & 0x03)) {
+      g_opener_stack->config_data_length = cache_entry->config_data_length;
+      g_opener_stack->config_data_buffer =
+          (0 == cache_entry->config_data_length) ?
+              NULL : path + cache_entry->config_data_offset;
+    }
+    message_router_request->data = path + cache_entry->parsed_length;
+    return kEipStatusOk;
+  }
+
   if (remaining_path_size > 0) {
     /* first electronic key */
     if (*message == 0x34) {
@@ -1096,18 +1490,18 @@ EipUint8 ParseConnectionPath(ConnectionObject *connection_object,
         }
       }
 
-      g_config_data_length = 0;
-      g_config_data_buffer = NULL;
+      g_opener_stack->config_data_length = 0;
+      g_opener_stack->config_data_buffer = NULL;
 
       while (remaining_path_size > 0) { /* have something left in the path should be configuration data */
 
         switch (*message) {
           case kDataSegmentTypeSimpleDataMessage:
             /* we have a simple data segment */
-            g_config_data_length = message[1] * 2; /*data segments store length 16-bit word wise */
-            g_config_data_buffer = &(message[2]);
-            remaining_path_size -= (g_config_data_length + 2);
-            message += (g_config_data_length + 2);
+            g_opener_stack->config_data_length = message[1] * 2; /*data segments store length 16-bit word wise */
+            g_opener_stack->config_data_buffer = &(message[2]);
+            remaining_path_size -= (g_opener_stack->config_data_length + 2);
+            message += (g_opener_stack->config_data_length + 2);
             break;
             /*TODO do we have to handle ANSI extended symbol data segments too? */
           case kProductionTimeInhibitTimeNetworkSegment:
@@ -1136,11 +1530,71 @@ EipUint8 ParseConnectionPath(ConnectionObject *connection_object,
     }
   }
 
+  StoreConnectionPathCacheEntry(connection_object, path, message - path);
+
   /*save back the current position in the stream allowing followers to parse anything thats still there*/
   message_router_request->data = message;
   return kEipStatusOk;
 }
 
+ConnectionPathCacheEntry *FindConnectionPathCacheEntry(
+    ConnectionObject *connection_object, EipUint8 *path) {
+  EipUint16 connection_types = (connection_object
+      ->o_to_t_network_connection_parameter & CIP_CONN_TYPE_MASK)
+      | ((connection_object->t_to_o_network_connection_parameter
+          & CIP_CONN_TYPE_MASK) >> 2);
+
+  for (int i = 0; i < OPENER_CONNECTION_PATH_CACHE_ENTRIES; i++) {
+    ConnectionPathCacheEntry *entry = &g_opener_stack->connection_path_cache[i];
+    if ((0 != entry->path_size)
+        && (connection_object->connection_path_size == entry->path_size)
+        && (connection_object->transport_type_class_trigger
+            == entry->transport_type_class_trigger)
+        && (connection_types == entry->connection_types)
+        && (0 == memcmp(path, entry->path, entry->path_size * 2))) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void StoreConnectionPathCacheEntry(ConnectionObject *connection_object,
+                                   EipUint8 *path, unsigned int parsed_length) {
+  if ((0 == connection_object->connection_path_size)
+      || (connection_object->connection_path_size * 2
+          > OPENER_CONNECTION_PATH_CACHE_MAX_PATH_LENGTH)
+      || (parsed_length > connection_object->connection_path_size * 2u)) {
+    return;
+  }
+
+  ConnectionPathCacheEntry *entry = &g_opener_stack->connection_path_cache[
+      g_opener_stack->connection_path_cache_next_entry];
+  g_opener_stack->connection_path_cache_next_entry =
+      (g_opener_stack->connection_path_cache_next_entry + 1)
+          % OPENER_CONNECTION_PATH_CACHE_ENTRIES;
+
+  entry->path_size = connection_object->connection_path_size;
+  memcpy(entry->path, path, entry->path_size * 2);
+  entry->transport_type_class_trigger = connection_object
+      ->transport_type_class_trigger;
+  entry->connection_types = (connection_object
+      ->o_to_t_network_connection_parameter & CIP_CONN_TYPE_MASK)
+      | ((connection_object->t_to_o_network_connection_parameter
+          & CIP_CONN_TYPE_MASK) >> 2);
+  entry->has_electronic_key = (0x34 == path[0]) ? true : false;
+  entry->electronic_key = connection_object->electronic_key;
+  entry->connection_path = connection_object->connection_path;
+  entry->production_inhibit_time = connection_object->production_inhibit_time;
+  entry->config_data_offset = 0;
+  entry->config_data_length = 0;
+  if ((0x03 != (connection_object->transport_type_class_trigger & 0x03))
+      && (NULL != g_opener_stack->config_data_buffer)) {
+    entry->config_data_offset = g_opener_stack->config_data_buffer - path;
+    entry->config_data_length = g_opener_stack->config_data_length;
+  }
+  entry->parsed_length = parsed_length;
+}
+
 void CloseConnection(ConnectionObject *pa_pstConnObj) {
   pa_pstConnObj->state = kConnectionStateNonExistent;
   if (0x03 != (pa_pstConnObj->transport_type_class_trigger & 0x03)) {
@@ -1164,20 +1618,173 @@ void CopyConnectionData(ConnectionObject *pa_pstDst,
 
 void AddNewActiveConnection(ConnectionObject *pa_pstConn) {
   pa_pstConn->first_connection_object = NULL;
-  pa_pstConn->next_connection_object = g_active_connection_list;
-  if (NULL != g_active_connection_list) {
-    g_active_connection_list->first_connection_object = pa_pstConn;
+  pa_pstConn->next_connection_object = g_opener_stack->active_connection_list;
+  if (NULL != g_opener_stack->active_connection_list) {
+    g_opener_stack->active_connection_list->first_connection_object = pa_pstConn;
+  }
+  g_opener_stack->active_connection_list = pa_pstConn;
+  g_opener_stack->active_connection_list->state = kConnectionStateEstablished;
+  if (0x03 != (pa_pstConn->transport_type_class_trigger & 0x03)) {
+    AddToAssemblyIndex(pa_pstConn);
   }
-  g_active_connection_list = pa_pstConn;
-  g_active_connection_list->state = kConnectionStateEstablished;
+}
+
+AssemblyIndexEntry *GetAssemblyIndexEntry(EipUint32 assembly,
+                                          EipBool8 create_entry) {
+  size_t slot = assembly % OPENER_ASSEMBLY_INDEX_SLOTS;
+
+  for (size_t probes = 0; probes < OPENER_ASSEMBLY_INDEX_SLOTS; probes++) {
+    AssemblyIndexEntry *entry = &g_opener_stack->assembly_index[slot];
+    if (0 == entry->assembly) { /* end of the probe sequence */
+      if (true == create_entry) {
+        entry->assembly = assembly;
+        return entry;
+      }
+      return NULL;
+    }
+    if (assembly == entry->assembly) {
+      return entry;
+    }
+    slot = (slot + 1) % OPENER_ASSEMBLY_INDEX_SLOTS;
+  }
+  return NULL;
+}
+
+void FreeAssemblyIndexEntry(AssemblyIndexEntry *entry) {
+  size_t free_slot = (size_t) (entry - g_opener_stack->assembly_index);
+  size_t slot = free_slot;
+
+  entry->assembly = 0;
+  entry->output_point_connections = NULL;
+  entry->input_point_connections = NULL;
+
+  for (;;) {
+    slot = (slot + 1) % OPENER_ASSEMBLY_INDEX_SLOTS;
+    AssemblyIndexEntry *next_entry = &g_opener_stack->assembly_index[slot];
+    if (0 == next_entry->assembly) {
+      break;
+    }
+    /* move the entry into the gap unless its home slot lies cyclically
+     * between the gap and the entry */
+    size_t home_slot = next_entry->assembly % OPENER_ASSEMBLY_INDEX_SLOTS;
+    EipBool8 home_after_gap =
+        (free_slot < slot) ?
+            ((free_slot < home_slot) && (home_slot <= slot)) :
+            ((free_slot < home_slot) || (home_slot <= slot));
+    if (!home_after_gap) {
+      g_opener_stack->assembly_index[free_slot] = *next_entry;
+      next_entry->assembly = 0;
+      next_entry->output_point_connections = NULL;
+      next_entry->input_point_connections = NULL;
+      free_slot = slot;
+    }
+  }
+}
+
+void AddToAssemblyIndex(ConnectionObject *connection_object) {
+  EipUint32 output_point = connection_object->connection_path
+      .connection_point[0];
+  EipUint32 input_point = connection_object->connection_path.connection_point[1];
+  AssemblyIndexEntry *entry;
+
+  connection_object->next_connection_of_output_point = NULL;
+  connection_object->next_connection_of_input_point = NULL;
+
+  if (0 != output_point) {
+    entry = GetAssemblyIndexEntry(output_point, true);
+    if (NULL != entry) {
+      connection_object->next_connection_of_output_point = entry
+          ->output_point_connections;
+      entry->output_point_connections = connection_object;
+    } else {
+      OPENER_TRACE_ERR("assembly index: no entry left for assembly %"PRIu32"\n",
+                       output_point);
+    }
+  }
+
+  if (0 != input_point) {
+    entry = GetAssemblyIndexEntry(input_point, true);
+    if (NULL != entry) {
+      connection_object->next_connection_of_input_point = entry
+          ->input_point_connections;
+      entry->input_point_connections = connection_object;
+    } else {
+      OPENER_TRACE_ERR("assembly index: no entry left for assembly %"PRIu32"\n",
+                       input_point);
+    }
+  }
+}
+
+void RemoveFromAssemblyIndex(ConnectionObject *connection_object) {
+  AssemblyIndexEntry *entry = GetAssemblyIndexEntry(
+      connection_object->connection_path.connection_point[0], false);
+  if (NULL != entry) {
+    ConnectionObject **link = &entry->output_point_connections;
+    while (NULL != *link) {
+      if (connection_object == *link) {
+        *link = connection_object->next_connection_of_output_point;
+        break;
+      }
+      link = &(*link)->next_connection_of_output_point;
+    }
+    if ((NULL == entry->output_point_connections)
+        && (NULL == entry->input_point_connections)) {
+      FreeAssemblyIndexEntry(entry);
+    }
+  }
+
+  /* looked up again, freeing an entry may have moved the others */
+  entry = GetAssemblyIndexEntry(
+      connection_object->connection_path.connection_point[1], false);
+  if (NULL != entry) {
+    ConnectionObject **link = &entry->input_point_connections;
+    while (NULL != *link) {
+      if (connection_object == *link) {
+        *link = connection_object->next_connection_of_input_point;
+        break;
+      }
+      link = &(*link)->next_connection_of_input_point;
+    }
+    if ((NULL == entry->output_point_connections)
+        && (NULL == entry->input_point_connections)) {
+      FreeAssemblyIndexEntry(entry);
+    }
+  }
+
+  connection_object->next_connection_of_output_point = NULL;
+  connection_object->next_connection_of_input_point = NULL;
+}
+
+ConnectionObject *GetFirstConnectionOfOutputPoint(EipUint32 output_point) {
+  AssemblyIndexEntry *entry = GetAssemblyIndexEntry(output_point, false);
+  return (NULL != entry) ? entry->output_point_connections : NULL;
+}
+
+ConnectionObject *GetFirstConnectionOfInputPoint(EipUint32 input_point) {
+  AssemblyIndexEntry *entry = GetAssemblyIndexEntry(input_point, false);
+  return (NULL != entry) ? entry->input_point_connections : NULL;
 }
 
 void RemoveFromActiveConnections(ConnectionObject *pa_pstConn) {
+  ConnectionReceiveStatistics *statistics = &pa_pstConn->receive_statistics;
+  if (1 < statistics->received_packets) {
+    OPENER_TRACE_INFO(
+        "connection %u: %u packets, inter-arrival min %llu us max %llu us, RPI %u us, mean deviation %llu us max %llu us\n",
+        (unsigned) pa_pstConn->consumed_connection_id,
+        (unsigned) statistics->received_packets,
+        statistics->min_inter_arrival_time, statistics->max_inter_arrival_time,
+        (unsigned) pa_pstConn->o_to_t_requested_packet_interval,
+        statistics->total_rpi_deviation / (statistics->received_packets - 1),
+        statistics->max_rpi_deviation);
+  }
+  if (0x03 != (pa_pstConn->transport_type_class_trigger & 0x03)) {
+    RemoveFromAssemblyIndex(pa_pstConn);
+  }
   if (NULL != pa_pstConn->first_connection_object) {
     pa_pstConn->first_connection_object->next_connection_object = pa_pstConn
         ->next_connection_object;
   } else {
-    g_active_connection_list = pa_pstConn->next_connection_object;
+    g_opener_stack->active_connection_list = pa_pstConn->next_connection_object;
   }
   if (NULL != pa_pstConn->next_connection_object) {
     pa_pstConn->next_connection_object->first_connection_object = pa_pstConn
@@ -1189,18 +1796,8 @@ void RemoveFromActiveConnections(ConnectionObject *pa_pstConn) {
 }
 
 EipBool8 IsConnectedOutputAssembly(EipUint32 pa_nInstanceNr) {
-  EipBool8 bRetVal = false;
-
-  ConnectionObject *pstRunner = g_active_connection_list;
-
-  while (NULL != pstRunner) {
-    if (pa_nInstanceNr == pstRunner->connection_path.connection_point[0]) {
-      bRetVal = true;
-      break;
-    }
-    pstRunner = pstRunner->next_connection_object;
-  }
-  return bRetVal;
+  return (NULL != GetFirstConnectionOfOutputPoint(pa_nInstanceNr)) ?
+      true : false;
 }
 
 EipStatus AddConnectableObject(EipUint32 pa_nClassId,
@@ -1210,11 +1807,12 @@ EipStatus AddConnectableObject(EipUint32 pa_nClassId,
   nRetVal = kEipStatusError;
 
   /*parsing is now finished all data is available and check now establish the connection */
-  for (i = 0; i < g_kNumberOfConnectableObjects; ++i) {
-    if ((0 == g_astConnMgmList[i].class_id)
-        || (pa_nClassId == g_astConnMgmList[i].class_id)) {
-      g_astConnMgmList[i].class_id = pa_nClassId;
-      g_astConnMgmList[i].open_connection_function = pa_pfOpenFunc;
+  for (i = 0; i < OPENER_NUMBER_OF_CONNECTABLE_OBJECTS; ++i) {
+    if ((0 == g_opener_stack->connection_management_handlers[i].class_id)
+        || (pa_nClassId == g_opener_stack->connection_management_handlers[i].class_id)) {
+      g_opener_stack->connection_management_handlers[i].class_id = pa_nClassId;
+      g_opener_stack->connection_management_handlers[i].open_connection_function =
+          pa_pfOpenFunc;
       nRetVal = kEipStatusOk;
       break;
     }
@@ -1230,9 +1828,9 @@ GetConnMgmEntry(EipUint32 class_id) {
 
   pstRetVal = NULL;
 
-  for (i = 0; i < g_kNumberOfConnectableObjects; ++i) {
-    if (class_id == g_astConnMgmList[i].class_id) {
-      pstRetVal = &(g_astConnMgmList[i]);
+  for (i = 0; i < OPENER_NUMBER_OF_CONNECTABLE_OBJECTS; ++i) {
+    if (class_id == g_opener_stack->connection_management_handlers[i].class_id) {
+      pstRetVal = &(g_opener_stack->connection_management_handlers[i]);
       break;
     }
   }
@@ -1243,27 +1841,36 @@ EipStatus TriggerConnections(unsigned int pa_unOutputAssembly,
                              unsigned int pa_unInputAssembly) {
   EipStatus nRetVal = kEipStatusError;
 
-  ConnectionObject *pstRunner = g_active_connection_list;
+  ConnectionObject *pstRunner = GetFirstConnectionOfInputPoint(
+      pa_unInputAssembly);
   while (NULL != pstRunner) {
     if ((pa_unOutputAssembly == pstRunner->connection_path.connection_point[0])
-        && (pa_unInputAssembly == pstRunner->connection_path.connection_point[1])) {
-      if (kConnectionTriggerTypeApplicationTriggeredConnection
-          == (pstRunner->transport_type_class_trigger
-              & kConnectionTriggerTypeProductionTriggerMask)) {
-        /* produce at the next allowed occurrence */
-        pstRunner->transmission_trigger_timer = pstRunner
-            ->production_inhibit_timer;
-        nRetVal = kEipStatusOk;
-      }
-      break;
+        && (kConnectionTriggerTypeApplicationTriggeredConnection
+            == (pstRunner->transport_type_class_trigger
+                & kConnectionTriggerTypeProductionTriggerMask))) {
+      /* produce at the next allowed occurrence */
+      pstRunner->transmission_trigger_timer = pstRunner
+          ->production_inhibit_timer;
+      nRetVal = kEipStatusOk;
     }
+    pstRunner = pstRunner->next_connection_of_input_point;
   }
   return nRetVal;
 }
 
 void InitializeConnectionManagerData() {
-  memset(g_astConnMgmList, 0,
-         g_kNumberOfConnectableObjects * sizeof(ConnectionManagementHandling));
+  memset(g_opener_stack->connection_management_handlers, 0,
+         OPENER_NUMBER_OF_CONNECTABLE_OBJECTS * sizeof(ConnectionManagementHandling));
+  memset(g_opener_stack->connection_path_cache, 0,
+         sizeof(g_opener_stack->connection_path_cache));
+  memset(g_opener_stack->assembly_index, 0, sizeof(g_opener_stack->assembly_index));
+  memset(&g_opener_stack->forward_open_statistics, 0,
+         sizeof(g_opener_stack->forward_open_statistics));
+  memset(&g_opener_stack->connection_manager_counters, 0,
+         sizeof(g_opener_stack->connection_manager_counters));
+  g_opener_stack->forward_opens_in_timer_tick = 0;
+  g_opener_stack->number_of_forward_open_admissions = 0;
+  g_opener_stack->connection_path_cache_next_entry = 0;
   InitializeClass3ConnectionData();
   InitializeIoConnectionData();
 }
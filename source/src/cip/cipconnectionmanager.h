@@ -117,6 +117,56 @@ typedef struct {
   LinkProducer producer;
 } LinkObject;
 
+/** @brief Number of bins of the inter-arrival time histogram of a connection
+ *
+ *  Each bin covers a quarter of the connection's O->T RPI. The last bin counts
+ *  all packets arriving two or more RPIs after their predecessor.
+ */
+#define OPENER_RECEIVE_HISTOGRAM_BINS 9
+
+/** @brief Timing statistics of the data consumed by an I/O connection
+ *
+ *  The statistics are based on the receive time stamps of the consumed
+ *  packets and are measured against the requested O->T packet interval.
+ */
+typedef struct {
+  MicroSeconds last_receive_time; /**< arrival of the last consumed packet */
+  EipUint32 received_packets; /**< number of consumed packets */
+  MicroSeconds min_inter_arrival_time;
+  MicroSeconds max_inter_arrival_time;
+  MicroSeconds max_rpi_deviation; /**< largest deviation from the RPI */
+  MicroSeconds total_rpi_deviation; /**< sum of all deviations from the RPI */
+  EipUint32 inter_arrival_histogram[OPENER_RECEIVE_HISTOGRAM_BINS];
+} ConnectionReceiveStatistics;
+
+/** @brief Packet counters of an I/O connection
+ *
+ *  The consumed packets are counted in ConnectionReceiveStatistics.
+ */
+typedef struct {
+  EipUint32 produced_packets;
+  EipUint32 duplicate_packets; /**< consumed packets without a new sequence number */
+  EipUint32 wrong_originator_packets; /**< packets not sent by the originator of the connection */
+  EipUint32 refused_packets; /**< consumed data refused by the assembly */
+} ConnectionPacketStatistics;
+
+/** @brief Number of bins of the forward open latency histogram
+ *
+ *  Bin i counts the requests processed in less than 2^i us, the last bin all
+ *  requests that took longer.
+ */
+#define OPENER_FORWARD_OPEN_LATENCY_BINS 16
+
+/** @brief Statistics of the forward open requests handled by the connection
+ *  manager
+ */
+typedef struct {
+  EipUint32 requests; /**< number of received forward open requests */
+  EipUint32 rejected_requests; /**< requests refused by the admission control */
+  MicroSeconds max_latency; /**< longest processing time of a request */
+  EipUint32 latency_histogram[OPENER_FORWARD_OPEN_LATENCY_BINS];
+} ForwardOpenStatistics;
+
 /** The data needed for handling connections. This data is strongly related to
  * the connection object defined in the CIP-specification. However the full
  * functionality of the connection object is not implemented. Therefore this
@@ -216,10 +266,99 @@ typedef struct connection_object {
   struct connection_object *next_connection_object;
   struct connection_object *first_connection_object;
 
+  /* pointers to be used in the connection lists of the assembly index */
+  struct connection_object *next_connection_of_output_point;
+  struct connection_object *next_connection_of_input_point;
+
   EipUint16 correct_originator_to_target_size;
   EipUint16 correct_target_to_originator_size;
+
+  ConnectionReceiveStatistics receive_statistics;
+  ConnectionPacketStatistics packet_statistics;
+
+  /** @brief Checksum of the data of the producing assembly at the last
+   * production, used to detect changes for change of state connections
+   */
+  EipUint32 produced_data_checksum;
+
+  /** @brief Time until the data of a change of state connection is compared
+   * with produced_data_checksum again, only running while the production
+   * inhibit timer is expired
+   */
+  EipInt32 change_of_state_check_timer;
 } ConnectionObject;
 
+/** @brief Number of object classes to which connections may be established */
+#define OPENER_NUMBER_OF_CONNECTABLE_OBJECTS (2 \
+    + OPENER_CIP_NUM_APPLICATION_SPECIFIC_CONNECTABLE_OBJECTS)
+
+/** @brief Open function of an object class to which connections may be
+ * established */
+typedef struct {
+  EipUint32 class_id;
+  OpenConnectionFunction open_connection_function;
+} ConnectionManagementHandling;
+
+/** @brief Longest connection path in bytes that is stored in the connection
+ * path cache, longer paths are always parsed */
+#define OPENER_CONNECTION_PATH_CACHE_MAX_PATH_LENGTH 64
+
+/** @brief Result of a successfully parsed forward open connection path */
+typedef struct {
+  EipUint8 path_size; /**< size of the path in 16-bit words, 0 marks an unused entry */
+  EipUint8 path[OPENER_CONNECTION_PATH_CACHE_MAX_PATH_LENGTH]; /**< the raw path bytes */
+  EipUint8 transport_type_class_trigger; /**< transport class and trigger of the request */
+  EipUint16 connection_types; /**< connection type bits of the O->T and T->O network connection parameters */
+  EipBool8 has_electronic_key; /**< the path starts with an electronic key segment */
+  CipElectronicKey electronic_key; /**< the already verified electronic key */
+  CipConnectionPath connection_path; /**< resolved class and connection points */
+  EipUint16 production_inhibit_time; /**< production inhibit time, 256 if not given */
+  unsigned int config_data_offset; /**< offset of the configuration data from the path start */
+  unsigned int config_data_length; /**< length of the configuration data, 0 if none */
+  unsigned int parsed_length; /**< number of bytes the parser consumed from the path start */
+} ConnectionPathCacheEntry;
+
+/** @brief Number of entries of the assembly index, each configured
+ * application connection type may use two assemblies not used by others */
+#define OPENER_ASSEMBLY_INDEX_ENTRIES (2 * (OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS \
+    + OPENER_CIP_NUM_INPUT_ONLY_CONNS + OPENER_CIP_NUM_LISTEN_ONLY_CONNS))
+
+/** @brief Number of slots of the assembly index hash table
+ *
+ *  The table is at most half full, so an assembly is found after a few
+ *  probes from its home slot, the instance number modulo the slot count.
+ */
+#define OPENER_ASSEMBLY_INDEX_SLOTS (2 * OPENER_ASSEMBLY_INDEX_ENTRIES + 1)
+
+/** @brief The active I/O connections using an assembly as connection point,
+ *  an entry of the assembly index */
+typedef struct {
+  EipUint32 assembly; /**< instance number of the assembly, 0 marks an unused entry */
+  ConnectionObject *output_point_connections; /**< connections consuming into the assembly */
+  ConnectionObject *input_point_connections; /**< connections producing the assembly */
+} AssemblyIndexEntry;
+
+/** @brief Forward open requests of an originator accepted in the current
+ * timer tick */
+typedef struct {
+  EipUint16 vendor_id;
+  EipUint32 serial_number;
+  int accepted_requests;
+} ForwardOpenAdmission;
+
+/** @brief Counters of the Connection Manager object, instance attributes 1
+ * to 8, wrapping around at 65535 as defined by the CIP specification */
+typedef struct {
+  CipUint open_requests;
+  CipUint open_format_rejects; /**< requests with a malformed request or path */
+  CipUint open_resource_rejects; /**< requests refused for lack of connections */
+  CipUint open_other_rejects;
+  CipUint close_requests;
+  CipUint close_format_rejects;
+  CipUint close_other_rejects; /**< requests for unknown connections */
+  CipUint connection_timeouts;
+} ConnectionManagerCounters;
+
 /** @brief Connection Manager class code */
 static const int g_kCipConnectionManagerClassCode = 0x06;
 
@@ -259,9 +398,31 @@ void CopyConnectionData(ConnectionObject *destination, ConnectionObject *source)
  */
 void CloseConnection(ConnectionObject *connection_object);
 
-/* TODO: Missing documentation */
+/** @brief Check if an assembly is the output point of an I/O connection
+ *
+ * @param instance_number instance number of the assembly
+ * @return true if an I/O connection consumes data into the assembly
+ */
 EipBool8 IsConnectedOutputAssembly(EipUint32 instance_number);
 
+/** @brief Get the I/O connections consuming into an output assembly
+ *
+ * The further connections are reached via next_connection_of_output_point.
+ *
+ * @param output_point instance number of the output assembly
+ * @return first connection of the list, NULL if there is none
+ */
+ConnectionObject *GetFirstConnectionOfOutputPoint(EipUint32 output_point);
+
+/** @brief Get the I/O connections producing an input assembly
+ *
+ * The further connections are reached via next_connection_of_input_point.
+ *
+ * @param input_point instance number of the input assembly
+ * @return first connection of the list, NULL if there is none
+ */
+ConnectionObject *GetFirstConnectionOfInputPoint(EipUint32 input_point);
+
 /** @brief Generate the ConnectionIDs and set the general configuration
  * parameter in the given connection object.
  *
@@ -284,4 +445,18 @@ void AddNewActiveConnection(ConnectionObject *connection_object);
 /* TODO: Missing documentation */
 void RemoveFromActiveConnections(ConnectionObject *connection_object);
 
+/** @brief Get a percentile of the processing time of forward open requests
+ *
+ * @param percentile the requested percentile, 1 to 100
+ * @return upper bound of the histogram bin holding the percentile in us,
+ *  0 if no forward open request has been processed yet
+ */
+MicroSeconds GetForwardOpenLatencyPercentile(unsigned int percentile);
+
+/** @brief Get the forward open statistics of the connection manager
+ *
+ * @return pointer to the statistics
+ */
+const ForwardOpenStatistics *GetForwardOpenStatistics(void);
+
 #endif /* OPENER_CIPCONNECTIONMANAGER_H_ */
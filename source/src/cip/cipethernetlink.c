@@ -12,49 +12,79 @@
 #include "ciperror.h"
 #include "endianconv.h"
 #include "opener_api.h"
+#include "opener_stack.h"
 
-typedef struct {
-  EipUint32 interface_speed;
-  EipUint32 interface_flags;
-  EipUint8 physical_address[6];
-} CipEthernetLinkObject;
-
-/* global private variables */
-CipEthernetLinkObject g_ethernet_link;
+/** @brief Interface flags bit indicating an active link */
+#define ETHERNET_LINK_FLAG_LINK_ACTIVE 0x01
+/** @brief Interface flags bit indicating full duplex operation */
+#define ETHERNET_LINK_FLAG_FULL_DUPLEX 0x02
 
 void ConfigureMacAddress(const EipUint8 *mac_address) {
-  memcpy(&g_ethernet_link.physical_address, mac_address,
-         sizeof(g_ethernet_link.physical_address));
+  memcpy(&g_opener_stack->ethernet_link.physical_address, mac_address,
+         sizeof(g_opener_stack->ethernet_link.physical_address));
 
 }
 
-EipStatus CipEthernetLinkInit() {
-  CipClass *ethernet_link_class;
-  CipInstance *ethernet_link_instance;
+/** @brief Attributes of the Ethernet Link object instance */
+static const CipAttributeDefinition kEthernetLinkInstanceAttributes[] = {
+    CIP_STACK_ATTRIBUTE(1, kCipUdint, kGetableSingleAndAll,
+        ethernet_link.interface_speed),
+    CIP_STACK_ATTRIBUTE(2, kCipDword, kGetableSingleAndAll,
+        ethernet_link.interface_flags),
+    CIP_STACK_ATTRIBUTE(3, kCip6Usint, kGetableSingleAndAll,
+        ethernet_link.physical_address),
+    CIP_STACK_ATTRIBUTE(4, kCip11Udint, kGetableSingleAndAll,
+        ethernet_link.interface_counters),
+    CIP_STACK_ATTRIBUTE(5, kCip12Udint, kGetableSingleAndAll,
+        ethernet_link.media_counters) };
+
+/** @brief Services of the Ethernet Link object instance */
+static const CipServiceStruct kEthernetLinkInstanceServices[] = {
+    { kGetAttributeAll, &GetAttributeAll, "GetAttributeAll" },
+    { kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle" } };
 
+/** @brief Definition of the Ethernet Link object */
+static const CipClassDefinition kEthernetLinkClassDefinition = {
+    CIP_ETHERNETLINK_CLASS_CODE, /* class ID */
+    "Ethernet Link", /* class name */
+    1, /* class revision */
+    0xffffffff, /* class getAttributeAll mask*/
+    kEthernetLinkInstanceAttributes,
+    CIP_TABLE_ENTRIES(kEthernetLinkInstanceAttributes),
+    5, /* highest instance attribute number */
+    0xffffffff, /* instance getAttributeAll mask*/
+    kEthernetLinkInstanceServices,
+    CIP_TABLE_ENTRIES(kEthernetLinkInstanceServices) };
+
+EipStatus CipEthernetLinkInit() {
   /* set attributes to initial values */
-  g_ethernet_link.interface_speed = 100;
-  g_ethernet_link.interface_flags = 0xF; /* successful speed and duplex neg, full duplex active link, TODO in future it should be checked if link is active */
-
-  if ((ethernet_link_class = CreateCipClass(CIP_ETHERNETLINK_CLASS_CODE, 0, /* # class attributes*/
-                                            0xffffffff, /* class getAttributeAll mask*/
-                                            0, /* # class services*/
-                                            3, /* # instance attributes*/
-                                            0xffffffff, /* instance getAttributeAll mask*/
-                                            0, /* # instance services*/
-                                            1, /* # instances*/
-                                            "Ethernet Link", 1)) != 0) {
-
-    ethernet_link_instance = GetCipInstance(ethernet_link_class, 1);
-    InsertAttribute(ethernet_link_instance, 1, kCipUdint,
-                    &g_ethernet_link.interface_speed, kGetableSingleAndAll); /* bind attributes to the instance*/
-    InsertAttribute(ethernet_link_instance, 2, kCipDword,
-                    &g_ethernet_link.interface_flags, kGetableSingleAndAll);
-    InsertAttribute(ethernet_link_instance, 3, kCip6Usint,
-                    &g_ethernet_link.physical_address, kGetableSingleAndAll);
-  } else {
+  g_opener_stack->ethernet_link.interface_speed = 100;
+  g_opener_stack->ethernet_link.interface_flags = 0xF; /* successful speed and duplex neg, full duplex active link, until the platform reports the link state with SetEthernetLinkState() */
+
+  if (0 == CreateCipClassFromDefinition(&kEthernetLinkClassDefinition)) {
     return kEipStatusError;
   }
 
   return kEipStatusOk;
 }
+
+void SetEthernetLinkState(EipUint32 interface_speed, EipBool8 link_active,
+                          EipBool8 full_duplex) {
+  g_opener_stack->ethernet_link.interface_speed = interface_speed;
+  /* the negotiation status bits are kept as initialized */
+  g_opener_stack->ethernet_link.interface_flags &= ~(ETHERNET_LINK_FLAG_LINK_ACTIVE
+      | ETHERNET_LINK_FLAG_FULL_DUPLEX);
+  if (link_active) {
+    g_opener_stack->ethernet_link.interface_flags |= ETHERNET_LINK_FLAG_LINK_ACTIVE;
+  }
+  if (full_duplex) {
+    g_opener_stack->ethernet_link.interface_flags |= ETHERNET_LINK_FLAG_FULL_DUPLEX;
+  }
+}
+
+void SetEthernetLinkCounters(
+    const CipEthernetLinkInterfaceCounters *interface_counters,
+    const CipEthernetLinkMediaCounters *media_counters) {
+  g_opener_stack->ethernet_link.interface_counters = *interface_counters;
+  g_opener_stack->ethernet_link.media_counters = *media_counters;
+}
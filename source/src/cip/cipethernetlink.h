@@ -11,9 +11,72 @@
 
 #define CIP_ETHERNETLINK_CLASS_CODE 0xF6
 
+/** @brief Interface counters, Ethernet Link attribute 4 */
+typedef struct {
+  CipUdint in_octets;
+  CipUdint in_ucast_packets;
+  CipUdint in_nucast_packets;
+  CipUdint in_discards;
+  CipUdint in_errors;
+  CipUdint in_unknown_protos;
+  CipUdint out_octets;
+  CipUdint out_ucast_packets;
+  CipUdint out_nucast_packets;
+  CipUdint out_discards;
+  CipUdint out_errors;
+} CipEthernetLinkInterfaceCounters;
+
+/** @brief Media counters, Ethernet Link attribute 5 */
+typedef struct {
+  CipUdint alignment_errors;
+  CipUdint fcs_errors;
+  CipUdint single_collisions;
+  CipUdint multiple_collisions;
+  CipUdint sqe_test_errors;
+  CipUdint deferred_transmissions;
+  CipUdint late_collisions;
+  CipUdint excessive_collisions;
+  CipUdint mac_transmit_errors;
+  CipUdint carrier_sense_errors;
+  CipUdint frame_too_long;
+  CipUdint mac_receive_errors;
+} CipEthernetLinkMediaCounters;
+
+/** @brief Data of the Ethernet Link object instance */
+typedef struct {
+  EipUint32 interface_speed;
+  EipUint32 interface_flags;
+  EipUint8 physical_address[6];
+  CipEthernetLinkInterfaceCounters interface_counters;
+  CipEthernetLinkMediaCounters media_counters;
+} CipEthernetLinkObject;
+
 /* public functions */
 /** @brief Initialize the Ethernet Link Objects data
  */
 EipStatus CipEthernetLinkInit(void);
 
+/** @brief Set the link state reported by the Ethernet Link object
+ *
+ * Called by the platform whenever it has read the state of the interface.
+ *
+ * @param interface_speed speed of the interface in Mbit/s
+ * @param link_active true if the link is up
+ * @param full_duplex true if the link runs in full duplex
+ */
+void SetEthernetLinkState(EipUint32 interface_speed, EipBool8 link_active,
+                          EipBool8 full_duplex);
+
+/** @brief Set the counters reported by the Ethernet Link object
+ *
+ * Called by the platform whenever it has read the counters of the interface,
+ * the object does not query the interface on requests.
+ *
+ * @param interface_counters new interface counters
+ * @param media_counters new media counters
+ */
+void SetEthernetLinkCounters(
+    const CipEthernetLinkInterfaceCounters *interface_counters,
+    const CipEthernetLinkMediaCounters *media_counters);
+
 #endif /* OPENER_CIPETHERNETLINK_H_*/
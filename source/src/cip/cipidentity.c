@@ -32,6 +32,7 @@
 #include "ciperror.h"
 #include "endianconv.h"
 #include "opener_api.h"
+#include "opener_stack.h"
 
 /* attributes in CIP Identity Object */
 
@@ -40,8 +41,6 @@ EipUint16 device_type_ = OPENER_DEVICE_TYPE; /**< Attribute 2: Device Type */
 EipUint16 product_code_ = OPENER_DEVICE_PRODUCT_CODE; /**< Attribute 3: Product Code */
 CipRevision revision_ = { OPENER_DEVICE_MAJOR_REVISION,
     OPENER_DEVICE_MINOR_REVISION }; /**< Attribute 4: Revision / USINT Major, USINT Minor */
-EipUint16 status_ = 0; /**< Attribute 5: Status */
-EipUint32 serial_number_ = 0; /**< Attribute 6: Serial Number, has to be set prior to OpENer initialization */
 CipShortString product_name_ = { sizeof(OPENER_DEVICE_NAME) - 1,
     OPENER_DEVICE_NAME }; /**< Attribute 7: Product Name */
 
@@ -49,14 +48,14 @@ CipShortString product_name_ = { sizeof(OPENER_DEVICE_NAME) - 1,
  * @param serial_number The serial number of the device
  */
 void SetDeviceSerialNumber(EipUint32 serial_number) {
-  serial_number_ = serial_number;
+  g_opener_stack->serial_number = serial_number;
 }
 
 /** Private functions, sets the devices status
  * @param status The serial number of the deivce
  */
 void SetDeviceStatus(EipUint16 status) {
-  status_ = status;
+  g_opener_stack->device_status = status;
 }
 
 /** Reset service
@@ -114,41 +113,41 @@ static EipStatus Reset(CipInstance *instance, /* pointer to instance*/
   return eip_status;
 }
 
+/** @brief Attributes of the identity object instance */
+static const CipAttributeDefinition kIdentityInstanceAttributes[] = {
+    CIP_SHARED_ATTRIBUTE(1, kCipUint, kGetableSingleAndAll, &vendor_id_),
+    CIP_SHARED_ATTRIBUTE(2, kCipUint, kGetableSingleAndAll, &device_type_),
+    CIP_SHARED_ATTRIBUTE(3, kCipUint, kGetableSingleAndAll, &product_code_),
+    CIP_SHARED_ATTRIBUTE(4, kCipUsintUsint, kGetableSingleAndAll, &revision_),
+    CIP_STACK_ATTRIBUTE(5, kCipWord, kGetableSingleAndAll, device_status),
+    CIP_STACK_ATTRIBUTE(6, kCipUdint, kGetableSingleAndAll, serial_number),
+    CIP_SHARED_ATTRIBUTE(7, kCipShortString, kGetableSingleAndAll,
+        &product_name_) };
+
+/** @brief Services of the identity object instance */
+static const CipServiceStruct kIdentityInstanceServices[] = {
+    { kGetAttributeAll, &GetAttributeAll, "GetAttributeAll" },
+    { kGetAttributeSingle, &GetAttributeSingle, "GetAttributeSingle" },
+    { kReset, &Reset, "Reset" } };
+
+/** @brief Definition of the identity object */
+static const CipClassDefinition kIdentityClassDefinition = {
+    kIdentityClassCode, /* class ID */
+    "identity", /* class name (for debug)*/
+    1, /* class revision*/
+    MASK4(1, 2, 6, 7), /* class getAttributeAll mask		CIP spec 5-2.3.2 */
+    kIdentityInstanceAttributes, CIP_TABLE_ENTRIES(kIdentityInstanceAttributes),
+    7, /* highest instance attribute number */
+    MASK7(1, 2, 3, 4, 5, 6, 7), /* instance getAttributeAll mask	CIP spec 5-2.3.2 */
+    kIdentityInstanceServices, CIP_TABLE_ENTRIES(kIdentityInstanceServices) };
+
 /** @brief CIP Identity object constructor
  *
  * @returns EIP_ERROR if the class could not be created, otherwise EIP_OK
  */
 EipStatus CipIdentityInit() {
-  CipClass *class;
-  CipInstance *instance;
-
-  class = CreateCipClass(kIdentityClassCode, 0, /* # of non-default class attributes */
-                         MASK4(1, 2, 6, 7), /* class getAttributeAll mask		CIP spec 5-2.3.2 */
-                         0, /* # of class services*/
-                         7, /* # of instance attributes*/
-                         MASK7(1, 2, 3, 4, 5, 6, 7), /* instance getAttributeAll mask	CIP spec 5-2.3.2 */
-                         1, /* # of instance services*/
-                         1, /* # of instances*/
-                         "identity", /* class name (for debug)*/
-                         1); /* class revision*/
-
-  if (class == 0)
+  if (0 == CreateCipClassFromDefinition(&kIdentityClassDefinition))
     return kEipStatusError;
 
-  instance = GetCipInstance(class, 1);
-
-  InsertAttribute(instance, 1, kCipUint, &vendor_id_, kGetableSingleAndAll);
-  InsertAttribute(instance, 2, kCipUint, &device_type_, kGetableSingleAndAll);
-  InsertAttribute(instance, 3, kCipUint, &product_code_, kGetableSingleAndAll);
-  InsertAttribute(instance, 4, kCipUsintUsint, &revision_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 5, kCipWord, &status_, kGetableSingleAndAll);
-  InsertAttribute(instance, 6, kCipUdint, &serial_number_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 7, kCipShortString, &product_name_,
-                  kGetableSingleAndAll);
-
-  InsertService(class, kReset, &Reset, "Reset");
-
   return kEipStatusOk;
 }
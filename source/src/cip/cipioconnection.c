@@ -17,6 +17,8 @@
 #include "cpf.h"
 #include "trace.h"
 #include "endianconv.h"
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /** @brief Gives the cardinality of a connection endpoint,
  *  either point to point or point to multipoint
@@ -59,23 +61,17 @@ void CloseIoConnection(ConnectionObject *connection_object);
 
 void HandleIoConnectionTimeOut(ConnectionObject *connection_object);
 
-/** @brief  Send the data from the produced CIP Object of the connection via the socket of the connection object
- *   on UDP.
- *      @param connection_object  pointer to the connection object
- *      @return status  EIP_OK .. success
- *                     EIP_ERROR .. error
+/** @brief Calculate the checksum of the data of the producing assembly
+ *
+ * Uses the 32-bit FNV-1a hash over the assembly data.
+ * @param connection_object pointer to the connection object data
+ * @return checksum of the data
  */
-EipStatus SendConnectedData(ConnectionObject *connection_object);
+EipUint32 CalculateProducedDataChecksum(ConnectionObject *connection_object);
 
 EipStatus HandleReceivedIoConnectionData(ConnectionObject *connection_object,
                                          EipUint8 *data, EipUint16 data_length);
 
-/**** Global variables ****/
-EipUint8 *g_config_data_buffer = NULL; /**< buffers for the config data coming with a forward open request. */
-unsigned int g_config_data_length = 0;
-
-EipUint32 g_run_idle_state; /**< buffer for holding the run idle information. */
-
 /**** Implementation ****/
 EipStatus EstablishIoConnction(ConnectionObject *connection_object,
                          EipUint16 *extended_error) {
@@ -244,7 +240,7 @@ EipStatus EstablishIoConnction(ConnectionObject *connection_object,
       }
     }
 
-    if (NULL != g_config_data_buffer) { /* config data has been sent with this forward open request */
+    if (NULL != g_opener_stack->config_data_buffer) { /* config data has been sent with this forward open request */
       *extended_error = HandleConfigData(assembly_class, io_connection_object);
       if (0 != *extended_error) {
         return kCipErrorConnectionFailure;
@@ -369,9 +365,9 @@ EipStatus OpenProducingMulticastConnection(
   /* we have a connection reuse the data and the socket */
 
   j = 0; /* allocate an unused sockaddr struct to use */
-  if (g_common_packet_format_data_item.address_info_item[0].type_id == 0) { /* it is not used yet */
+  if (common_packet_format_data->address_info_item[0].type_id == 0) { /* it is not used yet */
     j = 0;
-  } else if (g_common_packet_format_data_item.address_info_item[1].type_id
+  } else if (common_packet_format_data->address_info_item[1].type_id
       == 0) {
     j = 1;
   }
@@ -396,7 +392,7 @@ EipStatus OpenProducingMulticastConnection(
   connection_object->remote_address.sin_port = common_packet_format_data
       ->address_info_item[j].sin_port = htons(kOpenerEipIoUdpPort);
   connection_object->remote_address.sin_addr.s_addr = common_packet_format_data
-      ->address_info_item[j].sin_addr = g_multicast_configuration
+      ->address_info_item[j].sin_addr = g_opener_stack->multicast_configuration
       .starting_multicast_address;
   memset(common_packet_format_data->address_info_item[j].nasin_zero, 0, 8);
   common_packet_format_data->address_info_item[j].sin_family = htons(AF_INET);
@@ -420,7 +416,7 @@ EipStatus OpenMulticastConnection(
   int socket;
 
 
-  if (0 != g_common_packet_format_data_item.address_info_item[0].type_id) {
+  if (0 != common_packet_format_data->address_info_item[0].type_id) {
     if ((kUdpCommuncationDirectionConsuming == direction)
         && (kCipItemIdSocketAddressInfoOriginatorToTarget
             == common_packet_format_data->address_info_item[0].type_id)) {
@@ -429,7 +425,7 @@ EipStatus OpenMulticastConnection(
     } else {
       j = 1;
       /* if the type is not zero (not used) or if a given type it has to be the correct one */
-      if ((0 != g_common_packet_format_data_item.address_info_item[1].type_id)
+      if ((0 != common_packet_format_data->address_info_item[1].type_id)
           && (!((kUdpCommuncationDirectionConsuming == direction)
               && (kCipItemIdSocketAddressInfoOriginatorToTarget
                   == common_packet_format_data->address_info_item[0].type_id)))) {
@@ -445,7 +441,7 @@ EipStatus OpenMulticastConnection(
     common_packet_format_data->address_info_item[j].sin_port = htons(
         kOpenerEipIoUdpPort);
     common_packet_format_data->address_info_item[j].sin_addr =
-        g_multicast_configuration.starting_multicast_address;
+        g_opener_stack->multicast_configuration.starting_multicast_address;
     memset(common_packet_format_data->address_info_item[j].nasin_zero, 0, 8);
     common_packet_format_data->address_info_item[j].length = 16;
   }
@@ -492,18 +488,19 @@ EipUint16 HandleConfigData(CipClass *assembly_class,
   CipInstance *config_instance = GetCipInstance(
       assembly_class, connection_object->connection_path.connection_point[2]);
 
-  if (0 != g_config_data_length) {
+  if (0 != g_opener_stack->config_data_length) {
     if (ConnectionWithSameConfigPointExists(
         connection_object->connection_path.connection_point[2])) { /* there is a connected connection with the same config point
          * we have to have the same data as already present in the config point*/
       CipByteArray *p = (CipByteArray *) GetCipAttribute(config_instance, 3)
           ->data;
-      if (p->length != g_config_data_length) {
+      if (p->length != g_opener_stack->config_data_length) {
         connection_manager_status =
             kConnectionManagerStatusCodeErrorOwnershipConflict;
       } else {
         /*FIXME check if this is correct */
-        if (memcmp(p->data, g_config_data_buffer, g_config_data_length)) {
+        if (memcmp(p->data, g_opener_stack->config_data_buffer,
+                   g_opener_stack->config_data_length)) {
           connection_manager_status =
               kConnectionManagerStatusCodeErrorOwnershipConflict;
         }
@@ -513,8 +510,8 @@ EipUint16 HandleConfigData(CipClass *assembly_class,
        design this can be done rather efficiently */
       if (kEipStatusOk
           != NotifyAssemblyConnectedDataReceived(config_instance,
-                                                 g_config_data_buffer,
-                                                 g_config_data_length)) {
+                                                 g_opener_stack->config_data_buffer,
+                                                 g_opener_stack->config_data_length)) {
         OPENER_TRACE_WARN("Configuration data was invalid\n");
         connection_manager_status =
             kConnectionManagerStatusCodeInvalidConfigurationApplicationPath;
@@ -613,14 +610,14 @@ void HandleIoConnectionTimeOut(ConnectionObject *connection_object) {
 }
 
 EipStatus SendConnectedData(ConnectionObject *connection_object) {
-  CipCommonPacketFormatData *common_packet_format_data;
+  CipCommonPacketFormatData produced_common_packet_format_data;
+  CipCommonPacketFormatData *common_packet_format_data =
+      &produced_common_packet_format_data;
   EipUint16 reply_length;
   EipUint8 *message_data_reply_buffer;
 
   /* TODO think of adding an own send buffer to each connection object in order to preset up the whole message on connection opening and just change the variable data items e.g., sequence number */
 
-  common_packet_format_data = &g_common_packet_format_data_item; /* TODO think on adding a CPF data item to the S_CIP_ConnectionObject in order to remove the code here or even better allocate memory in the connection object for storing the message to send and just change the application data*/
-
   connection_object->eip_level_sequence_count_producing++;
 
   /* assembleCPFData */
@@ -645,7 +642,22 @@ EipStatus SendConnectedData(ConnectionObject *connection_object) {
   common_packet_format_data->data_item.length = 0;
 
   /* notify the application that data will be sent immediately after the call */
-  if (BeforeAssemblyDataSend(connection_object->producing_instance)) {
+  EipBool8 data_changed = BeforeAssemblyDataSend(
+      connection_object->producing_instance);
+  if (kConnectionTriggerTypeChangeOfStateTriggeredConnection
+      == (connection_object->transport_type_class_trigger
+          & kConnectionTriggerTypeProductionTriggerMask)) {
+    /* change of state connections keep the checksum of the produced data to
+     * detect changes, a changed checksum counts as new data as well. Cyclic
+     * and application triggered connections only count the changes reported
+     * by BeforeAssemblyDataSend */
+    EipUint32 checksum = CalculateProducedDataChecksum(connection_object);
+    if (checksum != connection_object->produced_data_checksum) {
+      data_changed = true;
+    }
+    connection_object->produced_data_checksum = checksum;
+  }
+  if (data_changed) {
     /* the data has changed increase sequence counter */
     connection_object->sequence_count_producing++;
   }
@@ -655,9 +667,9 @@ EipStatus SendConnectedData(ConnectionObject *connection_object) {
   common_packet_format_data->address_info_item[1].type_id = 0;
 
   reply_length = AssembleIOMessage(common_packet_format_data,
-                                   &g_message_data_reply_buffer[0]);
+                                   &g_opener_stack->message_data_reply_buffer[0]);
 
-  message_data_reply_buffer = &g_message_data_reply_buffer[reply_length - 2];
+  message_data_reply_buffer = &g_opener_stack->message_data_reply_buffer[reply_length - 2];
   common_packet_format_data->data_item.length = producing_instance_attributes
       ->length;
   if (kOpenerProducedDataHasRunIdleHeader) {
@@ -676,7 +688,7 @@ EipStatus SendConnectedData(ConnectionObject *connection_object) {
   }
 
   if (kOpenerProducedDataHasRunIdleHeader) {
-    AddDintToMessage(g_run_idle_state, &(message_data_reply_buffer));
+    AddDintToMessage(g_opener_stack->run_idle_state, &(message_data_reply_buffer));
   }
 
   memcpy(message_data_reply_buffer, producing_instance_attributes->data,
@@ -684,10 +696,35 @@ EipStatus SendConnectedData(ConnectionObject *connection_object) {
 
   reply_length += common_packet_format_data->data_item.length;
 
-  return SendUdpData(
+  EipStatus eip_status = SendUdpData(
       &connection_object->remote_address,
       connection_object->socket[kUdpCommuncationDirectionProducing],
-      &g_message_data_reply_buffer[0], reply_length);
+      &g_opener_stack->message_data_reply_buffer[0], reply_length);
+  if (kEipStatusOk == eip_status) {
+    connection_object->packet_statistics.produced_packets++;
+    g_opener_stack->opener_statistics.io_packets_produced++;
+  }
+  return eip_status;
+}
+
+EipUint32 CalculateProducedDataChecksum(ConnectionObject *connection_object) {
+  CipByteArray *producing_instance_attributes =
+      (CipByteArray *) connection_object->producing_instance->attributes->data;
+  EipUint32 checksum = 2166136261U; /* FNV offset basis */
+
+  for (int i = 0; i < producing_instance_attributes->length; i++) {
+    checksum ^= producing_instance_attributes->data[i];
+    checksum *= 16777619U; /* FNV prime */
+  }
+  return checksum;
+}
+
+EipBool8 HasProducedDataChanged(ConnectionObject *connection_object) {
+  if (NULL == connection_object->producing_instance) {
+    return false;
+  }
+  return (CalculateProducedDataChecksum(connection_object)
+      != connection_object->produced_data_checksum) ? true : false;
 }
 
 EipStatus HandleReceivedIoConnectionData(ConnectionObject *connection_object,
@@ -698,6 +735,7 @@ EipStatus HandleReceivedIoConnectionData(ConnectionObject *connection_object,
     EipUint16 sequence_buffer = GetIntFromMessage(&(data));
     if (SEQ_LEQ16(sequence_buffer,
                   connection_object->sequence_count_consuming)) {
+      connection_object->packet_statistics.duplicate_packets++;
       return kEipStatusOk; /* no new data for the assembly */
     }
     connection_object->sequence_count_consuming = sequence_buffer;
@@ -708,15 +746,16 @@ EipStatus HandleReceivedIoConnectionData(ConnectionObject *connection_object,
     /* we have no heartbeat connection */
     if (kOpenerConsumedDataHasRunIdleHeader) {
       EipUint32 nRunIdleBuf = GetDintFromMessage(&(data));
-      if (g_run_idle_state != nRunIdleBuf) {
+      if (g_opener_stack->run_idle_state != nRunIdleBuf) {
         RunIdleChanged(nRunIdleBuf);
       }
-      g_run_idle_state = nRunIdleBuf;
+      g_opener_stack->run_idle_state = nRunIdleBuf;
       data_length -= 4;
     }
 
     if (NotifyAssemblyConnectedDataReceived(
         connection_object->consuming_instance, data, data_length) != 0) {
+      connection_object->packet_statistics.refused_packets++;
       return kEipStatusError;
     }
   }
@@ -726,9 +765,9 @@ EipStatus HandleReceivedIoConnectionData(ConnectionObject *connection_object,
 EipStatus OpenCommunicationChannels(ConnectionObject *connection_object) {
 
   EipStatus eip_status = kEipStatusOk;
-  /*get pointer to the CPF data, currently we have just one global instance of the struct. This may change in the future*/
+  /* connections are opened by a forward open, use the CPF data of its request */
   CipCommonPacketFormatData *common_packet_format_data =
-      &g_common_packet_format_data_item;
+      g_opener_stack->common_packet_format_data;
 
   CommunicationEndpointCardinality originator_to_target_connection_type = (connection_object
       ->o_to_t_network_connection_parameter & 0x6000) >> 13;
@@ -73,7 +73,20 @@ EipStatus OpenCommunicationChannels(ConnectionObject *connection_object);
 void CloseCommunicationChannelsAndRemoveFromActiveConnectionsList(
     ConnectionObject *connection_object);
 
-extern EipUint8 *g_config_data_buffer;
-extern unsigned int g_config_data_length;
+/** @brief Check if the data of the producing assembly changed since the last
+ * production of the connection
+ *
+ * @param connection_object pointer to the connection object data
+ * @return true if the assembly data differs from the data last produced
+ */
+EipBool8 HasProducedDataChanged(ConnectionObject *connection_object);
+
+/** @brief  Send the data from the produced CIP Object of the connection via the socket of the connection object
+ *   on UDP.
+ *      @param connection_object  pointer to the connection object
+ *      @return status  EIP_OK .. success
+ *                     EIP_ERROR .. error
+ */
+EipStatus SendConnectedData(ConnectionObject *connection_object);
 
 #endif /* OPENER_CIPIOCONNECTION_H_ */
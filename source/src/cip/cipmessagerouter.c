@@ -9,9 +9,8 @@
 #include "endianconv.h"
 #include "ciperror.h"
 #include "trace.h"
-
-CipMessageRouterRequest g_message_router_request;
-CipMessageRouterResponse g_message_router_response;
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /** @brief A class registry list node
  *
@@ -25,9 +24,6 @@ typedef struct cip_message_router_object {
   CipClass *cip_class; /*< object */
 } CipMessageRouterObject;
 
-/** @brief Pointer to first registered object in MessageRouter*/
-CipMessageRouterObject *g_first_object = 0;
-
 /** @brief Register an Class to the message router
  *  @param cip_class Pointer to a class object to be registered.
  *  @return status      0 .. success
@@ -65,8 +61,10 @@ EipStatus CipMessageRouterInit() {
     return kEipStatusError;
 
   /* reserved for future use -> set to zero */
-  g_message_router_response.reserved = 0;
-  g_message_router_response.data = g_message_data_reply_buffer; /* set reply buffer, using a fixed buffer (about 100 bytes) */
+  g_opener_stack->message_router_response.reserved = 0;
+  g_opener_stack->message_router_response.data = g_opener_stack->message_data_reply_buffer; /* set reply buffer, using a fixed buffer (about 100 bytes) */
+  g_opener_stack->message_router_response.data_end = g_opener_stack->message_data_reply_buffer
+      + OPENER_MESSAGE_DATA_REPLY_BUFFER;
 
   return kEipStatusOk;
 }
@@ -79,7 +77,7 @@ EipStatus CipMessageRouterInit() {
  *      0 .. Class not registered
  */
 CipMessageRouterObject *GetRegisteredObject(EipUint32 class_id) {
-  CipMessageRouterObject *object = g_first_object; /* get pointer to head of class registration list */
+  CipMessageRouterObject *object = g_opener_stack->first_object; /* get pointer to head of class registration list */
 
   while (NULL != object) /* for each entry in list*/
   {
@@ -116,7 +114,7 @@ CipInstance *GetCipInstance(CipClass *cip_class, EipUint32 instance_number) {
 }
 
 EipStatus RegisterCipClass(CipClass *cip_class) {
-  CipMessageRouterObject **message_router_object = &g_first_object;
+  CipMessageRouterObject **message_router_object = &g_opener_stack->first_object;
 
   while (*message_router_object)
     message_router_object = &(*message_router_object)->next; /* follow the list until p points to an empty link (list end)*/
@@ -136,46 +134,48 @@ EipStatus NotifyMR(EipUint8 *data, int data_length) {
   EipStatus eip_status = kEipStatusOkSend;
   EipByte nStatus;
 
-  g_message_router_response.data = g_message_data_reply_buffer; /* set reply buffer, using a fixed buffer (about 100 bytes) */
+  g_opener_stack->message_router_response.data = g_opener_stack->message_data_reply_buffer; /* set reply buffer, using a fixed buffer (about 100 bytes) */
+  g_opener_stack->message_router_response.data_end = g_opener_stack->message_data_reply_buffer
+      + OPENER_MESSAGE_DATA_REPLY_BUFFER;
 
   OPENER_TRACE_INFO("notifyMR: routing unconnected message\n");
   if (kCipErrorSuccess
       != (nStatus = CreateMessageRouterRequestStructure(
-          data, data_length, &g_message_router_request))) { /* error from create MR structure*/
+          data, data_length, &g_opener_stack->message_router_request))) { /* error from create MR structure*/
     OPENER_TRACE_ERR("notifyMR: error from createMRRequeststructure\n");
-    g_message_router_response.general_status = nStatus;
-    g_message_router_response.size_of_additional_status = 0;
-    g_message_router_response.reserved = 0;
-    g_message_router_response.data_length = 0;
-    g_message_router_response.reply_service = (0x80
-        | g_message_router_request.service);
+    g_opener_stack->message_router_response.general_status = nStatus;
+    g_opener_stack->message_router_response.size_of_additional_status = 0;
+    g_opener_stack->message_router_response.reserved = 0;
+    g_opener_stack->message_router_response.data_length = 0;
+    g_opener_stack->message_router_response.reply_service = (0x80
+        | g_opener_stack->message_router_request.service);
   } else {
     /* forward request to appropriate Object if it is registered*/
     CipMessageRouterObject *registered_object;
 
     registered_object = GetRegisteredObject(
-        g_message_router_request.request_path.class_id);
+        g_opener_stack->message_router_request.request_path.class_id);
     if (registered_object == 0) {
       OPENER_TRACE_ERR(
           "notifyMR: sending CIP_ERROR_OBJECT_DOES_NOT_EXIST reply, class id 0x%x is not registered\n",
-          (unsigned ) g_message_router_request.request_path.class_id);
-      g_message_router_response.general_status =
+          (unsigned ) g_opener_stack->message_router_request.request_path.class_id);
+      g_opener_stack->message_router_response.general_status =
           kCipErrorPathDestinationUnknown; /*according to the test tool this should be the correct error flag instead of CIP_ERROR_OBJECT_DOES_NOT_EXIST;*/
-      g_message_router_response.size_of_additional_status = 0;
-      g_message_router_response.reserved = 0;
-      g_message_router_response.data_length = 0;
-      g_message_router_response.reply_service = (0x80
-          | g_message_router_request.service);
+      g_opener_stack->message_router_response.size_of_additional_status = 0;
+      g_opener_stack->message_router_response.reserved = 0;
+      g_opener_stack->message_router_response.data_length = 0;
+      g_opener_stack->message_router_response.reply_service = (0x80
+          | g_opener_stack->message_router_request.service);
     } else {
       /* call notify function from Object with ClassID (gMRRequest.RequestPath.ClassID)
        object will or will not make an reply into gMRResponse*/
-      g_message_router_response.reserved = 0;
+      g_opener_stack->message_router_response.reserved = 0;
       OPENER_ASSERT(NULL != registered_object->cip_class);
       OPENER_TRACE_INFO("notifyMR: calling notify function of class '%s'\n",
                         registered_object->cip_class->class_name);
       eip_status = NotifyClass(registered_object->cip_class,
-                               &g_message_router_request,
-                               &g_message_router_response);
+                               &g_opener_stack->message_router_request,
+                               &g_opener_stack->message_router_response);
 
 #ifdef OPENER_TRACE_ENABLED
       if (eip_status == kEipStatusError) {
@@ -194,6 +194,11 @@ EipStatus NotifyMR(EipUint8 *data, int data_length) {
 #endif
     }
   }
+  g_opener_stack->opener_statistics.explicit_requests++;
+  if ((kEipStatusOkSend == eip_status)
+      && (kCipErrorSuccess != g_opener_stack->message_router_response.general_status)) {
+    g_opener_stack->opener_statistics.explicit_error_responses++;
+  }
   return eip_status;
 }
 
@@ -222,7 +227,7 @@ CipError CreateMessageRouterRequestStructure(
 }
 
 void DeleteAllClasses(void) {
-  CipMessageRouterObject *message_router_object = g_first_object; /* get pointer to head of class registration list */
+  CipMessageRouterObject *message_router_object = g_opener_stack->first_object; /* get pointer to head of class registration list */
   CipMessageRouterObject *message_router_object_to_delete;
   CipInstance *instance, *instance_to_delete;
 
@@ -246,14 +251,16 @@ void DeleteAllClasses(void) {
         message_router_object_to_delete->cip_class->m_stSuper.cip_class
             ->class_name);
     CipFree(
-        message_router_object_to_delete->cip_class->m_stSuper.cip_class
+        (void *) message_router_object_to_delete->cip_class->m_stSuper.cip_class
             ->services);
     CipFree(message_router_object_to_delete->cip_class->m_stSuper.cip_class);
     /*clear class data*/
     CipFree(message_router_object_to_delete->cip_class->m_stSuper.attributes);
-    CipFree(message_router_object_to_delete->cip_class->services);
+    if (NULL == message_router_object_to_delete->cip_class->definition) { /* the services of a definition are constant */
+      CipFree((void *) message_router_object_to_delete->cip_class->services);
+    }
     CipFree(message_router_object_to_delete->cip_class);
     CipFree(message_router_object_to_delete);
   }
-  g_first_object = NULL;
+  g_opener_stack->first_object = NULL;
 }
@@ -11,13 +11,6 @@
 
 static const int kCipMessageRouterClassCode = 0x02;
 
-/** @brief Structure for storing the Response generated by an explict message.
- * 
- *  This buffer will be used for storing the result. The response message will be generated
- *  by assembleLinearMsg. 
- */
-extern CipMessageRouterResponse g_message_router_response;
-
 /* public functions */
 
 /** @brief Initialize the data structures of the message router
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "cipstatistics.h"
+
+#include "cipcommon.h"
+#include "cipconnectionmanager.h"
+#include "opener_api.h"
+#include "generic_networkhandler.h"
+#include "opener_stack.h"
+
+/** @brief GetAttributeSingle of the statistics object, refreshing the
+ *  snapshot before the attribute is read
+ */
+EipStatus GetAttributeSingleStatistics(
+    CipInstance *instance, CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response);
+
+/** @brief GetAttributeAll of the statistics object, refreshing the snapshot
+ *  before the attributes are read
+ */
+EipStatus GetAttributeAllStatistics(
+    CipInstance *instance, CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response);
+
+/** @brief Limit a time to the range of an UDINT */
+EipUint32 SaturateMicroSeconds(MicroSeconds time);
+
+/** @brief Attributes of the statistics object instance */
+static const CipAttributeDefinition kStatisticsInstanceAttributes[] = {
+    CIP_STACK_ATTRIBUTE(1, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.loop_iterations),
+    CIP_STACK_ATTRIBUTE(2, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.busy_loop_iterations),
+    CIP_STACK_ATTRIBUTE(3, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.max_loop_iteration_time),
+    CIP_STACK_ATTRIBUTE(4, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.max_loop_processing_time),
+    CIP_STACK_ATTRIBUTE(5, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.udp_packets_received),
+    CIP_STACK_ATTRIBUTE(6, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.tcp_messages_received),
+    CIP_STACK_ATTRIBUTE(7, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.too_large_tcp_messages),
+    CIP_STACK_ATTRIBUTE(8, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.registered_sessions),
+    CIP_STACK_ATTRIBUTE(9, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.encapsulation_errors),
+    CIP_STACK_ATTRIBUTE(10, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.explicit_requests),
+    CIP_STACK_ATTRIBUTE(11, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.explicit_error_responses),
+    CIP_STACK_ATTRIBUTE(12, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.io_packets_consumed),
+    CIP_STACK_ATTRIBUTE(13, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.io_packets_produced),
+    CIP_STACK_ATTRIBUTE(14, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.io_packets_wrong_size),
+    CIP_STACK_ATTRIBUTE(15, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.io_packets_wrong_originator),
+    CIP_STACK_ATTRIBUTE(16, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.io_packets_unknown_connection),
+    CIP_STACK_ATTRIBUTE(17, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.counters.connection_timeouts),
+    CIP_STACK_ATTRIBUTE(18, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.forward_open_requests),
+    CIP_STACK_ATTRIBUTE(19, kCipUdint, kGetableSingleAndAll,
+        statistics_object_snapshot.forward_open_rejections) };
+
+/** @brief Services of the statistics object instance */
+static const CipServiceStruct kStatisticsInstanceServices[] = {
+    { kGetAttributeAll, &GetAttributeAllStatistics, "GetAttributeAll" },
+    { kGetAttributeSingle, &GetAttributeSingleStatistics,
+        "GetAttributeSingle" } };
+
+/** @brief Definition of the OpENer statistics object */
+static const CipClassDefinition kStatisticsClassDefinition = {
+    CIP_OPENER_STATISTICS_CLASS_CODE, /* class ID */
+    "OpENer statistics", /* class name */
+    1, /* class revision */
+    0xffffffff, /* class getAttributeAll mask*/
+    kStatisticsInstanceAttributes,
+    CIP_TABLE_ENTRIES(kStatisticsInstanceAttributes),
+    19, /* highest instance attribute number */
+    0xffffffff, /* instance getAttributeAll mask*/
+    kStatisticsInstanceServices,
+    CIP_TABLE_ENTRIES(kStatisticsInstanceServices) };
+
+EipStatus CipStatisticsInit(void) {
+  memset(&g_opener_stack->opener_statistics, 0, sizeof(g_opener_stack->opener_statistics));
+
+  if (0 == CreateCipClassFromDefinition(&kStatisticsClassDefinition)) {
+    return kEipStatusError;
+  }
+
+  return kEipStatusOk;
+}
+
+EipUint32 SaturateMicroSeconds(MicroSeconds time) {
+  return (0xFFFFFFFFULL < time) ? 0xFFFFFFFFU : (EipUint32) time;
+}
+
+void CollectOpenerStatistics(OpenerStatisticsSnapshot *snapshot) {
+  const ForwardOpenStatistics *forward_open_statistics =
+      GetForwardOpenStatistics();
+
+  snapshot->loop_iterations = g_opener_stack->network_handler_loop_statistics.iterations;
+  snapshot->busy_loop_iterations = g_opener_stack->network_handler_loop_statistics
+      .busy_iterations;
+  snapshot->max_loop_iteration_time = SaturateMicroSeconds(
+      g_opener_stack->network_handler_loop_statistics.max_iteration_time);
+  snapshot->max_loop_processing_time = SaturateMicroSeconds(
+      g_opener_stack->network_handler_loop_statistics.max_processing_time);
+  snapshot->counters = g_opener_stack->opener_statistics;
+  snapshot->forward_open_requests = forward_open_statistics->requests;
+  snapshot->forward_open_rejections = forward_open_statistics
+      ->rejected_requests;
+}
+
+EipStatus GetAttributeSingleStatistics(
+    CipInstance *instance, CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response) {
+  CollectOpenerStatistics(&g_opener_stack->statistics_object_snapshot);
+  return GetAttributeSingle(instance, message_router_request,
+                            message_router_response);
+}
+
+EipStatus GetAttributeAllStatistics(
+    CipInstance *instance, CipMessageRouterRequest *message_router_request,
+    CipMessageRouterResponse *message_router_response) {
+  CollectOpenerStatistics(&g_opener_stack->statistics_object_snapshot);
+  return GetAttributeAll(instance, message_router_request,
+                         message_router_response);
+}
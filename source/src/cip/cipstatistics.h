@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_CIPSTATISTICS_H_
+#define OPENER_CIPSTATISTICS_H_
+
+#include "typedefs.h"
+#include "ciptypes.h"
+
+/** @file cipstatistics.h
+ * @brief Counters of the network handler, the encapsulation layer, the message
+ * router and the I/O connections, and the vendor specific object reporting
+ * them
+ *
+ * The counters are plain integers incremented where the events happen. They
+ * are only collected into a consistent snapshot when they are read, either
+ * through the OpENer statistics object or by the platform, e.g., into a
+ * shared memory segment.
+ */
+
+/** @brief Class code of the vendor specific OpENer statistics object */
+#define CIP_OPENER_STATISTICS_CLASS_CODE 0x64
+
+/** @brief Global event counters */
+typedef struct {
+  EipUint32 udp_packets_received; /**< on the unicast, broadcast and consuming sockets */
+  EipUint32 tcp_messages_received; /**< encapsulation messages received on TCP */
+  EipUint32 too_large_tcp_messages; /**< encapsulation messages dropped as larger than the buffer */
+  EipUint32 registered_sessions; /**< successful RegisterSession requests */
+  EipUint32 encapsulation_errors; /**< replies with an encapsulation error status */
+  EipUint32 explicit_requests; /**< requests handled by the message router */
+  EipUint32 explicit_error_responses; /**< message router replies with an error general status */
+  EipUint32 io_packets_consumed; /**< I/O packets with new data for their connection */
+  EipUint32 io_packets_produced;
+  EipUint32 io_packets_wrong_size; /**< consumed data not matching the assembly size */
+  EipUint32 io_packets_wrong_originator; /**< I/O packets not sent by the originator of their connection */
+  EipUint32 io_packets_unknown_connection; /**< I/O packets for no active connection */
+  EipUint32 connection_timeouts;
+} OpenerStatistics;
+
+/** @brief Snapshot of all statistics as reported by the statistics object,
+ *  times in us
+ */
+typedef struct {
+  EipUint32 loop_iterations;
+  EipUint32 busy_loop_iterations;
+  EipUint32 max_loop_iteration_time;
+  EipUint32 max_loop_processing_time;
+  OpenerStatistics counters;
+  EipUint32 forward_open_requests;
+  EipUint32 forward_open_rejections;
+} OpenerStatisticsSnapshot;
+
+/** @brief Initialize the statistics and create the OpENer statistics object */
+EipStatus CipStatisticsInit(void);
+
+/** @brief Collect the current values of all statistics
+ *
+ * @param snapshot the snapshot to fill
+ */
+void CollectOpenerStatistics(OpenerStatisticsSnapshot *snapshot);
+
+#endif /* OPENER_CIPSTATISTICS_H_ */
@@ -14,6 +14,7 @@
 #include "endianconv.h"
 #include "cipethernetlink.h"
 #include "opener_api.h"
+#include "opener_stack.h"
 
 CipDword tcp_status_ = 0x1; /**< #1  TCP status with 1 we indicate that we got a valid configuration from DHCP or BOOTP */
 CipDword configuration_capability_ = 0x04 | 0x20; /**< #2  This is a default value meaning that it is a DHCP client see 5-3.2.2.2 EIP specification; 0x20 indicates "Hardware Configurable" */
@@ -25,34 +26,6 @@ CIP_ETHERNETLINK_CLASS_CODE, /**< EIP_UINT16 ClassID*/
 0 /**< EIP_UINT16 AttributNr (not used as this is the EPATH the EthernetLink object)*/
 };
 
-CipTcpIpNetworkInterfaceConfiguration interface_configuration_ = /**< #5 IP, network mask, gateway, name server 1 & 2, domain name*/
-{ 0, /* default IP address */
-0, /* NetworkMask */
-0, /* Gateway */
-0, /* NameServer */
-0, /* NameServer2 */
-{ /* DomainName */
-0, NULL, } };
-
-CipString hostname_ = /**< #6 Hostname*/
-{ 0, NULL };
-/** @brief #8 the time to live value to be used for multi-cast connections
- *
- * Currently we implement it non set-able and with the default value of 1.
- */
-EipUint8 g_time_to_live_value = 1;
-
-/** @brief #9 The multicast configuration for this device
- *
- * Currently we implement it non set-able and use the default
- * allocation algorithm
- */
-MulticastAddressConfiguration g_multicast_configuration = { 0, /* us the default allocation algorithm */
-0, /* reserved */
-1, /* we currently use only one multicast address */
-0 /* the multicast address will be allocated on ip address configuration */
-};
-
 /************** Functions ****************************************/
 EipStatus GetAttributeSingleTcpIpInterface(
     CipInstance *instance, CipMessageRouterRequest *message_router_request,
@@ -66,53 +39,53 @@ EipStatus ConfigureNetworkInterface(const char *ip_address,
                                     const char *subnet_mask,
                                     const char *gateway) {
 
-  interface_configuration_.ip_address = inet_addr(ip_address);
-  interface_configuration_.network_mask = inet_addr(subnet_mask);
-  interface_configuration_.gateway = inet_addr(gateway);
+  g_opener_stack->interface_configuration.ip_address = inet_addr(ip_address);
+  g_opener_stack->interface_configuration.network_mask = inet_addr(subnet_mask);
+  g_opener_stack->interface_configuration.gateway = inet_addr(gateway);
 
   /* calculate the CIP multicast address. The multicast address is calculated, not input*/
-  EipUint32 host_id = ntohl(interface_configuration_.ip_address)
-      & ~ntohl(interface_configuration_.network_mask); /* see CIP spec 3-5.3 for multicast address algorithm*/
+  EipUint32 host_id = ntohl(g_opener_stack->interface_configuration.ip_address)
+      & ~ntohl(g_opener_stack->interface_configuration.network_mask); /* see CIP spec 3-5.3 for multicast address algorithm*/
   host_id -= 1;
   host_id &= 0x3ff;
 
-  g_multicast_configuration.starting_multicast_address = htonl(
+  g_opener_stack->multicast_configuration.starting_multicast_address = htonl(
       ntohl(inet_addr("239.192.1.0")) + (host_id << 5));
 
   return kEipStatusOk;
 }
 
 void ConfigureDomainName(const char *domain_name) {
-  if (NULL != interface_configuration_.domain_name.string) {
+  if (NULL != g_opener_stack->interface_configuration.domain_name.string) {
     /* if the string is already set to a value we have to free the resources
      * before we can set the new value in order to avoid memory leaks.
      */
-    CipFree(interface_configuration_.domain_name.string);
+    CipFree(g_opener_stack->interface_configuration.domain_name.string);
   }
-  interface_configuration_.domain_name.length = strlen(domain_name);
-  if (interface_configuration_.domain_name.length) {
-    interface_configuration_.domain_name.string = (EipByte *) CipCalloc(
-        interface_configuration_.domain_name.length + 1, sizeof(EipInt8));
-    strcpy(interface_configuration_.domain_name.string, domain_name);
+  g_opener_stack->interface_configuration.domain_name.length = strlen(domain_name);
+  if (g_opener_stack->interface_configuration.domain_name.length) {
+    g_opener_stack->interface_configuration.domain_name.string = (EipByte *) CipCalloc(
+        g_opener_stack->interface_configuration.domain_name.length + 1, sizeof(EipInt8));
+    strcpy(g_opener_stack->interface_configuration.domain_name.string, domain_name);
   } else {
-    interface_configuration_.domain_name.string = NULL;
+    g_opener_stack->interface_configuration.domain_name.string = NULL;
   }
 }
 
 void ConfigureHostName(const char *hostname) {
-  if (NULL != hostname_.string) {
+  if (NULL != g_opener_stack->hostname.string) {
     /* if the string is already set to a value we have to free the resources
      * before we can set the new value in order to avoid memory leaks.
      */
-    CipFree(hostname_.string);
+    CipFree(g_opener_stack->hostname.string);
   }
-  hostname_.length = strlen(hostname);
-  if (hostname_.length) {
-    hostname_.string = (EipByte *) CipCalloc(hostname_.length + 1,
-                                             sizeof(EipByte));
-    strcpy(hostname_.string, hostname);
+  g_opener_stack->hostname.length = strlen(hostname);
+  if (g_opener_stack->hostname.length) {
+    g_opener_stack->hostname.string = (EipByte *) CipCalloc(
+        g_opener_stack->hostname.length + 1, sizeof(EipByte));
+    strcpy(g_opener_stack->hostname.string, hostname);
   } else {
-    hostname_.string = NULL;
+    g_opener_stack->hostname.string = NULL;
   }
 }
 
@@ -140,62 +113,61 @@ EipStatus SetAttributeSingleTcp(
   return kEipStatusOkSend;
 }
 
+/** @brief Attributes of the TCP/IP interface object instance */
+static const CipAttributeDefinition kTcpIpInstanceAttributes[] = {
+    CIP_SHARED_ATTRIBUTE(1, kCipDword, kGetableSingleAndAll,
+        (void *) &tcp_status_),
+    CIP_SHARED_ATTRIBUTE(2, kCipDword, kGetableSingleAndAll,
+        (void *) &configuration_capability_),
+    CIP_SHARED_ATTRIBUTE(3, kCipDword, kGetableSingleAndAll,
+        (void *) &configuration_control_),
+    CIP_SHARED_ATTRIBUTE(4, kCipEpath, kGetableSingleAndAll,
+        &physical_link_object_),
+    CIP_STACK_ATTRIBUTE(5, kCipUdintUdintUdintUdintUdintString,
+        kGetableSingleAndAll, interface_configuration),
+    CIP_STACK_ATTRIBUTE(6, kCipString, kGetableSingleAndAll, hostname),
+    CIP_STACK_ATTRIBUTE(8, kCipUsint, kGetableSingleAndAll,
+        time_to_live_value),
+    CIP_STACK_ATTRIBUTE(9, kCipAny, kGetableSingleAndAll,
+        multicast_configuration) };
+
+/** @brief Services of the TCP/IP interface object instance */
+static const CipServiceStruct kTcpIpInstanceServices[] = {
+    { kGetAttributeAll, &GetAttributeAllTcpIpInterface,
+        "GetAttributeAllTCPIPInterface" },
+    { kGetAttributeSingle, &GetAttributeSingleTcpIpInterface,
+        "GetAttributeSingleTCPIPInterface" },
+    { kSetAttributeSingle, &SetAttributeSingleTcp, "SetAttributeSingle" } };
+
+/** @brief Definition of the TCP/IP interface object */
+static const CipClassDefinition kTcpIpClassDefinition = {
+    kCipTcpIpInterfaceClassCode, /* class ID */
+    "TCP/IP interface", /* class name */
+    3, /* class revision */
+    0xffffffff, /* class getAttributeAll mask*/
+    kTcpIpInstanceAttributes, CIP_TABLE_ENTRIES(kTcpIpInstanceAttributes),
+    9, /* highest instance attribute number */
+    0xffffffff, /* instance getAttributeAll mask*/
+    kTcpIpInstanceServices, CIP_TABLE_ENTRIES(kTcpIpInstanceServices) };
+
 EipStatus CipTcpIpInterfaceInit() {
-  CipClass *tcp_ip_class = NULL;
-
-  if ((tcp_ip_class = CreateCipClass(kCipTcpIpInterfaceClassCode, 0, /* # class attributes*/
-                                     0xffffffff, /* class getAttributeAll mask*/
-                                     0, /* # class services*/
-                                     8, /* # instance attributes*/
-                                     0xffffffff, /* instance getAttributeAll mask*/
-                                     1, /* # instance services*/
-                                     1, /* # instances*/
-                                     "TCP/IP interface", 3)) == 0) {
+  if (0 == CreateCipClassFromDefinition(&kTcpIpClassDefinition)) {
     return kEipStatusError;
   }
-  CipInstance *instance = GetCipInstance(tcp_ip_class, 1); /* bind attributes to the instance #1 that was created above*/
-
-  InsertAttribute(instance, 1, kCipDword, (void *) &tcp_status_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 2, kCipDword, (void *) &configuration_capability_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 3, kCipDword, (void *) &configuration_control_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 4, kCipEpath, &physical_link_object_,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 5, kCipUdintUdintUdintUdintUdintString,
-                  &interface_configuration_, kGetableSingleAndAll);
-  InsertAttribute(instance, 6, kCipString, (void *) &hostname_,
-                  kGetableSingleAndAll);
-
-  InsertAttribute(instance, 8, kCipUsint, (void *) &g_time_to_live_value,
-                  kGetableSingleAndAll);
-  InsertAttribute(instance, 9, kCipAny, (void *) &g_multicast_configuration,
-                  kGetableSingleAndAll);
-
-  InsertService(tcp_ip_class, kGetAttributeSingle,
-                &GetAttributeSingleTcpIpInterface,
-                "GetAttributeSingleTCPIPInterface");
-
-  InsertService(tcp_ip_class, kGetAttributeAll, &GetAttributeAllTcpIpInterface,
-                "GetAttributeAllTCPIPInterface");
-
-  InsertService(tcp_ip_class, kSetAttributeSingle, &SetAttributeSingleTcp,
-                "SetAttributeSingle");
 
   return kEipStatusOk;
 }
 
 void ShutdownTcpIpInterface(void) {
   /*Only free the resources if they are initialized */
-  if (NULL != hostname_.string) {
-    CipFree(hostname_.string);
-    hostname_.string = NULL;
+  if (NULL != g_opener_stack->hostname.string) {
+    CipFree(g_opener_stack->hostname.string);
+    g_opener_stack->hostname.string = NULL;
   }
 
-  if (NULL != interface_configuration_.domain_name.string) {
-    CipFree(interface_configuration_.domain_name.string);
-    interface_configuration_.domain_name.string = NULL;
+  if (NULL != g_opener_stack->interface_configuration.domain_name.string) {
+    CipFree(g_opener_stack->interface_configuration.domain_name.string);
+    g_opener_stack->interface_configuration.domain_name.string = NULL;
   }
 }
 
@@ -204,31 +176,34 @@ EipStatus GetAttributeSingleTcpIpInterface(
     CipMessageRouterResponse *message_router_response) {
 
   EipStatus status = kEipStatusOkSend;
-  EipByte *message = message_router_response->data;
 
   if (9 == message_router_request->request_path.attribute_number) { /* attribute 9 can not be easily handled with the default mechanism therefore we will do it by hand */
+    CipResponseWriter writer;
+
     message_router_response->data_length = 0;
     message_router_response->reply_service = (0x80
         | message_router_request->service);
     message_router_response->general_status = kCipErrorSuccess;
     message_router_response->size_of_additional_status = 0;
 
-    message_router_response->data_length += EncodeData(
-        kCipUsint, &(g_multicast_configuration.alloc_control), &message);
-    message_router_response->data_length += EncodeData(
-        kCipUsint, &(g_multicast_configuration.reserved_shall_be_zero),
-        &message);
-    message_router_response->data_length += EncodeData(
-        kCipUint,
-        &(g_multicast_configuration.number_of_allocated_multicast_addresses),
-        &message);
-
     EipUint32 multicast_address = ntohl(
-        g_multicast_configuration.starting_multicast_address);
-
-    message_router_response->data_length += EncodeData(kCipUdint,
-                                                       &multicast_address,
-                                                       &message);
+        g_opener_stack->multicast_configuration.starting_multicast_address);
+
+    InitializeResponseWriter(&writer, message_router_response);
+    WriteResponseData(&writer, kCipUsint,
+                      &(g_opener_stack->multicast_configuration.alloc_control));
+    WriteResponseData(&writer, kCipUsint,
+                      &(g_opener_stack->multicast_configuration.reserved_shall_be_zero));
+    WriteResponseData(
+        &writer, kCipUint,
+        &(g_opener_stack->multicast_configuration.number_of_allocated_multicast_addresses));
+    WriteResponseData(&writer, kCipUdint, &multicast_address);
+
+    if (writer.overflow) {
+      message_router_response->general_status = kCipErrorReplyDataTooLarge;
+    } else {
+      message_router_response->data_length = GetResponseWriterLength(&writer);
+    }
   } else {
     status = GetAttributeSingle(instance, message_router_request,
                                 message_router_response);
@@ -252,8 +227,18 @@ EipStatus GetAttributeAllTcpIpInterface(
       message_router_request->request_path.attribute_number = attribute_number;
 
       if (8 == attribute_number) { /* insert 6 zeros for the required empty safety network number according to Table 5-3.10 */
-        memset(message_router_response->data, 0, 6);
-        message_router_response->data += 6;
+        static const EipUint8 kEmptySafetyNetworkNumber[6] = { 0 };
+        CipResponseWriter writer;
+
+        InitializeResponseWriter(&writer, message_router_response);
+        if (0 > WriteResponseDataArray(&writer, kCipUsint,
+                                       kEmptySafetyNetworkNumber, 6)) {
+          message_router_response->general_status = kCipErrorReplyDataTooLarge;
+          message_router_response->data_length = 0;
+          message_router_response->data = response;
+          return kEipStatusOkSend;
+        }
+        message_router_response->data += GetResponseWriterLength(&writer);
       }
 
       if (kEipStatusOkSend
@@ -262,6 +247,12 @@ EipStatus GetAttributeAllTcpIpInterface(
         message_router_response->data = response;
         return kEipStatusError;
       }
+      if (kCipErrorReplyDataTooLarge
+          == message_router_response->general_status) {
+        message_router_response->data_length = 0;
+        message_router_response->data = response;
+        return kEipStatusOkSend;
+      }
       message_router_response->data += message_router_response->data_length;
     }
     attribute++;
@@ -14,8 +14,6 @@
 #include "typedefs.h"
 #include "ciptypes.h"
 
-extern CipTcpIpNetworkInterfaceConfiguration interface_configuration_;
-
 static const EipUint16 kCipTcpIpInterfaceClassCode = 0xF5; /**< TCP/IP Interface Object class code */
 
 /** @brief Multicast Configuration struct, called Mcast config
@@ -28,11 +26,6 @@ typedef struct multicast_address_configuration {
   CipUdint starting_multicast_address; /**< Starting multicast address from which Num Mcast addresses are allocated */
 } MulticastAddressConfiguration;
 
-/* global public variables */
-extern CipUsint g_time_to_live_value; /**< Time-to-live value for IP multicast packets. Default is 1; Minimum is 1; Maximum is 255 */
-
-extern MulticastAddressConfiguration g_multicast_configuration; /**< Multicast configuration */
-
 /* public functions */
 /** @brief Initializing the data structures of the TCP/IP interface object
  */
@@ -102,6 +102,8 @@ typedef enum cip_data_types {
   kCip6Usint = 0xA2, /**< Struct for MAC Address (six USINTs)*/
   kCipMemberList = 0xA3, /**< */
   kCipByteArray = 0xA4, /**< */
+  kCip11Udint = 0xA5, /**< Struct of eleven UDINTs, Ethernet Link attribute 4 interface counters */
+  kCip12Udint = 0xA6, /**< Struct of twelve UDINTs, Ethernet Link attribute 5 media counters */
   kInternalUint6 = 0xF0 /**< bogus hack, for port class attribute 9, TODO
    figure out the right way to handle it */
 } CipDataType;
@@ -269,8 +271,23 @@ typedef struct {
   EipInt16 data_length; /**< Supportative non-CIP variable, gives length of data segment */
   CipOctet *data; /**< Array of octet; Response data per object definition from
    request */
+  CipOctet *data_end; /**< Supportative non-CIP variable, first octet behind the
+   reply buffer data points into */
 } CipMessageRouterResponse;
 
+/** @brief Cursor for writing response data into a reply buffer of limited size
+ *
+ * Writes which would not fit into the buffer leave the buffer untouched and
+ * mark the writer as overflown, so several values can be written before the
+ * result is checked once.
+ */
+typedef struct cip_response_writer {
+  CipOctet *start; /**< response data written with this writer */
+  CipOctet *current_position; /**< where the next value will be written */
+  CipOctet *end; /**< first octet behind the reply buffer */
+  EipBool8 overflow; /**< true if a write did not fit into the buffer */
+} CipResponseWriter;
+
 typedef struct {
   EipUint16 attribute_number;
   EipUint8 type;
@@ -309,8 +326,12 @@ typedef struct cip_class {
    returned by getAttributeAll*/
   EipUint16 number_of_services; /**< number of services supported*/
   CipInstance *instances; /**< pointer to the list of instances*/
-  struct cip_service_struct *services; /**< pointer to the array of services*/
+  const struct cip_service_struct *services; /**< pointer to the array of
+   services, constant if taken from a class definition */
   char *class_name; /**< class name */
+  const struct cip_class_definition *definition; /**< constant definition the
+   class has been created from, NULL if
+   the class has been built at runtime */
 } CipClass;
 
 /** @ingroup CIP_API
@@ -339,6 +360,57 @@ typedef struct cip_service_struct {
   char *name; /**< name of the service */
 } CipServiceStruct;
 
+/** @brief Attribute of a CipClassDefinition
+ *
+ * The data is either shared by all stacks or a member of OpenerStack, given
+ * by its offset, see CIP_SHARED_ATTRIBUTE and CIP_STACK_ATTRIBUTE.
+ */
+typedef struct {
+  EipUint16 attribute_number;
+  EipUint8 type;
+  CIPAttributeFlag attribute_flags;
+  void *data; /**< data shared by all stacks, NULL for data of the stack */
+  size_t stack_data_offset; /**< offset of the data in OpenerStack if data is
+   NULL */
+} CipAttributeDefinition;
+
+/** @brief Attribute definition whose data is shared by all stacks */
+#define CIP_SHARED_ATTRIBUTE(number, type, flags, data) \
+  { number, type, flags, data, 0 }
+
+/** @brief Attribute definition whose data is the given member of each
+ * OpenerStack, the user has to include opener_stack.h */
+#define CIP_STACK_ATTRIBUTE(number, type, flags, member) \
+  { number, type, flags, NULL, offsetof(OpenerStack, member) }
+
+/** @brief Constant definition of a CIP class with one instance
+ *
+ * The definition is not modified and may therefore be placed in read-only
+ * memory. CreateCipClassFromDefinition() uses the service table directly and
+ * builds the attribute table of the instance from the attribute definitions,
+ * pointing to the data of the active stack. The standard GetAttributeSingle
+ * and GetAttributeAll services have to be part of the service table if they
+ * shall be supported.
+ */
+typedef struct cip_class_definition {
+  EipUint32 class_id; /**< class ID */
+  char *class_name; /**< class name */
+  EipUint16 revision; /**< class revision */
+  EipUint32 class_get_attribute_all_mask; /**< mask of the class attributes
+   returned by getAttributeAll */
+  const CipAttributeDefinition *instance_attributes; /**< attributes of instance 1 */
+  EipUint16 number_of_instance_attributes; /**< number of entries of instance_attributes */
+  EipUint16 highest_instance_attribute_number; /**< highest attribute number
+   in instance_attributes */
+  EipUint32 instance_get_attribute_all_mask; /**< mask of the instance
+   attributes returned by getAttributeAll */
+  const CipServiceStruct *instance_services; /**< services of the instance */
+  EipUint16 number_of_instance_services; /**< number of entries of instance_services */
+} CipClassDefinition;
+
+/** @brief Number of entries of a constant table, for CipClassDefinition */
+#define CIP_TABLE_ENTRIES(table) (sizeof(table) / sizeof((table)[0]))
+
 /**
  * @brief Struct for saving TCP/IP interface information
  */
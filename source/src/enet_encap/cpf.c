@@ -14,31 +14,41 @@
 #include "ciperror.h"
 #include "cipconnectionmanager.h"
 #include "trace.h"
+#include "opener_stack.h"
 
-CipCommonPacketFormatData g_common_packet_format_data_item; /**< CPF global data items */
+/**
+ * @brief Returns the length an address item of the given type has to have
+ *
+ * @param type_id Item ID of the address item
+ * @return the expected length, -1 if type_id is no address item
+ */
+int GetExpectedAddressItemLength(CipUint type_id);
 
 int NotifyCommonPacketFormat(EncapsulationData *receive_data,
                              EipUint8 *reply_buffer) {
   int return_value = kEipStatusError;
+  CipCommonPacketFormatData common_packet_format_data;
 
   if ((return_value = CreateCommonPacketFormatStructure(
       receive_data->current_communication_buffer_position,
-      receive_data->data_length, &g_common_packet_format_data_item))
+      receive_data->data_length, &common_packet_format_data))
       == kEipStatusError) {
     OPENER_TRACE_ERR("notifyCPF: error from createCPFstructure\n");
   } else {
     return_value = kEipStatusOk; /* In cases of errors we normally need to send an error response */
-    if (g_common_packet_format_data_item.address_item.type_id
+    if (common_packet_format_data.address_item.type_id
         == kCipItemIdNullAddress) /* check if NullAddressItem received, otherwise it is no unconnected message and should not be here*/
         { /* found null address item*/
-      if (g_common_packet_format_data_item.data_item.type_id
+      if (common_packet_format_data.data_item.type_id
           == kCipItemIdUnconnectedDataItem) { /* unconnected data item received*/
-        return_value = NotifyMR(
-            g_common_packet_format_data_item.data_item.data,
-            g_common_packet_format_data_item.data_item.length);
+        g_opener_stack->common_packet_format_data = &common_packet_format_data;
+        return_value = NotifyMR(common_packet_format_data.data_item.data,
+                                common_packet_format_data.data_item.length);
+        g_opener_stack->common_packet_format_data = NULL;
         if (return_value != kEipStatusError) {
           return_value = AssembleLinearMessage(
-              &g_message_router_response, &g_common_packet_format_data_item,
+              &g_opener_stack->message_router_response,
+              &common_packet_format_data,
               reply_buffer);
         }
       } else {
@@ -58,20 +68,21 @@ int NotifyCommonPacketFormat(EncapsulationData *receive_data,
 
 int NotifyConnectedCommonPacketFormat(EncapsulationData *received_data,
                                       EipUint8 *reply_buffer) {
+  CipCommonPacketFormatData common_packet_format_data;
 
   int return_value = CreateCommonPacketFormatStructure(
       received_data->current_communication_buffer_position,
-      received_data->data_length, &g_common_packet_format_data_item);
+      received_data->data_length, &common_packet_format_data);
 
   if (kEipStatusError == return_value) {
     OPENER_TRACE_ERR("notifyConnectedCPF: error from createCPFstructure\n");
   } else {
     return_value = kEipStatusError; /* For connected explicit messages status always has to be 0*/
-    if (g_common_packet_format_data_item.address_item.type_id
+    if (common_packet_format_data.address_item.type_id
         == kCipItemIdConnectionAddress) /* check if ConnectedAddressItem received, otherwise it is no connected message and should not be here*/
         { /* ConnectedAddressItem item */
       ConnectionObject *connection_object = GetConnectedObject(
-          g_common_packet_format_data_item.address_item.data
+          common_packet_format_data.address_item.data
               .connection_identifier);
       if (NULL != connection_object) {
         /* reset the watchdog timer */
@@ -80,20 +91,23 @@ int NotifyConnectedCommonPacketFormat(EncapsulationData *received_data,
             << (2 + connection_object->connection_timeout_multiplier);
 
         /*TODO check connection id  and sequence count    */
-        if (g_common_packet_format_data_item.data_item.type_id
+        if (common_packet_format_data.data_item.type_id
             == kCipItemIdConnectedDataItem) { /* connected data item received*/
-          EipUint8 *pnBuf = g_common_packet_format_data_item.data_item.data;
-          g_common_packet_format_data_item.address_item.data.sequence_number =
+          EipUint8 *pnBuf = common_packet_format_data.data_item.data;
+          common_packet_format_data.address_item.data.sequence_number =
               (EipUint32) GetIntFromMessage(&pnBuf);
+          g_opener_stack->common_packet_format_data = &common_packet_format_data;
           return_value = NotifyMR(
-              pnBuf, g_common_packet_format_data_item.data_item.length - 2);
+              pnBuf, common_packet_format_data.data_item.length - 2);
+          g_opener_stack->common_packet_format_data = NULL;
 
           if (return_value != kEipStatusError) {
-            g_common_packet_format_data_item.address_item.data
+            common_packet_format_data.address_item.data
                 .connection_identifier = connection_object
                 ->produced_connection_id;
             return_value = AssembleLinearMessage(
-                &g_message_router_response, &g_common_packet_format_data_item,
+                &g_opener_stack->message_router_response,
+                &common_packet_format_data,
                 reply_buffer);
           }
         } else {
@@ -113,8 +127,28 @@ int NotifyConnectedCommonPacketFormat(EncapsulationData *received_data,
   return return_value;
 }
 
+int GetExpectedAddressItemLength(CipUint type_id) {
+  switch (type_id) {
+    case kCipItemIdNullAddress:
+      return 0;
+    case kCipItemIdConnectionAddress:
+      return 4;
+    case kCipItemIdSequencedAddressItem:
+      return 8;
+    default:
+      return -1;
+  }
+}
+
 /**
  * @brief Creates Common Packet Format structure out of data.
+ *
+ * The items are decoded in a single pass in any order. Every item is checked
+ * against the remaining data before it is read. Exactly one address item and
+ * one data item have to be present, up to two sockaddr info items are
+ * accepted and any other item is skipped. The function only works on the
+ * given structure and can therefore be used with a structure on the stack.
+ *
  * @param data Pointer to data which need to be structured.
  * @param data_length	Length of data in pa_Data.
  * @param common_packet_format_data	Pointer to structure of CPF data item.
@@ -125,81 +159,109 @@ int NotifyConnectedCommonPacketFormat(EncapsulationData *received_data,
 EipStatus CreateCommonPacketFormatStructure(
     EipUint8 *data, int data_length,
     CipCommonPacketFormatData *common_packet_format_data) {
+  const EipUint8 *const end_of_data = data + data_length;
+  EipBool8 address_item_received = false;
+  EipBool8 data_item_received = false;
+  int number_of_address_info_items = 0;
 
   common_packet_format_data->address_info_item[0].type_id = 0;
   common_packet_format_data->address_info_item[1].type_id = 0;
 
-  int length_count = 0;
+  if (data_length < 2) {
+    OPENER_TRACE_WARN("createCPFstructure: no item count received\n");
+    return kEipStatusError;
+  }
   common_packet_format_data->item_count = GetIntFromMessage(&data);
-  length_count += 2;
-  if (common_packet_format_data->item_count >= 1) {
-    common_packet_format_data->address_item.type_id = GetIntFromMessage(&data);
-    common_packet_format_data->address_item.length = GetIntFromMessage(&data);
-    length_count += 4;
-    if (common_packet_format_data->address_item.length >= 4) {
-      common_packet_format_data->address_item.data.connection_identifier =
-          GetDintFromMessage(&data);
-      length_count += 4;
+
+  for (int i = 0; i < common_packet_format_data->item_count; i++) {
+    if (end_of_data - data < 4) {
+      OPENER_TRACE_WARN("createCPFstructure: item %d header truncated\n", i);
+      return kEipStatusError;
     }
-    if (common_packet_format_data->address_item.length == 8) {
-      common_packet_format_data->address_item.data.sequence_number =
-          GetDintFromMessage(&data);
-      length_count += 4;
+    CipUint type_id = GetIntFromMessage(&data);
+    CipUint length = GetIntFromMessage(&data);
+    if (end_of_data - data < length) {
+      OPENER_TRACE_WARN(
+          "createCPFstructure: item 0x%x exceeds the received data\n",
+          type_id);
+      return kEipStatusError;
     }
-  }
-  if (common_packet_format_data->item_count >= 2) {
-    common_packet_format_data->data_item.type_id = GetIntFromMessage(&data);
-    common_packet_format_data->data_item.length = GetIntFromMessage(&data);
-    common_packet_format_data->data_item.data = data;
-    data += common_packet_format_data->data_item.length;
-    length_count += (4 + common_packet_format_data->data_item.length);
-  }
-  for (int j = 0; j < (common_packet_format_data->item_count - 2); j++) /* TODO there needs to be a limit check here???*/
-  {
-    common_packet_format_data->address_info_item[j].type_id = GetIntFromMessage(
-        &data);
-    length_count += 2;
-    if ((common_packet_format_data->address_info_item[j].type_id
-        == kCipItemIdSocketAddressInfoOriginatorToTarget)
-        || (common_packet_format_data->address_info_item[j].type_id
-            == kCipItemIdSocketAddressInfoTargetToOriginator)) {
-      common_packet_format_data->address_info_item[j].length =
-          GetIntFromMessage(&data);
-      common_packet_format_data->address_info_item[j].sin_family =
-          GetIntFromMessage(&data);
-      common_packet_format_data->address_info_item[j].sin_port =
-          GetIntFromMessage(&data);
-      common_packet_format_data->address_info_item[j].sin_addr =
-          GetDintFromMessage(&data);
-      for (int i = 0; i < 8; i++) {
-        common_packet_format_data->address_info_item[j].nasin_zero[i] = *data;
-        data++;
+
+    switch (type_id) {
+      case kCipItemIdNullAddress:
+      case kCipItemIdConnectionAddress:
+      case kCipItemIdSequencedAddressItem:
+        if ((true == address_item_received)
+            || (GetExpectedAddressItemLength(type_id) != length)) {
+          OPENER_TRACE_WARN(
+              "createCPFstructure: invalid address item 0x%x\n", type_id);
+          return kEipStatusError;
+        }
+        address_item_received = true;
+        common_packet_format_data->address_item.type_id = type_id;
+        common_packet_format_data->address_item.length = length;
+        if (length >= 4) {
+          common_packet_format_data->address_item.data.connection_identifier =
+              GetDintFromMessage(&data);
+        }
+        if (length == 8) {
+          common_packet_format_data->address_item.data.sequence_number =
+              GetDintFromMessage(&data);
+        }
+        break;
+
+      case kCipItemIdConnectedDataItem:
+      case kCipItemIdUnconnectedDataItem:
+        if (true == data_item_received) {
+          OPENER_TRACE_WARN("createCPFstructure: more than one data item\n");
+          return kEipStatusError;
+        }
+        data_item_received = true;
+        common_packet_format_data->data_item.type_id = type_id;
+        common_packet_format_data->data_item.length = length;
+        common_packet_format_data->data_item.data = data;
+        data += length;
+        break;
+
+      case kCipItemIdSocketAddressInfoOriginatorToTarget:
+      case kCipItemIdSocketAddressInfoTargetToOriginator: {
+        if ((number_of_address_info_items >= 2) || (16 != length)) {
+          OPENER_TRACE_WARN(
+              "createCPFstructure: invalid sockaddr info item 0x%x\n",
+              type_id);
+          return kEipStatusError;
+        }
+        SocketAddressInfoItem *address_info_item = &common_packet_format_data
+            ->address_info_item[number_of_address_info_items++];
+        address_info_item->type_id = type_id;
+        address_info_item->length = length;
+        address_info_item->sin_family = GetIntFromMessage(&data);
+        address_info_item->sin_port = GetIntFromMessage(&data);
+        address_info_item->sin_addr = GetDintFromMessage(&data);
+        memcpy(address_info_item->nasin_zero, data, 8);
+        data += 8;
+        break;
       }
-      length_count += 18;
-    } else { /* no sockaddr item found */
-      common_packet_format_data->address_info_item[j].type_id = 0; /* mark as not set */
-      data -= 2;
+
+      default:
+        OPENER_TRACE_WARN("createCPFstructure: skipping unknown item 0x%x\n",
+                          type_id);
+        data += length;
+        break;
     }
   }
-  /* set the addressInfoItems to not set if they were not received */
-  if (common_packet_format_data->item_count < 4) {
-    common_packet_format_data->address_info_item[1].type_id = 0;
-    if (common_packet_format_data->item_count < 3) {
-      common_packet_format_data->address_info_item[0].type_id = 0;
-    }
+
+  if ((false == address_item_received) || (false == data_item_received)) {
+    OPENER_TRACE_WARN("createCPFstructure: address or data item missing\n");
+    return kEipStatusError;
   }
-  if (length_count == data_length) { /* length of data is equal to length of Addr and length of Data */
-    return kEipStatusOk;
-  } else {
+  if (data != end_of_data) {
     OPENER_TRACE_WARN(
-        "something is wrong with the length in Message Router @ CreateCommonPacketFormatStructure\n");
-    if (common_packet_format_data->item_count > 2) {
-      /* there is an optional packet in data stream which is not sockaddr item */
-      return kEipStatusOk;
-    } else { /* something with the length was wrong */
-      return kEipStatusError;
-    }
+        "createCPFstructure: %d bytes after the last item\n",
+        (int) (end_of_data - data));
+    return kEipStatusError;
   }
+  return kEipStatusOk;
 }
 
 /* null address item -> address length set to 0 */
@@ -317,10 +379,9 @@ int EncodeDataItemLength(
 int EncodeDataItemData(
     CipCommonPacketFormatData* common_packet_format_data_item,
     EipUint8** message, int size) {
-  for (int i = 0; i < common_packet_format_data_item->data_item.length; i++) {
-    size += AddSintToMessage(
-        *(common_packet_format_data_item->data_item.data + i), message);
-  }
+  size += AddSintArrayToMessage(common_packet_format_data_item->data_item.data,
+                                common_packet_format_data_item->data_item.length,
+                                message);
   return size;
 }
 
@@ -404,9 +465,8 @@ int EncodeUnconnectedDataItemLength(
 int EncodeMessageRouterResponseData(
     int size, CipMessageRouterResponse* message_router_response,
     EipUint8** message) {
-  for (int i = 0; i < message_router_response->data_length; i++) {
-    size += AddSintToMessage((message_router_response->data)[i], &*message);
-  }
+  size += AddSintArrayToMessage(message_router_response->data,
+                                message_router_response->data_length, message);
   return size;
 }
 
@@ -491,7 +551,7 @@ int AssembleLinearMessage(
         message_size = EncodeConnectedDataItemLength(message_router_response,
                                                      &message, message_size);
         message_size = EncodeSequenceNumber(message_size,
-                                            &g_common_packet_format_data_item,
+                                            common_packet_format_data_item,
                                             &message);
 
       } else { /* Unconnected Item */
@@ -558,6 +618,6 @@ int AssembleLinearMessage(
 int AssembleIOMessage(CipCommonPacketFormatData *common_packet_format_data_item,
                       EipUint8 *message) {
   return AssembleLinearMessage(0, common_packet_format_data_item,
-                               &g_message_data_reply_buffer[0]);
+                               &g_opener_stack->message_data_reply_buffer[0]);
 }
 
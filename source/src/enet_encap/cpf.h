@@ -93,6 +93,9 @@ int NotifyConnectedCommonPacketFormat(EncapsulationData *received_data,
 
 /** @ingroup ENCAP
  *  Create CPF structure out of the received data.
+ *
+ *  The data is checked against data_length while it is parsed, malformed
+ *  packets are rejected. The function only writes to the given structure.
  *  @param  data		pointer to data which need to be structured.
  *  @param  data_length	length of data in pa_Data.
  *  @param  common_packet_format_data	pointer to structure of CPF data item.
@@ -130,11 +133,4 @@ int AssembleLinearMessage(
     CipCommonPacketFormatData *common_packet_format_data_item,
     EipUint8 *message);
 
-/** @ingroup ENCAP
- * @brief Data storage for the any CPF data
- * Currently we are single threaded and need only one CPF at the time.
- * For future extensions towards multithreading maybe more CPF data items may be necessary
- */
-extern CipCommonPacketFormatData g_common_packet_format_data_item;
-
 #endif /* OPENER_CPF_H_ */
@@ -15,19 +15,16 @@
 #include "cipconnectionmanager.h"
 #include "cipidentity.h"
 #include "generic_networkhandler.h"
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /*Identity data from cipidentity.c*/
 extern EipUint16 vendor_id_;
 extern EipUint16 device_type_;
 extern EipUint16 product_code_;
 extern CipRevision revision_;
-extern EipUint16 status_;
-extern EipUint32 serial_number_;
 extern CipShortString product_name_;
 
-/*ip address data taken from TCPIPInterfaceObject*/
-extern CipTcpIpNetworkInterfaceConfiguration interface_configuration_;
-
 const int kSupportedProtocolVersion = 1; /**< Supported Encapsulation protocol version */
 
 const int kEncapsulationHeaderOptionsFlag = 0x00; /**< Mask of which options are supported as of the current CIP specs no other option value as 0 should be supported.*/
@@ -62,27 +59,6 @@ typedef enum {
   kCapabilityFlagsCipUdpClass0or1 = 0x0100
 } CapabilityFlags;
 
-#define ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES 2 /**< According to EIP spec at least 2 delayed message requests should be supported */
-
-#define ENCAP_MAX_DELAYED_ENCAP_MESSAGE_SIZE (ENCAPSULATION_HEADER_LENGTH + 39 + sizeof(OPENER_DEVICE_NAME)) /* currently we only have the size of an encapsulation message */
-
-/* Encapsulation layer data  */
-
-/** @brief Delayed Encapsulation Message structure */
-typedef struct {
-  EipInt32 time_out; /**< time out in milli seconds */
-  int socket; /**< associated socket */
-  struct sockaddr_in receiver;
-  EipByte message[ENCAP_MAX_DELAYED_ENCAP_MESSAGE_SIZE];
-  unsigned int message_size;
-} DelayedEncapsulationMessage;
-
-EncapsulationInterfaceInformation g_interface_information;
-
-int g_registered_sessions[OPENER_NUMBER_OF_SUPPORTED_SESSIONS];
-
-DelayedEncapsulationMessage g_delayed_encapsulation_messages[ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES];
-
 /*** private functions ***/
 void HandleReceivedListServicesCommand(EncapsulationData *receive_data);
 
@@ -107,10 +83,6 @@ EipStatus HandleReceivedSendRequestResponseDataCommand(
 
 int GetFreeSessionIndex(void);
 
-EipInt16 CreateEncapsulationStructure(EipUint8 *receive_buffer,
-                                      int receive_buffer_length,
-                                      EncapsulationData *encapsulation_data);
-
 SessionStatus CheckRegisteredSessions(EncapsulationData *receive_data);
 
 int EncapsulateData(const EncapsulationData *const send_data);
@@ -123,29 +95,27 @@ int EncapsulateListIdentyResponseMessage(EipByte *const communication_buffer);
 /*   @brief Initializes session list and interface information. */
 void EncapsulationInit(void) {
 
-  DetermineEndianess();
-
   /*initialize random numbers for random delayed response message generation
    * we use the ip address as seed as suggested in the spec */
-  srand(interface_configuration_.ip_address);
+  srand(g_opener_stack->interface_configuration.ip_address);
 
   /* initialize Sessions to invalid == free session */
   for (unsigned int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
-    g_registered_sessions[i] = kEipInvalidSocket;
+    g_opener_stack->registered_sessions[i] = kEipInvalidSocket;
   }
 
   for (unsigned int i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
-    g_delayed_encapsulation_messages[i].socket = -1;
+    g_opener_stack->delayed_encapsulation_messages[i].socket = -1;
   }
 
   /*TODO make the interface information configurable*/
   /* initialize interface information */
-  g_interface_information.type_code = kCipItemIdListServiceResponse;
-  g_interface_information.length = sizeof(g_interface_information);
-  g_interface_information.encapsulation_protocol_version = 1;
-  g_interface_information.capability_flags = kCapabilityFlagsCipTcp
+  g_opener_stack->interface_information.type_code = kCipItemIdListServiceResponse;
+  g_opener_stack->interface_information.length = sizeof(g_opener_stack->interface_information);
+  g_opener_stack->interface_information.encapsulation_protocol_version = 1;
+  g_opener_stack->interface_information.capability_flags = kCapabilityFlagsCipTcp
       | kCapabilityFlagsCipUdpClass0or1;
-  strcpy((char *) g_interface_information.name_of_service, "Communications");
+  strcpy((char *) g_opener_stack->interface_information.name_of_service, "Communications");
 }
 
 int HandleReceivedExplictTcpData(int socket, EipUint8 *buffer,
@@ -207,6 +177,9 @@ int HandleReceivedExplictTcpData(int socket, EipUint8 *buffer,
           encapsulation_data.data_length = 0;
           break;
       }
+      if (kEncapsulationProtocolSuccess != encapsulation_data.status) {
+        g_opener_stack->opener_statistics.encapsulation_errors++;
+      }
       /* if nRetVal is greater than 0 data has to be sent */
       if (kEipStatusOk < return_value) {
         return_value = EncapsulateData(&encapsulation_data);
@@ -295,19 +268,19 @@ void HandleReceivedListServicesCommand(EncapsulationData *receive_data) {
   EipUint8 *communication_buffer = receive_data
       ->current_communication_buffer_position;
 
-  receive_data->data_length = g_interface_information.length + 2;
+  receive_data->data_length = g_opener_stack->interface_information.length + 2;
 
   /* copy Interface data to msg for sending */
   AddIntToMessage(1, &communication_buffer);
-  AddIntToMessage(g_interface_information.type_code, &communication_buffer);
-  AddIntToMessage((EipUint16) (g_interface_information.length - 4),
+  AddIntToMessage(g_opener_stack->interface_information.type_code, &communication_buffer);
+  AddIntToMessage((EipUint16) (g_opener_stack->interface_information.length - 4),
                   &communication_buffer);
-  AddIntToMessage(g_interface_information.encapsulation_protocol_version,
+  AddIntToMessage(g_opener_stack->interface_information.encapsulation_protocol_version,
                   &communication_buffer);
-  AddIntToMessage(g_interface_information.capability_flags,
+  AddIntToMessage(g_opener_stack->interface_information.capability_flags,
                   &communication_buffer);
-  memcpy(communication_buffer, g_interface_information.name_of_service,
-         sizeof(g_interface_information.name_of_service));
+  memcpy(communication_buffer, g_opener_stack->interface_information.name_of_service,
+         sizeof(g_opener_stack->interface_information.name_of_service));
 }
 
 void HandleReceivedListInterfacesCommand(EncapsulationData *receive_data) {
@@ -328,8 +301,8 @@ void HandleReceivedListIdentityCommandUdp(int socket,
   DelayedEncapsulationMessage *delayed_message_buffer = NULL;
 
   for (unsigned int i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
-    if (kEipInvalidSocket == g_delayed_encapsulation_messages[i].socket) {
-      delayed_message_buffer = &(g_delayed_encapsulation_messages[i]);
+    if (kEipInvalidSocket == g_opener_stack->delayed_encapsulation_messages[i].socket) {
+      delayed_message_buffer = &(g_opener_stack->delayed_encapsulation_messages[i]);
       break;
     }
   }
@@ -368,7 +341,7 @@ int EncapsulateListIdentyResponseMessage(EipByte *const communication_buffer) {
   AddIntToMessage(kSupportedProtocolVersion, &communication_buffer_runner);
 
   EncapsulateIpAddress(htons(kOpenerEthernetPort),
-                       interface_configuration_.ip_address,
+                       g_opener_stack->interface_configuration.ip_address,
                        &communication_buffer_runner);
 
   memset(communication_buffer_runner, 0, 8);
@@ -379,8 +352,8 @@ int EncapsulateListIdentyResponseMessage(EipByte *const communication_buffer) {
   AddIntToMessage(product_code_, &communication_buffer_runner);
   *(communication_buffer_runner)++ = revision_.major_revision;
   *(communication_buffer_runner)++ = revision_.minor_revision;
-  AddIntToMessage(status_, &communication_buffer_runner);
-  AddDintToMessage(serial_number_, &communication_buffer_runner);
+  AddIntToMessage(g_opener_stack->device_status, &communication_buffer_runner);
+  AddDintToMessage(g_opener_stack->serial_number, &communication_buffer_runner);
   *communication_buffer_runner++ = (unsigned char) product_name_.length;
   memcpy(communication_buffer_runner, product_name_.string,
          product_name_.length);
@@ -425,7 +398,7 @@ void HandleReceivedRegisterSessionCommand(int socket,
       && (0 == nOptionFlag)) { /*Option field should be zero*/
     /* check if the socket has already a session open */
     for (int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-      if (g_registered_sessions[i] == socket) {
+      if (g_opener_stack->registered_sessions[i] == socket) {
         /* the socket has already registered a session this is not allowed*/
         receive_data->session_handle = i + 1; /*return the already assigned session back, the cip spec is not clear about this needs to be tested*/
         receive_data->status = kEncapsulationProtocolInvalidCommand;
@@ -443,7 +416,8 @@ void HandleReceivedRegisterSessionCommand(int socket,
       {
         receive_data->status = kEncapsulationProtocolInsufficientMemory;
       } else { /* successful session registered */
-        g_registered_sessions[session_index] = socket; /* store associated socket */
+        g_opener_stack->registered_sessions[session_index] = socket; /* store associated socket */
+        g_opener_stack->opener_statistics.registered_sessions++;
         receive_data->session_handle = session_index + 1;
         receive_data->status = kEncapsulationProtocolSuccess;
         receive_data_buffer =
@@ -469,9 +443,9 @@ EipStatus HandleReceivedUnregisterSessionCommand(
   if ((0 < receive_data->session_handle)
       && (receive_data->session_handle <= OPENER_NUMBER_OF_SUPPORTED_SESSIONS)) {
     i = receive_data->session_handle - 1;
-    if (kEipInvalidSocket != g_registered_sessions[i]) {
-      IApp_CloseSocket_tcp(g_registered_sessions[i]);
-      g_registered_sessions[i] = kEipInvalidSocket;
+    if (kEipInvalidSocket != g_opener_stack->registered_sessions[i]) {
+      IApp_CloseSocket_tcp(g_opener_stack->registered_sessions[i]);
+      g_opener_stack->registered_sessions[i] = kEipInvalidSocket;
       return kEipStatusOk;
     }
   }
@@ -559,22 +533,13 @@ EipStatus HandleReceivedSendRequestResponseDataCommand(
  */
 int GetFreeSessionIndex(void) {
   for (int session_index = 0; session_index < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; session_index++) {
-    if (kEipInvalidSocket == g_registered_sessions[session_index]) {
+    if (kEipInvalidSocket == g_opener_stack->registered_sessions[session_index]) {
       return session_index;
     }
   }
   return kSessionStatusInvalid;
 }
 
-/** @brief copy data from pa_buf in little endian to host in structure.
- * @param receive_buffer
- * @param length Length of the data in receive_buffer. Might be more than one message
- * @param encapsulation_data	structure to which data shall be copied
- * @return return difference between bytes in pa_buf an data_length
- *  		0 .. full package received
- * 			>0 .. more than one packet received
- * 			<0 .. only fragment of data portion received
- */
 EipInt16 CreateEncapsulationStructure(EipUint8 *receive_buffer,
                                       int receive_buffer_length,
                                       EncapsulationData *encapsulation_data) {
@@ -600,45 +565,46 @@ SessionStatus CheckRegisteredSessions(EncapsulationData *receive_data) {
   if ((0 < receive_data->session_handle)
       && (receive_data->session_handle <= OPENER_NUMBER_OF_SUPPORTED_SESSIONS)) {
     if (kEipInvalidSocket
-        != g_registered_sessions[receive_data->session_handle - 1]) {
+        != g_opener_stack->registered_sessions[receive_data->session_handle - 1]) {
       return kSessionStatusValid;
     }
   }
   return kSessionStatusInvalid;
 }
 
-void CloseSession(int socket) {
+EipStatus CloseSession(int socket) {
   int i;
   for (i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if (g_registered_sessions[i] == socket) {
+    if (g_opener_stack->registered_sessions[i] == socket) {
       IApp_CloseSocket_tcp(socket);
-      g_registered_sessions[i] = kEipInvalidSocket;
-      break;
+      g_opener_stack->registered_sessions[i] = kEipInvalidSocket;
+      return kEipStatusOk;
     }
   }
+  return kEipStatusError;
 }
 
 void EncapsulationShutDown(void) {
   for (int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; ++i) {
-    if (kEipInvalidSocket != g_registered_sessions[i]) {
-      IApp_CloseSocket_tcp(g_registered_sessions[i]);
-      g_registered_sessions[i] = kEipInvalidSocket;
+    if (kEipInvalidSocket != g_opener_stack->registered_sessions[i]) {
+      IApp_CloseSocket_tcp(g_opener_stack->registered_sessions[i]);
+      g_opener_stack->registered_sessions[i] = kEipInvalidSocket;
     }
   }
 }
 
 void ManageEncapsulationMessages(MilliSeconds elapsed_time) {
   for (unsigned int i = 0; i < ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES; i++) {
-    if (kEipInvalidSocket != g_delayed_encapsulation_messages[i].socket) {
-      g_delayed_encapsulation_messages[i].time_out -=
+    if (kEipInvalidSocket != g_opener_stack->delayed_encapsulation_messages[i].socket) {
+      g_opener_stack->delayed_encapsulation_messages[i].time_out -=
           elapsed_time;
-      if (0 > g_delayed_encapsulation_messages[i].time_out) {
+      if (0 > g_opener_stack->delayed_encapsulation_messages[i].time_out) {
         /* If delay is reached or passed, send the UDP message */
-        SendUdpData(&(g_delayed_encapsulation_messages[i].receiver),
-                    g_delayed_encapsulation_messages[i].socket,
-                    &(g_delayed_encapsulation_messages[i].message[0]),
-                    g_delayed_encapsulation_messages[i].message_size);
-        g_delayed_encapsulation_messages[i].socket = -1;
+        SendUdpData(&(g_opener_stack->delayed_encapsulation_messages[i].receiver),
+                    g_opener_stack->delayed_encapsulation_messages[i].socket,
+                    &(g_opener_stack->delayed_encapsulation_messages[i].message[0]),
+                    g_opener_stack->delayed_encapsulation_messages[i].message_size);
+        g_opener_stack->delayed_encapsulation_messages[i].socket = -1;
       }
     }
   }
@@ -7,6 +7,7 @@
 #define OPENER_ENCAP_H_
 
 #include "typedefs.h"
+#include "opener_user_conf.h"
 
 /** @file encap.h
  * @brief This file contains the public interface of the encapsulation layer
@@ -20,6 +21,10 @@
 
 #define ENCAPSULATION_HEADER_LENGTH	24
 
+#define ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES 2 /**< According to EIP spec at least 2 delayed message requests should be supported */
+
+#define ENCAP_MAX_DELAYED_ENCAP_MESSAGE_SIZE (ENCAPSULATION_HEADER_LENGTH + 39 + sizeof(OPENER_DEVICE_NAME)) /* currently we only have the size of an encapsulation message */
+
 /** @brief Ethernet/IP standard port */
 static const int kOpenerEthernetPort = 0xAF12;
 
@@ -56,6 +61,15 @@ typedef struct encapsulation_interface_information {
   EipInt8 name_of_service[16];
 } EncapsulationInterfaceInformation;
 
+/** @brief Delayed Encapsulation Message structure */
+typedef struct {
+  EipInt32 time_out; /**< time out in milli seconds */
+  int socket; /**< associated socket */
+  struct sockaddr_in receiver;
+  EipByte message[ENCAP_MAX_DELAYED_ENCAP_MESSAGE_SIZE];
+  unsigned int message_size;
+} DelayedEncapsulationMessage;
+
 /*** global variables (public) ***/
 
 /*** public functions ***/
@@ -80,4 +94,20 @@ void EncapsulationShutDown(void);
  */
 void ManageEncapsulationMessages(MilliSeconds elapsed_time);
 
+/** @ingroup ENCAP
+ * @brief Decode the encapsulation header of a received message
+ *
+ * @param receive_buffer the received data
+ * @param receive_buffer_length length of the received data, might be more
+ *  than one message
+ * @param encapsulation_data structure the header is decoded into
+ * @return difference between the received bytes and the message length
+ *  - 0 .. full message received
+ *  - >0 .. more than one message received
+ *  - <0 .. only a fragment of the data received
+ */
+EipInt16 CreateEncapsulationStructure(EipUint8 *receive_buffer,
+                                      int receive_buffer_length,
+                                      EncapsulationData *encapsulation_data);
+
 #endif /* OPENER_ENCAP_H_ */
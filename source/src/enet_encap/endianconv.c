@@ -11,200 +11,138 @@
 #include <sys/socket.h>
 #endif
 
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include "endianconv.h"
 
-OpenerEndianess g_opener_platform_endianess = kOpenerEndianessUnknown;
-
-/* THESE ROUTINES MODIFY THE BUFFER POINTER*/
+int AddSintArrayToMessage(const EipUint8 *data, size_t number_of_elements,
+                          EipUint8 **buffer) {
+  memcpy(*buffer, data, number_of_elements);
+  *buffer += number_of_elements;
+  return number_of_elements;
+}
 
-/**
- *   @brief Reads EIP_UINT8 from *buffer and converts little endian to host.
- *   @param buffer pointer where data should be reed.
- *   @return EIP_UINT8 data value
- */
-EipUint8 GetSintFromMessage(EipUint8** buffer) {
-  unsigned char *buffer_address = (unsigned char *) *buffer;
-  EipUint16 data = buffer_address[0];
-  *buffer += 1;
-  return data;
+int AddIntArrayToMessage(const EipUint16 *data, size_t number_of_elements,
+                         EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(*buffer, data, number_of_elements * 2);
+  *buffer += number_of_elements * 2;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    AddIntToMessage(data[i], buffer);
+  }
+#endif
+  return number_of_elements * 2;
 }
 
-/* little-endian-to-host unsigned 16 bit*/
-
-/**
- *   @brief Reads EIP_UINT16 from *buffer and converts little endian to host.
- *   @param buffer pointer where data should be reed.
- *   @return EIP_UINT16 data value
- */
-EipUint16 GetIntFromMessage(EipUint8** buffer) {
-  unsigned char *buffer_address = (unsigned char *) *buffer;
-  EipUint16 data = buffer_address[0] | buffer_address[1] << 8;
-  *buffer += 2;
-  return data;
+void GetIntArrayFromMessage(EipUint16 *data, size_t number_of_elements,
+                            EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(data, *buffer, number_of_elements * 2);
+  *buffer += number_of_elements * 2;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    data[i] = GetIntFromMessage(buffer);
+  }
+#endif
 }
 
-/**
- *   @brief Reads EIP_UINT32 from *buffer and converts little endian to host.
- *   @param buffer pointer where data should be reed.
- *   @return EIP_UNÍT32 value
- */
-EipUint32 GetDintFromMessage(EipUint8** buffer) {
-  unsigned char *p = (unsigned char *) *buffer;
-  EipUint32 data = p[0] | p[1] << 8 | p[2] << 16 | p[3] << 24;
-  *buffer += 4;
-  return data;
+int AddDintArrayToMessage(const EipUint32 *data, size_t number_of_elements,
+                          EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(*buffer, data, number_of_elements * 4);
+  *buffer += number_of_elements * 4;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    AddDintToMessage(data[i], buffer);
+  }
+#endif
+  return number_of_elements * 4;
 }
 
-/**
- * @brief converts UINT8 data from host to little endian an writes it to buffer.
- * @param data value to be written
- * @param buffer pointer where data should be written.
- */
-int AddSintToMessage(EipUint8 data, EipUint8 **buffer) {
-  unsigned char *p = (unsigned char *) *buffer;
-
-  p[0] = (unsigned char) data;
-  *buffer += 1;
-  return 1;
+void GetDintArrayFromMessage(EipUint32 *data, size_t number_of_elements,
+                             EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(data, *buffer, number_of_elements * 4);
+  *buffer += number_of_elements * 4;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    data[i] = GetDintFromMessage(buffer);
+  }
+#endif
 }
 
-/**
- * @brief converts UINT16 data from host to little endian an writes it to buffer.
- * @param data value to be written
- * @param buffer pointer where data should be written.
- */
-int AddIntToMessage(EipUint16 data, EipUint8 **buffer) {
-  unsigned char *p = (unsigned char *) *buffer;
-
-  p[0] = (unsigned char) data;
-  p[1] = (unsigned char) (data >> 8);
-  *buffer += 2;
-  return 2;
+int AddRealArrayToMessage(const CipReal *data, size_t number_of_elements,
+                          EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(*buffer, data, number_of_elements * 4);
+  *buffer += number_of_elements * 4;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    EipUint32 bit_pattern;
+    memcpy(&bit_pattern, &data[i], sizeof(bit_pattern));
+    AddDintToMessage(bit_pattern, buffer);
+  }
+#endif
+  return number_of_elements * 4;
 }
 
-/**
- * @brief Converts UINT32 data from host to little endian and writes it to buffer.
- * @param data value to be written
- * @param buffer pointer where data should be written.
- */
-int AddDintToMessage(EipUint32 data, EipUint8** buffer) {
-  unsigned char *p = (unsigned char *) *buffer;
-
-  p[0] = (unsigned char) data;
-  p[1] = (unsigned char) (data >> 8);
-  p[2] = (unsigned char) (data >> 16);
-  p[3] = (unsigned char) (data >> 24);
-  *buffer += 4;
-
-  return 4;
+void GetRealArrayFromMessage(CipReal *data, size_t number_of_elements,
+                             EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(data, *buffer, number_of_elements * 4);
+  *buffer += number_of_elements * 4;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    EipUint32 bit_pattern = GetDintFromMessage(buffer);
+    memcpy(&data[i], &bit_pattern, sizeof(bit_pattern));
+  }
+#endif
 }
 
 #ifdef OPENER_SUPPORT_64BIT_DATATYPES
 
-/**
- *   @brief Reads EipUint64 from *pa_buf and converts little endian to host.
- *   @param pa_buf pointer where data should be reed.
- *   @return EipUint64 value
- */
-EipUint64 GetLintFromMessage(EipUint8 **buffer) {
-  EipUint8 *buffer_address = *buffer;
-  EipUint64 data = ((((EipUint64) buffer_address[0]) << 56)
-      & 0xFF00000000000000LL)
-      + ((((EipUint64) buffer_address[1]) << 48) & 0x00FF000000000000LL)
-      + ((((EipUint64) buffer_address[2]) << 40) & 0x0000FF0000000000LL)
-      + ((((EipUint64) buffer_address[3]) << 32) & 0x000000FF00000000LL)
-      + ((((EipUint64) buffer_address[4]) << 24) & 0x00000000FF000000)
-      + ((((EipUint64) buffer_address[5]) << 16) & 0x0000000000FF0000)
-      + ((((EipUint64) buffer_address[6]) << 8) & 0x000000000000FF00)
-      + (((EipUint64) buffer_address[7]) & 0x00000000000000FF);
-  (*buffer) += 8;
-  return data;
+int AddLintArrayToMessage(const EipUint64 *data, size_t number_of_elements,
+                          EipUint8 **buffer) {
+#ifdef OPENER_BIG_ENDIAN_PLATFORM
+  memcpy(*buffer, data, number_of_elements * 8);
+  *buffer += number_of_elements * 8;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    AddLintToMessage(data[i], buffer);
+  }
+#endif
+  return number_of_elements * 8;
 }
 
-/**
- * @brief Converts EipUint64 data from host to little endian and writes it to buffer.
- * @param data value to be written
- * @param buffer pointer where data should be written.
- */
-int AddLintToMessage(EipUint64 data, EipUint8 **buffer) {
-  EipUint8 *buffer_address = *buffer;
-  buffer_address[0] = (EipUint8) (data >> 56) & 0xFF;
-  buffer_address[1] = (EipUint8) (data >> 48) & 0xFF;
-  buffer_address[2] = (EipUint8) (data >> 40) & 0xFF;
-  buffer_address[3] = (EipUint8) (data >> 32) & 0xFF;
-  buffer_address[4] = (EipUint8) (data >> 24) & 0xFF;
-  buffer_address[5] = (EipUint8) (data >> 16) & 0xFF;
-  buffer_address[6] = (EipUint8) (data >> 8) & 0xFF;
-  buffer_address[7] = (EipUint8) (data) & 0xFF;
-  (*buffer) += 8;
-
-  return 8;
+void GetLintArrayFromMessage(EipUint64 *data, size_t number_of_elements,
+                             EipUint8 **buffer) {
+#ifdef OPENER_BIG_ENDIAN_PLATFORM
+  memcpy(data, *buffer, number_of_elements * 8);
+  *buffer += number_of_elements * 8;
+#else
+  for (size_t i = 0; i < number_of_elements; i++) {
+    data[i] = GetLintFromMessage(buffer);
+  }
+#endif
 }
 
 #endif
 
-
 int EncapsulateIpAddress(EipUint16 port, EipUint32 address,
                                            EipByte **communication_buffer) {
-  int size = 0;
-  if (kOpENerEndianessLittle == g_opener_platform_endianess) {
-    size += AddIntToMessage(htons(AF_INET), communication_buffer);
-    size += AddIntToMessage(port, communication_buffer);
-    size += AddDintToMessage(address, communication_buffer);
-
-  } else {
-    if (kOpENerEndianessBig == g_opener_platform_endianess) {
-      (*communication_buffer)[0] = (unsigned char) (AF_INET >> 8);
-      (*communication_buffer)[1] = (unsigned char) AF_INET;
-      *communication_buffer += 2;
-      size += 2;
-
-      (*communication_buffer)[0] = (unsigned char) (port >> 8);
-      (*communication_buffer)[1] = (unsigned char) port;
-      *communication_buffer += 2;
-      size += 2;
-
-      (*communication_buffer)[3] = (unsigned char) address;
-      (*communication_buffer)[2] = (unsigned char) (address >> 8);
-      (*communication_buffer)[1] = (unsigned char) (address >> 16);
-      (*communication_buffer)[0] = (unsigned char) (address >> 24);
-      *communication_buffer += 4;
-      size += 4;
-    } else {
-      fprintf(stderr, "No endianess detected! Probably the DetermineEndianess function was not executed!");
-      exit (EXIT_FAILURE);
-    }
-  }
-  return size;
-}
+  /* sin_family is transmitted in network byte order as well */
+  (*communication_buffer)[0] = (unsigned char) (AF_INET >> 8);
+  (*communication_buffer)[1] = (unsigned char) AF_INET;
+  *communication_buffer += 2;
 
-/**
- * @brief Detects Endianess of the platform and sets global g_nOpENerPlatformEndianess variable accordingly
- *
- * Detects Endianess of the platform and sets global variable g_nOpENerPlatformEndianess accordingly,
- * whereas 0 equals little endian and 1 equals big endian
- */
-void DetermineEndianess() {
-  int i = 1;
-  char *p = (char *) &i;
-  if (p[0] == 1) {
-    g_opener_platform_endianess = kOpENerEndianessLittle;
-  } else {
-    g_opener_platform_endianess = kOpENerEndianessBig;
-  }
-}
+  /* port and address are already given in network byte order */
+  memcpy(*communication_buffer, &port, sizeof(port));
+  *communication_buffer += 2;
+  memcpy(*communication_buffer, &address, sizeof(address));
+  *communication_buffer += 4;
 
-/**
- * @brief Returns global variable g_nOpENerPlatformEndianess, whereas 0 equals little endian and 1 equals big endian
- *
- * @return 0 equals little endian and 1 equals big endian
- */
-int GetEndianess() {
-  return g_opener_platform_endianess;
+  return 8;
 }
 
 void MoveMessageNOctets(int amount_of_bytes_moved, CipOctet **message_runner) {
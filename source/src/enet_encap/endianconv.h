@@ -6,6 +6,9 @@
 #ifndef OPENER_ENDIANCONV_H_
 #define OPENER_ENDIANCONV_H_
 
+#include <stddef.h>
+#include <string.h>
+
 #include "typedefs.h"
 
 /** @file endianconv.h
@@ -18,12 +21,46 @@ typedef enum {
   kOpENerEndianessBig = 1
 } OpenerEndianess;
 
+/** @def OPENER_LITTLE_ENDIAN_PLATFORM
+ * @brief Defined if the target is known to be little endian at compile time
+ *
+ * On little endian targets the codec functions copy the values directly from
+ * and to the message buffers. On all other targets the values are assembled
+ * byte by byte, which is correct for any byte order.
+ */
+#ifndef OPENER_LITTLE_ENDIAN_PLATFORM
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define OPENER_LITTLE_ENDIAN_PLATFORM 1
+#endif
+#elif defined(_WIN32)
+#define OPENER_LITTLE_ENDIAN_PLATFORM 1
+#endif
+#endif
+
+/** @def OPENER_BIG_ENDIAN_PLATFORM
+ * @brief Defined if the target is known to be big endian at compile time
+ */
+#ifndef OPENER_BIG_ENDIAN_PLATFORM
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define OPENER_BIG_ENDIAN_PLATFORM 1
+#endif
+#endif
+#endif
+
+/* THESE ROUTINES MODIFY THE BUFFER POINTER*/
+
 /** @ingroup ENCAP
  *   @brief Reads EIP_UINT8 from *buffer and converts little endian to host.
  *   @param buffer pointer where data should be reed.
  *   @return EIP_UINT8 data value
  */
-EipUint8 GetSintFromMessage(EipUint8** buffer);
+static inline EipUint8 GetSintFromMessage(EipUint8 **buffer) {
+  EipUint8 data = **buffer;
+  *buffer += 1;
+  return data;
+}
 
 /** @ingroup ENCAP
  *
@@ -31,7 +68,16 @@ EipUint8 GetSintFromMessage(EipUint8** buffer);
  * @param buffer Pointer to the network buffer array. This pointer will be incremented by 2!
  * @return Extracted 16 bit integer value
  */
-EipUint16 GetIntFromMessage(EipUint8 **buffer);
+static inline EipUint16 GetIntFromMessage(EipUint8 **buffer) {
+  EipUint16 data;
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(&data, *buffer, sizeof(data));
+#else
+  data = (EipUint16) ((*buffer)[0] | (*buffer)[1] << 8);
+#endif
+  *buffer += 2;
+  return data;
+}
 
 /** @ingroup ENCAP
  *
@@ -39,7 +85,17 @@ EipUint16 GetIntFromMessage(EipUint8 **buffer);
  * @param buffer pointer to the network buffer array. This pointer will be incremented by 4!
  * @return Extracted 32 bit integer value
  */
-EipUint32 GetDintFromMessage(EipUint8 **buffer);
+static inline EipUint32 GetDintFromMessage(EipUint8 **buffer) {
+  EipUint32 data;
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(&data, *buffer, sizeof(data));
+#else
+  data = (EipUint32) (*buffer)[0] | (EipUint32) (*buffer)[1] << 8
+      | (EipUint32) (*buffer)[2] << 16 | (EipUint32) (*buffer)[3] << 24;
+#endif
+  *buffer += 4;
+  return data;
+}
 
 /** @ingroup ENCAP
  *
@@ -47,7 +103,11 @@ EipUint32 GetDintFromMessage(EipUint8 **buffer);
  * @param data value to be written
  * @param buffer pointer where data should be written.
  */
-int AddSintToMessage(EipUint8 data, EipUint8 **buffer);
+static inline int AddSintToMessage(EipUint8 data, EipUint8 **buffer) {
+  **buffer = data;
+  *buffer += 1;
+  return 1;
+}
 
 /** @ingroup ENCAP
  *
@@ -57,7 +117,16 @@ int AddSintToMessage(EipUint8 data, EipUint8 **buffer);
  *
  * @return Length in bytes of the encoded message
  */
-int AddIntToMessage(EipUint16 data, EipUint8 **buffer);
+static inline int AddIntToMessage(EipUint16 data, EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(*buffer, &data, sizeof(data));
+#else
+  (*buffer)[0] = (EipUint8) data;
+  (*buffer)[1] = (EipUint8) (data >> 8);
+#endif
+  *buffer += 2;
+  return 2;
+}
 
 /** @ingroup ENCAP
  *
@@ -67,21 +136,179 @@ int AddIntToMessage(EipUint16 data, EipUint8 **buffer);
  *
  * @return Length in bytes of the encoded message
  */
-int AddDintToMessage(EipUint32 data, EipUint8 **buffer);
+static inline int AddDintToMessage(EipUint32 data, EipUint8 **buffer) {
+#ifdef OPENER_LITTLE_ENDIAN_PLATFORM
+  memcpy(*buffer, &data, sizeof(data));
+#else
+  (*buffer)[0] = (EipUint8) data;
+  (*buffer)[1] = (EipUint8) (data >> 8);
+  (*buffer)[2] = (EipUint8) (data >> 16);
+  (*buffer)[3] = (EipUint8) (data >> 24);
+#endif
+  *buffer += 4;
+  return 4;
+}
 
 #ifdef OPENER_SUPPORT_64BIT_DATATYPES
 
-EipUint64 GetLintFromMessage(EipUint8 **buffer);
+/** @ingroup ENCAP
+ *
+ * @brief Get an 64Bit integer from the network buffer.
+ *
+ * The 64 bit values are transferred with the most significant byte first.
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 8!
+ * @return Extracted 64 bit integer value
+ */
+static inline EipUint64 GetLintFromMessage(EipUint8 **buffer) {
+  EipUint64 data;
+#if defined(OPENER_BIG_ENDIAN_PLATFORM)
+  memcpy(&data, *buffer, sizeof(data));
+#elif defined(OPENER_LITTLE_ENDIAN_PLATFORM) && defined(__GNUC__)
+  memcpy(&data, *buffer, sizeof(data));
+  data = __builtin_bswap64(data);
+#else
+  data = 0;
+  for (int i = 0; i < 8; i++) {
+    data = (data << 8) | (*buffer)[i];
+  }
+#endif
+  *buffer += 8;
+  return data;
+}
 
 /** @ingroup ENCAP
  *
  * @brief Write an 64Bit integer to the network buffer.
+ *
+ * The 64 bit values are transferred with the most significant byte first.
  * @param data value to write
  * @param buffer pointer to the network buffer array. This pointer will be incremented by 8!
  *
  * @return Length in bytes of the encoded message
  */
-int AddLintToMessage(EipUint64 pa_unData, EipUint8 **buffer);
+static inline int AddLintToMessage(EipUint64 data, EipUint8 **buffer) {
+#if defined(OPENER_BIG_ENDIAN_PLATFORM)
+  memcpy(*buffer, &data, sizeof(data));
+#elif defined(OPENER_LITTLE_ENDIAN_PLATFORM) && defined(__GNUC__)
+  data = __builtin_bswap64(data);
+  memcpy(*buffer, &data, sizeof(data));
+#else
+  for (int i = 7; i >= 0; i--) {
+    (*buffer)[i] = (EipUint8) data;
+    data >>= 8;
+  }
+#endif
+  *buffer += 8;
+  return 8;
+}
+
+#endif
+
+/** @ingroup ENCAP
+ *
+ * @brief Copy an array of 8 bit values to the network buffer.
+ * @param data values to write
+ * @param number_of_elements number of values in data
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by number_of_elements!
+ *
+ * @return Length in bytes of the encoded message
+ */
+int AddSintArrayToMessage(const EipUint8 *data, size_t number_of_elements,
+                          EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Write an array of 16 bit integers (INT, UINT, WORD) to the network buffer.
+ * @param data values to write
+ * @param number_of_elements number of values in data
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 2 * number_of_elements!
+ *
+ * @return Length in bytes of the encoded message
+ */
+int AddIntArrayToMessage(const EipUint16 *data, size_t number_of_elements,
+                         EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Read an array of 16 bit integers (INT, UINT, WORD) from the network buffer.
+ * @param data will hold the read values
+ * @param number_of_elements number of values to read
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 2 * number_of_elements!
+ */
+void GetIntArrayFromMessage(EipUint16 *data, size_t number_of_elements,
+                            EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Write an array of 32 bit integers (DINT, UDINT, DWORD) to the network buffer.
+ * @param data values to write
+ * @param number_of_elements number of values in data
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 4 * number_of_elements!
+ *
+ * @return Length in bytes of the encoded message
+ */
+int AddDintArrayToMessage(const EipUint32 *data, size_t number_of_elements,
+                          EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Read an array of 32 bit integers (DINT, UDINT, DWORD) from the network buffer.
+ * @param data will hold the read values
+ * @param number_of_elements number of values to read
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 4 * number_of_elements!
+ */
+void GetDintArrayFromMessage(EipUint32 *data, size_t number_of_elements,
+                             EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Write an array of REAL values to the network buffer.
+ * @param data values to write
+ * @param number_of_elements number of values in data
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 4 * number_of_elements!
+ *
+ * @return Length in bytes of the encoded message
+ */
+int AddRealArrayToMessage(const CipReal *data, size_t number_of_elements,
+                          EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Read an array of REAL values from the network buffer.
+ * @param data will hold the read values
+ * @param number_of_elements number of values to read
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 4 * number_of_elements!
+ */
+void GetRealArrayFromMessage(CipReal *data, size_t number_of_elements,
+                             EipUint8 **buffer);
+
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+
+/** @ingroup ENCAP
+ *
+ * @brief Write an array of 64 bit integers (LINT, ULINT, LWORD) to the network buffer.
+ *
+ * The byte order of the elements is the same as for AddLintToMessage().
+ * @param data values to write
+ * @param number_of_elements number of values in data
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 8 * number_of_elements!
+ *
+ * @return Length in bytes of the encoded message
+ */
+int AddLintArrayToMessage(const EipUint64 *data, size_t number_of_elements,
+                          EipUint8 **buffer);
+
+/** @ingroup ENCAP
+ *
+ * @brief Read an array of 64 bit integers (LINT, ULINT, LWORD) from the network buffer.
+ *
+ * The byte order of the elements is the same as for GetLintFromMessage().
+ * @param data will hold the read values
+ * @param number_of_elements number of values to read
+ * @param buffer pointer to the network buffer array. This pointer will be incremented by 8 * number_of_elements!
+ */
+void GetLintArrayFromMessage(EipUint64 *data, size_t number_of_elements,
+                             EipUint8 **buffer);
 
 #endif
 
@@ -96,18 +323,21 @@ int AddLintToMessage(EipUint64 pa_unData, EipUint8 **buffer);
 int EncapsulateIpAddress(EipUint16 port, EipUint32 address,
                                            EipByte **communication_buffer);
 
-/** Identify if we are running on a big or little endian system and set
- * variable.
- */
-void DetermineEndianess(void);
-
-/** @brief Return the endianess identified on system startup
+/** @brief Return the endianess of the target as determined at compile time
  * @return
- *    - -1 endianess has not been identified up to now
+ *    - -1 endianess is not known at compile time
  *    - 0  little endian system
  *    - 1  big endian system
  */
-int GetEndianess(void);
+static inline int GetEndianess(void) {
+#if defined(OPENER_LITTLE_ENDIAN_PLATFORM)
+  return kOpENerEndianessLittle;
+#elif defined(OPENER_BIG_ENDIAN_PLATFORM)
+  return kOpENerEndianessBig;
+#else
+  return kOpenerEndianessUnknown;
+#endif
+}
 
 void MoveMessageNOctets(int n, CipOctet **message_runner);
 
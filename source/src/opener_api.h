@@ -18,6 +18,56 @@
  * needed to implement an EtherNet/IP enabled slave-device.
  */
 
+/** @ingroup CIP_API
+ * @brief The data of one stack instance, i.e., of one EtherNet/IP device
+ *
+ * All functions of OpENer work on the active stack of the calling thread.
+ * Without a call of SetActiveOpenerStack this is the default stack, so an
+ * application implementing a single device does not need to care about it.
+ */
+typedef struct opener_stack OpenerStack;
+
+/** @ingroup CIP_API
+ * @brief Create an additional stack instance
+ *
+ * The new stack is in the same state as the default stack at program start.
+ * After activating it with SetActiveOpenerStack it is configured and
+ * initialized like the default stack.
+ *
+ * @return the new stack, NULL if no memory is available
+ */
+OpenerStack *CreateOpenerStack(void);
+
+/** @ingroup CIP_API
+ * @brief Free a stack created with CreateOpenerStack
+ *
+ * The stack has to be shut down with NetworkHandlerFinish and
+ * ShutdownCipStack before. If it is the active stack of the calling thread
+ * the default stack becomes active.
+ *
+ * @param stack the stack to be freed, must not be the default stack
+ */
+void DestroyOpenerStack(OpenerStack *stack);
+
+/** @ingroup CIP_API
+ * @brief Select the stack the functions of OpENer called by this thread work
+ * on
+ *
+ * A stack must not be active in two threads at the same time, except for the
+ * calling of functions only reading its data. Different stacks must not be
+ * run concurrently either, see opener_stack.h.
+ *
+ * @param stack the stack to be used, NULL for the default stack
+ */
+void SetActiveOpenerStack(OpenerStack *stack);
+
+/** @ingroup CIP_API
+ * @brief Get the active stack of the calling thread
+ *
+ * @return the stack set with SetActiveOpenerStack, or the default stack
+ */
+OpenerStack *GetActiveOpenerStack(void);
+
 /** @ingroup CIP_API
  * @brief Configure the data of the network interface of the device
  *
@@ -119,6 +169,18 @@ CipInstance *GetCipInstance(CipClass *cip_object, EipUint32 instance_number);
 CipAttributeStruct *GetCipAttribute(CipInstance *cip_instance,
                                     EipUint16 attribute_number);
 
+/** @ingroup CIP_API
+ * @brief Get the constant definition of an attribute of a class created
+ * with CreateCipClassFromDefinition
+ *
+ * @param cip_class the class the attribute belongs to
+ * @param attribute_number number of the instance attribute to retrieve
+ * @return pointer to the attribute definition
+ *          0 if the class has no definition or not this attribute
+ */
+const CipAttributeDefinition *GetCipAttributeDefinition(
+    const CipClass *cip_class, EipUint16 attribute_number);
+
 /** @ingroup CIP_API
  * @brief Allocate memory for new CIP Class and attributes
  *
@@ -153,6 +215,23 @@ CipClass *CreateCipClass(EipUint32 class_id, int number_of_class_attributes,
                          int number_of_instances, char *class_name,
                          EipUint16 class_revision);
 
+/** @ingroup CIP_API
+ * @brief Create a CIP class and its instance from a constant definition
+ *
+ *  Other than CreateCipClass() no attribute or service is inserted for the
+ *  instance: the service table of the definition is used directly and the
+ *  attribute table is filled from the attribute definitions, pointing to the
+ *  data of the active stack. Only the class object gets the standard class
+ *  attributes and services. No instances, attributes or services may be added
+ *  to the created class afterwards.
+ *
+ *  @param definition the definition of the class, has to stay valid as long
+ *  as the class exists
+ *  @return pointer to new class object
+ *      0 on error
+ */
+CipClass *CreateCipClassFromDefinition(const CipClassDefinition *definition);
+
 /** @ingroup CIP_API
  * @brief Add a number of CIP instances to a given CIP class
  *
@@ -199,9 +278,12 @@ CipInstance *AddCIPInstance(CipClass *cip_class_to_add_instance,
  *  @param cip_data_type type of attribute to be inserted.
  *  @param cip_data pointer to data of attribute.
  *  @param cip_flags flags to indicate set-ability and get-ability of attribute.
+ *  @return kEipStatusOk on success, kEipStatusError if the instance has been
+ *  created from a class definition or its attribute array is full
  */
-void InsertAttribute(CipInstance *cip_instance, EipUint16 attribute_number,
-                     EipUint8 cip_data_type, void *cip_data, EipByte cip_flags);
+EipStatus InsertAttribute(CipInstance *cip_instance, EipUint16 attribute_number,
+                          EipUint8 cip_data_type, void *cip_data,
+                          EipByte cip_flags);
 
 /** @ingroup CIP_API
  * @brief Insert a service in an instance of a CIP object
@@ -215,9 +297,13 @@ void InsertAttribute(CipInstance *cip_instance, EipUint16 attribute_number,
  * @param service_code service code of service to be inserted.
  * @param service_function pointer to function which represents the service.
  * @param service_name name of the service
+ * @return kEipStatusOk on success, kEipStatusError if the class has been
+ * created from a class definition or its service array is full
  */
-void InsertService(CipClass *cip_class_to_add_service, EipUint8 service_code,
-                   CipServiceFunction service_function, char *service_name);
+EipStatus InsertService(CipClass *cip_class_to_add_service,
+                        EipUint8 service_code,
+                        CipServiceFunction service_function,
+                        char *service_name);
 
 /** @ingroup CIP_API
  * @brief Produce the data according to CIP encoding onto the message buffer.
@@ -246,6 +332,90 @@ int EncodeData(EipUint8 cip_data_type, void *cip_data, EipUint8 **cip_message);
  */
 int DecodeData(EipUint8 cip_data_type, void *cip_data, EipUint8 **cip_message);
 
+/** @ingroup CIP_API
+ * @brief Get the number of bytes EncodeData will produce for the given data
+ *
+ * Allows to size a response and to check it against the reply buffer before
+ * anything is encoded.
+ *  @param cip_data_type the CIP type to encode
+ *  @param cip_data pointer to data value, only accessed for variable width
+ *  types like strings
+ *  @return encoded length in bytes, 0 for types OpENer can not encode
+ */
+int GetEncodedDataSize(EipUint8 cip_data_type, const void *cip_data);
+
+/** @ingroup CIP_API
+ * @brief Produce an array of values of an elementary CIP type (BOOL to LWORD)
+ * onto the message buffer.
+ *
+ *  @param cip_data_type the CIP type of the array elements
+ *  @param cip_data pointer to the first element
+ *  @param number_of_elements number of elements to encode
+ *  @param cip_message pointer to memory where response should be written
+ *  @return length of the encoded array in bytes
+ *          -1 .. the type is not a fixed width elementary type
+ */
+int EncodeDataArray(EipUint8 cip_data_type, const void *cip_data,
+                    size_t number_of_elements, EipUint8 **cip_message);
+
+/** @ingroup CIP_API
+ * @brief Retrieve an array of values of an elementary CIP type (BOOL to LWORD)
+ * from the message buffer.
+ *
+ *  @param cip_data_type the CIP type of the array elements
+ *  @param cip_data pointer to the first element to be written
+ *  @param number_of_elements number of elements to decode
+ *  @param cip_message pointer to memory where the data should be taken from
+ *  @return length of taken bytes
+ *          -1 .. the type is not a fixed width elementary type
+ */
+int DecodeDataArray(EipUint8 cip_data_type, void *cip_data,
+                    size_t number_of_elements, EipUint8 **cip_message);
+
+/** @ingroup CIP_API
+ * @brief Start writing the response data of a message router response
+ *
+ * The writer starts at the response's data pointer and is limited by the end
+ * of the reply buffer.
+ *  @param writer the writer to initialize
+ *  @param message_router_response the response the data is written for
+ */
+void InitializeResponseWriter(CipResponseWriter *writer,
+                              CipMessageRouterResponse *message_router_response);
+
+/** @ingroup CIP_API
+ * @brief Produce the data according to CIP encoding onto the reply buffer, if
+ * it fits.
+ *
+ *  @param writer the response writer
+ *  @param cip_data_type the CIP type to encode
+ *  @param cip_data pointer to data value
+ *  @return length of the encoded data in bytes
+ *          -1 .. the data would overflow the reply buffer, nothing is written
+ *          and the writer is marked as overflown
+ */
+int WriteResponseData(CipResponseWriter *writer, EipUint8 cip_data_type,
+                      const void *cip_data);
+
+/** @ingroup CIP_API
+ * @brief Produce an array of an elementary CIP type onto the reply buffer, if
+ * it fits.
+ *
+ * See EncodeDataArray() for the supported types.
+ *  @return length of the encoded array in bytes
+ *          -1 .. the type is not supported or the array would overflow the
+ *          reply buffer, nothing is written. In the latter case the writer is
+ *          marked as overflown.
+ */
+int WriteResponseDataArray(CipResponseWriter *writer, EipUint8 cip_data_type,
+                           const void *cip_data, size_t number_of_elements);
+
+/** @ingroup CIP_API
+ * @brief Get the number of bytes written by a response writer since it has
+ * been initialized
+ */
+EipInt16 GetResponseWriterLength(const CipResponseWriter *writer);
+
 /** @ingroup CIP_API
  * @brief Create an instance of an assembly object
  *
@@ -430,11 +600,15 @@ int HandleReceivedExplictUdpData(int socket, struct sockaddr_in *from_address,
  *  @param from_address address from which the data has been received. Only
  *           data from the connections originator may be accepted. Avoids
  *           connection hijacking
+ *  @param receive_time time of arrival of the data in microseconds, used for
+ *           the receive statistics of the connection. Only differences between
+ *           the receive times of one connection are evaluated.
  *  @return EIP_OK on success
  */
 EipStatus
 HandleReceivedConnectedData(EipUint8 *received_data, int received_data_length,
-                            struct sockaddr_in *from_address);
+                            struct sockaddr_in *from_address,
+                            MicroSeconds receive_time);
 
 /** @ingroup CIP_API
  * @brief Check if any of the connection timers (TransmissionTrigger or
@@ -442,13 +616,27 @@ HandleReceivedConnectedData(EipUint8 *received_data, int received_data_length,
  *
  * If the a timeout occurs the function performs the necessary action. This
  * function should be called periodically once every OPENER_TIMER_TICK
- * milliseconds.
+ * milliseconds. In busy-poll mode the connection timers are left to
+ * ManageConnectionTimers.
  *
  * @return EIP_OK on success
  */
 EipStatus
 ManageConnections(MilliSeconds elapsed_time);
 
+/** @ingroup CIP_API
+ * @brief Advance the connection timers and perform the actions of the timers
+ * that expired.
+ *
+ * Part of ManageConnections. In busy-poll mode (OPENER_BUSY_POLL)
+ * ManageConnections leaves the connection timers out and this function has to
+ * be called on every pass of the main loop instead, so that I/O is produced
+ * and timeouts are detected without waiting for the next timer tick.
+ *
+ * @param elapsed_time milliseconds since the last call
+ */
+void ManageConnectionTimers(MilliSeconds elapsed_time);
+
 /** @ingroup CIP_API
  * @brief Trigger the production of an application triggered connection.
  *
@@ -479,8 +667,10 @@ TriggerConnections(unsigned int output_assembly_id,
  * According to the specifications that will clean up and close the session in
  * the encapsulation layer.
  * @param socket_handle the handler to the socket of the closed connection
+ * @return kEipStatusOk if a session was registered for the socket, the socket
+ *  is closed then; kEipStatusError if there was none, the socket is left open
  */
-void CloseSession(int socket);
+EipStatus CloseSession(int socket);
 
 /**  @defgroup CIP_CALLBACK_API Callback Functions Demanded by OpENer
  * @ingroup CIP_API
@@ -553,7 +743,8 @@ AfterAssemblyDataReceived(CipInstance *instance);
  *
  * Within this function the user can update the data of the assembly object
  * before it gets sent. The application can inform the application if data has
- * changed.
+ * changed. Changes of the assembly data are also detected by the stack itself,
+ * change of state connections produce them at the next allowed occurrence.
  * @param instance instance of assembly object that should send data.
  * @return data has changed:
  *          - true assembly data has changed
@@ -794,6 +985,19 @@ void CloseSocket(int socket);
  * milliseconds the
  *     function EIP_STATUS ManageConnections(void) has to be called.
  *
+ * @section multiple_stacks_sec Several Devices in One Process
+ * The data of a device is kept in an OpenerStack, initially all functions
+ * work on the default stack. Further devices are created with
+ * CreateOpenerStack. The application selects the device it works on with
+ * SetActiveOpenerStack and then performs the startup sequence and the normal
+ * operation described above for it. The stacks only run one after the other:
+ * the trace ring, the trace mask, the identity data, the assemblies of the
+ * sample application, the statistics segment and the memory transport are
+ * shared by all stacks and not thread safe, see opener_stack.h. Running the
+ * stacks in parallel threads is not implemented. The call-back functions are
+ * shared by all stacks, they can use GetActiveOpenerStack to find out which
+ * device they are called for.
+ *
  * @section callback_funcs_sec Callback Functions
  * In order to make OpENer more platform independent and in order to inform the
  * application on certain state changes and actions within the stack a set of
@@ -816,11 +1020,15 @@ void CloseSocket(int socket);
  * number_of_instances);
  *   - S_CIP_Instance *AddCIPInstance(S_CIP_Class * cip_class, EIP_UINT32
  * instance_id);
- *   - void InsertAttribute(S_CIP_Instance *instance, EIP_UINT16
+ *   - EipStatus InsertAttribute(S_CIP_Instance *instance, EIP_UINT16
  * attribute_number, EIP_UINT8 cip_type, void* data);
- *   - void InsertService(S_CIP_Class *class, EIP_UINT8 service_number,
+ *   - EipStatus InsertService(S_CIP_Class *class, EIP_UINT8 service_number,
  * CipServiceFunction service_function, char *service_name);
  *
+ * Objects with a single instance may instead be described by constant
+ * attribute and service tables in a CipClassDefinition and created with
+ * CipClass *CreateCipClassFromDefinition(const CipClassDefinition *definition).
+ *
  * @page license OpENer Open Source License
  * The OpENer Open Source License is an adapted BSD style license. The
  * adaptations include the use of the term EtherNet/IP(TM) and the necessary
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_OPENER_STACK_H_
+#define OPENER_OPENER_STACK_H_
+
+/** @file opener_stack.h
+ * @brief The data of one stack instance
+ *
+ * Everything that describes the state of one EtherNet/IP device is kept in an
+ * OpenerStack: the registered classes, the sessions and connections, the
+ * network configuration, the sockets and the counters. The functions of the
+ * stack work on the active stack of the calling thread, g_opener_stack, so a
+ * process can run many devices by switching the active stack with
+ * SetActiveOpenerStack before it calls into a device.
+ *
+ * Data that is the same for all devices stays global: the identity data
+ * defined in opener_user_conf.h, the constant class definitions, the network
+ * transport and the trace mask.
+ *
+ * The stacks must not run concurrently, even though the active stack is
+ * selected per thread. Some parts used by every stack are not thread safe:
+ * the binary trace ring has a single producer, the sample application keeps
+ * its assembly data in globals, and the POSIX statistics segment and memory
+ * transport are global too. A process running many devices calls into them
+ * one after the other, e.g. from one thread, or serializes the calls.
+ */
+
+#include "typedefs.h"
+#include "opener_api.h"
+#include "appcontype.h"
+#include "cipconnectionmanager.h"
+#include "cipethernetlink.h"
+#include "cipstatistics.h"
+#include "ciptcpipinterface.h"
+#include "cpf.h"
+#include "encap.h"
+#include "generic_networkhandler.h"
+
+/** @brief Storage class of variables with one instance per thread */
+#ifdef _MSC_VER
+#define OPENER_THREAD_LOCAL __declspec(thread)
+#else
+#define OPENER_THREAD_LOCAL __thread
+#endif
+
+struct cip_message_router_object;
+
+/** @brief The data of one stack instance, i.e., of one EtherNet/IP device */
+struct opener_stack {
+  /* connection manager */
+  ConnectionObject *active_connection_list; /**< all currently active connections */
+  ConnectionObject dummy_connection_object; /**< buffer connection object needed for forward open */
+  EipUint32 incarnation_id; /**< connection ID's "incarnation ID" in the upper 16 bits */
+  EipUint32 last_connection_id; /**< counter forming the lower 16 bits of new connection IDs */
+  ConnectionManagementHandling connection_management_handlers[OPENER_NUMBER_OF_CONNECTABLE_OBJECTS]; /**< object classes to which connections may be established */
+  ConnectionPathCacheEntry connection_path_cache[OPENER_CONNECTION_PATH_CACHE_ENTRIES]; /**< connection paths of recently successful forward open requests */
+  unsigned int connection_path_cache_next_entry; /**< entry of the connection path cache to be replaced next */
+  AssemblyIndexEntry assembly_index[OPENER_ASSEMBLY_INDEX_SLOTS]; /**< reverse index from the assemblies to the active I/O connections, hashed by instance number */
+  ForwardOpenAdmission forward_open_admissions[OPENER_FORWARD_OPEN_ADMISSION_ORIGINATORS]; /**< originators that sent forward open requests in the current timer tick */
+  int number_of_forward_open_admissions; /**< number of valid entries in forward_open_admissions */
+  int forward_opens_in_timer_tick; /**< forward open requests accepted in the current timer tick */
+  ForwardOpenStatistics forward_open_statistics;
+  ConnectionManagerCounters connection_manager_counters;
+
+  /* application connection types and explicit connections */
+  ExclusiveOwnerConnection exclusive_owner_connections[OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS];
+  InputOnlyConnection input_only_connections[OPENER_CIP_NUM_INPUT_ONLY_CONNS];
+  ListenOnlyConnection listen_only_connections[OPENER_CIP_NUM_LISTEN_ONLY_CONNS];
+  ConnectionObject explicit_connections[OPENER_CIP_NUM_EXPLICIT_CONNS];
+
+  /* I/O connections */
+  EipUint8 *config_data_buffer; /**< config data coming with a forward open request */
+  unsigned int config_data_length;
+  EipUint32 run_idle_state; /**< run idle information of the last consumed packet */
+
+  /* message router */
+  struct cip_message_router_object *first_object; /**< first class registered at the message router */
+  CipMessageRouterRequest message_router_request;
+  CipMessageRouterResponse message_router_response; /**< the response generated by an explicit message */
+  EipUint8 message_data_reply_buffer[OPENER_MESSAGE_DATA_REPLY_BUFFER]; /**< data of explicit message replies and produced I/O data */
+
+  /* identity, TCP/IP interface and Ethernet link object */
+  EipUint16 device_status; /**< identity attribute 5: Status */
+  EipUint32 serial_number; /**< identity attribute 6: Serial Number, has to be set prior to OpENer initialization */
+  CipTcpIpNetworkInterfaceConfiguration interface_configuration; /**< TCP/IP attribute 5: IP, network mask, gateway, name server 1 & 2, domain name */
+  CipString hostname; /**< TCP/IP attribute 6: Hostname */
+  CipUsint time_to_live_value; /**< TCP/IP attribute 8: time-to-live value for IP multicast packets, fixed to 1 */
+  MulticastAddressConfiguration multicast_configuration; /**< TCP/IP attribute 9: using the default allocation algorithm */
+  CipEthernetLinkObject ethernet_link;
+
+  /* statistics */
+  OpenerStatistics opener_statistics; /**< event counters of the stack */
+  OpenerStatisticsSnapshot statistics_object_snapshot; /**< snapshot reported by the attributes of the statistics object */
+
+  /* encapsulation layer */
+  CipCommonPacketFormatData *common_packet_format_data; /**< CPF data of the explicit message being processed, owned by its caller, NULL if none is */
+  EncapsulationInterfaceInformation interface_information;
+  int registered_sessions[OPENER_NUMBER_OF_SUPPORTED_SESSIONS]; /**< sockets of the registered sessions */
+  DelayedEncapsulationMessage delayed_encapsulation_messages[ENCAP_NUMBER_OF_SUPPORTED_DELAYED_ENCAP_MESSAGES];
+
+  /* network handler */
+  NetworkStatus network_status;
+  EipUint8 ethernet_communication_buffer[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  SocketEvents monitored_sockets[OPENER_MAX_MONITORED_SOCKETS]; /**< all monitored sockets */
+  int number_of_monitored_sockets;
+  SocketEvents ready_sockets[OPENER_MAX_MONITORED_SOCKETS]; /**< the sockets reported by the last wait, events of removed sockets are cleared */
+  int number_of_ready_sockets;
+  int current_active_tcp_socket; /**< the TCP socket the last explicit message was received on, determines the peer of point to point connections */
+  struct timeval time_value;
+  MilliSeconds actual_time;
+  MilliSeconds last_time;
+  PendingTcpReply pending_tcp_replies[OPENER_NUMBER_OF_SUPPORTED_SESSIONS];
+  PendingTcpRequest pending_tcp_requests[OPENER_NUMBER_OF_SUPPORTED_SESSIONS];
+  NetworkHandlerLoopStatistics network_handler_loop_statistics;
+  NetworkHandlerPlatformState platform; /**< state of the port's network handler */
+};
+
+/** @brief The stack used by threads that did not select another one */
+extern OpenerStack g_default_opener_stack;
+
+/** @brief The active stack of the calling thread, see SetActiveOpenerStack */
+extern OPENER_THREAD_LOCAL OpenerStack *g_opener_stack;
+
+#endif /* OPENER_OPENER_STACK_H_ */
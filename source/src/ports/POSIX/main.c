@@ -11,6 +11,10 @@
 #include "opener_api.h"
 #include "cipcommon.h"
 #include "trace.h"
+#include "netdevcounters.h"
+#ifdef OPENER_STATISTICS_SEGMENT
+#include "statisticssegment.h"
+#endif
 
 /******************************************************************************/
 /** @brief Signal handler function for ending stack execution
@@ -76,6 +80,10 @@ int main(int argc, char *arg[]) {
       if (kEipStatusOk != NetworkHandlerProcessOnce()) {
         break;
       }
+      RefreshNetdevCounters();
+#ifdef OPENER_STATISTICS_SEGMENT
+      UpdateStatisticsSegment();
+#endif
     }
 
     /* clean up network state */
@@ -0,0 +1,645 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "memorytransport.h"
+
+/** @brief Handle of the first socket, 0 is left out to catch unset handles */
+#define OPENER_MEMORY_TRANSPORT_FIRST_SOCKET 1
+
+/** @brief First port assigned to sockets sending without being bound */
+#define OPENER_MEMORY_TRANSPORT_EPHEMERAL_PORT 49152
+
+/** @brief Number of sockets the table starts with, it is doubled when full */
+#define OPENER_MEMORY_TRANSPORT_INITIAL_SOCKETS 64
+
+typedef enum {
+  kMemorySocketTypeUnused = 0,
+  kMemorySocketTypeDatagram,
+  kMemorySocketTypeStream,
+  kMemorySocketTypeListener
+} MemorySocketType;
+
+/** @brief Ring buffer holding the received data of a socket */
+typedef struct {
+  EipUint8 *data; /**< OPENER_MEMORY_TRANSPORT_QUEUE_SIZE bytes */
+  size_t head; /**< position of the first queued byte */
+  size_t length; /**< number of queued bytes */
+} MemoryQueue;
+
+/** @brief Header preceding each datagram in the queue */
+typedef struct {
+  size_t length;
+  struct sockaddr_in from_address;
+  MicroSeconds receive_time;
+} MemoryDatagramHeader;
+
+typedef struct {
+  MemorySocketType type;
+  int bound; /**< the local address is set */
+  struct sockaddr_in local_address;
+  struct sockaddr_in peer_address; /**< streams only */
+  int peer_socket; /**< other end of a stream, kEipInvalidSocket if closed */
+  int listener; /**< listener of a stream not yet accepted */
+  EipUint32 connection_number; /**< accept order of pending streams */
+  int pending_connections; /**< listeners only, streams not yet accepted */
+  MemoryQueue queue;
+} MemorySocket;
+
+/** @brief Socket table, indexed by the handle */
+MemorySocket *g_memory_sockets;
+
+/** @brief Number of entries of g_memory_sockets */
+int g_memory_sockets_allocated;
+
+/** @brief Number of entries up to the last open socket, bounds the searches */
+int g_memory_sockets_in_use;
+
+MemoryTransportStatistics g_memory_transport_statistics;
+
+/** @brief Counter ordering the connection attempts */
+EipUint32 g_memory_transport_connection_number;
+
+/** @brief Get the socket of a handle
+ *
+ * @param socket_handle The handle
+ * @return the socket, NULL with errno set to EBADF if the handle is not open
+ */
+MemorySocket *GetMemorySocket(int socket_handle);
+
+/** @brief Allocate a socket and its queue
+ *
+ * Growing the socket table moves it, pointers to sockets taken before are
+ * invalid afterwards.
+ *
+ * @param type Type of the new socket
+ * @return handle of the socket, -1 with errno set on error
+ */
+int AllocateMemorySocket(MemorySocketType type);
+
+/** @brief Append data to a queue, the caller checks for space */
+void WriteToMemoryQueue(MemoryQueue *queue, const void *data, size_t length);
+
+/** @brief Take data from the front of a queue
+ *
+ * @param buffer Receives the data, NULL for dropping it
+ */
+void ReadFromMemoryQueue(MemoryQueue *queue, void *buffer, size_t length);
+
+/** @brief Check if a socket has data, a connection or an end of stream */
+int IsMemorySocketReadable(const MemorySocket *memory_socket);
+
+/** @brief Check if a stream socket can send data or its peer has closed */
+int IsMemorySocketWritable(const MemorySocket *memory_socket);
+
+/** @brief Queue a datagram at a receiving socket
+ *
+ * @return 1 if the datagram was queued, 0 if the queue is full
+ */
+int DeliverMemoryDatagram(MemorySocket *receiver, const EipUint8 *data,
+                          size_t data_length,
+                          const struct sockaddr_in *from_address);
+
+MemorySocket *GetMemorySocket(int socket_handle) {
+  int index = socket_handle - OPENER_MEMORY_TRANSPORT_FIRST_SOCKET;
+  if ((0 > index) || (g_memory_sockets_allocated <= index)
+      || (kMemorySocketTypeUnused == g_memory_sockets[index].type)) {
+    errno = EBADF;
+    return NULL;
+  }
+  return &g_memory_sockets[index];
+}
+
+int AllocateMemorySocket(MemorySocketType type) {
+  int index = 0;
+
+  while ((index < g_memory_sockets_in_use)
+      && (kMemorySocketTypeUnused != g_memory_sockets[index].type)) {
+    index++;
+  }
+  if (g_memory_sockets_allocated == index) {
+    if (OPENER_MEMORY_TRANSPORT_MAX_SOCKETS == g_memory_sockets_allocated) {
+      errno = EMFILE;
+      return kEipInvalidSocket;
+    }
+    int number_of_sockets =
+        (0 == g_memory_sockets_allocated) ?
+            OPENER_MEMORY_TRANSPORT_INITIAL_SOCKETS :
+            2 * g_memory_sockets_allocated;
+    if (OPENER_MEMORY_TRANSPORT_MAX_SOCKETS < number_of_sockets) {
+      number_of_sockets = OPENER_MEMORY_TRANSPORT_MAX_SOCKETS;
+    }
+    MemorySocket *memory_sockets = realloc(
+        g_memory_sockets, number_of_sockets * sizeof(MemorySocket));
+    if (NULL == memory_sockets) {
+      errno = ENOMEM;
+      return kEipInvalidSocket;
+    }
+    memset(&memory_sockets[g_memory_sockets_allocated], 0,
+           (number_of_sockets - g_memory_sockets_allocated)
+               * sizeof(MemorySocket));
+    g_memory_sockets = memory_sockets;
+    g_memory_sockets_allocated = number_of_sockets;
+  }
+
+  MemorySocket *memory_socket = &g_memory_sockets[index];
+  memset(memory_socket, 0, sizeof(MemorySocket));
+  memory_socket->queue.data = malloc(OPENER_MEMORY_TRANSPORT_QUEUE_SIZE);
+  if (NULL == memory_socket->queue.data) {
+    errno = ENOMEM;
+    return kEipInvalidSocket;
+  }
+  memory_socket->type = type;
+  memory_socket->peer_socket = kEipInvalidSocket;
+  memory_socket->listener = kEipInvalidSocket;
+  if (g_memory_sockets_in_use <= index) {
+    g_memory_sockets_in_use = index + 1;
+  }
+  return index + OPENER_MEMORY_TRANSPORT_FIRST_SOCKET;
+}
+
+void WriteToMemoryQueue(MemoryQueue *queue, const void *data, size_t length) {
+  size_t tail = (queue->head + queue->length)
+      % OPENER_MEMORY_TRANSPORT_QUEUE_SIZE;
+  size_t first_part = OPENER_MEMORY_TRANSPORT_QUEUE_SIZE - tail;
+
+  if (first_part > length) {
+    first_part = length;
+  }
+  memcpy(&queue->data[tail], data, first_part);
+  memcpy(queue->data, (const EipUint8 *) data + first_part,
+         length - first_part);
+  queue->length += length;
+}
+
+void ReadFromMemoryQueue(MemoryQueue *queue, void *buffer, size_t length) {
+  size_t first_part = OPENER_MEMORY_TRANSPORT_QUEUE_SIZE - queue->head;
+
+  if (first_part > length) {
+    first_part = length;
+  }
+  if (NULL != buffer) {
+    memcpy(buffer, &queue->data[queue->head], first_part);
+    memcpy((EipUint8 *) buffer + first_part, queue->data, length - first_part);
+  }
+  queue->head = (queue->head + length) % OPENER_MEMORY_TRANSPORT_QUEUE_SIZE;
+  queue->length -= length;
+}
+
+int IsMemorySocketReadable(const MemorySocket *memory_socket) {
+  if (kMemorySocketTypeListener == memory_socket->type) {
+    return 0 != memory_socket->pending_connections;
+  }
+  return (0 != memory_socket->queue.length)
+      || ((kMemorySocketTypeStream == memory_socket->type)
+          && (kEipInvalidSocket == memory_socket->peer_socket));
+}
+
+int IsMemorySocketWritable(const MemorySocket *memory_socket) {
+  if (kMemorySocketTypeStream != memory_socket->type) {
+    return kMemorySocketTypeDatagram == memory_socket->type;
+  }
+  MemorySocket *peer = GetMemorySocket(memory_socket->peer_socket);
+  /* a closed peer is reported too, sending then fails with EPIPE */
+  return (NULL == peer)
+      || (OPENER_MEMORY_TRANSPORT_QUEUE_SIZE > peer->queue.length);
+}
+
+int DeliverMemoryDatagram(MemorySocket *receiver, const EipUint8 *data,
+                          size_t data_length,
+                          const struct sockaddr_in *from_address) {
+  MemoryDatagramHeader header = { .length = data_length, .from_address =
+      *from_address, .receive_time = GetMicroSeconds() };
+
+  if (OPENER_MEMORY_TRANSPORT_QUEUE_SIZE - receiver->queue.length
+      < sizeof(header) + data_length) {
+    g_memory_transport_statistics.datagrams_dropped++;
+    return 0;
+  }
+  WriteToMemoryQueue(&receiver->queue, &header, sizeof(header));
+  WriteToMemoryQueue(&receiver->queue, data, data_length);
+  g_memory_transport_statistics.datagrams_delivered++;
+  return 1;
+}
+
+int CreateSocketMemoryTransport(int type, int protocol) {
+  (void) protocol;
+  if (SOCK_STREAM == type) {
+    return AllocateMemorySocket(kMemorySocketTypeStream);
+  }
+  if (SOCK_DGRAM == type) {
+    return AllocateMemorySocket(kMemorySocketTypeDatagram);
+  }
+  errno = EPROTONOSUPPORT;
+  return kEipInvalidSocket;
+}
+
+int SetSocketOptionMemoryTransport(int socket_handle, int level,
+                                   int option_name, const void *option_value,
+                                   socklen_t option_length) {
+  /* address reuse, broadcast, TTL and timestamps have no meaning here */
+  (void) level;
+  (void) option_name;
+  (void) option_value;
+  (void) option_length;
+  return (NULL != GetMemorySocket(socket_handle)) ? 0 : -1;
+}
+
+int BindSocketMemoryTransport(int socket_handle,
+                              const struct sockaddr_in *address) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (memory_socket->bound) {
+    errno = EINVAL;
+    return -1;
+  }
+  memory_socket->local_address = *address;
+  memory_socket->bound = 1;
+  return 0;
+}
+
+int ListenSocketMemoryTransport(int socket_handle, int backlog) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  (void) backlog;
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if ((kMemorySocketTypeStream != memory_socket->type)
+      || (!memory_socket->bound)) {
+    errno = EINVAL;
+    return -1;
+  }
+  memory_socket->type = kMemorySocketTypeListener;
+  return 0;
+}
+
+int AcceptMemoryTransport(int socket_handle) {
+  MemorySocket *listener = GetMemorySocket(socket_handle);
+  MemorySocket *oldest_connection = NULL;
+  int accepted_socket = kEipInvalidSocket;
+
+  if (NULL == listener) {
+    return -1;
+  }
+  if (kMemorySocketTypeListener != listener->type) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (0 == listener->pending_connections) {
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  for (int i = 0; i < g_memory_sockets_in_use; i++) {
+    MemorySocket *connection = &g_memory_sockets[i];
+    if ((kMemorySocketTypeStream == connection->type)
+        && (socket_handle == connection->listener)
+        && ((NULL == oldest_connection)
+            || (connection->connection_number
+                < oldest_connection->connection_number))) {
+      oldest_connection = connection;
+      accepted_socket = i + OPENER_MEMORY_TRANSPORT_FIRST_SOCKET;
+    }
+  }
+  oldest_connection->listener = kEipInvalidSocket;
+  listener->pending_connections--;
+  return accepted_socket;
+}
+
+int GetPeerAddressMemoryTransport(int socket_handle,
+                                  struct sockaddr_in *peer_address) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (kMemorySocketTypeStream != memory_socket->type) {
+    errno = ENOTCONN;
+    return -1;
+  }
+  *peer_address = memory_socket->peer_address;
+  return 0;
+}
+
+int ReceiveFromMemoryTransport(int socket_handle, EipUint8 *buffer,
+                               size_t buffer_size,
+                               struct sockaddr_in *from_address,
+                               MicroSeconds *receive_time) {
+  MemoryDatagramHeader header;
+
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (kMemorySocketTypeDatagram != memory_socket->type) {
+    errno = EOPNOTSUPP;
+    return -1;
+  }
+  if (0 == memory_socket->queue.length) {
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  ReadFromMemoryQueue(&memory_socket->queue, &header, sizeof(header));
+  size_t copied_length =
+      (header.length < buffer_size) ? header.length : buffer_size;
+  ReadFromMemoryQueue(&memory_socket->queue, buffer, copied_length);
+  /* like UDP the rest of a datagram too large for the buffer is lost */
+  ReadFromMemoryQueue(&memory_socket->queue, NULL,
+                      header.length - copied_length);
+
+  *from_address = header.from_address;
+  if (NULL != receive_time) {
+    *receive_time = header.receive_time;
+  }
+  return (int) copied_length;
+}
+
+long ReceiveMemoryTransport(int socket_handle, EipUint8 *buffer,
+                            size_t buffer_size) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (kMemorySocketTypeDatagram == memory_socket->type) {
+    struct sockaddr_in from_address;
+    return ReceiveFromMemoryTransport(socket_handle, buffer, buffer_size,
+                                      &from_address, NULL);
+  }
+  if (kMemorySocketTypeStream != memory_socket->type) {
+    errno = ENOTCONN;
+    return -1;
+  }
+  if (0 == memory_socket->queue.length) {
+    if (kEipInvalidSocket == memory_socket->peer_socket) {
+      return 0; /* the peer closed the connection */
+    }
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  if (buffer_size > memory_socket->queue.length) {
+    buffer_size = memory_socket->queue.length;
+  }
+  ReadFromMemoryQueue(&memory_socket->queue, buffer, buffer_size);
+  return (long) buffer_size;
+}
+
+long SendNonBlockingMemoryTransport(int socket_handle, const EipUint8 *data,
+                                    size_t data_length) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (kMemorySocketTypeStream != memory_socket->type) {
+    errno = ENOTCONN;
+    return -1;
+  }
+  MemorySocket *peer = GetMemorySocket(memory_socket->peer_socket);
+  if (NULL == peer) {
+    errno = EPIPE;
+    return -1;
+  }
+  size_t free_space = OPENER_MEMORY_TRANSPORT_QUEUE_SIZE - peer->queue.length;
+  if (0 == free_space) {
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  if (data_length > free_space) {
+    data_length = free_space;
+  }
+  WriteToMemoryQueue(&peer->queue, data, data_length);
+  g_memory_transport_statistics.stream_bytes_sent += data_length;
+  return (long) data_length;
+}
+
+int SendToMemoryTransport(int socket_handle, const EipUint8 *data,
+                          size_t data_length,
+                          const struct sockaddr_in *to_address) {
+  MemorySocket *any_address_receiver = NULL;
+  int number_of_receivers = 0;
+
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return -1;
+  }
+  if (kMemorySocketTypeDatagram != memory_socket->type) {
+    errno = EOPNOTSUPP;
+    return -1;
+  }
+  if (!memory_socket->bound) { /* bind implicitly like the kernel */
+    memory_socket->local_address.sin_family = AF_INET;
+    memory_socket->local_address.sin_addr.s_addr = htonl(INADDR_ANY);
+    memory_socket->local_address.sin_port = htons(
+        OPENER_MEMORY_TRANSPORT_EPHEMERAL_PORT
+            + (memory_socket - g_memory_sockets));
+    memory_socket->bound = 1;
+  }
+
+  EipUint32 destination = ntohl(to_address->sin_addr.s_addr);
+  int is_group_address = (INADDR_BROADCAST == destination)
+      || (0xE0000000UL == (destination & 0xF0000000UL)); /* multicast */
+
+  for (int i = 0; i < g_memory_sockets_in_use; i++) {
+    MemorySocket *receiver = &g_memory_sockets[i];
+    if ((kMemorySocketTypeDatagram != receiver->type) || (!receiver->bound)
+        || (to_address->sin_port != receiver->local_address.sin_port)) {
+      continue;
+    }
+    if (to_address->sin_addr.s_addr == receiver->local_address.sin_addr.s_addr) {
+      DeliverMemoryDatagram(receiver, data, data_length,
+                            &memory_socket->local_address);
+      if (!is_group_address) {
+        return (int) data_length;
+      }
+      number_of_receivers++;
+    } else if (htonl(INADDR_ANY) == receiver->local_address.sin_addr.s_addr) {
+      if (is_group_address) {
+        DeliverMemoryDatagram(receiver, data, data_length,
+                              &memory_socket->local_address);
+        number_of_receivers++;
+      } else if (NULL == any_address_receiver) {
+        any_address_receiver = receiver;
+      }
+    }
+  }
+
+  if (NULL != any_address_receiver) {
+    DeliverMemoryDatagram(any_address_receiver, data, data_length,
+                          &memory_socket->local_address);
+  } else if (0 == number_of_receivers) {
+    /* nobody listens, the datagram is lost as on a real network */
+    g_memory_transport_statistics.datagrams_dropped++;
+  }
+  return (int) data_length;
+}
+
+int SetNonBlockingMemoryTransport(int socket_handle) {
+  /* the sockets never block */
+  return (NULL != GetMemorySocket(socket_handle)) ? 0 : -1;
+}
+
+int AddSocketMemoryTransport(int socket_handle) {
+  /* readiness is taken from the queues */
+  return (NULL != GetMemorySocket(socket_handle)) ? 0 : -1;
+}
+
+void ModifySocketMemoryTransport(int socket_handle, int events) {
+  (void) socket_handle;
+  (void) events;
+}
+
+void RemoveSocketMemoryTransport(int socket_handle) {
+  (void) socket_handle;
+}
+
+int WaitForReadySocketsMemoryTransport(const SocketEvents *monitored_sockets,
+                                       int number_of_monitored_sockets,
+                                       SocketEvents *ready_sockets,
+                                       struct timeval *timeout) {
+  int number_of_ready_sockets = 0;
+
+  (void) timeout; /* nothing can arrive while waiting, the simulation sends */
+  for (int i = 0; i < number_of_monitored_sockets; i++) {
+    MemorySocket *memory_socket = GetMemorySocket(
+        monitored_sockets[i].socket_handle);
+    if (NULL == memory_socket) {
+      continue;
+    }
+    int events = 0;
+    if ((monitored_sockets[i].events & kSocketEventReadable)
+        && IsMemorySocketReadable(memory_socket)) {
+      events |= kSocketEventReadable;
+    }
+    if ((monitored_sockets[i].events & kSocketEventWritable)
+        && IsMemorySocketWritable(memory_socket)) {
+      events |= kSocketEventWritable;
+    }
+    if (0 != events) {
+      ready_sockets[number_of_ready_sockets].socket_handle =
+          monitored_sockets[i].socket_handle;
+      ready_sockets[number_of_ready_sockets].events = events;
+      number_of_ready_sockets++;
+    }
+  }
+  return number_of_ready_sockets;
+}
+
+void CloseSocketMemoryTransport(int socket_handle) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  if (NULL == memory_socket) {
+    return;
+  }
+  if (kMemorySocketTypeListener == memory_socket->type) {
+    /* refuse the connections not yet accepted */
+    for (int i = 0; i < g_memory_sockets_in_use; i++) {
+      if ((kMemorySocketTypeStream == g_memory_sockets[i].type)
+          && (socket_handle == g_memory_sockets[i].listener)) {
+        CloseSocketMemoryTransport(i + OPENER_MEMORY_TRANSPORT_FIRST_SOCKET);
+      }
+    }
+  }
+  MemorySocket *listener = GetMemorySocket(memory_socket->listener);
+  if (NULL != listener) { /* closed before being accepted */
+    listener->pending_connections--;
+  }
+  MemorySocket *peer = GetMemorySocket(memory_socket->peer_socket);
+  if (NULL != peer) {
+    peer->peer_socket = kEipInvalidSocket; /* the peer reads the end of stream */
+  }
+  free(memory_socket->queue.data);
+  memset(memory_socket, 0, sizeof(MemorySocket));
+  while ((0 < g_memory_sockets_in_use)
+      && (kMemorySocketTypeUnused
+          == g_memory_sockets[g_memory_sockets_in_use - 1].type)) {
+    g_memory_sockets_in_use--;
+  }
+}
+
+int MemoryTransportConnect(const struct sockaddr_in *originator_address,
+                           const struct sockaddr_in *target_address) {
+  int listener_handle = kEipInvalidSocket;
+
+  for (int i = 0; i < g_memory_sockets_in_use; i++) {
+    MemorySocket *listener = &g_memory_sockets[i];
+    if ((kMemorySocketTypeListener == listener->type)
+        && (target_address->sin_port == listener->local_address.sin_port)
+        && ((target_address->sin_addr.s_addr
+            == listener->local_address.sin_addr.s_addr)
+            || (htonl(INADDR_ANY) == listener->local_address.sin_addr.s_addr))) {
+      listener_handle = i + OPENER_MEMORY_TRANSPORT_FIRST_SOCKET;
+      break;
+    }
+  }
+  if (kEipInvalidSocket == listener_handle) {
+    errno = ECONNREFUSED;
+    return kEipInvalidSocket;
+  }
+
+  int originator_handle = AllocateMemorySocket(kMemorySocketTypeStream);
+  if (kEipInvalidSocket == originator_handle) {
+    return kEipInvalidSocket;
+  }
+  int target_handle = AllocateMemorySocket(kMemorySocketTypeStream);
+  if (kEipInvalidSocket == target_handle) {
+    CloseSocketMemoryTransport(originator_handle);
+    return kEipInvalidSocket;
+  }
+
+  MemorySocket *originator = GetMemorySocket(originator_handle);
+  originator->bound = 1;
+  originator->local_address = *originator_address;
+  originator->peer_address = *target_address;
+  originator->peer_socket = target_handle;
+
+  MemorySocket *target = GetMemorySocket(target_handle);
+  target->bound = 1;
+  target->local_address = *target_address;
+  target->peer_address = *originator_address;
+  target->peer_socket = originator_handle;
+  target->listener = listener_handle;
+  target->connection_number = g_memory_transport_connection_number++;
+  GetMemorySocket(listener_handle)->pending_connections++;
+  return originator_handle;
+}
+
+size_t MemoryTransportGetQueuedBytes(int socket_handle) {
+  MemorySocket *memory_socket = GetMemorySocket(socket_handle);
+  return (NULL != memory_socket) ? memory_socket->queue.length : 0;
+}
+
+void MemoryTransportReset(void) {
+  for (int i = 0; i < g_memory_sockets_in_use; i++) {
+    if (kMemorySocketTypeUnused != g_memory_sockets[i].type) {
+      CloseSocketMemoryTransport(i + OPENER_MEMORY_TRANSPORT_FIRST_SOCKET);
+    }
+  }
+  free(g_memory_sockets);
+  g_memory_sockets = NULL;
+  g_memory_sockets_allocated = 0;
+  memset(&g_memory_transport_statistics, 0,
+         sizeof(g_memory_transport_statistics));
+  g_memory_transport_connection_number = 0;
+}
+
+const NetworkTransport g_memory_network_transport = {
+    .create_socket = &CreateSocketMemoryTransport,
+    .set_socket_option = &SetSocketOptionMemoryTransport,
+    .bind_socket = &BindSocketMemoryTransport,
+    .listen_socket = &ListenSocketMemoryTransport,
+    .accept_connection = &AcceptMemoryTransport,
+    .get_peer_address = &GetPeerAddressMemoryTransport,
+    .receive = &ReceiveMemoryTransport,
+    .send_non_blocking = &SendNonBlockingMemoryTransport,
+    .receive_from = &ReceiveFromMemoryTransport,
+    .send_to = &SendToMemoryTransport,
+    .set_non_blocking = &SetNonBlockingMemoryTransport,
+    .add_socket = &AddSocketMemoryTransport,
+    .modify_socket = &ModifySocketMemoryTransport,
+    .remove_socket = &RemoveSocketMemoryTransport,
+    .wait_for_ready_sockets = &WaitForReadySocketsMemoryTransport,
+    .close_socket = &CloseSocketMemoryTransport };
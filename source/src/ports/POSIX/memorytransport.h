@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_MEMORYTRANSPORT_H_
+#define OPENER_MEMORYTRANSPORT_H_
+
+/** @file memorytransport.h
+ * @brief Network transport passing the data in memory instead of the kernel
+ *
+ * Selected with SetNetworkTransport(&g_memory_network_transport) before the
+ * network handler is initialized, the stack and any number of simulated
+ * originators then exchange their data within one process:
+ *
+ *  - an originator opens an encapsulation session with MemoryTransportConnect
+ *    and uses send_non_blocking and receive of the transport on the returned
+ *    socket
+ *  - for UDP it creates and binds a datagram socket with the transport's
+ *    functions, datagrams are delivered to the socket bound to the
+ *    destination address and port, or to the one bound to INADDR_ANY;
+ *    multicast and broadcast datagrams to all of them
+ *
+ * Sending never blocks and wait_for_ready_sockets returns at once, so the
+ * simulation decides when the stack runs by calling NetworkHandlerProcessOnce.
+ * The transport is not thread safe.
+ */
+
+#include "network_transport.h"
+
+#ifndef OPENER_MEMORY_TRANSPORT_MAX_SOCKETS
+/** @brief Number of sockets of all simulated hosts
+ *
+ * The socket table grows on demand up to this limit. The handles never enter
+ * an fd_set, so the limit is not bound to FD_SETSIZE; it is the size of the
+ * ephemeral port range, giving each socket sending without being bound its
+ * own port.
+ */
+#define OPENER_MEMORY_TRANSPORT_MAX_SOCKETS 16384
+#endif
+
+#ifndef OPENER_MEMORY_TRANSPORT_QUEUE_SIZE
+/** @brief Receive queue of a socket in bytes
+ *
+ * A stream socket whose peer's queue is full reports
+ * OPENER_SOCKET_WOULD_BLOCK, datagrams not fitting into the queue are dropped.
+ */
+#define OPENER_MEMORY_TRANSPORT_QUEUE_SIZE 32768
+#endif
+
+/** @brief Counters of the memory transport */
+typedef struct {
+  EipUint32 datagrams_delivered; /**< datagrams queued at a receiving socket */
+  EipUint32 datagrams_dropped; /**< datagrams without receiver or queue space */
+  EipUint32 stream_bytes_sent; /**< bytes queued at the peer of a stream */
+} MemoryTransportStatistics;
+
+extern MemoryTransportStatistics g_memory_transport_statistics;
+
+/** @brief Transport exchanging the data between sockets of this process */
+extern const NetworkTransport g_memory_network_transport;
+
+/** @brief Open a stream connection to a listening socket
+ *
+ * The connection is ready at once, the listener reports it as readable until
+ * it is accepted.
+ *
+ * @param originator_address Address of the simulated originator, reported as
+ * peer address to the accepting side
+ * @param target_address Address of the listening socket
+ * @return the originator's socket, -1 on error
+ */
+int MemoryTransportConnect(const struct sockaddr_in *originator_address,
+                           const struct sockaddr_in *target_address);
+
+/** @brief Get the number of bytes waiting in a socket's receive queue
+ *
+ * For datagram sockets the queue also holds the sender addresses.
+ *
+ * @param socket_handle The socket
+ * @return number of queued bytes, 0 for invalid sockets
+ */
+size_t MemoryTransportGetQueuedBytes(int socket_handle);
+
+/** @brief Close all sockets and clear the counters */
+void MemoryTransportReset(void);
+
+#endif /* OPENER_MEMORYTRANSPORT_H_ */
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+#include "netdevcounters.h"
+
+#include "cipethernetlink.h"
+#include "ciptcpipinterface.h"
+#include "networkhandler.h"
+#include "trace.h"
+#include "opener_stack.h"
+
+/** @brief Look up the interface carrying the configured IP address
+ *
+ * @return 1 if the interface was found, 0 otherwise
+ */
+int FindNetdevInterface(void);
+
+/** @brief Read a numeric attribute of the interface from sysfs
+ *
+ * @param attribute path of the attribute relative to the interface's
+ * directory, e.g., "statistics/rx_bytes"
+ * @param value set to the value read
+ * @return 1 on success, 0 if the attribute could not be read
+ */
+int ReadNetdevValue(const char *attribute, long long *value);
+
+/** @brief Read a statistics counter of the interface, truncated to an UDINT
+ *
+ * @param counter name of the counter in the statistics directory
+ * @return the counter, 0 if it is not provided by the interface
+ */
+CipUdint ReadNetdevCounter(const char *counter);
+
+int FindNetdevInterface(void) {
+  struct ifaddrs *interfaces = NULL;
+  int found = 0;
+
+  if (0 != getifaddrs(&interfaces)) {
+    return 0;
+  }
+  for (struct ifaddrs *entry = interfaces; NULL != entry;
+      entry = entry->ifa_next) {
+    if ((NULL != entry->ifa_addr) && (AF_INET == entry->ifa_addr->sa_family)
+        && (g_opener_stack->interface_configuration.ip_address
+            == ((struct sockaddr_in *) entry->ifa_addr)->sin_addr.s_addr)) {
+      strncpy(g_opener_stack->platform.netdev_interface_name, entry->ifa_name,
+              sizeof(g_opener_stack->platform.netdev_interface_name) - 1);
+      g_opener_stack->platform.netdev_interface_name[
+          sizeof(g_opener_stack->platform.netdev_interface_name) - 1] = '\0';
+      found = 1;
+      break;
+    }
+  }
+  freeifaddrs(interfaces);
+  return found;
+}
+
+int ReadNetdevValue(const char *attribute, long long *value) {
+  char path[96];
+  int success = 0;
+
+  snprintf(path, sizeof(path), "/sys/class/net/%s/%s",
+           g_opener_stack->platform.netdev_interface_name, attribute);
+  FILE *file = fopen(path, "r");
+  if (NULL == file) {
+    return 0;
+  }
+  success = (1 == fscanf(file, "%lld", value));
+  fclose(file);
+  return success;
+}
+
+CipUdint ReadNetdevCounter(const char *counter) {
+  char attribute[48];
+  long long value = 0;
+
+  snprintf(attribute, sizeof(attribute), "statistics/%s", counter);
+  if (!ReadNetdevValue(attribute, &value)) {
+    return 0;
+  }
+  /* the CIP counters are UDINTs wrapping around */
+  return (CipUdint) value;
+}
+
+void RefreshNetdevCounters(void) {
+  MicroSeconds now = GetMicroSeconds();
+  CipEthernetLinkInterfaceCounters interface_counters;
+  CipEthernetLinkMediaCounters media_counters;
+  long long value = 0;
+
+  if (kNetdevInterfaceUnavailable == g_opener_stack->platform.netdev_interface_state) {
+    return;
+  }
+  if (kNetdevInterfaceUnknown == g_opener_stack->platform.netdev_interface_state) {
+    if (!FindNetdevInterface()
+        || !ReadNetdevValue("statistics/rx_bytes", &value)) {
+      OPENER_TRACE_WARN(
+          "netdev: no statistics of the interface found, Ethernet Link counters not available\n");
+      g_opener_stack->platform.netdev_interface_state = kNetdevInterfaceUnavailable;
+      return;
+    }
+    OPENER_TRACE_INFO("netdev: Ethernet Link object reports interface %s\n",
+                      g_opener_stack->platform.netdev_interface_name);
+    g_opener_stack->platform.netdev_interface_state = kNetdevInterfaceFound;
+  } else if (now - g_opener_stack->platform.netdev_last_refresh
+      < OPENER_NETDEV_REFRESH_INTERVAL) {
+    return;
+  }
+  g_opener_stack->platform.netdev_last_refresh = now;
+
+  /* speed 0 means indeterminate, e.g., for virtual interfaces */
+  long long speed = 0;
+  if (!ReadNetdevValue("speed", &speed) || (0 > speed)) {
+    speed = 0;
+  }
+  long long carrier = 0;
+  EipBool8 link_active =
+      (ReadNetdevValue("carrier", &carrier) && (1 == carrier)) ? true : false;
+  EipBool8 full_duplex = false;
+  char path[96];
+  char duplex[8] = "";
+  snprintf(path, sizeof(path), "/sys/class/net/%s/duplex",
+           g_opener_stack->platform.netdev_interface_name);
+  FILE *file = fopen(path, "r");
+  if (NULL != file) {
+    if ((1 == fscanf(file, "%7s", duplex)) && (0 == strcmp(duplex, "full"))) {
+      full_duplex = true;
+    }
+    fclose(file);
+  }
+  SetEthernetLinkState((EipUint32) speed, link_active, full_duplex);
+
+  /* Linux counts broadcasts neither separately nor as multicasts */
+  CipUdint received_packets = ReadNetdevCounter("rx_packets");
+  interface_counters.in_octets = ReadNetdevCounter("rx_bytes");
+  interface_counters.in_nucast_packets = ReadNetdevCounter("multicast");
+  interface_counters.in_ucast_packets = received_packets
+      - interface_counters.in_nucast_packets;
+  interface_counters.in_discards = ReadNetdevCounter("rx_dropped");
+  interface_counters.in_errors = ReadNetdevCounter("rx_errors");
+  interface_counters.in_unknown_protos = ReadNetdevCounter("rx_nohandler");
+  interface_counters.out_octets = ReadNetdevCounter("tx_bytes");
+  interface_counters.out_ucast_packets = ReadNetdevCounter("tx_packets");
+  interface_counters.out_nucast_packets = 0;
+  interface_counters.out_discards = ReadNetdevCounter("tx_dropped");
+  interface_counters.out_errors = ReadNetdevCounter("tx_errors");
+
+  /* counters without an equivalent in the Linux statistics stay 0 */
+  memset(&media_counters, 0, sizeof(media_counters));
+  media_counters.alignment_errors = ReadNetdevCounter("rx_frame_errors");
+  media_counters.fcs_errors = ReadNetdevCounter("rx_crc_errors");
+  media_counters.late_collisions = ReadNetdevCounter("tx_window_errors");
+  media_counters.excessive_collisions = ReadNetdevCounter("tx_aborted_errors");
+  media_counters.mac_transmit_errors = ReadNetdevCounter("tx_fifo_errors");
+  media_counters.carrier_sense_errors = ReadNetdevCounter("tx_carrier_errors");
+  media_counters.frame_too_long = ReadNetdevCounter("rx_length_errors");
+  media_counters.mac_receive_errors = ReadNetdevCounter("rx_fifo_errors");
+
+  SetEthernetLinkCounters(&interface_counters, &media_counters);
+}
@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_NETDEVCOUNTERS_H_
+#define OPENER_NETDEVCOUNTERS_H_
+
+/** @file netdevcounters.h
+ * @brief Feeds the Ethernet Link object with the state and the statistics of
+ * the host's network interface
+ *
+ * The interface carrying the configured IP address is looked up once, its
+ * link state and counters are then read from /sys/class/net every
+ * OPENER_NETDEV_REFRESH_INTERVAL and handed to the Ethernet Link object,
+ * which answers requests from these cached values.
+ */
+
+/** @brief States of the lookup of the interface */
+typedef enum {
+  kNetdevInterfaceUnknown = 0, /**< not looked up yet */
+  kNetdevInterfaceFound,
+  kNetdevInterfaceUnavailable /**< no interface or statistics found */
+} NetdevInterfaceState;
+
+/** @brief Time between two reads of the interface statistics in us */
+#define OPENER_NETDEV_REFRESH_INTERVAL 1000000
+
+/** @brief Refresh the Ethernet Link object if the refresh interval elapsed
+ *
+ * If the interface or its statistics are not found, e.g., on systems without
+ * sysfs, the Ethernet Link object keeps its initial values.
+ */
+void RefreshNetdevCounters(void);
+
+#endif /* OPENER_NETDEVCOUNTERS_H_ */
@@ -4,12 +4,45 @@
  *
  ******************************************************************************/
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/time.h>
 #include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#ifdef OPENER_POSIX_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include "networkhandler.h"
 
 #include "encap.h"
+#include "opener_stack.h"
+#include "opener_error.h"
+#include "trace.h"
+
+#if defined(SO_TIMESTAMPNS) && !defined(SCM_TIMESTAMPNS)
+/* not all C libraries export the control message type, it equals the option */
+#define SCM_TIMESTAMPNS SO_TIMESTAMPNS
+#endif
+
+#ifdef OPENER_POSIX_USE_EPOLL
+/** @brief Maximum number of events fetched with one call of epoll_wait */
+#define OPENER_EPOLL_MAX_EVENTS 32
+
+/** @brief Register a socket at the epoll instance or change its events
+ *
+ *  The monitored SocketEvent flags are kept in the upper half of the event
+ *  data, so that errors and hang ups are reported for these events only.
+ *
+ *  @param operation EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ *  @param socket_handle The socket
+ *  @param events Combination of SocketEvent flags
+ *  @return 0 on success, -1 on error
+ */
+int ControlEpollSocket(int operation, int socket_handle, int events);
+#endif
 
 MicroSeconds GetMicroSeconds(void) {
   struct timespec now;
@@ -24,12 +57,224 @@ MilliSeconds GetMilliSeconds(void) {
 }
 
 EipStatus NetworkHandlerInitializePlatform(void) {
-  /* Add platform dependent code here if necessary */
+#ifdef OPENER_POSIX_USE_EPOLL
+  g_opener_stack->platform.epoll_file_descriptor = epoll_create1(
+      EPOLL_CLOEXEC);
+  if (-1 == g_opener_stack->platform.epoll_file_descriptor) {
+    int error_code = GetSocketErrorNumber();
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: error creating epoll instance: %d - %s\n",
+                     error_code, error_message);
+    free(error_message);
+    return kEipStatusError;
+  }
+#endif
   return kEipStatusOk;
 }
 
+void NetworkHandlerFinishPlatform(void) {
+#ifdef OPENER_POSIX_USE_EPOLL
+  close(g_opener_stack->platform.epoll_file_descriptor);
+  /* connection sockets closed later on are not removed from it anymore */
+  g_opener_stack->platform.epoll_file_descriptor = -1;
+#endif
+}
+
 
 void CloseSocketPlatform(int socket_handle) {
     shutdown(socket_handle, SHUT_RDWR);
+    /* closing the socket also removes it from the epoll instance */
     close(socket_handle);
 }
+
+int SetSocketToNonBlockingPlatform(int socket_handle) {
+  int flags = fcntl(socket_handle, F_GETFL);
+  if (-1 == flags) {
+    return -1;
+  }
+  return fcntl(socket_handle, F_SETFL, flags | O_NONBLOCK);
+}
+
+#ifdef OPENER_POSIX_USE_EPOLL
+int ControlEpollSocket(int operation, int socket_handle, int events) {
+  struct epoll_event event = { .events = 0, .data.u64 = ((uint64_t) events
+      << 32) | (uint32_t) socket_handle };
+
+  if (events & kSocketEventReadable) {
+    event.events |= EPOLLIN;
+  }
+  if (events & kSocketEventWritable) {
+    event.events |= EPOLLOUT;
+  }
+  if (-1 == epoll_ctl(g_opener_stack->platform.epoll_file_descriptor,
+                      operation, socket_handle, &event)) {
+    int error_code = GetSocketErrorNumber();
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: error registering socket %d at epoll: %d - %s\n",
+                     socket_handle, error_code, error_message);
+    free(error_message);
+    return -1;
+  }
+  return 0;
+}
+#endif
+
+int AddSocketPlatform(int socket_handle) {
+#ifdef OPENER_POSIX_USE_EPOLL
+  return ControlEpollSocket(EPOLL_CTL_ADD, socket_handle, kSocketEventReadable);
+#else
+  /* select gets the monitored sockets on each call, but an fd_set only holds
+   the descriptors below FD_SETSIZE */
+  if (FD_SETSIZE <= socket_handle) {
+    OPENER_TRACE_ERR("networkhandler: socket %d exceeds FD_SETSIZE %d\n",
+                     socket_handle, FD_SETSIZE);
+    errno = EMFILE;
+    return -1;
+  }
+  return 0;
+#endif
+}
+
+void ModifySocketPlatform(int socket_handle, int events) {
+#ifdef OPENER_POSIX_USE_EPOLL
+  ControlEpollSocket(EPOLL_CTL_MOD, socket_handle, events);
+#else
+  (void) socket_handle;
+  (void) events;
+#endif
+}
+
+void RemoveSocketPlatform(int socket_handle) {
+#ifdef OPENER_POSIX_USE_EPOLL
+  if ((-1 != g_opener_stack->platform.epoll_file_descriptor)
+      && (-1 == epoll_ctl(g_opener_stack->platform.epoll_file_descriptor,
+                      EPOLL_CTL_DEL, socket_handle, NULL))) {
+    int error_code = GetSocketErrorNumber();
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR(
+        "networkhandler: error removing socket %d from epoll: %d - %s\n",
+        socket_handle, error_code, error_message);
+    free(error_message);
+  }
+#else
+  (void) socket_handle;
+#endif
+}
+
+int WaitForReadySocketsPlatform(const SocketEvents *monitored_sockets,
+                                int number_of_monitored_sockets,
+                                SocketEvents *ready_sockets,
+                                struct timeval *timeout) {
+#ifdef OPENER_POSIX_USE_EPOLL
+  struct epoll_event events[OPENER_EPOLL_MAX_EVENTS];
+  int max_events = (number_of_monitored_sockets < OPENER_EPOLL_MAX_EVENTS) ?
+      number_of_monitored_sockets : OPENER_EPOLL_MAX_EVENTS;
+  /* round up, a truncated timeout would make the loop spin */
+  int timeout_in_milli_seconds = timeout->tv_sec * 1000
+      + (timeout->tv_usec + 999) / 1000;
+  (void) monitored_sockets; /* the epoll instance knows the sockets */
+
+  int number_of_events = epoll_wait(
+      g_opener_stack->platform.epoll_file_descriptor, events, max_events,
+      timeout_in_milli_seconds);
+
+  for (int i = 0; i < number_of_events; i++) {
+    int monitored_events = (int) (events[i].data.u64 >> 32);
+    ready_sockets[i].socket_handle = (int) (uint32_t) events[i].data.u64;
+    ready_sockets[i].events = 0;
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      ready_sockets[i].events |= kSocketEventReadable;
+    }
+    if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+      ready_sockets[i].events |= kSocketEventWritable;
+    }
+    ready_sockets[i].events &= monitored_events;
+  }
+  return number_of_events;
+#else
+  fd_set read_set;
+  fd_set write_set;
+  int highest_socket_handle = -1;
+
+  FD_ZERO(&read_set);
+  FD_ZERO(&write_set);
+  for (int i = 0; i < number_of_monitored_sockets; i++) {
+    if (monitored_sockets[i].events & kSocketEventReadable) {
+      FD_SET(monitored_sockets[i].socket_handle, &read_set);
+    }
+    if (monitored_sockets[i].events & kSocketEventWritable) {
+      FD_SET(monitored_sockets[i].socket_handle, &write_set);
+    }
+    if (monitored_sockets[i].socket_handle > highest_socket_handle) {
+      highest_socket_handle = monitored_sockets[i].socket_handle;
+    }
+  }
+
+  int number_of_ready_sockets = select(highest_socket_handle + 1, &read_set,
+                                       &write_set, NULL, timeout);
+  if (number_of_ready_sockets <= 0) {
+    return number_of_ready_sockets;
+  }
+
+  number_of_ready_sockets = 0;
+  for (int i = 0; i < number_of_monitored_sockets; i++) {
+    int socket_handle = monitored_sockets[i].socket_handle;
+    int events = (FD_ISSET(socket_handle, &read_set) ? kSocketEventReadable : 0)
+        | (FD_ISSET(socket_handle, &write_set) ? kSocketEventWritable : 0);
+    if (0 != events) {
+      ready_sockets[number_of_ready_sockets].socket_handle = socket_handle;
+      ready_sockets[number_of_ready_sockets].events = events;
+      number_of_ready_sockets++;
+    }
+  }
+  return number_of_ready_sockets;
+#endif
+}
+
+int ReceiveFromSocketPlatform(int socket_handle, EipUint8 *buffer,
+                              size_t buffer_size,
+                              struct sockaddr_in *from_address,
+                              MicroSeconds *receive_time) {
+#ifdef SO_TIMESTAMPNS
+  struct iovec io_vector = { .iov_base = buffer, .iov_len = buffer_size };
+  union {
+    char buffer[CMSG_SPACE(sizeof(struct timespec))];
+    struct cmsghdr align;
+  } control;
+  struct msghdr message = { .msg_name = from_address, .msg_namelen =
+      sizeof(struct sockaddr_in), .msg_iov = &io_vector, .msg_iovlen = 1,
+      .msg_control = control.buffer, .msg_controllen = sizeof(control.buffer) };
+
+  int received_size = recvmsg(socket_handle, &message, 0);
+  if (received_size < 0) {
+    return received_size;
+  }
+
+  for (struct cmsghdr *control_message = CMSG_FIRSTHDR(&message);
+      NULL != control_message;
+      control_message = CMSG_NXTHDR(&message, control_message)) {
+    if ((SOL_SOCKET == control_message->cmsg_level)
+        && (SCM_TIMESTAMPNS == control_message->cmsg_type)) {
+      struct timespec kernel_time;
+      memcpy(&kernel_time, CMSG_DATA(control_message), sizeof(kernel_time));
+      *receive_time = (MicroSeconds) kernel_time.tv_nsec / 1000ULL
+          + kernel_time.tv_sec * 1000000ULL;
+      return received_size;
+    }
+  }
+
+  /* no kernel timestamp, take the current time from the same clock */
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  *receive_time = (MicroSeconds) now.tv_nsec / 1000ULL
+      + now.tv_sec * 1000000ULL;
+  return received_size;
+#else
+  socklen_t from_address_length = sizeof(struct sockaddr_in);
+  int received_size = recvfrom(socket_handle, buffer, buffer_size, 0,
+                               (struct sockaddr *) from_address,
+                               &from_address_length);
+  *receive_time = GetMicroSeconds();
+  return received_size;
+#endif
+}
@@ -8,13 +8,114 @@
 
 #include <string.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <net/if.h>
+
+#include <errno.h>
 
 #include "typedefs.h"
+#include "netdevcounters.h"
+
+/** @brief Flags for sending on TCP sockets without blocking the stack
+ *
+ *  The TCP sockets are non-blocking anyway, MSG_NOSIGNAL avoids a SIGPIPE if
+ *  the client has already closed the connection.
+ */
+#define OPENER_NON_BLOCKING_SEND_FLAGS (MSG_DONTWAIT | MSG_NOSIGNAL)
+
+/** @brief Error number indicating that the socket cannot take more data */
+#define OPENER_SOCKET_WOULD_BLOCK EWOULDBLOCK
+
+/** @brief State of the POSIX network handler kept per stack, see OpenerStack
+ */
+typedef struct {
+#ifdef OPENER_POSIX_USE_EPOLL
+  int epoll_file_descriptor; /**< epoll instance monitoring the sockets of the master set */
+#endif
+  char netdev_interface_name[IF_NAMESIZE]; /**< interface carrying the configured IP address */
+  NetdevInterfaceState netdev_interface_state;
+  MicroSeconds netdev_last_refresh; /**< time of the last refresh in us */
+} NetworkHandlerPlatformState;
 
 EipStatus NetworkHandlerInitializePlatform(void);
 
+/** @brief Release the resources of NetworkHandlerInitializePlatform */
+void NetworkHandlerFinishPlatform(void);
+
 void CloseSocketPlatform(int socket_handle);
 
+/** @brief Register a socket at the platform's readiness notification
+ *
+ *  Has to be called for every socket monitored by the network handler, so
+ *  that the platform can report incoming data on it. The select backend
+ *  refuses descriptors of FD_SETSIZE and above, as select can not wait for
+ *  them.
+ *
+ *  @param socket_handle The socket to be monitored
+ *  @return 0 on success, -1 if the socket can not be monitored
+ */
+int AddSocketPlatform(int socket_handle);
+
+/** @brief Change the events a monitored socket is reported for
+ *
+ *  @param socket_handle The monitored socket
+ *  @param events Combination of SocketEvent flags
+ */
+void ModifySocketPlatform(int socket_handle, int events);
+
+/** @brief Switch a socket to non-blocking mode
+ *
+ *  @param socket_handle The socket
+ *  @return 0 on success, -1 on error
+ */
+int SetSocketToNonBlockingPlatform(int socket_handle);
+
+/** @brief Stop monitoring a socket without closing it
+ *
+ *  @param socket_handle The socket not to be monitored any longer
+ */
+void RemoveSocketPlatform(int socket_handle);
+
+/** @brief Wait until events occur on the monitored sockets
+ *
+ *  Depending on the build configuration this is done with select() or with
+ *  epoll (OpENer_POSIX_EPOLL). The epoll backend takes the ready sockets
+ *  directly from the returned events and does not use monitored_sockets, it
+ *  relies on AddSocketPlatform, ModifySocketPlatform and RemoveSocketPlatform
+ *  instead.
+ *
+ *  @param monitored_sockets The sockets of the stack and their events
+ *  @param number_of_monitored_sockets Number of entries of monitored_sockets
+ *  @param ready_sockets Will hold the sockets on which events occurred, needs
+ *  room for number_of_monitored_sockets entries
+ *  @param timeout Maximum time to wait
+ *  @return Number of entries of ready_sockets, 0 on timeout, -1 on error
+ */
+int WaitForReadySocketsPlatform(const SocketEvents *monitored_sockets,
+                                int number_of_monitored_sockets,
+                                SocketEvents *ready_sockets,
+                                struct timeval *timeout);
+
+/** @brief Receive a datagram together with its time of arrival
+ *
+ *  If the socket has kernel receive timestamps enabled (SO_TIMESTAMPNS) the
+ *  timestamp taken by the kernel is returned, otherwise the time the datagram
+ *  has been read. The receive times of one socket are always taken from the
+ *  same clock and are therefore only meaningful relative to each other.
+ *
+ *  @param socket_handle The socket to read from
+ *  @param buffer Buffer for the received data
+ *  @param buffer_size Size of the buffer in bytes
+ *  @param from_address Will hold the sender's address
+ *  @param receive_time Will hold the time of arrival of the datagram
+ *  @return Number of bytes received, -1 on error
+ */
+int ReceiveFromSocketPlatform(int socket_handle, EipUint8 *buffer,
+                              size_t buffer_size,
+                              struct sockaddr_in *from_address,
+                              MicroSeconds *receive_time);
+
 /** @brief This function shall return the current time in microseconds relative to epoch, and shall be implemented in a port specific networkhandler
  *
  *  @return Current time relative to epoch as MicroSeconds
@@ -0,0 +1,1020 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "generic_networkhandler.h"
+#include "opener_api.h"
+#include "cipcommon.h"
+#include "cipstatistics.h"
+#include "encap.h"
+#include "cpf.h"
+#include "trace.h"
+#include "opener_stack.h"
+
+/** @file pcapreplay.c
+ * @brief Replays a capture of EtherNet/IP traffic into the stack without
+ * sockets
+ *
+ * Usage: opener_pcap_replay [-a adapter address] [-r] [-w output capture]
+ *                           capture
+ *
+ * The capture is read in the libpcap file format, with Ethernet, Linux cooked,
+ * raw IPv4 or BSD loopback link layer. Packets to the adapter are injected
+ * into the stack:
+ * - TCP payloads to the encapsulation port are reassembled per connection and
+ *   passed message by message to HandleReceivedExplictTcpData
+ * - UDP datagrams to the encapsulation port are passed to
+ *   HandleReceivedExplictUdpData
+ * - UDP datagrams to the I/O port are passed to HandleReceivedConnectedData
+ *
+ * The adapter address is taken from the first TCP segment to the encapsulation
+ * port unless given with -a.
+ *
+ * The replayed stack assigns other O->T connection IDs than the adapter of the
+ * capture. The IDs of the Forward_Open replies in the capture and of the
+ * replies of the stack are matched by the connection triad, and the IDs of
+ * the replayed I/O data are translated. The captured replies are expected to
+ * be in single TCP segments.
+ *
+ * This file takes the place of the network handler: CreateUdpSocket,
+ * SendUdpData, the socket close callbacks and GetMicroSeconds are implemented
+ * here. Everything the stack sends, including the TCP replies, is written to
+ * the output capture as raw IPv4 frames. The time of the stack is the capture
+ * time, and ManageConnections is called every kOpenerTimerTickInMilliSeconds
+ * of capture time. With -r the replay waits for the original times between
+ * the packets, otherwise it runs as fast as possible.
+ */
+
+/** @brief UDP port of the I/O data, see kOpenerEipIoUdpPort */
+#define REPLAY_IO_PORT 0x08AE
+
+#define REPLAY_MAX_PACKET_SIZE 65535
+#define REPLAY_MAX_TCP_FLOWS 32
+#define REPLAY_MAX_CONNECTION_IDS 64
+
+/** @brief Bytes a TCP flow can buffer for an incomplete message */
+#define REPLAY_FLOW_BUFFER_SIZE (2 * PC_OPENER_ETHERNET_BUFFER_SIZE)
+
+/** @brief Socket handles handed to the stack, no real sockets */
+#define REPLAY_UDP_EXPLICIT_SOCKET 999
+#define REPLAY_FIRST_TCP_SOCKET 1000
+#define REPLAY_FIRST_UDP_SOCKET 2000
+
+#define PCAP_MAGIC 0xA1B2C3D4U
+#define PCAP_MAGIC_NANOSECONDS 0xA1B23C4DU
+#define PCAP_LINK_TYPE_NULL 0
+#define PCAP_LINK_TYPE_ETHERNET 1
+#define PCAP_LINK_TYPE_RAW 101
+#define PCAP_LINK_TYPE_LINUX_SLL 113
+#define PCAP_LINK_TYPE_IPV4 228
+
+#define IP_PROTOCOL_TCP 6
+#define IP_PROTOCOL_UDP 17
+
+#define TCP_FLAG_FIN 0x01
+#define TCP_FLAG_SYN 0x02
+#define TCP_FLAG_RST 0x04
+#define TCP_FLAG_PSH 0x08
+#define TCP_FLAG_ACK 0x10
+
+/** @brief A capture file being read */
+typedef struct {
+  FILE *file;
+  int swapped; /**< the file was written with the other byte order */
+  int nanoseconds; /**< time stamps have ns instead of us resolution */
+  EipUint32 link_type;
+} PcapReader;
+
+/** @brief A TCP connection to the encapsulation port */
+typedef struct {
+  int used;
+  int socket; /**< handle the stack knows the connection by */
+  struct sockaddr_in peer;
+  int synchronized; /**< next_sequence is known */
+  EipUint32 next_sequence; /**< next expected sequence number of the peer */
+  EipUint32 reply_sequence; /**< sequence number of the next reply frame */
+  size_t buffered;
+  EipUint8 buffer[REPLAY_FLOW_BUFFER_SIZE];
+} ReplayTcpFlow;
+
+/** @brief O->T connection ID of a connection in the capture and the replay */
+typedef struct {
+  EipUint16 connection_serial_number;
+  EipUint16 originator_vendor_id;
+  EipUint32 originator_serial_number;
+  EipUint32 captured_connection_id; /**< 0 until the captured reply is seen */
+  EipUint32 replayed_connection_id; /**< 0 until the stack replied */
+} ReplayConnectionId;
+
+typedef struct {
+  uint64_t packets; /**< packets read from the capture */
+  uint64_t ignored_packets; /**< packets not addressed to the adapter */
+  uint64_t tcp_messages;
+  uint64_t udp_explicit_messages;
+  uint64_t io_packets;
+  uint64_t tcp_gaps; /**< segments missing in the capture */
+  uint64_t oversized_messages; /**< messages not fitting into the buffer */
+  uint64_t frames_written; /**< frames sent by the stack */
+  MicroSeconds stack_time; /**< wall time spent in the stack */
+} ReplayStatistics;
+
+/* global private variables */
+/** @brief Current time of the stack, the capture time */
+MicroSeconds g_replay_time = 0;
+
+/** @brief Capture time of the last call of ManageConnections */
+MicroSeconds g_replay_last_tick = 0;
+
+/** @brief Set with -r, wait for the original times between the packets */
+int g_replay_real_time = 0;
+
+/** @brief Wall time and capture time the replay started at */
+MicroSeconds g_replay_wall_start = 0;
+MicroSeconds g_replay_capture_start = 0;
+
+/** @brief Address of the adapter in network byte order, 0 until known */
+in_addr_t g_replay_adapter_address = 0;
+
+/** @brief Originator of the message currently processed by the stack */
+struct sockaddr_in g_replay_peer_address;
+
+int g_replay_next_udp_socket = REPLAY_FIRST_UDP_SOCKET;
+
+/** @brief Identification of the next frame written to the output capture */
+EipUint16 g_replay_frame_identification = 0;
+
+/** @brief Output capture, NULL if the sent frames are dropped */
+FILE *g_replay_sink = NULL;
+
+ReplayTcpFlow g_replay_flows[REPLAY_MAX_TCP_FLOWS];
+
+ReplayConnectionId g_replay_connection_ids[REPLAY_MAX_CONNECTION_IDS];
+
+/** @brief Entry of g_replay_connection_ids reused next when all are used */
+int g_replay_next_connection_id = 0;
+
+ReplayStatistics g_replay_statistics;
+
+/** @brief Get the current wall time in us */
+MicroSeconds GetReplayWallTime(void);
+
+/** @brief Open a capture file and read its header
+ *
+ * @return 1 on success, 0 if the file is no supported capture
+ */
+int OpenPcapReader(PcapReader *reader, const char *file_name);
+
+/** @brief Convert a 32 bit value of the capture file to host byte order */
+EipUint32 GetPcapUint32(const PcapReader *reader, const EipUint8 *data);
+
+/** @brief Read the next packet of the capture
+ *
+ * @param reader the capture
+ * @param data buffer of REPLAY_MAX_PACKET_SIZE bytes for the packet
+ * @param length set to the captured length of the packet
+ * @param time set to the time stamp of the packet in us
+ * @return 1 if a packet was read, 0 at the end of the capture, -1 on errors
+ */
+int ReadPcapPacket(PcapReader *reader, EipUint8 *data, size_t *length,
+                   MicroSeconds *time);
+
+/** @brief Strip the link layer header of a captured packet
+ *
+ * @param link_type link layer of the capture
+ * @param data the captured packet
+ * @param length length of the packet, set to the length of the IPv4 packet
+ * @return the IPv4 packet, NULL if the packet is no IPv4 packet
+ */
+const EipUint8 *GetIpv4Packet(EipUint32 link_type, const EipUint8 *data,
+                              size_t *length);
+
+/** @brief Find the adapter address in the first TCP segment to the
+ * encapsulation port of the capture
+ */
+in_addr_t FindAdapterAddress(PcapReader *reader);
+
+/** @brief Advance the time of the stack to the time of the next packet,
+ * calling ManageConnections for every timer tick on the way
+ */
+void AdvanceReplayTime(MicroSeconds time);
+
+/** @brief Inject an IPv4 packet into the stack */
+void ReplayIpv4Packet(const EipUint8 *packet, size_t length);
+
+void ReplayTcpSegment(const struct sockaddr_in *source, const EipUint8 *segment,
+                      size_t length);
+
+void ReplayUdpDatagram(const struct sockaddr_in *source, in_addr_t destination,
+                       EipUint16 destination_port, const EipUint8 *payload,
+                       size_t length);
+
+/** @brief Pass the complete encapsulation messages buffered by a TCP flow to
+ * the stack
+ */
+void ProcessTcpFlowMessages(ReplayTcpFlow *flow);
+
+ReplayTcpFlow *GetReplayTcpFlow(const struct sockaddr_in *peer);
+
+/** @brief Record the O->T connection IDs of successful Forward_Open replies
+ *
+ * @param data encapsulation messages sent by the adapter
+ * @param length length of the messages
+ * @param replayed 1 for replies of the stack, 0 for replies of the capture
+ */
+void RecordForwardOpenReplies(const EipUint8 *data, size_t length,
+                              int replayed);
+
+/** @brief Get the ID the stack assigned to a captured O->T connection ID
+ *
+ * @return the replayed ID, the captured ID if it is unknown
+ */
+EipUint32 TranslateConnectionId(EipUint32 captured_connection_id);
+
+/** @brief Close a TCP flow, closing its session in the stack */
+void CloseReplayTcpFlow(ReplayTcpFlow *flow);
+
+/** @brief Write the header of the output capture */
+void WriteSinkHeader(void);
+
+/** @brief Write a frame sent by the stack to the output capture
+ *
+ * @param protocol IP_PROTOCOL_TCP or IP_PROTOCOL_UDP
+ * @param source_port source port in host byte order
+ * @param destination the receiver of the frame
+ * @param payload the data sent
+ * @param length length of the data
+ * @param flow the TCP flow of a TCP frame, NULL for UDP
+ */
+void WriteSinkFrame(EipUint8 protocol, EipUint16 source_port,
+                    const struct sockaddr_in *destination,
+                    const EipUint8 *payload, size_t length,
+                    ReplayTcpFlow *flow);
+
+void PrintReplayStatistics(void);
+
+int main(int argc, char *argv[]) {
+  PcapReader reader;
+  const char *adapter_address = NULL;
+  const char *output_file = NULL;
+  int option;
+
+  while (-1 != (option = getopt(argc, argv, "a:rw:"))) {
+    switch (option) {
+      case 'a':
+        adapter_address = optarg;
+        break;
+      case 'r':
+        g_replay_real_time = 1;
+        break;
+      case 'w':
+        output_file = optarg;
+        break;
+      default:
+        optind = argc + 1;
+        break;
+    }
+  }
+  if (optind + 1 != argc) {
+    printf("Usage: %s [-a adapter address] [-r] [-w output capture] "
+           "capture\n",
+           argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (!OpenPcapReader(&reader, argv[optind])) {
+    return EXIT_FAILURE;
+  }
+
+  if (NULL != adapter_address) {
+    g_replay_adapter_address = inet_addr(adapter_address);
+  } else {
+    g_replay_adapter_address = FindAdapterAddress(&reader);
+  }
+  if (0 == g_replay_adapter_address) {
+    printf("no TCP traffic to port %d in the capture, give the adapter "
+           "address with -a\n",
+           kOpenerEthernetPort);
+    return EXIT_FAILURE;
+  }
+
+  if (NULL != output_file) {
+    if (NULL == (g_replay_sink = fopen(output_file, "wb"))) {
+      perror(output_file);
+      return EXIT_FAILURE;
+    }
+    WriteSinkHeader();
+  }
+
+  struct in_addr address = { g_replay_adapter_address };
+  ConfigureNetworkInterface(inet_ntoa(address), "255.255.255.0", "0.0.0.0");
+  SetDeviceSerialNumber(123456789);
+  CipStackInit((EipUint16) rand());
+
+  EipUint8 *packet = malloc(REPLAY_MAX_PACKET_SIZE);
+  size_t length;
+  MicroSeconds time;
+  int result;
+  if (NULL == packet) {
+    return EXIT_FAILURE;
+  }
+  while (0 < (result = ReadPcapPacket(&reader, packet, &length, &time))) {
+    g_replay_statistics.packets++;
+    AdvanceReplayTime(time);
+
+    const EipUint8 *ip_packet = GetIpv4Packet(reader.link_type, packet,
+                                              &length);
+    if (NULL == ip_packet) {
+      g_replay_statistics.ignored_packets++;
+      continue;
+    }
+    MicroSeconds start = GetReplayWallTime();
+    ReplayIpv4Packet(ip_packet, length);
+    g_replay_statistics.stack_time += GetReplayWallTime() - start;
+  }
+  if (0 > result) {
+    printf("capture truncated after %llu packets\n",
+           (unsigned long long) g_replay_statistics.packets);
+  }
+
+  ShutdownCipStack();
+  PrintReplayStatistics();
+
+  free(packet);
+  fclose(reader.file);
+  if (NULL != g_replay_sink) {
+    fclose(g_replay_sink);
+  }
+  return EXIT_SUCCESS;
+}
+
+MicroSeconds GetReplayWallTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (MicroSeconds) now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+int OpenPcapReader(PcapReader *reader, const char *file_name) {
+  EipUint8 header[24];
+
+  reader->file = fopen(file_name, "rb");
+  if (NULL == reader->file) {
+    perror(file_name);
+    return 0;
+  }
+  if (sizeof(header) != fread(header, 1, sizeof(header), reader->file)) {
+    printf("%s is no capture file\n", file_name);
+    return 0;
+  }
+
+  EipUint32 magic = (EipUint32) header[0] | ((EipUint32) header[1] << 8)
+      | ((EipUint32) header[2] << 16) | ((EipUint32) header[3] << 24);
+  EipUint32 swapped_magic = (magic >> 24) | ((magic >> 8) & 0xFF00)
+      | ((magic << 8) & 0xFF0000) | (magic << 24);
+  reader->swapped = ((PCAP_MAGIC == swapped_magic)
+      || (PCAP_MAGIC_NANOSECONDS == swapped_magic));
+  reader->nanoseconds = ((PCAP_MAGIC_NANOSECONDS == magic)
+      || (PCAP_MAGIC_NANOSECONDS == swapped_magic));
+  if ((!reader->swapped) && (PCAP_MAGIC != magic)
+      && (PCAP_MAGIC_NANOSECONDS != magic)) {
+    printf("%s is no libpcap capture file, pcapng is not supported\n",
+           file_name);
+    return 0;
+  }
+
+  reader->link_type = GetPcapUint32(reader, &header[20]) & 0xFFFF;
+  switch (reader->link_type) {
+    case PCAP_LINK_TYPE_NULL:
+    case PCAP_LINK_TYPE_ETHERNET:
+    case PCAP_LINK_TYPE_RAW:
+    case PCAP_LINK_TYPE_LINUX_SLL:
+    case PCAP_LINK_TYPE_IPV4:
+      return 1;
+    default:
+      printf("link type %u of %s is not supported\n",
+             (unsigned) reader->link_type, file_name);
+      return 0;
+  }
+}
+
+EipUint32 GetPcapUint32(const PcapReader *reader, const EipUint8 *data) {
+  if (reader->swapped) {
+    return ((EipUint32) data[0] << 24) | ((EipUint32) data[1] << 16)
+        | ((EipUint32) data[2] << 8) | (EipUint32) data[3];
+  }
+  return (EipUint32) data[0] | ((EipUint32) data[1] << 8)
+      | ((EipUint32) data[2] << 16) | ((EipUint32) data[3] << 24);
+}
+
+int ReadPcapPacket(PcapReader *reader, EipUint8 *data, size_t *length,
+                   MicroSeconds *time) {
+  EipUint8 header[16];
+
+  size_t read_length = fread(header, 1, sizeof(header), reader->file);
+  if (0 == read_length) {
+    return 0;
+  }
+  if (sizeof(header) != read_length) {
+    return -1;
+  }
+  EipUint32 captured_length = GetPcapUint32(reader, &header[8]);
+  if (REPLAY_MAX_PACKET_SIZE < captured_length) {
+    return -1;
+  }
+  if (captured_length != fread(data, 1, captured_length, reader->file)) {
+    return -1;
+  }
+  *length = captured_length;
+  *time = (MicroSeconds) GetPcapUint32(reader, &header[0]) * 1000000ULL
+      + GetPcapUint32(reader, &header[4]) / (reader->nanoseconds ? 1000 : 1);
+  return 1;
+}
+
+const EipUint8 *GetIpv4Packet(EipUint32 link_type, const EipUint8 *data,
+                              size_t *length) {
+  size_t header_length = 0;
+  EipUint16 ether_type = 0x0800;
+
+  switch (link_type) {
+    case PCAP_LINK_TYPE_NULL:
+      header_length = 4; /* address family in host byte order of the writer */
+      if ((*length < header_length) || ((2 != data[0]) && (2 != data[3]))) {
+        return NULL;
+      }
+      break;
+    case PCAP_LINK_TYPE_ETHERNET:
+      header_length = 14;
+      if (*length < header_length) {
+        return NULL;
+      }
+      ether_type = (EipUint16) ((data[12] << 8) | data[13]);
+      if ((0x8100 == ether_type) && (*length >= header_length + 4)) { /* VLAN */
+        ether_type = (EipUint16) ((data[16] << 8) | data[17]);
+        header_length += 4;
+      }
+      break;
+    case PCAP_LINK_TYPE_LINUX_SLL:
+      header_length = 16;
+      if (*length < header_length) {
+        return NULL;
+      }
+      ether_type = (EipUint16) ((data[14] << 8) | data[15]);
+      break;
+    default: /* raw IPv4 */
+      break;
+  }
+  if ((0x0800 != ether_type) || (*length < header_length + 20)
+      || (0x40 != (data[header_length] & 0xF0))) {
+    return NULL;
+  }
+  *length -= header_length;
+  return &data[header_length];
+}
+
+in_addr_t FindAdapterAddress(PcapReader *reader) {
+  EipUint8 *packet = malloc(REPLAY_MAX_PACKET_SIZE);
+  in_addr_t adapter_address = 0;
+  size_t length;
+  MicroSeconds time;
+
+  if (NULL == packet) {
+    return 0;
+  }
+  long start = ftell(reader->file);
+  while ((0 == adapter_address)
+      && (0 < ReadPcapPacket(reader, packet, &length, &time))) {
+    const EipUint8 *ip_packet = GetIpv4Packet(reader->link_type, packet,
+                                              &length);
+    if (NULL == ip_packet) {
+      continue;
+    }
+    size_t header_length = (ip_packet[0] & 0x0F) * 4;
+    if ((IP_PROTOCOL_TCP == ip_packet[9])
+        && (length >= header_length + 20)
+        && (kOpenerEthernetPort
+            == ((ip_packet[header_length + 2] << 8)
+                | ip_packet[header_length + 3]))) {
+      memcpy(&adapter_address, &ip_packet[16], sizeof(adapter_address));
+    }
+  }
+  fseek(reader->file, start, SEEK_SET);
+  free(packet);
+  return adapter_address;
+}
+
+void AdvanceReplayTime(MicroSeconds time) {
+  const MicroSeconds tick = kOpenerTimerTickInMilliSeconds * 1000ULL;
+
+  if (0 == g_replay_capture_start) {
+    g_replay_capture_start = time;
+    g_replay_wall_start = GetReplayWallTime();
+    g_replay_time = time;
+    g_replay_last_tick = time;
+  }
+  if (time < g_replay_time) { /* the stack's time must not go backwards */
+    return;
+  }
+
+  while (g_replay_last_tick + tick <= time) {
+    g_replay_last_tick += tick;
+    g_replay_time = g_replay_last_tick;
+    if (g_replay_real_time) {
+      MicroSeconds due = g_replay_wall_start + g_replay_time
+          - g_replay_capture_start;
+      MicroSeconds now = GetReplayWallTime();
+      if (due > now) {
+        struct timespec delay = { (time_t) ((due - now) / 1000000ULL),
+            (long) ((due - now) % 1000000ULL) * 1000 };
+        nanosleep(&delay, NULL);
+      }
+    }
+    MicroSeconds start = GetReplayWallTime();
+    ManageConnections(kOpenerTimerTickInMilliSeconds);
+#ifdef OPENER_BUSY_POLL
+    ManageConnectionTimers(kOpenerTimerTickInMilliSeconds);
+#endif
+    g_replay_statistics.stack_time += GetReplayWallTime() - start;
+  }
+  g_replay_time = time;
+}
+
+void ReplayIpv4Packet(const EipUint8 *packet, size_t length) {
+  size_t header_length = (packet[0] & 0x0F) * 4;
+  size_t total_length = (size_t) ((packet[2] << 8) | packet[3]);
+  struct sockaddr_in source;
+  in_addr_t destination;
+
+  /* fragments and truncated packets can not be replayed */
+  if ((total_length > length) || (header_length + 8 > total_length)
+      || (0 != (((packet[6] << 8) | packet[7]) & 0x3FFF))) {
+    g_replay_statistics.ignored_packets++;
+    return;
+  }
+  memcpy(&destination, &packet[16], sizeof(destination));
+  if ((IP_PROTOCOL_TCP == packet[9])
+      && (0 == memcmp(&packet[12], &g_replay_adapter_address, 4))
+      && (kOpenerEthernetPort
+          == ((packet[header_length] << 8) | packet[header_length + 1]))) {
+    size_t data_offset = header_length + (packet[header_length + 12] >> 4) * 4;
+    if (data_offset < total_length) {
+      RecordForwardOpenReplies(&packet[data_offset], total_length - data_offset,
+                               0);
+    }
+    g_replay_statistics.ignored_packets++;
+    return;
+  }
+  if ((destination != g_replay_adapter_address)
+      && (0xFF != packet[19]) && (0xE0 != (packet[16] & 0xF0))) {
+    g_replay_statistics.ignored_packets++;
+    return;
+  }
+
+  memset(&source, 0, sizeof(source));
+  source.sin_family = AF_INET;
+  memcpy(&source.sin_addr.s_addr, &packet[12], 4);
+  const EipUint8 *transport = &packet[header_length];
+  size_t transport_length = total_length - header_length;
+  source.sin_port = htons((EipUint16) ((transport[0] << 8) | transport[1]));
+  EipUint16 destination_port = (EipUint16) ((transport[2] << 8) | transport[3]);
+
+  if ((IP_PROTOCOL_TCP == packet[9]) && (kOpenerEthernetPort == destination_port)
+      && (destination == g_replay_adapter_address)) {
+    ReplayTcpSegment(&source, transport, transport_length);
+  } else if (IP_PROTOCOL_UDP == packet[9]) {
+    ReplayUdpDatagram(&source, destination, destination_port, &transport[8],
+                      transport_length - 8);
+  } else {
+    g_replay_statistics.ignored_packets++;
+  }
+}
+
+void ReplayTcpSegment(const struct sockaddr_in *source, const EipUint8 *segment,
+                      size_t length) {
+  size_t header_length = (segment[12] >> 4) * 4;
+  EipUint8 flags = segment[13];
+
+  if ((20 > header_length) || (header_length > length)) {
+    g_replay_statistics.ignored_packets++;
+    return;
+  }
+  EipUint32 sequence = ((EipUint32) segment[4] << 24)
+      | ((EipUint32) segment[5] << 16) | ((EipUint32) segment[6] << 8)
+      | (EipUint32) segment[7];
+  const EipUint8 *payload = &segment[header_length];
+  size_t payload_length = length - header_length;
+
+  ReplayTcpFlow *flow = GetReplayTcpFlow(source);
+  if (NULL == flow) {
+    g_replay_statistics.ignored_packets++;
+    return;
+  }
+  if (flags & TCP_FLAG_SYN) {
+    flow->synchronized = 1;
+    flow->next_sequence = sequence + 1;
+    flow->buffered = 0;
+    return;
+  }
+  if (!flow->synchronized) { /* capture started in the middle of the flow */
+    flow->synchronized = 1;
+    flow->next_sequence = sequence;
+  }
+
+  EipUint32 offset = flow->next_sequence - sequence;
+  if ((0 < payload_length) && (0x80000000U < offset)) {
+    /* segments are missing, drop the incomplete message */
+    g_replay_statistics.tcp_gaps++;
+    flow->buffered = 0;
+    offset = 0;
+    flow->next_sequence = sequence;
+  }
+  if (offset < payload_length) { /* skip the retransmitted part */
+    size_t new_length = payload_length - offset;
+    if (flow->buffered + new_length > sizeof(flow->buffer)) {
+      g_replay_statistics.oversized_messages++;
+      flow->buffered = 0;
+    } else {
+      memcpy(&flow->buffer[flow->buffered], &payload[offset], new_length);
+      flow->buffered += new_length;
+    }
+    flow->next_sequence += (EipUint32) new_length;
+    ProcessTcpFlowMessages(flow);
+  }
+
+  if (flags & (TCP_FLAG_FIN | TCP_FLAG_RST)) {
+    CloseReplayTcpFlow(flow);
+  }
+}
+
+void ProcessTcpFlowMessages(ReplayTcpFlow *flow) {
+  static EipUint8 message[PC_OPENER_ETHERNET_BUFFER_SIZE];
+
+  while (ENCAPSULATION_HEADER_LENGTH <= flow->buffered) {
+    size_t message_length = ENCAPSULATION_HEADER_LENGTH
+        + (size_t) (flow->buffer[2] | (flow->buffer[3] << 8));
+    if (message_length > flow->buffered) {
+      if (message_length > sizeof(flow->buffer)) {
+        g_replay_statistics.oversized_messages++;
+        flow->buffered = 0;
+      }
+      return;
+    }
+
+    if (message_length <= sizeof(message)) {
+      int remaining_bytes = 0;
+      memcpy(message, flow->buffer, message_length);
+      g_replay_statistics.tcp_messages++;
+      g_opener_stack->opener_statistics.tcp_messages_received++;
+      g_replay_peer_address = flow->peer;
+      int reply_length = HandleReceivedExplictTcpData(flow->socket, message,
+                                                      message_length,
+                                                      &remaining_bytes);
+      if (0 < reply_length) {
+        RecordForwardOpenReplies(message, reply_length, 1);
+        WriteSinkFrame(IP_PROTOCOL_TCP, kOpenerEthernetPort, &flow->peer,
+                       message, reply_length, flow);
+      }
+    } else {
+      g_replay_statistics.oversized_messages++;
+    }
+    if (!flow->used) { /* the stack closed the session */
+      return;
+    }
+
+    flow->buffered -= message_length;
+    memmove(flow->buffer, &flow->buffer[message_length], flow->buffered);
+  }
+}
+
+void ReplayUdpDatagram(const struct sockaddr_in *source, in_addr_t destination,
+                       EipUint16 destination_port, const EipUint8 *payload,
+                       size_t length) {
+  static EipUint8 message[PC_OPENER_ETHERNET_BUFFER_SIZE];
+  struct sockaddr_in from_address = *source;
+
+  if (length > sizeof(message)) {
+    g_replay_statistics.oversized_messages++;
+    return;
+  }
+  memcpy(message, payload, length);
+
+  if (kOpenerEthernetPort == destination_port) {
+    int remaining_bytes = 0;
+    g_replay_statistics.udp_explicit_messages++;
+    g_opener_stack->opener_statistics.udp_packets_received++;
+    g_replay_peer_address = *source;
+    int reply_length = HandleReceivedExplictUdpData(
+        REPLAY_UDP_EXPLICIT_SOCKET, &from_address, message, length,
+        &remaining_bytes, destination == g_replay_adapter_address);
+    if (0 < reply_length) {
+      WriteSinkFrame(IP_PROTOCOL_UDP, kOpenerEthernetPort, source, message,
+                     reply_length, NULL);
+    }
+  } else if ((REPLAY_IO_PORT == destination_port)
+      && (destination == g_replay_adapter_address)) {
+    g_replay_statistics.io_packets++;
+    g_opener_stack->opener_statistics.udp_packets_received++;
+    EipUint8 *address_item = &message[2];
+    if ((10 <= length)
+        && (kCipItemIdSequencedAddressItem == GetIntFromMessage(&address_item))) {
+      /* sequenced address item, translate its connection ID */
+      EipUint8 *connection_id = &message[6];
+      EipUint32 translated_id = TranslateConnectionId(
+          GetDintFromMessage(&connection_id));
+      connection_id = &message[6];
+      AddDintToMessage(translated_id, &connection_id);
+    }
+    HandleReceivedConnectedData(message, (int) length, &from_address,
+                                g_replay_time);
+  } else {
+    g_replay_statistics.ignored_packets++;
+  }
+}
+
+ReplayTcpFlow *GetReplayTcpFlow(const struct sockaddr_in *peer) {
+  ReplayTcpFlow *unused_flow = NULL;
+
+  for (int i = 0; i < REPLAY_MAX_TCP_FLOWS; i++) {
+    ReplayTcpFlow *flow = &g_replay_flows[i];
+    if (!flow->used) {
+      if (NULL == unused_flow) {
+        unused_flow = flow;
+      }
+      continue;
+    }
+    if ((flow->peer.sin_addr.s_addr == peer->sin_addr.s_addr)
+        && (flow->peer.sin_port == peer->sin_port)) {
+      return flow;
+    }
+  }
+  if (NULL != unused_flow) {
+    unused_flow->used = 1;
+    unused_flow->socket = REPLAY_FIRST_TCP_SOCKET
+        + (int) (unused_flow - g_replay_flows);
+    unused_flow->peer = *peer;
+    unused_flow->synchronized = 0;
+    unused_flow->reply_sequence = 1;
+    unused_flow->buffered = 0;
+  }
+  return unused_flow;
+}
+
+void RecordForwardOpenReplies(const EipUint8 *data, size_t length,
+                              int replayed) {
+  while (ENCAPSULATION_HEADER_LENGTH + 8 <= length) {
+    const EipUint8 *message = data;
+    size_t message_length = ENCAPSULATION_HEADER_LENGTH
+        + (size_t) (message[2] | (message[3] << 8));
+    if (message_length > length) {
+      return;
+    }
+    data += message_length;
+    length -= message_length;
+
+    /* SendRRData: interface handle, timeout and the CPF items */
+    if (0x6F != (message[0] | (message[1] << 8))) {
+      continue;
+    }
+    const EipUint8 *item = &message[ENCAPSULATION_HEADER_LENGTH + 8];
+    const EipUint8 *end = &message[message_length];
+    int item_count = message[ENCAPSULATION_HEADER_LENGTH + 6]
+        | (message[ENCAPSULATION_HEADER_LENGTH + 7] << 8);
+    for (; (0 < item_count) && (item + 4 <= end); item_count--) {
+      EipUint16 type_id = (EipUint16) (item[0] | (item[1] << 8));
+      size_t item_length = (size_t) (item[2] | (item[3] << 8));
+      const EipUint8 *reply = &item[4];
+      item = &item[4 + item_length];
+      if (item > end) {
+        break;
+      }
+      /* successful (Large_)Forward_Open reply up to the originator serial */
+      if ((kCipItemIdUnconnectedDataItem != type_id) || (20 > item_length)
+          || ((0xD4 != reply[0]) && (0xDB != reply[0])) || (0 != reply[2])
+          || (0 != reply[3])) {
+        continue;
+      }
+      EipUint8 *reply_data = (EipUint8 *) &reply[4];
+      EipUint32 connection_id = GetDintFromMessage(&reply_data);
+      reply_data += 4; /* T->O connection ID */
+      EipUint16 connection_serial_number = GetIntFromMessage(&reply_data);
+      EipUint16 originator_vendor_id = GetIntFromMessage(&reply_data);
+      EipUint32 originator_serial_number = GetDintFromMessage(&reply_data);
+
+      ReplayConnectionId *entry = NULL;
+      for (int i = 0; i < REPLAY_MAX_CONNECTION_IDS; i++) {
+        ReplayConnectionId *candidate = &g_replay_connection_ids[i];
+        if ((candidate->connection_serial_number == connection_serial_number)
+            && (candidate->originator_vendor_id == originator_vendor_id)
+            && (candidate->originator_serial_number
+                == originator_serial_number)
+            && ((0 != candidate->captured_connection_id)
+                || (0 != candidate->replayed_connection_id))) {
+          entry = candidate;
+          break;
+        }
+      }
+      if (NULL == entry) {
+        entry = &g_replay_connection_ids[g_replay_next_connection_id];
+        g_replay_next_connection_id = (g_replay_next_connection_id + 1)
+            % REPLAY_MAX_CONNECTION_IDS;
+        memset(entry, 0, sizeof(*entry));
+        entry->connection_serial_number = connection_serial_number;
+        entry->originator_vendor_id = originator_vendor_id;
+        entry->originator_serial_number = originator_serial_number;
+      }
+      if (replayed) {
+        entry->replayed_connection_id = connection_id;
+      } else {
+        entry->captured_connection_id = connection_id;
+      }
+    }
+  }
+}
+
+EipUint32 TranslateConnectionId(EipUint32 captured_connection_id) {
+  for (int i = 0; i < REPLAY_MAX_CONNECTION_IDS; i++) {
+    if ((g_replay_connection_ids[i].captured_connection_id
+        == captured_connection_id)
+        && (0 != g_replay_connection_ids[i].replayed_connection_id)) {
+      return g_replay_connection_ids[i].replayed_connection_id;
+    }
+  }
+  return captured_connection_id;
+}
+
+void CloseReplayTcpFlow(ReplayTcpFlow *flow) {
+  if (flow->used) {
+    CloseSession(flow->socket); /* calls IApp_CloseSocket_tcp */
+    flow->used = 0;
+  }
+}
+
+void WriteSinkHeader(void) {
+  EipUint8 header[24];
+  EipUint8 *buffer = header;
+
+  AddDintToMessage(PCAP_MAGIC, &buffer);
+  AddIntToMessage(2, &buffer); /* version 2.4 */
+  AddIntToMessage(4, &buffer);
+  AddDintToMessage(0, &buffer); /* time zone */
+  AddDintToMessage(0, &buffer); /* accuracy */
+  AddDintToMessage(REPLAY_MAX_PACKET_SIZE, &buffer);
+  AddDintToMessage(PCAP_LINK_TYPE_RAW, &buffer);
+  fwrite(header, 1, sizeof(header), g_replay_sink);
+}
+
+void WriteSinkFrame(EipUint8 protocol, EipUint16 source_port,
+                    const struct sockaddr_in *destination,
+                    const EipUint8 *payload, size_t length,
+                    ReplayTcpFlow *flow) {
+  EipUint8 header[16 + 20 + 20];
+  size_t transport_header_length = (IP_PROTOCOL_TCP == protocol) ? 20 : 8;
+  size_t total_length = 20 + transport_header_length + length;
+  EipUint8 *buffer = header;
+
+  g_replay_statistics.frames_written++;
+  if ((NULL == g_replay_sink) || (REPLAY_MAX_PACKET_SIZE < total_length)) {
+    return;
+  }
+
+  /* record header, little endian as the file header */
+  AddDintToMessage((EipUint32) (g_replay_time / 1000000ULL), &buffer);
+  AddDintToMessage((EipUint32) (g_replay_time % 1000000ULL), &buffer);
+  AddDintToMessage((EipUint32) total_length, &buffer);
+  AddDintToMessage((EipUint32) total_length, &buffer);
+
+  /* IPv4 header */
+  EipUint8 *ip_header = buffer;
+  *buffer++ = 0x45;
+  *buffer++ = 0;
+  *buffer++ = (EipUint8) (total_length >> 8);
+  *buffer++ = (EipUint8) total_length;
+  *buffer++ = (EipUint8) (g_replay_frame_identification >> 8);
+  *buffer++ = (EipUint8) g_replay_frame_identification;
+  g_replay_frame_identification++;
+  *buffer++ = 0x40; /* don't fragment */
+  *buffer++ = 0;
+  *buffer++ = 64; /* TTL */
+  *buffer++ = protocol;
+  *buffer++ = 0; /* checksum */
+  *buffer++ = 0;
+  memcpy(buffer, &g_replay_adapter_address, 4);
+  buffer += 4;
+  memcpy(buffer, &destination->sin_addr.s_addr, 4);
+  buffer += 4;
+  EipUint32 checksum = 0;
+  for (int i = 0; i < 20; i += 2) {
+    checksum += (EipUint32) ((ip_header[i] << 8) | ip_header[i + 1]);
+  }
+  checksum = (checksum & 0xFFFF) + (checksum >> 16);
+  checksum = ~((checksum & 0xFFFF) + (checksum >> 16));
+  ip_header[10] = (EipUint8) (checksum >> 8);
+  ip_header[11] = (EipUint8) checksum;
+
+  /* TCP or UDP header, the checksum is left 0 */
+  EipUint16 destination_port = ntohs(destination->sin_port);
+  *buffer++ = (EipUint8) (source_port >> 8);
+  *buffer++ = (EipUint8) source_port;
+  *buffer++ = (EipUint8) (destination_port >> 8);
+  *buffer++ = (EipUint8) destination_port;
+  if (IP_PROTOCOL_TCP == protocol) {
+    EipUint32 sequence = flow->reply_sequence;
+    flow->reply_sequence += (EipUint32) length;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      *buffer++ = (EipUint8) (sequence >> shift);
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      *buffer++ = (EipUint8) (flow->next_sequence >> shift);
+    }
+    *buffer++ = 0x50; /* header length */
+    *buffer++ = TCP_FLAG_PSH | TCP_FLAG_ACK;
+    *buffer++ = 0xFF; /* window */
+    *buffer++ = 0xFF;
+    memset(buffer, 0, 4); /* checksum and urgent pointer */
+    buffer += 4;
+  } else {
+    *buffer++ = (EipUint8) ((length + 8) >> 8);
+    *buffer++ = (EipUint8) (length + 8);
+    *buffer++ = 0;
+    *buffer++ = 0;
+  }
+
+  fwrite(header, 1, buffer - header, g_replay_sink);
+  fwrite(payload, 1, length, g_replay_sink);
+}
+
+void PrintReplayStatistics(void) {
+  MicroSeconds wall_time = GetReplayWallTime() - g_replay_wall_start;
+  double capture_time = (g_replay_time - g_replay_capture_start) / 1e6;
+  uint64_t injected_packets = g_replay_statistics.packets
+      - g_replay_statistics.ignored_packets;
+
+  printf("replayed %llu of %llu packets, capture time %.3f s, wall time "
+         "%.3f ms, stack time %.3f ms (%.2f us per packet)\n",
+         (unsigned long long) injected_packets,
+         (unsigned long long) g_replay_statistics.packets, capture_time,
+         wall_time / 1e3, g_replay_statistics.stack_time / 1e3,
+         (0 != injected_packets) ?
+             (double) g_replay_statistics.stack_time / injected_packets : 0.0);
+  printf("TCP messages %llu, UDP explicit messages %llu, I/O packets %llu, "
+         "TCP gaps %llu, oversized messages %llu\n",
+         (unsigned long long) g_replay_statistics.tcp_messages,
+         (unsigned long long) g_replay_statistics.udp_explicit_messages,
+         (unsigned long long) g_replay_statistics.io_packets,
+         (unsigned long long) g_replay_statistics.tcp_gaps,
+         (unsigned long long) g_replay_statistics.oversized_messages);
+  printf("frames sent by the stack %llu, I/O packets consumed %u, produced "
+         "%u, unknown connection %u, wrong size %u, wrong originator %u\n",
+         (unsigned long long) g_replay_statistics.frames_written,
+         (unsigned) g_opener_stack->opener_statistics.io_packets_consumed,
+         (unsigned) g_opener_stack->opener_statistics.io_packets_produced,
+         (unsigned) g_opener_stack->opener_statistics.io_packets_unknown_connection,
+         (unsigned) g_opener_stack->opener_statistics.io_packets_wrong_size,
+         (unsigned) g_opener_stack->opener_statistics.io_packets_wrong_originator);
+}
+
+/* The socket layer of the network handler, replaced by the replay */
+
+MicroSeconds GetMicroSeconds(void) {
+  return g_replay_time;
+}
+
+int CreateUdpSocket(UdpCommuncationDirection communication_direction,
+                    struct sockaddr_in *socket_data) {
+  if ((kUdpCommuncationDirectionConsuming == communication_direction)
+      || (0 == socket_data->sin_addr.s_addr)) {
+    /* peer to peer producer or consumer, the originator is the peer of the
+     * message being processed */
+    socket_data->sin_addr.s_addr = g_replay_peer_address.sin_addr.s_addr;
+  }
+  return g_replay_next_udp_socket++;
+}
+
+EipStatus SendUdpData(struct sockaddr_in *socket_data, int socket,
+                      EipUint8 *data, EipUint16 data_length) {
+  WriteSinkFrame(
+      IP_PROTOCOL_UDP,
+      (REPLAY_UDP_EXPLICIT_SOCKET == socket) ?
+          kOpenerEthernetPort : REPLAY_IO_PORT,
+      socket_data, data, data_length, NULL);
+  return kEipStatusOk;
+}
+
+void IApp_CloseSocket_udp(int socket_handle) {
+  (void) socket_handle;
+}
+
+void IApp_CloseSocket_tcp(int socket_handle) {
+  for (int i = 0; i < REPLAY_MAX_TCP_FLOWS; i++) {
+    if (g_replay_flows[i].used && (g_replay_flows[i].socket == socket_handle)) {
+      g_replay_flows[i].used = 0;
+    }
+  }
+}
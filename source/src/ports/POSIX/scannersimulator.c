@@ -0,0 +1,1028 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+/* struct ip_mreq is not part of POSIX */
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+/** @file scannersimulator.c
+ * @brief Originator simulator putting explicit and I/O load on an OpENer
+ * adapter, e.g., over the loopback interface
+ *
+ * The simulator registers a number of encapsulation sessions and opens a
+ * number of class 1 I/O connections: the first one as exclusive owner, the
+ * others as input only connections. While the connections are produced at
+ * their RPI, every session keeps one Get_Attribute_Single request
+ * outstanding. At the end the achieved packet rates, the deviation of the
+ * received packets from the RPI, the missed packets and the latency
+ * percentiles of the explicit requests are reported.
+ *
+ * The defaults match the assemblies of the sample application, which allows
+ * one exclusive owner and three input only connections.
+ *
+ * For multicast over loopback the interface has to accept multicast, on Linux
+ * e.g., "ip link set lo multicast on; ip route add 224.0.0.0/4 dev lo".
+ */
+
+/** @brief Encapsulation port of the adapter */
+#define SIMULATOR_ENCAPSULATION_PORT 0xAF12
+
+/** @brief UDP port the adapter consumes I/O data on */
+#define SIMULATOR_IO_PORT 2222
+
+#define SIMULATOR_ENCAPSULATION_HEADER_LENGTH 24
+#define SIMULATOR_BUFFER_SIZE 600
+#define SIMULATOR_VENDOR_ID 0x4D
+
+/** @brief Time to wait for replies during setup and tear down in ms */
+#define SIMULATOR_SETUP_TIMEOUT 2000
+
+/** @brief Command line options of the simulator */
+typedef struct {
+  const char *address; /**< IP address of the adapter */
+  int duration; /**< load duration in s */
+  int number_of_sessions; /**< sessions flooding explicit requests */
+  int number_of_connections; /**< I/O connections */
+  uint32_t requested_packet_interval; /**< RPI in us */
+  int assembly_size; /**< size of the input and output assemblies */
+  int multicast; /**< T->O multicast instead of point-to-point */
+  unsigned int output_assembly;
+  unsigned int input_assembly;
+  unsigned int config_assembly;
+  unsigned int heartbeat_assembly; /**< O->T assembly of input only connections */
+  unsigned int explicit_class; /**< path of the flooded Get_Attribute_Single */
+  unsigned int explicit_instance;
+  unsigned int explicit_attribute;
+} SimulatorOptions;
+
+/** @brief An encapsulation session */
+typedef struct {
+  int socket;
+  uint32_t session_handle;
+  int outstanding; /**< a request is waiting for its reply */
+  uint64_t request_time; /**< time the outstanding request was sent in us */
+  size_t received; /**< bytes of the current reply received so far */
+  uint8_t buffer[SIMULATOR_BUFFER_SIZE];
+} SimulatorSession;
+
+/** @brief A class 1 I/O connection and its statistics */
+typedef struct {
+  int open;
+  int exclusive_owner; /**< 0 for input only connections */
+  uint16_t connection_serial_number;
+  uint32_t o_to_t_connection_id;
+  uint32_t t_to_o_connection_id;
+  uint32_t o_to_t_packet_interval; /**< actual packet interval in us */
+  uint32_t t_to_o_packet_interval;
+  uint64_t next_production; /**< time of the next O->T packet in us */
+  uint32_t eip_sequence_count;
+  uint16_t sequence_count;
+  uint64_t produced_packets;
+  uint64_t consumed_packets;
+  uint64_t missed_packets; /**< gaps in the T->O sequence numbers */
+  uint32_t last_consumed_sequence;
+  uint64_t last_receive_time;
+  uint64_t total_deviation; /**< sum of the deviations from the T->O RPI in us */
+  uint64_t max_deviation;
+} SimulatorConnection;
+
+/** @brief Latencies of the explicit requests in us */
+typedef struct {
+  uint64_t *samples;
+  size_t count;
+  size_t capacity;
+} LatencySamples;
+
+/** @brief Get CLOCK_MONOTONIC in us */
+uint64_t GetSimulatorTime(void);
+
+void PutUint16(uint8_t **buffer, uint16_t value);
+void PutUint32(uint8_t **buffer, uint32_t value);
+uint16_t GetUint16(const uint8_t *buffer);
+uint32_t GetUint32(const uint8_t *buffer);
+
+/** @brief Parse the command line
+ *
+ * @return 1 on success, 0 if the usage has to be printed
+ */
+int ParseSimulatorOptions(int argc, char *argv[], SimulatorOptions *options);
+
+void PrintSimulatorUsage(const char *program);
+
+/** @brief Connect to the adapter and register a session
+ *
+ * @return 1 on success, 0 on failure
+ */
+int OpenSimulatorSession(const SimulatorOptions *options,
+                         SimulatorSession *session);
+
+/** @brief Send an unconnected message router request with SendRRData
+ *
+ * @param session the session to send on
+ * @param request the message router request
+ * @param request_length length of the request
+ * @param extra_item additional CPF item, e.g., a sockaddr info item, or NULL
+ * @param extra_item_length length of the additional item
+ * @return 1 on success, 0 on failure
+ */
+int SendSimulatorRequest(SimulatorSession *session, const uint8_t *request,
+                         size_t request_length, const uint8_t *extra_item,
+                         size_t extra_item_length);
+
+/** @brief Receive an encapsulation message, waiting up to the setup timeout
+ *
+ * @return length of the message, 0 on failure
+ */
+size_t ReceiveSimulatorReply(SimulatorSession *session);
+
+/** @brief Find a CPF item in a SendRRData reply
+ *
+ * @param message the encapsulation message
+ * @param length length of the message
+ * @param type_id the item type searched for
+ * @param item_length set to the length of the item
+ * @return pointer to the data of the item, NULL if not present
+ */
+const uint8_t *FindCommonPacketFormatItem(const uint8_t *message,
+                                          size_t length, uint16_t type_id,
+                                          uint16_t *item_length);
+
+/** @brief Open an I/O connection with a Forward_Open request
+ *
+ * @param index index of the connection, 0 is the exclusive owner
+ * @param udp_port local UDP port point-to-point T->O data is expected on
+ * @param multicast_address set to the T->O multicast address if multicast
+ * @return 1 on success, 0 on failure
+ */
+int OpenSimulatorConnection(const SimulatorOptions *options,
+                            SimulatorSession *session,
+                            SimulatorConnection *connection, int index,
+                            uint16_t udp_port,
+                            struct sockaddr_in *multicast_address);
+
+/** @brief Close an I/O connection with a Forward_Close request */
+void CloseSimulatorConnection(const SimulatorOptions *options,
+                              SimulatorSession *session,
+                              SimulatorConnection *connection);
+
+/** @brief Send the O->T data of a connection */
+void ProduceSimulatorConnection(const SimulatorOptions *options,
+                                int udp_socket,
+                                const struct sockaddr_in *adapter_address,
+                                SimulatorConnection *connection);
+
+/** @brief Account a received T->O packet in its connections' statistics */
+void ConsumeSimulatorPacket(SimulatorConnection *connections,
+                            int number_of_connections, const uint8_t *data,
+                            size_t length, uint64_t receive_time);
+
+/** @brief Send the Get_Attribute_Single request flooded by a session */
+int SendExplicitLoadRequest(const SimulatorOptions *options,
+                            SimulatorSession *session);
+
+/** @brief Read the available data of a session, completing its reply
+ *
+ * @return 1 if a reply was completed, 0 if not yet, -1 on errors
+ */
+int ReceiveExplicitLoadReply(SimulatorSession *session);
+
+void AddLatencySample(LatencySamples *latencies, uint64_t latency);
+
+int CompareLatencies(const void *first, const void *second);
+
+/** @brief Get a percentile of the sorted latencies */
+uint64_t GetLatencyPercentile(const LatencySamples *latencies,
+                              unsigned int percentile);
+
+void PrintSimulatorResults(const SimulatorOptions *options,
+                           const SimulatorConnection *connections,
+                           LatencySamples *latencies,
+                           uint64_t explicit_errors, double elapsed_seconds);
+
+int main(int argc, char *argv[]) {
+  SimulatorOptions options;
+  struct sockaddr_in adapter_address;
+  struct sockaddr_in local_address;
+  struct sockaddr_in multicast_address;
+  socklen_t address_length = sizeof(local_address);
+  LatencySamples latencies = { NULL, 0, 0 };
+  uint64_t explicit_errors = 0;
+  int exit_code = EXIT_FAILURE;
+
+  if (!ParseSimulatorOptions(argc, argv, &options)) {
+    PrintSimulatorUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  memset(&adapter_address, 0, sizeof(adapter_address));
+  adapter_address.sin_family = AF_INET;
+  adapter_address.sin_port = htons(SIMULATOR_IO_PORT);
+  adapter_address.sin_addr.s_addr = inet_addr(options.address);
+
+  SimulatorSession *sessions = calloc(options.number_of_sessions,
+                                      sizeof(SimulatorSession));
+  SimulatorConnection *connections = calloc(options.number_of_connections,
+                                            sizeof(SimulatorConnection));
+  struct pollfd *poll_entries = calloc(options.number_of_sessions + 2,
+                                       sizeof(struct pollfd));
+  if ((NULL == sessions) || (NULL == connections) || (NULL == poll_entries)) {
+    printf("out of memory\n");
+    return EXIT_FAILURE;
+  }
+  for (int i = 0; i < options.number_of_sessions; i++) {
+    sessions[i].socket = -1;
+  }
+
+  /* one socket sends all O->T data and receives point-to-point T->O data */
+  int udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  int multicast_socket = -1;
+  memset(&local_address, 0, sizeof(local_address));
+  local_address.sin_family = AF_INET;
+  if ((0 > udp_socket)
+      || (0 != bind(udp_socket, (struct sockaddr *) &local_address,
+                    sizeof(local_address)))
+      || (0 != getsockname(udp_socket, (struct sockaddr *) &local_address,
+                           &address_length))) {
+    perror("UDP socket");
+    return EXIT_FAILURE;
+  }
+
+  for (int i = 0; i < options.number_of_sessions; i++) {
+    if (!OpenSimulatorSession(&options, &sessions[i])) {
+      printf("could not register session %d\n", i + 1);
+      goto cleanup;
+    }
+  }
+
+  memset(&multicast_address, 0, sizeof(multicast_address));
+  for (int i = 0; i < options.number_of_connections; i++) {
+    if (!OpenSimulatorConnection(&options, &sessions[0], &connections[i], i,
+                                 ntohs(local_address.sin_port),
+                                 &multicast_address)) {
+      printf("could not open connection %d\n", i + 1);
+      goto cleanup;
+    }
+  }
+
+  if (options.multicast && (0 != options.number_of_connections)) {
+    struct ip_mreq membership;
+    int reuse = 1;
+    struct sockaddr_in group_address = multicast_address;
+
+    group_address.sin_addr.s_addr = htonl(INADDR_ANY);
+    membership.imr_multiaddr = multicast_address.sin_addr;
+    membership.imr_interface.s_addr = adapter_address.sin_addr.s_addr;
+    multicast_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if ((0 > multicast_socket)
+        || (0 != setsockopt(multicast_socket, SOL_SOCKET, SO_REUSEADDR,
+                            &reuse, sizeof(reuse)))
+        || (0 != bind(multicast_socket, (struct sockaddr *) &group_address,
+                      sizeof(group_address)))
+        || (0 != setsockopt(multicast_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                            &membership, sizeof(membership)))) {
+      perror("multicast socket");
+      goto cleanup;
+    }
+  }
+
+  uint64_t start_time = GetSimulatorTime();
+  uint64_t end_time = start_time + (uint64_t) options.duration * 1000000ULL;
+  for (int i = 0; i < options.number_of_connections; i++) {
+    connections[i].next_production = start_time;
+  }
+  for (int i = 0; i < options.number_of_sessions; i++) {
+    if (!SendExplicitLoadRequest(&options, &sessions[i])) {
+      goto cleanup;
+    }
+  }
+
+  uint64_t now = start_time;
+  while (now < end_time) {
+    uint64_t next_event = end_time;
+
+    for (int i = 0; i < options.number_of_connections; i++) {
+      while (connections[i].next_production <= now) {
+        ProduceSimulatorConnection(&options, udp_socket, &adapter_address,
+                                   &connections[i]);
+        connections[i].next_production += connections[i]
+            .o_to_t_packet_interval;
+      }
+      if (connections[i].next_production < next_event) {
+        next_event = connections[i].next_production;
+      }
+    }
+
+    int number_of_entries = 0;
+    for (int i = 0; i < options.number_of_sessions; i++) {
+      poll_entries[number_of_entries].fd = sessions[i].socket;
+      poll_entries[number_of_entries++].events = POLLIN;
+    }
+    poll_entries[number_of_entries].fd = udp_socket;
+    poll_entries[number_of_entries++].events = POLLIN;
+    if (0 <= multicast_socket) {
+      poll_entries[number_of_entries].fd = multicast_socket;
+      poll_entries[number_of_entries++].events = POLLIN;
+    }
+
+    /* waits below 1 ms are spent polling */
+    int timeout = (int) ((next_event - now) / 1000);
+    if (0 > poll(poll_entries, number_of_entries, timeout)) {
+      if (EINTR == errno) {
+        continue;
+      }
+      perror("poll");
+      goto cleanup;
+    }
+    now = GetSimulatorTime();
+
+    for (int i = 0; i < options.number_of_sessions; i++) {
+      if (0 == (poll_entries[i].revents & (POLLIN | POLLERR | POLLHUP))) {
+        continue;
+      }
+      int result = ReceiveExplicitLoadReply(&sessions[i]);
+      if (0 > result) {
+        printf("session %d closed by the adapter\n", i + 1);
+        goto cleanup;
+      }
+      if (1 == result) {
+        AddLatencySample(&latencies, now - sessions[i].request_time);
+        /* general status of the message router reply */
+        const uint8_t *reply = FindCommonPacketFormatItem(sessions[i].buffer,
+                                                          sessions[i].received,
+                                                          0xB2, NULL);
+        if ((NULL == reply) || (0 != reply[2])) {
+          explicit_errors++;
+        }
+        sessions[i].received = 0;
+        if (!SendExplicitLoadRequest(&options, &sessions[i])) {
+          goto cleanup;
+        }
+      }
+    }
+
+    for (int i = options.number_of_sessions; i < number_of_entries; i++) {
+      if (0 == (poll_entries[i].revents & POLLIN)) {
+        continue;
+      }
+      uint8_t packet[SIMULATOR_BUFFER_SIZE];
+      ssize_t length;
+      while (0 < (length = recv(poll_entries[i].fd, packet, sizeof(packet),
+                                MSG_DONTWAIT))) {
+        ConsumeSimulatorPacket(connections, options.number_of_connections,
+                               packet, (size_t) length, GetSimulatorTime());
+      }
+    }
+  }
+
+  PrintSimulatorResults(&options, connections, &latencies, explicit_errors,
+                        (double) (now - start_time) / 1e6);
+  exit_code = EXIT_SUCCESS;
+
+  cleanup:
+  /* drain the replies of the flooded requests before closing */
+  for (int i = 0; i < options.number_of_sessions; i++) {
+    if (sessions[i].outstanding) {
+      while (0 == ReceiveExplicitLoadReply(&sessions[i])) {
+        struct pollfd entry = { sessions[i].socket, POLLIN, 0 };
+        if (0 >= poll(&entry, 1, SIMULATOR_SETUP_TIMEOUT)) {
+          break;
+        }
+      }
+      sessions[i].received = 0;
+    }
+  }
+  for (int i = 0; i < options.number_of_connections; i++) {
+    if (connections[i].open) {
+      CloseSimulatorConnection(&options, &sessions[0], &connections[i]);
+    }
+  }
+  for (int i = 0; i < options.number_of_sessions; i++) {
+    if (0 <= sessions[i].socket) {
+      close(sessions[i].socket);
+    }
+  }
+  if (0 <= multicast_socket) {
+    close(multicast_socket);
+  }
+  close(udp_socket);
+  free(latencies.samples);
+  free(poll_entries);
+  free(connections);
+  free(sessions);
+  return exit_code;
+}
+
+uint64_t GetSimulatorTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000ULL + (uint64_t) now.tv_nsec / 1000;
+}
+
+void PutUint16(uint8_t **buffer, uint16_t value) {
+  (*buffer)[0] = (uint8_t) value;
+  (*buffer)[1] = (uint8_t) (value >> 8);
+  *buffer += 2;
+}
+
+void PutUint32(uint8_t **buffer, uint32_t value) {
+  PutUint16(buffer, (uint16_t) value);
+  PutUint16(buffer, (uint16_t) (value >> 16));
+}
+
+uint16_t GetUint16(const uint8_t *buffer) {
+  return (uint16_t) (buffer[0] | (buffer[1] << 8));
+}
+
+uint32_t GetUint32(const uint8_t *buffer) {
+  return (uint32_t) GetUint16(buffer)
+      | ((uint32_t) GetUint16(buffer + 2) << 16);
+}
+
+void PrintSimulatorUsage(const char *program) {
+  printf("Usage: %s [options]\n", program);
+  printf("  -a address     IP address of the adapter (127.0.0.1)\n");
+  printf("  -d seconds     duration of the load (10)\n");
+  printf("  -n sessions    sessions flooding Get_Attribute_Single requests (1)\n");
+  printf("  -m connections class 1 I/O connections, the first one exclusive owner (1)\n");
+  printf("  -r rpi         requested packet interval in us (10000)\n");
+  printf("  -s size        size of the input and output assemblies (32)\n");
+  printf("  -M             T->O data as multicast instead of point-to-point\n");
+  printf("  -o assembly    output assembly (150)\n");
+  printf("  -i assembly    input assembly (100)\n");
+  printf("  -c assembly    configuration assembly (151)\n");
+  printf("  -h assembly    heartbeat assembly of input only connections (152)\n");
+  printf("  -g c/i/a       class/instance/attribute read by the sessions (1/1/1)\n");
+}
+
+int ParseSimulatorOptions(int argc, char *argv[], SimulatorOptions *options) {
+  int option;
+
+  options->address = "127.0.0.1";
+  options->duration = 10;
+  options->number_of_sessions = 1;
+  options->number_of_connections = 1;
+  options->requested_packet_interval = 10000;
+  options->assembly_size = 32;
+  options->multicast = 0;
+  options->output_assembly = 150;
+  options->input_assembly = 100;
+  options->config_assembly = 151;
+  options->heartbeat_assembly = 152;
+  options->explicit_class = 1;
+  options->explicit_instance = 1;
+  options->explicit_attribute = 1;
+
+  while (-1 != (option = getopt(argc, argv, "a:d:n:m:r:s:Mo:i:c:h:g:"))) {
+    switch (option) {
+      case 'a':
+        options->address = optarg;
+        break;
+      case 'd':
+        options->duration = atoi(optarg);
+        break;
+      case 'n':
+        options->number_of_sessions = atoi(optarg);
+        break;
+      case 'm':
+        options->number_of_connections = atoi(optarg);
+        break;
+      case 'r':
+        options->requested_packet_interval = (uint32_t) strtoul(optarg, NULL,
+                                                                0);
+        break;
+      case 's':
+        options->assembly_size = atoi(optarg);
+        break;
+      case 'M':
+        options->multicast = 1;
+        break;
+      case 'o':
+        options->output_assembly = (unsigned int) strtoul(optarg, NULL, 0);
+        break;
+      case 'i':
+        options->input_assembly = (unsigned int) strtoul(optarg, NULL, 0);
+        break;
+      case 'c':
+        options->config_assembly = (unsigned int) strtoul(optarg, NULL, 0);
+        break;
+      case 'h':
+        options->heartbeat_assembly = (unsigned int) strtoul(optarg, NULL, 0);
+        break;
+      case 'g': {
+        char *end = optarg;
+        options->explicit_class = (unsigned int) strtoul(end, &end, 0);
+        if ('/' != *end++) {
+          return 0;
+        }
+        options->explicit_instance = (unsigned int) strtoul(end, &end, 0);
+        if ('/' != *end++) {
+          return 0;
+        }
+        options->explicit_attribute = (unsigned int) strtoul(end, &end, 0);
+        if ('\0' != *end) {
+          return 0;
+        }
+        break;
+      }
+      default:
+        return 0;
+    }
+  }
+
+  /* 8 bit logical segments only */
+  return (optind == argc) && (0 < options->duration)
+      && (1 <= options->number_of_sessions)
+      && (0 <= options->number_of_connections)
+      && (1000 <= options->requested_packet_interval)
+      && (0 < options->assembly_size) && (400 >= options->assembly_size)
+      && (256 > options->output_assembly) && (256 > options->input_assembly)
+      && (256 > options->config_assembly)
+      && (256 > options->heartbeat_assembly)
+      && (256 > options->explicit_class) && (256 > options->explicit_instance)
+      && (256 > options->explicit_attribute);
+}
+
+int OpenSimulatorSession(const SimulatorOptions *options,
+                         SimulatorSession *session) {
+  struct sockaddr_in address;
+  uint8_t request[SIMULATOR_ENCAPSULATION_HEADER_LENGTH + 4];
+  uint8_t *position = request;
+  int no_delay = 1;
+
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(SIMULATOR_ENCAPSULATION_PORT);
+  address.sin_addr.s_addr = inet_addr(options->address);
+
+  session->socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if ((0 > session->socket)
+      || (0 != connect(session->socket, (struct sockaddr *) &address,
+                       sizeof(address)))) {
+    perror("connect");
+    return 0;
+  }
+  setsockopt(session->socket, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+             sizeof(no_delay));
+
+  memset(request, 0, sizeof(request));
+  PutUint16(&position, 0x65); /* RegisterSession */
+  PutUint16(&position, 4);
+  position = &request[SIMULATOR_ENCAPSULATION_HEADER_LENGTH];
+  PutUint16(&position, 1); /* protocol version */
+  PutUint16(&position, 0); /* options */
+  if (sizeof(request) != (size_t) send(session->socket, request,
+                                       sizeof(request), 0)) {
+    return 0;
+  }
+  size_t length = ReceiveSimulatorReply(session);
+  session->received = 0;
+  if ((SIMULATOR_ENCAPSULATION_HEADER_LENGTH > length)
+      || (0 != GetUint32(&session->buffer[8]))) {
+    return 0;
+  }
+  session->session_handle = GetUint32(&session->buffer[4]);
+  return 1;
+}
+
+int SendSimulatorRequest(SimulatorSession *session, const uint8_t *request,
+                         size_t request_length, const uint8_t *extra_item,
+                         size_t extra_item_length) {
+  uint8_t message[SIMULATOR_BUFFER_SIZE];
+  uint8_t *position = message;
+  size_t data_length = 6 + 4 + 4 + request_length + extra_item_length + 2;
+
+  if (sizeof(message) < SIMULATOR_ENCAPSULATION_HEADER_LENGTH + data_length) {
+    return 0;
+  }
+  memset(message, 0, SIMULATOR_ENCAPSULATION_HEADER_LENGTH);
+  PutUint16(&position, 0x6F); /* SendRRData */
+  PutUint16(&position, (uint16_t) data_length);
+  PutUint32(&position, session->session_handle);
+  position = &message[SIMULATOR_ENCAPSULATION_HEADER_LENGTH];
+  PutUint32(&position, 0); /* interface handle */
+  PutUint16(&position, 0); /* timeout */
+  PutUint16(&position, (NULL != extra_item) ? 3 : 2); /* item count */
+  PutUint16(&position, 0); /* null address item */
+  PutUint16(&position, 0);
+  PutUint16(&position, 0xB2); /* unconnected data item */
+  PutUint16(&position, (uint16_t) request_length);
+  memcpy(position, request, request_length);
+  position += request_length;
+  if (NULL != extra_item) {
+    memcpy(position, extra_item, extra_item_length);
+    position += extra_item_length;
+  }
+
+  size_t length = position - message;
+  return length == (size_t) send(session->socket, message, length, 0);
+}
+
+size_t ReceiveSimulatorReply(SimulatorSession *session) {
+  uint64_t deadline = GetSimulatorTime() + SIMULATOR_SETUP_TIMEOUT * 1000ULL;
+  int result;
+
+  session->received = 0;
+  while (0 == (result = ReceiveExplicitLoadReply(session))) {
+    struct pollfd entry = { session->socket, POLLIN, 0 };
+    uint64_t now = GetSimulatorTime();
+    if ((now >= deadline)
+        || (0 >= poll(&entry, 1, (int) ((deadline - now) / 1000) + 1))) {
+      return 0;
+    }
+  }
+  return (1 == result) ? session->received : 0;
+}
+
+const uint8_t *FindCommonPacketFormatItem(const uint8_t *message,
+                                          size_t length, uint16_t type_id,
+                                          uint16_t *item_length) {
+  size_t offset = SIMULATOR_ENCAPSULATION_HEADER_LENGTH + 6;
+
+  if (offset + 2 > length) {
+    return NULL;
+  }
+  uint16_t item_count = GetUint16(&message[offset]);
+  offset += 2;
+  for (uint16_t i = 0; (i < item_count) && (offset + 4 <= length); i++) {
+    uint16_t type = GetUint16(&message[offset]);
+    uint16_t data_length = GetUint16(&message[offset + 2]);
+    if (offset + 4 + data_length > length) {
+      return NULL;
+    }
+    if (type == type_id) {
+      if (NULL != item_length) {
+        *item_length = data_length;
+      }
+      return &message[offset + 4];
+    }
+    offset += 4 + data_length;
+  }
+  return NULL;
+}
+
+int OpenSimulatorConnection(const SimulatorOptions *options,
+                            SimulatorSession *session,
+                            SimulatorConnection *connection, int index,
+                            uint16_t udp_port,
+                            struct sockaddr_in *multicast_address) {
+  uint8_t request[64];
+  uint8_t sockaddr_item[20];
+  uint8_t *position = request;
+  uint16_t item_length = 0;
+
+  connection->exclusive_owner = (0 == index);
+  connection->connection_serial_number = (uint16_t) (0x1000 + index);
+  connection->t_to_o_connection_id = 0x53490000U + (uint32_t) index;
+
+  /* O->T: run/idle header and data, or the sequence count of a heartbeat */
+  uint16_t o_to_t_size =
+      connection->exclusive_owner ?
+          (uint16_t) (options->assembly_size + 6) : 2;
+  uint16_t t_to_o_size = (uint16_t) (options->assembly_size + 2);
+  uint16_t point_to_point = 0x4000;
+  uint16_t multicast = 0x2000;
+
+  *position++ = 0x54; /* Forward_Open */
+  *position++ = 2;
+  *position++ = 0x20;
+  *position++ = 0x06;
+  *position++ = 0x24;
+  *position++ = 0x01;
+  *position++ = 0x0A; /* priority/time tick */
+  *position++ = 0x0E; /* timeout ticks */
+  PutUint32(&position, 0); /* O->T connection ID, chosen by the target */
+  PutUint32(&position, connection->t_to_o_connection_id);
+  PutUint16(&position, connection->connection_serial_number);
+  PutUint16(&position, SIMULATOR_VENDOR_ID);
+  PutUint32(&position, (uint32_t) getpid());
+  *position++ = 2; /* connection timeout multiplier */
+  *position++ = 0;
+  *position++ = 0;
+  *position++ = 0;
+  PutUint32(&position, options->requested_packet_interval);
+  PutUint16(&position, point_to_point | o_to_t_size);
+  PutUint32(&position, options->requested_packet_interval);
+  PutUint16(&position,
+            (options->multicast ? multicast : point_to_point) | t_to_o_size);
+  *position++ = 0x01; /* class 1, cyclic */
+  *position++ = 4; /* connection path size in words */
+  *position++ = 0x20;
+  *position++ = 0x04;
+  *position++ = 0x24;
+  *position++ = (uint8_t) options->config_assembly;
+  *position++ = 0x2C;
+  *position++ = (uint8_t) (
+      connection->exclusive_owner ?
+          options->output_assembly : options->heartbeat_assembly);
+  *position++ = 0x2C;
+  *position++ = (uint8_t) options->input_assembly;
+
+  /* T->O sockaddr info item telling the target our UDP port */
+  uint8_t *item = sockaddr_item;
+  PutUint16(&item, 0x8001);
+  PutUint16(&item, 16);
+  memset(item, 0, 16);
+  item[1] = AF_INET; /* the sockaddr info is big endian */
+  item[2] = (uint8_t) (udp_port >> 8);
+  item[3] = (uint8_t) udp_port;
+
+  if (!SendSimulatorRequest(session, request, position - request,
+                            options->multicast ? NULL : sockaddr_item,
+                            options->multicast ? 0 : sizeof(sockaddr_item))) {
+    return 0;
+  }
+  size_t length = ReceiveSimulatorReply(session);
+  const uint8_t *reply = FindCommonPacketFormatItem(session->buffer, length,
+                                                    0xB2, &item_length);
+  session->received = 0;
+  if ((NULL == reply) || (4 > item_length)) {
+    return 0;
+  }
+  if (0 != reply[2]) {
+    printf("Forward_Open refused: general status 0x%02x, extended status "
+           "0x%04x\n",
+           reply[2], (4 <= reply[3]) ? GetUint16(&reply[4]) : 0);
+    return 0;
+  }
+  if (4 + 26 > item_length) {
+    return 0;
+  }
+  connection->o_to_t_connection_id = GetUint32(&reply[4]);
+  connection->t_to_o_connection_id = GetUint32(&reply[8]);
+  connection->o_to_t_packet_interval = GetUint32(&reply[4 + 16]);
+  connection->t_to_o_packet_interval = GetUint32(&reply[4 + 20]);
+  if (0 == connection->o_to_t_packet_interval) {
+    connection->o_to_t_packet_interval = options->requested_packet_interval;
+  }
+
+  if (options->multicast) {
+    const uint8_t *multicast_item = FindCommonPacketFormatItem(
+        session->buffer, length, 0x8001, &item_length);
+    if ((NULL == multicast_item) || (16 > item_length)) {
+      printf("Forward_Open reply without T->O multicast address\n");
+      return 0;
+    }
+    multicast_address->sin_family = AF_INET;
+    memcpy(&multicast_address->sin_port, &multicast_item[2], 2);
+    memcpy(&multicast_address->sin_addr, &multicast_item[4], 4);
+  }
+  connection->open = 1;
+  return 1;
+}
+
+void CloseSimulatorConnection(const SimulatorOptions *options,
+                              SimulatorSession *session,
+                              SimulatorConnection *connection) {
+  uint8_t request[32];
+  uint8_t *position = request;
+
+  *position++ = 0x4E; /* Forward_Close */
+  *position++ = 2;
+  *position++ = 0x20;
+  *position++ = 0x06;
+  *position++ = 0x24;
+  *position++ = 0x01;
+  *position++ = 0x0A;
+  *position++ = 0x0E;
+  PutUint16(&position, connection->connection_serial_number);
+  PutUint16(&position, SIMULATOR_VENDOR_ID);
+  PutUint32(&position, (uint32_t) getpid());
+  *position++ = 3; /* connection path size in words */
+  *position++ = 0;
+  *position++ = 0x20;
+  *position++ = 0x04;
+  *position++ = 0x24;
+  *position++ = (uint8_t) options->config_assembly;
+  *position++ = 0x2C;
+  *position++ = (uint8_t) options->input_assembly;
+
+  if (SendSimulatorRequest(session, request, position - request, NULL, 0)) {
+    ReceiveSimulatorReply(session);
+  }
+  session->received = 0;
+  connection->open = 0;
+}
+
+void ProduceSimulatorConnection(const SimulatorOptions *options,
+                                int udp_socket,
+                                const struct sockaddr_in *adapter_address,
+                                SimulatorConnection *connection) {
+  uint8_t packet[SIMULATOR_BUFFER_SIZE];
+  uint8_t *position = packet;
+  uint16_t data_length =
+      connection->exclusive_owner ?
+          (uint16_t) (options->assembly_size + 6) : 2;
+
+  connection->eip_sequence_count++;
+  connection->sequence_count++;
+  PutUint16(&position, 2); /* item count */
+  PutUint16(&position, 0x8002); /* sequenced address item */
+  PutUint16(&position, 8);
+  PutUint32(&position, connection->o_to_t_connection_id);
+  PutUint32(&position, connection->eip_sequence_count);
+  PutUint16(&position, 0xB1); /* connected data item */
+  PutUint16(&position, data_length);
+  PutUint16(&position, connection->sequence_count);
+  if (connection->exclusive_owner) {
+    PutUint32(&position, 1); /* run */
+    memset(position, (uint8_t) connection->sequence_count,
+           options->assembly_size);
+    position += options->assembly_size;
+  }
+
+  if (0 < sendto(udp_socket, packet, position - packet, 0,
+                 (const struct sockaddr *) adapter_address,
+                 sizeof(*adapter_address))) {
+    connection->produced_packets++;
+  }
+}
+
+void ConsumeSimulatorPacket(SimulatorConnection *connections,
+                            int number_of_connections, const uint8_t *data,
+                            size_t length, uint64_t receive_time) {
+  /* item count, sequenced address item, connected data item header */
+  if ((18 > length) || (2 != GetUint16(data))
+      || (0x8002 != GetUint16(&data[2]))) {
+    return;
+  }
+  uint32_t connection_id = GetUint32(&data[6]);
+  uint32_t sequence = GetUint32(&data[10]);
+
+  /* multicast connections of the same input share one connection ID */
+  for (int i = 0; i < number_of_connections; i++) {
+    SimulatorConnection *connection = &connections[i];
+    if ((!connection->open)
+        || (connection->t_to_o_connection_id != connection_id)) {
+      continue;
+    }
+    if (0 != connection->consumed_packets) {
+      uint32_t difference = sequence - connection->last_consumed_sequence;
+      if ((0 == difference) || (0x80000000U < difference)) {
+        continue; /* duplicate or reordered */
+      }
+      connection->missed_packets += difference - 1;
+
+      uint64_t inter_arrival_time = receive_time
+          - connection->last_receive_time;
+      uint64_t interval = connection->t_to_o_packet_interval;
+      uint64_t deviation =
+          (inter_arrival_time > interval) ?
+              inter_arrival_time - interval : interval - inter_arrival_time;
+      connection->total_deviation += deviation;
+      if (deviation > connection->max_deviation) {
+        connection->max_deviation = deviation;
+      }
+    }
+    connection->last_consumed_sequence = sequence;
+    connection->last_receive_time = receive_time;
+    connection->consumed_packets++;
+  }
+}
+
+int SendExplicitLoadRequest(const SimulatorOptions *options,
+                            SimulatorSession *session) {
+  uint8_t request[8] = { 0x0E, 3, 0x20, (uint8_t) options->explicit_class,
+      0x24, (uint8_t) options->explicit_instance, 0x30,
+      (uint8_t) options->explicit_attribute };
+
+  session->request_time = GetSimulatorTime();
+  session->received = 0;
+  if (!SendSimulatorRequest(session, request, sizeof(request), NULL, 0)) {
+    perror("send");
+    return 0;
+  }
+  session->outstanding = 1;
+  return 1;
+}
+
+int ReceiveExplicitLoadReply(SimulatorSession *session) {
+  size_t expected = SIMULATOR_ENCAPSULATION_HEADER_LENGTH;
+
+  if (SIMULATOR_ENCAPSULATION_HEADER_LENGTH <= session->received) {
+    expected += GetUint16(&session->buffer[2]);
+  }
+  if (sizeof(session->buffer) < expected) {
+    return -1;
+  }
+  ssize_t length = recv(session->socket, &session->buffer[session->received],
+                        expected - session->received, MSG_DONTWAIT);
+  if (0 == length) {
+    return -1;
+  }
+  if (0 > length) {
+    return ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) ?
+        0 : -1;
+  }
+  session->received += (size_t) length;
+  if (SIMULATOR_ENCAPSULATION_HEADER_LENGTH > session->received) {
+    return 0;
+  }
+  expected = SIMULATOR_ENCAPSULATION_HEADER_LENGTH
+      + GetUint16(&session->buffer[2]);
+  if (session->received < expected) {
+    /* the header just completed, read the data with the next call */
+    return (sizeof(session->buffer) < expected) ? -1 : 0;
+  }
+  session->outstanding = 0;
+  return 1;
+}
+
+void AddLatencySample(LatencySamples *latencies, uint64_t latency) {
+  if (latencies->count == latencies->capacity) {
+    size_t capacity = (0 == latencies->capacity) ? 4096 :
+        latencies->capacity * 2;
+    uint64_t *samples = realloc(latencies->samples,
+                                capacity * sizeof(uint64_t));
+    if (NULL == samples) {
+      return;
+    }
+    latencies->samples = samples;
+    latencies->capacity = capacity;
+  }
+  latencies->samples[latencies->count++] = latency;
+}
+
+int CompareLatencies(const void *first, const void *second) {
+  uint64_t first_latency = *(const uint64_t *) first;
+  uint64_t second_latency = *(const uint64_t *) second;
+  return (first_latency > second_latency) - (first_latency < second_latency);
+}
+
+uint64_t GetLatencyPercentile(const LatencySamples *latencies,
+                              unsigned int percentile) {
+  if (0 == latencies->count) {
+    return 0;
+  }
+  size_t index = (latencies->count * percentile + 99) / 100;
+  return latencies->samples[(0 == index) ? 0 : index - 1];
+}
+
+void PrintSimulatorResults(const SimulatorOptions *options,
+                           const SimulatorConnection *connections,
+                           LatencySamples *latencies,
+                           uint64_t explicit_errors, double elapsed_seconds) {
+  uint64_t total_produced = 0;
+  uint64_t total_consumed = 0;
+  uint64_t total_missed = 0;
+
+  printf("%.1f s, %d sessions, %d connections, RPI %lu us, %d byte "
+         "assemblies, T->O %s\n",
+         elapsed_seconds, options->number_of_sessions,
+         options->number_of_connections,
+         (unsigned long) options->requested_packet_interval,
+         options->assembly_size,
+         options->multicast ? "multicast" : "point-to-point");
+
+  for (int i = 0; i < options->number_of_connections; i++) {
+    const SimulatorConnection *connection = &connections[i];
+    uint64_t deviations = (1 < connection->consumed_packets) ?
+        connection->consumed_packets - 1 : 1;
+
+    printf("connection %d (%s): produced %llu (%.1f/s), consumed %llu "
+           "(%.1f/s), missed %llu, RPI deviation mean %llu us max %llu us\n",
+           i + 1, connection->exclusive_owner ? "exclusive owner" :
+               "input only",
+           (unsigned long long) connection->produced_packets,
+           connection->produced_packets / elapsed_seconds,
+           (unsigned long long) connection->consumed_packets,
+           connection->consumed_packets / elapsed_seconds,
+           (unsigned long long) connection->missed_packets,
+           (unsigned long long) (connection->total_deviation / deviations),
+           (unsigned long long) connection->max_deviation);
+    total_produced += connection->produced_packets;
+    total_consumed += connection->consumed_packets;
+    total_missed += connection->missed_packets;
+  }
+  if (0 != options->number_of_connections) {
+    printf("I/O total: produced %.1f/s, consumed %.1f/s, missed %llu\n",
+           total_produced / elapsed_seconds, total_consumed / elapsed_seconds,
+           (unsigned long long) total_missed);
+  }
+
+  qsort(latencies->samples, latencies->count, sizeof(uint64_t),
+        CompareLatencies);
+  printf("explicit: %llu requests (%.1f/s), %llu errors, latency p50 %llu us "
+         "p90 %llu us p99 %llu us max %llu us\n",
+         (unsigned long long) latencies->count,
+         latencies->count / elapsed_seconds,
+         (unsigned long long) explicit_errors,
+         (unsigned long long) GetLatencyPercentile(latencies, 50),
+         (unsigned long long) GetLatencyPercentile(latencies, 90),
+         (unsigned long long) GetLatencyPercentile(latencies, 99),
+         (unsigned long long) GetLatencyPercentile(latencies, 100));
+}
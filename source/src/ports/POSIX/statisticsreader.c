@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "statisticssegment.h"
+
+/** @file statisticsreader.c
+ * @brief Prints the statistics an OpENer process publishes in its statistics
+ * segment
+ *
+ * Usage: opener_statistics [statistics segment file]
+ */
+
+/** @brief Default location of the shared memory object of the statistics */
+#define OPENER_STATISTICS_SEGMENT_DEFAULT_FILE "/dev/shm" OPENER_STATISTICS_SEGMENT_NAME
+
+/** @brief Number of attempts to get a consistent copy of the segment */
+#define OPENER_STATISTICS_READ_ATTEMPTS 100
+
+/** @brief Copy the segment while it is not updated
+ *
+ * @param segment the mapped segment
+ * @param copy the copy to fill
+ * @return 1 on success, 0 if no consistent copy could be taken
+ */
+int CopyStatisticsSegment(const StatisticsSegment *segment,
+                          StatisticsSegment *copy);
+
+/** @brief Print a copy of the statistics segment as text */
+void PrintStatisticsSegment(const StatisticsSegment *segment);
+
+/** @brief Print the inter-arrival times of the data consumed by a connection */
+void PrintReceiveStatistics(const StatisticsSegmentConnection *connection);
+
+int main(int argc, char *argv[]) {
+  const char *file_name = OPENER_STATISTICS_SEGMENT_DEFAULT_FILE;
+  struct stat file_status;
+  StatisticsSegment copy;
+
+  if (2 < argc) {
+    printf("Usage: %s [statistics segment file]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (2 == argc) {
+    file_name = argv[1];
+  }
+
+  int file_descriptor = open(file_name, O_RDONLY);
+  if (0 > file_descriptor) {
+    perror(file_name);
+    return EXIT_FAILURE;
+  }
+  if ((0 != fstat(file_descriptor, &file_status))
+      || (sizeof(StatisticsSegment) > (size_t) file_status.st_size)) {
+    printf("%s is not an OpENer statistics segment\n", file_name);
+    close(file_descriptor);
+    return EXIT_FAILURE;
+  }
+  const StatisticsSegment *segment = mmap(NULL, sizeof(StatisticsSegment),
+                                          PROT_READ, MAP_SHARED,
+                                          file_descriptor, 0);
+  close(file_descriptor);
+  if (MAP_FAILED == segment) {
+    perror(file_name);
+    return EXIT_FAILURE;
+  }
+
+  if ((OPENER_STATISTICS_SEGMENT_MAGIC != segment->magic)
+      || (OPENER_STATISTICS_SEGMENT_VERSION != segment->version)) {
+    printf("%s is not an OpENer statistics segment of this version\n",
+           file_name);
+    return EXIT_FAILURE;
+  }
+  if (!CopyStatisticsSegment(segment, &copy)) {
+    printf("%s is updated continuously, no consistent copy\n", file_name);
+    return EXIT_FAILURE;
+  }
+  PrintStatisticsSegment(&copy);
+  return EXIT_SUCCESS;
+}
+
+int CopyStatisticsSegment(const StatisticsSegment *segment,
+                          StatisticsSegment *copy) {
+  const struct timespec retry_delay = { 0, 1000000 };
+
+  for (int i = 0; i < OPENER_STATISTICS_READ_ATTEMPTS; i++) {
+    uint32_t update_count = __atomic_load_n(&segment->update_count,
+                                            __ATOMIC_ACQUIRE);
+    if (update_count & 1) {
+      nanosleep(&retry_delay, NULL);
+      continue;
+    }
+    memcpy(copy, segment, sizeof(StatisticsSegment));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (update_count
+        == __atomic_load_n(&segment->update_count, __ATOMIC_RELAXED)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void PrintStatisticsSegment(const StatisticsSegment *segment) {
+  const OpenerStatisticsSnapshot *statistics = &segment->statistics;
+  const OpenerStatistics *counters = &statistics->counters;
+
+  printf("statistics of process %u, update %u at %llu us\n",
+         (unsigned) segment->process_id, (unsigned) (segment->update_count / 2),
+         (unsigned long long) segment->update_time);
+  printf("network handler: %u iterations, %u busy, max iteration %u us, "
+         "max processing %u us\n",
+         (unsigned) statistics->loop_iterations,
+         (unsigned) statistics->busy_loop_iterations,
+         (unsigned) statistics->max_loop_iteration_time,
+         (unsigned) statistics->max_loop_processing_time);
+  printf("network: %u UDP packets, %u TCP messages, %u too large\n",
+         (unsigned) counters->udp_packets_received,
+         (unsigned) counters->tcp_messages_received,
+         (unsigned) counters->too_large_tcp_messages);
+  printf("encapsulation: %u sessions registered, %u errors\n",
+         (unsigned) counters->registered_sessions,
+         (unsigned) counters->encapsulation_errors);
+  printf("message router: %u requests, %u error responses\n",
+         (unsigned) counters->explicit_requests,
+         (unsigned) counters->explicit_error_responses);
+  printf("connection manager: %u forward opens, %u rejected, %u timeouts\n",
+         (unsigned) statistics->forward_open_requests,
+         (unsigned) statistics->forward_open_rejections,
+         (unsigned) counters->connection_timeouts);
+  printf("I/O: %u consumed, %u produced, %u wrong size, %u wrong originator, "
+         "%u unknown connection\n",
+         (unsigned) counters->io_packets_consumed,
+         (unsigned) counters->io_packets_produced,
+         (unsigned) counters->io_packets_wrong_size,
+         (unsigned) counters->io_packets_wrong_originator,
+         (unsigned) counters->io_packets_unknown_connection);
+
+  printf("%u active connections\n",
+         (unsigned) (segment->number_of_connections
+             + segment->omitted_connections));
+  for (uint32_t i = 0; i < segment->number_of_connections; i++) {
+    const StatisticsSegmentConnection *connection = &segment->connections[i];
+    printf("  serial %04x vendor %04x originator %08x O->T %08x T->O %08x: "
+           "%u consumed, %u produced, %u duplicate, %u wrong originator, "
+           "%u refused\n",
+           (unsigned) connection->connection_serial_number,
+           (unsigned) connection->originator_vendor_id,
+           (unsigned) connection->originator_serial_number,
+           (unsigned) connection->consumed_connection_id,
+           (unsigned) connection->produced_connection_id,
+           (unsigned) connection->receive_statistics.received_packets,
+           (unsigned) connection->packet_statistics.produced_packets,
+           (unsigned) connection->packet_statistics.duplicate_packets,
+           (unsigned) connection->packet_statistics.wrong_originator_packets,
+           (unsigned) connection->packet_statistics.refused_packets);
+    PrintReceiveStatistics(connection);
+  }
+  if (0 != segment->omitted_connections) {
+    printf("  %u connections omitted\n",
+           (unsigned) segment->omitted_connections);
+  }
+}
+
+void PrintReceiveStatistics(const StatisticsSegmentConnection *connection) {
+  const ConnectionReceiveStatistics *statistics = &connection
+      ->receive_statistics;
+
+  if (2 > statistics->received_packets) {
+    return;
+  }
+  printf("    RPI %u us: inter-arrival min %llu us, max %llu us, "
+         "RPI deviation max %llu us, mean %llu us\n",
+         (unsigned) connection->o_to_t_requested_packet_interval,
+         (unsigned long long) statistics->min_inter_arrival_time,
+         (unsigned long long) statistics->max_inter_arrival_time,
+         (unsigned long long) statistics->max_rpi_deviation,
+         (unsigned long long) (statistics->total_rpi_deviation
+             / (statistics->received_packets - 1)));
+  printf("    inter-arrival histogram (RPI/4 steps):");
+  for (size_t i = 0; i < OPENER_RECEIVE_HISTOGRAM_BINS; i++) {
+    printf(" %u", (unsigned) statistics->inter_arrival_histogram[i]);
+  }
+  printf("\n");
+}
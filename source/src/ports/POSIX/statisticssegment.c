@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "statisticssegment.h"
+
+#include "generic_networkhandler.h"
+#include "trace.h"
+#include "opener_stack.h"
+
+/** @brief The statistics segment of this process, NULL until set up */
+StatisticsSegment *g_statistics_segment = NULL;
+
+/** @brief Set if the statistics segment could not be set up */
+int g_statistics_segment_unavailable = 0;
+
+/** @brief Map the shared memory object and initialize an empty segment in it
+ *
+ * @return 1 on success, 0 if the shared memory object could not be set up
+ */
+int SetupStatisticsSegment(void);
+
+/** @brief Copy the packet counters of the active connections into the segment
+ *
+ * @param segment the segment to fill
+ */
+void CollectConnectionStatistics(StatisticsSegment *segment);
+
+int SetupStatisticsSegment(void) {
+  int file_descriptor = shm_open(OPENER_STATISTICS_SEGMENT_NAME,
+                                 O_CREAT | O_RDWR, 0644);
+  if (0 > file_descriptor) {
+    return 0;
+  }
+  if (0 != ftruncate(file_descriptor, sizeof(StatisticsSegment))) {
+    close(file_descriptor);
+    return 0;
+  }
+  void *memory = mmap(NULL, sizeof(StatisticsSegment), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, file_descriptor, 0);
+  close(file_descriptor);
+  if (MAP_FAILED == memory) {
+    return 0;
+  }
+
+  StatisticsSegment *segment = (StatisticsSegment *) memory;
+  memset(segment, 0, sizeof(StatisticsSegment));
+  segment->magic = OPENER_STATISTICS_SEGMENT_MAGIC;
+  segment->version = OPENER_STATISTICS_SEGMENT_VERSION;
+  segment->process_id = (uint32_t) getpid();
+
+  g_statistics_segment = segment;
+  return 1;
+}
+
+void CollectConnectionStatistics(StatisticsSegment *segment) {
+  ConnectionObject *connection_object = g_opener_stack->active_connection_list;
+  uint32_t number_of_connections = 0;
+  uint32_t omitted_connections = 0;
+
+  for (; NULL != connection_object;
+      connection_object = connection_object->next_connection_object) {
+    if (OPENER_STATISTICS_SEGMENT_CONNECTIONS <= number_of_connections) {
+      omitted_connections++;
+      continue;
+    }
+    StatisticsSegmentConnection *entry =
+        &segment->connections[number_of_connections++];
+    entry->connection_serial_number = connection_object
+        ->connection_serial_number;
+    entry->originator_vendor_id = connection_object->originator_vendor_id;
+    entry->originator_serial_number = connection_object
+        ->originator_serial_number;
+    entry->consumed_connection_id = connection_object->consumed_connection_id;
+    entry->produced_connection_id = connection_object->produced_connection_id;
+    entry->o_to_t_requested_packet_interval = connection_object
+        ->o_to_t_requested_packet_interval;
+    entry->receive_statistics = connection_object->receive_statistics;
+    entry->packet_statistics = connection_object->packet_statistics;
+  }
+  segment->number_of_connections = number_of_connections;
+  segment->omitted_connections = omitted_connections;
+}
+
+void UpdateStatisticsSegment(void) {
+  MicroSeconds now = GetMicroSeconds();
+
+  if (NULL == g_statistics_segment) {
+    if (g_statistics_segment_unavailable) {
+      return;
+    }
+    if (!SetupStatisticsSegment()) {
+      OPENER_TRACE_ERR("statistics segment %s could not be set up\n",
+                       OPENER_STATISTICS_SEGMENT_NAME);
+      g_statistics_segment_unavailable = 1;
+      return;
+    }
+  } else if (now - g_statistics_segment->update_time
+      < OPENER_STATISTICS_SEGMENT_UPDATE_INTERVAL) {
+    return;
+  }
+
+  /* readers retry while the update count is odd or changed during reading */
+  uint32_t update_count = g_statistics_segment->update_count;
+  __atomic_store_n(&g_statistics_segment->update_count, update_count + 1,
+                   __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  g_statistics_segment->update_time = now;
+  CollectOpenerStatistics(&g_statistics_segment->statistics);
+  CollectConnectionStatistics(g_statistics_segment);
+
+  __atomic_store_n(&g_statistics_segment->update_count, update_count + 2,
+                   __ATOMIC_RELEASE);
+}
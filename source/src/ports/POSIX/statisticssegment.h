@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_STATISTICSSEGMENT_H_
+#define OPENER_STATISTICSSEGMENT_H_
+
+#include <stdint.h>
+
+#include "cipstatistics.h"
+#include "cipconnectionmanager.h"
+
+/** @file statisticssegment.h
+ * @brief Publishes the statistics of the stack into a shared memory segment
+ *
+ * The segment OPENER_STATISTICS_SEGMENT_NAME holds a snapshot of the global
+ * statistics and the packet counters of the active connections. It is
+ * rewritten at most every OPENER_STATISTICS_SEGMENT_UPDATE_INTERVAL by the
+ * stack's thread, monitoring tools such as opener_statistics map it read-only
+ * without disturbing the stack.
+ *
+ * All counters are cumulative, rates have to be computed by the reader from
+ * two snapshots and their update times.
+ */
+
+/** @brief Name of the shared memory object holding the statistics */
+#define OPENER_STATISTICS_SEGMENT_NAME "/opener_statistics"
+
+/** @brief Minimal time between two updates of the segment in us */
+#define OPENER_STATISTICS_SEGMENT_UPDATE_INTERVAL 1000000
+
+/** @brief Number of connections the segment can report */
+#define OPENER_STATISTICS_SEGMENT_CONNECTIONS 64
+
+/** @brief Value identifying a statistics segment, "OpSt" */
+#define OPENER_STATISTICS_SEGMENT_MAGIC 0x7453704FU
+
+#define OPENER_STATISTICS_SEGMENT_VERSION 2
+
+/** @brief Statistics of one active connection
+ *
+ *  The inter-arrival histogram of the receive statistics counts in quarters of
+ *  o_to_t_requested_packet_interval.
+ */
+typedef struct {
+  uint16_t connection_serial_number;
+  uint16_t originator_vendor_id;
+  uint32_t originator_serial_number;
+  uint32_t consumed_connection_id;
+  uint32_t produced_connection_id;
+  uint32_t o_to_t_requested_packet_interval; /**< in us */
+  ConnectionReceiveStatistics receive_statistics;
+  ConnectionPacketStatistics packet_statistics;
+} StatisticsSegmentConnection;
+
+/** @brief Layout of the shared memory object */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t update_count; /**< incremented before and after each update, odd while the segment is updated */
+  uint32_t process_id; /**< process publishing the statistics */
+  uint64_t update_time; /**< time of the last update in us, as GetMicroSeconds() */
+  uint32_t number_of_connections; /**< valid entries of connections */
+  uint32_t omitted_connections; /**< active connections not fitting into connections */
+  OpenerStatisticsSnapshot statistics;
+  StatisticsSegmentConnection connections[OPENER_STATISTICS_SEGMENT_CONNECTIONS];
+} StatisticsSegment;
+
+/** @brief Update the statistics segment if the update interval has elapsed
+ *
+ * Sets up the segment on the first call. If the shared memory object can not
+ * be set up, the statistics are not published.
+ */
+void UpdateStatisticsSegment(void);
+
+#endif /* OPENER_STATISTICSSEGMENT_H_ */
@@ -0,0 +1,251 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tracering.h"
+
+/** @file tracedecoder.c
+ * @brief Renders the records of an OpENer trace ring as text
+ *
+ * Usage: opener_trace_decode [trace ring file]
+ *
+ * The default file is the shared memory object of the trace ring. A copy of
+ * it, e.g., taken from a device after an incident, can be decoded as well.
+ */
+
+/** @brief Default location of the shared memory object of the trace ring */
+#define OPENER_TRACE_RING_DEFAULT_FILE "/dev/shm" OPENER_TRACE_RING_NAME
+
+/** @brief Print one conversion of a format string with its recorded arguments
+ *
+ * @param conversion the conversion, e.g., "%08lx"
+ * @param type kind of argument the conversion consumes
+ * @param star_arguments number of '*' fields of the conversion
+ * @param payload position in the payload, advanced behind the used arguments
+ * @param payload_end end of the used payload
+ * @return 0 if the payload did not hold all arguments of the conversion
+ */
+int PrintTraceConversion(const char *conversion, TraceArgumentType type,
+                         int star_arguments, const uint8_t **payload,
+                         const uint8_t *payload_end);
+
+/** @brief Print a trace record as text
+ *
+ * @param ring the trace ring
+ * @param record the record to print
+ */
+void PrintTraceRecord(const TraceRing *ring, const TraceRingRecord *record);
+
+int main(int argc, char *argv[]) {
+  const char *file_name = OPENER_TRACE_RING_DEFAULT_FILE;
+  struct stat file_status;
+
+  if (2 < argc) {
+    printf("Usage: %s [trace ring file]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (2 == argc) {
+    file_name = argv[1];
+  }
+
+  int file_descriptor = open(file_name, O_RDONLY);
+  if (0 > file_descriptor) {
+    perror(file_name);
+    return EXIT_FAILURE;
+  }
+  if ((0 != fstat(file_descriptor, &file_status))
+      || (sizeof(TraceRing) > (size_t) file_status.st_size)) {
+    printf("%s is not an OpENer trace ring\n", file_name);
+    close(file_descriptor);
+    return EXIT_FAILURE;
+  }
+  const TraceRing *ring = mmap(NULL, sizeof(TraceRing), PROT_READ, MAP_SHARED,
+                               file_descriptor, 0);
+  close(file_descriptor);
+  if (MAP_FAILED == ring) {
+    perror(file_name);
+    return EXIT_FAILURE;
+  }
+
+  if ((OPENER_TRACE_RING_MAGIC != ring->magic)
+      || (OPENER_TRACE_RING_VERSION != ring->version)
+      || (OPENER_TRACE_RING_RECORDS != ring->number_of_records)) {
+    printf("%s is not an OpENer trace ring of this version\n", file_name);
+    return EXIT_FAILURE;
+  }
+
+  uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint64_t sequence = (OPENER_TRACE_RING_RECORDS < head) ?
+      head - OPENER_TRACE_RING_RECORDS : 0;
+  unsigned long long skipped_records = 0;
+
+  printf("trace ring of process %u, %llu traces recorded\n",
+         (unsigned) ring->process_id, (unsigned long long) head);
+  for (; sequence < head; sequence++) {
+    const TraceRingRecord *record = &ring->records[sequence
+        & (OPENER_TRACE_RING_RECORDS - 1)];
+    TraceRingRecord copy = *record;
+
+    /* skip records being overwritten while we read them */
+    if ((sequence + 1 != __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE))
+        || (sequence + 1 != copy.sequence)) {
+      skipped_records++;
+      continue;
+    }
+    PrintTraceRecord(ring, &copy);
+  }
+  if (0 != skipped_records) {
+    printf("%llu records were overwritten while decoding\n", skipped_records);
+  }
+  return EXIT_SUCCESS;
+}
+
+void PrintTraceRecord(const TraceRing *ring, const TraceRingRecord *record) {
+  int64_t realtime = (int64_t) record->timestamp + ring->realtime_offset;
+  time_t seconds = (time_t) (realtime / 1000000000LL);
+  struct tm broken_down_time;
+  char time_string[32];
+
+  localtime_r(&seconds, &broken_down_time);
+  strftime(time_string, sizeof(time_string), "%Y-%m-%d %H:%M:%S",
+           &broken_down_time);
+  printf("[%s.%09lld] ", time_string, (long long) (realtime % 1000000000LL));
+
+  uint32_t number_of_formats = __atomic_load_n(&ring->number_of_formats,
+                                               __ATOMIC_ACQUIRE);
+  if ((OPENER_TRACE_RING_NO_FORMAT == record->format_id)
+      || (number_of_formats <= record->format_id)) {
+    printf("<format table full>\n");
+    return;
+  }
+
+  const char *format = &ring->format_area[ring->format_offsets[record
+      ->format_id]];
+  const uint8_t *payload = record->payload;
+  const uint8_t *payload_end = record->payload
+      + ((OPENER_TRACE_RING_PAYLOAD_SIZE < record->payload_length) ?
+          OPENER_TRACE_RING_PAYLOAD_SIZE : record->payload_length);
+  const char *text = format;
+  const char *conversion_start = NULL;
+  int star_arguments = 0;
+  TraceArgumentType type;
+
+  while (kTraceArgumentNone
+      != (type = TraceRingNextConversion(&format, &conversion_start,
+                                         &star_arguments))) {
+    char conversion[32];
+    size_t conversion_length = format - conversion_start;
+
+    fwrite(text, 1, conversion_start - text, stdout);
+    text = format;
+    if (kTraceArgumentLiteral == type) {
+      putchar('%');
+      continue;
+    }
+    if (sizeof(conversion) <= conversion_length) {
+      printf("<?>");
+      continue;
+    }
+    memcpy(conversion, conversion_start, conversion_length);
+    conversion[conversion_length] = '\0';
+    if (!PrintTraceConversion(conversion, type, star_arguments, &payload,
+                              payload_end)) {
+      printf("<truncated>");
+    }
+  }
+  /* remaining text, or everything behind an unsupported conversion */
+  fputs(text, stdout);
+}
+
+int PrintTraceConversion(const char *conversion, TraceArgumentType type,
+                         int star_arguments, const uint8_t **payload,
+                         const uint8_t *payload_end) {
+  int stars[2] = { 0, 0 };
+  uint64_t value;
+
+  for (int i = 0; i < star_arguments; i++) {
+    if (payload_end - *payload < (long) sizeof(value)) {
+      return 0;
+    }
+    memcpy(&value, *payload, sizeof(value));
+    *payload += sizeof(value);
+    if (i < 2) {
+      stars[i] = (int) (int64_t) value;
+    }
+  }
+
+  if (kTraceArgumentString == type) {
+    const uint8_t *string_end = memchr(*payload, '\0', payload_end - *payload);
+    if (NULL == string_end) {
+      return 0;
+    }
+    const char *string = (const char *) *payload;
+    *payload = string_end + 1;
+    switch (star_arguments) {
+      case 0:
+        printf(conversion, string);
+        break;
+      case 1:
+        printf(conversion, stars[0], string);
+        break;
+      default:
+        printf(conversion, stars[0], stars[1], string);
+        break;
+    }
+    return 1;
+  }
+
+  if (payload_end - *payload < (long) sizeof(value)) {
+    return 0;
+  }
+  memcpy(&value, *payload, sizeof(value));
+  *payload += sizeof(value);
+
+  /* the conversion is printed with the type it was recorded with */
+#define PRINT_TRACE_ARGUMENT(argument)                                    \
+  do {                                                                    \
+    switch (star_arguments) {                                             \
+      case 0: printf(conversion, argument); break;                        \
+      case 1: printf(conversion, stars[0], argument); break;              \
+      default: printf(conversion, stars[0], stars[1], argument); break;   \
+    }                                                                     \
+  } while (0)
+
+  switch (type) {
+    case kTraceArgumentInt:
+      PRINT_TRACE_ARGUMENT((int) (int64_t) value);
+      break;
+    case kTraceArgumentLong:
+      PRINT_TRACE_ARGUMENT((long) (int64_t) value);
+      break;
+    case kTraceArgumentLongLong:
+      PRINT_TRACE_ARGUMENT((long long) value);
+      break;
+    case kTraceArgumentSize:
+      PRINT_TRACE_ARGUMENT((size_t) value);
+      break;
+    case kTraceArgumentDouble: {
+      double double_value;
+      memcpy(&double_value, &value, sizeof(double_value));
+      PRINT_TRACE_ARGUMENT(double_value);
+      break;
+    }
+    case kTraceArgumentPointer:
+      PRINT_TRACE_ARGUMENT((void *) (uintptr_t) value);
+      break;
+    default:
+      break;
+  }
+#undef PRINT_TRACE_ARGUMENT
+  return 1;
+}
@@ -0,0 +1,287 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "tracering.h"
+
+/** @brief The trace ring of this process, NULL until set up */
+TraceRing *g_trace_ring = NULL;
+
+/** @brief Set if the trace ring could not be set up, the traces go to stderr */
+int g_trace_ring_unavailable = 0;
+
+/** @brief Map the shared memory object and initialize an empty ring in it
+ *
+ * @return 1 on success, 0 if the shared memory object could not be set up
+ */
+int SetupTraceRing(void);
+
+/** @brief Copy a format string into the format table
+ *
+ * @param format the format string
+ * @return ID of the format string, OPENER_TRACE_RING_NO_FORMAT if the table
+ * is full
+ */
+uint16_t RegisterTraceFormat(const char *format);
+
+/** @brief Get the time of a clock in ns */
+int64_t GetTraceRingTime(clockid_t clock);
+
+int SetupTraceRing(void) {
+  int file_descriptor = shm_open(OPENER_TRACE_RING_NAME, O_CREAT | O_RDWR,
+                                 0600);
+  if (0 > file_descriptor) {
+    return 0;
+  }
+  if (0 != ftruncate(file_descriptor, sizeof(TraceRing))) {
+    close(file_descriptor);
+    return 0;
+  }
+  void *memory = mmap(NULL, sizeof(TraceRing), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, file_descriptor, 0);
+  close(file_descriptor);
+  if (MAP_FAILED == memory) {
+    return 0;
+  }
+
+  /* the traces of a previous run are dropped, decode them before restarting */
+  TraceRing *ring = (TraceRing *) memory;
+  memset(ring, 0, sizeof(TraceRing));
+  ring->magic = OPENER_TRACE_RING_MAGIC;
+  ring->version = OPENER_TRACE_RING_VERSION;
+  ring->number_of_records = OPENER_TRACE_RING_RECORDS;
+  /* format ID 0 marks unregistered trace sites, it is the empty string */
+  ring->number_of_formats = 1;
+  ring->format_area_used = 1;
+  ring->process_id = (uint32_t) getpid();
+  ring->realtime_offset = GetTraceRingTime(CLOCK_REALTIME)
+      - GetTraceRingTime(CLOCK_MONOTONIC);
+
+  g_trace_ring = ring;
+  return 1;
+}
+
+uint16_t RegisterTraceFormat(const char *format) {
+  size_t length = strlen(format) + 1;
+
+  if ((OPENER_TRACE_RING_FORMATS <= g_trace_ring->number_of_formats)
+      || (OPENER_TRACE_RING_FORMAT_AREA_SIZE
+          < g_trace_ring->format_area_used + length)) {
+    return OPENER_TRACE_RING_NO_FORMAT;
+  }
+
+  uint32_t format_id = g_trace_ring->number_of_formats;
+  memcpy(&g_trace_ring->format_area[g_trace_ring->format_area_used], format,
+         length);
+  g_trace_ring->format_offsets[format_id] = g_trace_ring->format_area_used;
+  g_trace_ring->format_area_used += length;
+  __atomic_store_n(&g_trace_ring->number_of_formats, format_id + 1,
+                   __ATOMIC_RELEASE);
+  return (uint16_t) format_id;
+}
+
+int64_t GetTraceRingTime(clockid_t clock) {
+  struct timespec now;
+
+  clock_gettime(clock, &now);
+  return (int64_t) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void TraceRingRecordTrace(uint16_t *format_id, const char *format, ...) {
+  va_list arguments;
+
+  va_start(arguments, format);
+  if ((NULL == g_trace_ring)
+      && (g_trace_ring_unavailable || !SetupTraceRing())) {
+    g_trace_ring_unavailable = 1;
+    vfprintf(stderr, format, arguments);
+    va_end(arguments);
+    return;
+  }
+
+  if (0 == *format_id) {
+    *format_id = RegisterTraceFormat(format);
+  }
+
+  uint64_t sequence = g_trace_ring->head;
+  TraceRingRecord *record = &g_trace_ring->records[sequence
+      & (OPENER_TRACE_RING_RECORDS - 1)];
+
+  /* invalidate the record before overwriting it */
+  __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  record->timestamp = (uint64_t) GetTraceRingTime(CLOCK_MONOTONIC);
+  record->format_id = *format_id;
+
+  size_t used = 0;
+  const char *position = format;
+  const char *conversion_start = NULL;
+  int star_arguments = 0;
+  TraceArgumentType type = kTraceArgumentNone;
+
+  while ((OPENER_TRACE_RING_NO_FORMAT != *format_id)
+      && (kTraceArgumentNone
+          != (type = TraceRingNextConversion(&position, &conversion_start,
+                                             &star_arguments)))) {
+    uint64_t value = 0;
+
+    if (kTraceArgumentLiteral == type) {
+      continue;
+    }
+    for (; star_arguments > 0; --star_arguments) {
+      value = (uint64_t) (int64_t) va_arg(arguments, int);
+      if (OPENER_TRACE_RING_PAYLOAD_SIZE - used < sizeof(value)) {
+        break;
+      }
+      memcpy(&record->payload[used], &value, sizeof(value));
+      used += sizeof(value);
+    }
+
+    if (kTraceArgumentString == type) {
+      const char *string = va_arg(arguments, const char *);
+      size_t length = 0;
+
+      if (OPENER_TRACE_RING_PAYLOAD_SIZE == used) {
+        break;
+      }
+      if (NULL == string) {
+        string = "(null)";
+      }
+      /* strings are truncated to the remaining payload */
+      while ((used + length < OPENER_TRACE_RING_PAYLOAD_SIZE - 1)
+          && ('\0' != string[length])) {
+        length++;
+      }
+      memcpy(&record->payload[used], string, length);
+      record->payload[used + length] = '\0';
+      used += length + 1;
+      continue;
+    }
+
+    switch (type) {
+      case kTraceArgumentInt:
+        value = (uint64_t) (int64_t) va_arg(arguments, int);
+        break;
+      case kTraceArgumentLong:
+        value = (uint64_t) (int64_t) va_arg(arguments, long);
+        break;
+      case kTraceArgumentLongLong:
+        value = (uint64_t) va_arg(arguments, long long);
+        break;
+      case kTraceArgumentSize:
+        value = (uint64_t) va_arg(arguments, size_t);
+        break;
+      case kTraceArgumentDouble: {
+        double double_value = va_arg(arguments, double);
+        memcpy(&value, &double_value, sizeof(value));
+        break;
+      }
+      case kTraceArgumentPointer:
+        value = (uint64_t) (uintptr_t) va_arg(arguments, void *);
+        break;
+      default:
+        break;
+    }
+    if (OPENER_TRACE_RING_PAYLOAD_SIZE - used < sizeof(value)) {
+      break;
+    }
+    memcpy(&record->payload[used], &value, sizeof(value));
+    used += sizeof(value);
+  }
+  va_end(arguments);
+
+  record->payload_length = (uint16_t) used;
+  __atomic_store_n(&record->sequence, sequence + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&g_trace_ring->head, sequence + 1, __ATOMIC_RELEASE);
+}
+
+TraceArgumentType TraceRingNextConversion(const char **format,
+                                          const char **conversion_start,
+                                          int *star_arguments) {
+  const char *position = *format;
+  int number_of_longs = 0;
+  char length_modifier = '\0';
+
+  *star_arguments = 0;
+  while (('\0' != *position) && ('%' != *position)) {
+    position++;
+  }
+  if ('\0' == *position) {
+    *format = position;
+    return kTraceArgumentNone;
+  }
+
+  *conversion_start = position++;
+  /* flags, field width and precision */
+  while (('\0' != *position) && (NULL != strchr("-+ #0123456789.*", *position))) {
+    if ('*' == *position) {
+      (*star_arguments)++;
+    }
+    position++;
+  }
+  while (('\0' != *position) && (NULL != strchr("hlLqjzt", *position))) {
+    if ('l' == *position) {
+      number_of_longs++;
+    } else {
+      length_modifier = *position;
+    }
+    position++;
+  }
+  if ('\0' == *position) {
+    *format = *conversion_start;
+    return kTraceArgumentNone;
+  }
+  *format = position + 1;
+
+  switch (*position) {
+    case '%':
+      return kTraceArgumentLiteral;
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+      if (('j' == length_modifier) || ('z' == length_modifier)
+          || ('t' == length_modifier)) {
+        return kTraceArgumentSize;
+      }
+      if ((1 < number_of_longs) || ('q' == length_modifier)) {
+        return kTraceArgumentLongLong;
+      }
+      return (1 == number_of_longs) ? kTraceArgumentLong : kTraceArgumentInt;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      if ('L' == length_modifier) {
+        break; /* long double is not supported */
+      }
+      return kTraceArgumentDouble;
+    case 's':
+      return kTraceArgumentString;
+    case 'p':
+      return kTraceArgumentPointer;
+    default:
+      break;
+  }
+  /* unsupported conversion, the rest of the format string is taken as text */
+  *format = *conversion_start;
+  return kTraceArgumentNone;
+}
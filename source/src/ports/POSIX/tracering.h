@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+#ifndef OPENER_TRACERING_H_
+#define OPENER_TRACERING_H_
+
+#include <stdint.h>
+
+/** @file tracering.h
+ * @brief Binary trace backend recording into a ring buffer in shared memory
+ *
+ * Instead of formatting the trace messages with fprintf, each trace is stored
+ * as a fixed size record holding a timestamp, the ID of its format string and
+ * the raw arguments. The ring lives in the POSIX shared memory object
+ * OPENER_TRACE_RING_NAME, which survives the process, and is rendered with
+ * the opener_trace_decode tool, e.g., after an incident.
+ *
+ * The ring has a single producer: all traces have to be issued from the
+ * thread running the stack.
+ */
+
+/** @brief Name of the shared memory object holding the trace ring */
+#define OPENER_TRACE_RING_NAME "/opener_trace"
+
+/** @brief Number of trace records kept in the ring, has to be a power of 2 */
+#define OPENER_TRACE_RING_RECORDS 4096
+
+/** @brief Maximum number of different format strings */
+#define OPENER_TRACE_RING_FORMATS 1024
+
+/** @brief Bytes available for storing the format strings */
+#define OPENER_TRACE_RING_FORMAT_AREA_SIZE 65536
+
+/** @brief Bytes of a trace record available for the arguments */
+#define OPENER_TRACE_RING_PAYLOAD_SIZE 108
+
+/** @brief Value identifying a trace ring, "OpTr" */
+#define OPENER_TRACE_RING_MAGIC 0x7254704FU
+
+#define OPENER_TRACE_RING_VERSION 1
+
+/** @brief Format ID of traces whose format string did not fit into the
+ * format table
+ */
+#define OPENER_TRACE_RING_NO_FORMAT 0xFFFF
+
+/** @brief Kinds of arguments a format string conversion consumes */
+typedef enum {
+  kTraceArgumentNone = 0, /**< end of the format string */
+  kTraceArgumentLiteral, /**< "%%", consumes no argument */
+  kTraceArgumentInt, /**< int and shorter integer types */
+  kTraceArgumentLong, /**< long */
+  kTraceArgumentLongLong, /**< long long */
+  kTraceArgumentSize, /**< size_t, intmax_t and ptrdiff_t */
+  kTraceArgumentDouble, /**< double */
+  kTraceArgumentString, /**< zero terminated string, copied into the record */
+  kTraceArgumentPointer /**< void * */
+} TraceArgumentType;
+
+/** @brief One trace, 128 bytes */
+typedef struct trace_ring_record {
+  uint64_t sequence; /**< sequence number + 1, written last to mark the record complete */
+  uint64_t timestamp; /**< CLOCK_MONOTONIC in ns */
+  uint16_t format_id; /**< index into the format table */
+  uint16_t payload_length; /**< bytes of payload used */
+  uint8_t payload[OPENER_TRACE_RING_PAYLOAD_SIZE]; /**< the arguments in the order of the format string, 8 bytes each, strings zero terminated */
+} TraceRingRecord;
+
+/** @brief Layout of the shared memory object */
+typedef struct trace_ring {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t number_of_records; /**< OPENER_TRACE_RING_RECORDS of the producer */
+  uint32_t number_of_formats; /**< registered format strings */
+  uint32_t format_area_used; /**< bytes of the format area in use */
+  uint32_t process_id; /**< process recording into the ring */
+  int64_t realtime_offset; /**< CLOCK_REALTIME - CLOCK_MONOTONIC in ns when the ring was set up */
+  uint64_t head; /**< number of records written so far */
+  uint32_t format_offsets[OPENER_TRACE_RING_FORMATS]; /**< start of each format string in the format area */
+  char format_area[OPENER_TRACE_RING_FORMAT_AREA_SIZE];
+  TraceRingRecord records[OPENER_TRACE_RING_RECORDS];
+} TraceRing;
+
+/** @brief Record a trace into the ring
+ *
+ * Sets up the ring on the first call. If the shared memory object can not be
+ * set up, the traces are written to stderr instead.
+ *
+ * @param format_id format ID cache of the calling trace site, 0 if the format
+ * string is not registered yet
+ * @param format printf style format string, has to be a string literal
+ */
+void TraceRingRecordTrace(uint16_t *format_id, const char *format, ...);
+
+/** @brief Get the next conversion of a printf style format string
+ *
+ * @param format position in the format string, advanced behind the conversion
+ * @param conversion_start set to the '%' starting the conversion
+ * @param star_arguments set to the number of '*' fields of the conversion,
+ * each consumes an additional int argument before the converted value
+ * @return the kind of argument the conversion consumes, kTraceArgumentNone if
+ * the format string has no further conversion
+ */
+TraceArgumentType TraceRingNextConversion(const char **format,
+                                          const char **conversion_start,
+                                          int *star_arguments);
+
+#endif /* OPENER_TRACERING_H_ */
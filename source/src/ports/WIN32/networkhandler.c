@@ -15,6 +15,8 @@
 
 #include "generic_networkhandler.h"
 #include "encap.h"
+#include "opener_stack.h"
+#include "trace.h"
 
 MicroSeconds getMicroSeconds() {
   LARGE_INTEGER performance_counter;
@@ -41,6 +43,86 @@ EipStatus NetworkHandlerInitializePlatform(void) {
   return kEipStatusOk;
 }
 
+void NetworkHandlerFinishPlatform(void) {
+  WSACleanup();
+}
+
 void CloseSocketPlatform(int socket_handle) {
     closesocket(socket_handle);
 }
+
+int AddSocketPlatform(int socket_handle) {
+  /* select is used on this platform, it gets the sockets on each call. A
+   Winsock fd_set holds up to FD_SETSIZE sockets whatever their handles are. */
+  if (FD_SETSIZE <= g_opener_stack->number_of_monitored_sockets) {
+    OPENER_TRACE_ERR("networkhandler: cannot monitor socket %d, FD_SETSIZE %d reached\n",
+                     socket_handle, FD_SETSIZE);
+    return -1;
+  }
+  return 0;
+}
+
+void ModifySocketPlatform(int socket_handle, int events) {
+  (void) socket_handle;
+  (void) events;
+}
+
+int SetSocketToNonBlockingPlatform(int socket_handle) {
+  u_long non_blocking = 1;
+  return (0 == ioctlsocket(socket_handle, FIONBIO, &non_blocking)) ? 0 : -1;
+}
+
+void RemoveSocketPlatform(int socket_handle) {
+  (void) socket_handle;
+}
+
+int WaitForReadySocketsPlatform(const SocketEvents *monitored_sockets,
+                                int number_of_monitored_sockets,
+                                SocketEvents *ready_sockets,
+                                struct timeval *timeout) {
+  fd_set read_set;
+  fd_set write_set;
+
+  FD_ZERO(&read_set);
+  FD_ZERO(&write_set);
+  for (int i = 0; i < number_of_monitored_sockets; i++) {
+    if (monitored_sockets[i].events & kSocketEventReadable) {
+      FD_SET(monitored_sockets[i].socket_handle, &read_set);
+    }
+    if (monitored_sockets[i].events & kSocketEventWritable) {
+      FD_SET(monitored_sockets[i].socket_handle, &write_set);
+    }
+  }
+
+  /* Winsock ignores the first parameter of select */
+  int number_of_ready_sockets = select(0, &read_set, &write_set, NULL,
+                                       timeout);
+  if (number_of_ready_sockets <= 0) {
+    return number_of_ready_sockets;
+  }
+
+  number_of_ready_sockets = 0;
+  for (int i = 0; i < number_of_monitored_sockets; i++) {
+    int socket_handle = monitored_sockets[i].socket_handle;
+    int events = (FD_ISSET(socket_handle, &read_set) ? kSocketEventReadable : 0)
+        | (FD_ISSET(socket_handle, &write_set) ? kSocketEventWritable : 0);
+    if (0 != events) {
+      ready_sockets[number_of_ready_sockets].socket_handle = socket_handle;
+      ready_sockets[number_of_ready_sockets].events = events;
+      number_of_ready_sockets++;
+    }
+  }
+  return number_of_ready_sockets;
+}
+
+int ReceiveFromSocketPlatform(int socket_handle, EipUint8 *buffer,
+                              size_t buffer_size,
+                              struct sockaddr_in *from_address,
+                              MicroSeconds *receive_time) {
+  int from_address_length = sizeof(struct sockaddr_in);
+  int received_size = recvfrom(socket_handle, (char *) buffer, buffer_size, 0,
+                               (struct sockaddr *) from_address,
+                               &from_address_length);
+  *receive_time = getMicroSeconds();
+  return received_size;
+}
@@ -10,10 +10,91 @@
 
 typedef unsigned long socklen_t;
 
+/** @brief Flags for sending on TCP sockets
+ *
+ *  Winsock has no per call non-blocking flag, the TCP sockets are switched to
+ *  non-blocking mode with SetSocketToNonBlockingPlatform instead.
+ */
+#define OPENER_NON_BLOCKING_SEND_FLAGS 0
+
+/** @brief Error number indicating that the socket cannot take more data */
+#define OPENER_SOCKET_WOULD_BLOCK WSAEWOULDBLOCK
+
+/** @brief State of the Windows network handler kept per stack, see
+ *  OpenerStack; the Windows port has no such state yet
+ */
+typedef struct {
+  int reserved;
+} NetworkHandlerPlatformState;
+
 EipStatus NetworkHandlerInitializePlatform(void);
 
+/** @brief Release the resources of NetworkHandlerInitializePlatform */
+void NetworkHandlerFinishPlatform(void);
+
 void CloseSocketPlatform(int socket_handle);
 
+/** @brief Register a socket at the platform's readiness notification
+ *
+ *  Select can wait for FD_SETSIZE sockets at most, further sockets are
+ *  refused.
+ *
+ *  @param socket_handle The socket to be monitored
+ *  @return 0 on success, -1 if the socket can not be monitored
+ */
+int AddSocketPlatform(int socket_handle);
+
+/** @brief Change the events a monitored socket is reported for
+ *
+ *  @param socket_handle The monitored socket
+ *  @param events Combination of SocketEvent flags
+ */
+void ModifySocketPlatform(int socket_handle, int events);
+
+/** @brief Switch a socket to non-blocking mode
+ *
+ *  @param socket_handle The socket
+ *  @return 0 on success, -1 on error
+ */
+int SetSocketToNonBlockingPlatform(int socket_handle);
+
+/** @brief Stop monitoring a socket without closing it
+ *
+ *  @param socket_handle The socket not to be monitored any longer
+ */
+void RemoveSocketPlatform(int socket_handle);
+
+/** @brief Wait until events occur on the monitored sockets
+ *
+ *  @param monitored_sockets The sockets of the stack and their events
+ *  @param number_of_monitored_sockets Number of entries of monitored_sockets
+ *  @param ready_sockets Will hold the sockets on which events occurred, needs
+ *  room for number_of_monitored_sockets entries
+ *  @param timeout Maximum time to wait
+ *  @return Number of entries of ready_sockets, 0 on timeout, -1 on error
+ */
+int WaitForReadySocketsPlatform(const SocketEvents *monitored_sockets,
+                                int number_of_monitored_sockets,
+                                SocketEvents *ready_sockets,
+                                struct timeval *timeout);
+
+/** @brief Receive a datagram together with its time of arrival
+ *
+ *  Winsock provides no kernel receive timestamps, the time the datagram has
+ *  been read is returned instead.
+ *
+ *  @param socket_handle The socket to read from
+ *  @param buffer Buffer for the received data
+ *  @param buffer_size Size of the buffer in bytes
+ *  @param from_address Will hold the sender's address
+ *  @param receive_time Will hold the time of arrival of the datagram
+ *  @return Number of bytes received, -1 on error
+ */
+int ReceiveFromSocketPlatform(int socket_handle, EipUint8 *buffer,
+                              size_t buffer_size,
+                              struct sockaddr_in *from_address,
+                              MicroSeconds *receive_time);
+
 /** @brief This function shall return the current time in microseconds relative to epoch, and shall be implemented in a port specific networkhandler
  *
  *  @return Current time relative to epoch as MicroSeconds
@@ -74,12 +74,29 @@ typedef unsigned short in_port_t;
  */
 #define OPENER_CIP_NUM_LISTEN_ONLY_CONNS_PER_CON_PATH   3
 
+/** @brief Number of connection paths of successful forward open requests
+ *  kept in the connection path cache
+ *
+ *  Forward open requests repeating a cached connection path skip the parsing
+ *  and validation of the path. Has to be at least 1.
+ */
+#define OPENER_CONNECTION_PATH_CACHE_ENTRIES 4
+
+/** @brief Number of originators the forward open admission control tracks
+ *  per timer tick
+ *
+ *  Originators are identified by their vendor ID and serial number. Requests
+ *  of originators not fitting into the table are only limited by
+ *  kOpenerForwardOpensPerTimerTick.
+ */
+#define OPENER_FORWARD_OPEN_ADMISSION_ORIGINATORS 16
+
 /** @brief The number of bytes used for the buffer that will be used for generating any
  *  reply data of messages. There are two uses in OpENer:
  *    1. Explicit messages will use this buffer to store the data generated by the request
  *    2. I/O Connections will use this buffer for the produced data
  */
-#define OPENER_MESSAGE_DATA_REPLY_BUFFER 100
+#define OPENER_MESSAGE_DATA_REPLY_BUFFER 128
 
 /** @brief Number of sessions that can be handled at the same time
  */
@@ -89,6 +106,20 @@ typedef unsigned short in_port_t;
  */
 static const int kOpenerTimerTickInMilliSeconds = 10;
 
+/** @brief Maximum number of forward open requests accepted per timer tick
+ *
+ *  Further requests are refused with "no more connections available" and are
+ *  repeated by the originators. This bounds the time spent on connection
+ *  establishment, e.g., when all originators reconnect after a power cycle,
+ *  and keeps the timing of the established I/O connections.
+ */
+static const int kOpenerForwardOpensPerTimerTick = 16;
+
+/** @brief Maximum number of forward open requests accepted from a single
+ *  originator per timer tick
+ */
+static const int kOpenerForwardOpensPerOriginatorPerTimerTick = 4;
+
 /** @brief Define if RUN IDLE data is sent with consumed data
 */
 static const int kOpenerConsumedDataHasRunIdleHeader = 1;
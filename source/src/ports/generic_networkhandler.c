@@ -14,12 +14,15 @@
 #include <assert.h>
 
 #include "generic_networkhandler.h"
+#include "network_transport.h"
 
 #include "typedefs.h"
 #include "trace.h"
 #include "opener_error.h"
 #include "encap.h"
 #include "ciptcpipinterface.h"
+#include "cipstatistics.h"
+#include "opener_stack.h"
 
 /** @brief handle any connection request coming in the TCP server socket.
  *
@@ -36,10 +39,19 @@ void CheckAndHandleUdpUnicastSocket(void);
  */
 void CheckAndHandleUdpGlobalBroadcastSocket(void);
 
-/** @brief check if on one of the UDP consuming sockets data has been received and if yes handle it correctly
+/** @brief check if the socket is the consuming socket of an I/O connection and if yes handle the received data
  *
+ *  @param socket The socket with received data
+ *  @return true if the socket belongs to an I/O connection
  */
-void CheckAndHandleConsumingUdpSockets(void);
+EipBool8 CheckAndHandleConsumingUdpSocket(int socket);
+
+/** @brief Dispatch a socket reported ready by the network transport
+ *
+ *  @param ready_socket The socket and its events, no events if the socket
+ *  has been removed since the wait
+ */
+void HandleReadySocket(const SocketEvents *ready_socket);
 
 /** @brief Handles data on an established TCP connection, processed connection is given by socket
  *
@@ -48,23 +60,94 @@ void CheckAndHandleConsumingUdpSockets(void);
  */
 EipStatus HandleDataOnTcpSocket(int socket);
 
+const NetworkTransport *g_network_transport = &g_socket_network_transport;
+
+/** @brief Send a reply on a TCP socket without blocking
+ *
+ *  If the socket cannot take the whole reply the rest is stored and the
+ *  socket is monitored for write readiness instead of incoming data until the
+ *  reply has been sent completely.
+ *
+ *  @param socket The socket to send the reply on
+ *  @param data The reply data
+ *  @param data_length Length of the reply
+ *  @return kEipStatusOk if the reply was sent or stored, kEipStatusError if
+ *  the socket has to be closed
+ */
+EipStatus SendTcpReply(int socket, EipUint8 *data, size_t data_length);
+
+/** @brief Continue sending the stored reply of a TCP socket
+ *
+ *  Called when the socket is ready for writing. Once the reply has been sent
+ *  completely the socket is read from again. If sending fails the socket is
+ *  closed together with its session.
+ *
+ *  @param socket The socket with a pending reply
+ */
+void SendPendingTcpReply(int socket);
+
+/** @brief Change the events a monitored socket is reported for
+ *
+ *  @param socket The monitored socket
+ *  @param events Combination of SocketEvent flags
+ */
+void SetMonitoredSocketEvents(int socket, int events);
+
+/** @brief Read from a non-blocking TCP socket
+ *
+ *  @return number of bytes read, 0 if no data is available, -1 if the
+ *  connection has been closed or failed
+ */
+long ReceiveTcpData(int socket, EipUint8 *buffer, size_t buffer_size);
+
+/** @brief Store the received part of a request until the socket is readable
+ *  again
+ *
+ *  @param socket The socket the data was received on
+ *  @param data The received part of the request
+ *  @param length Length of the received part
+ *  @param bytes_to_drop Bytes of a too large message still to be dropped
+ *  @return kEipStatusOk if the data was stored, kEipStatusError if there is
+ *  no space left and the socket has to be closed
+ */
+EipStatus StoreTcpRequest(int socket, const EipUint8 *data, size_t length,
+                          size_t bytes_to_drop);
+
+/** @brief Read and drop the rest of a message too large for the buffer
+ *
+ *  @param socket The socket the message is received on
+ *  @param bytes_to_drop Bytes of the message not yet read
+ *  @return kEipStatusOk if the rest was dropped or is awaited, kEipStatusError
+ *  if the socket has to be closed
+ */
+EipStatus DropTcpData(int socket, size_t bytes_to_drop);
+
 /*************************************************
  * Function implementations from now on
  *************************************************/
 
+void SetNetworkTransport(const NetworkTransport *transport) {
+  g_network_transport =
+      (NULL != transport) ? transport : &g_socket_network_transport;
+}
+
 EipStatus NetworkHandlerInitialize(void) {
 
   if(kEipStatusOk != NetworkHandlerInitializePlatform()) {
     return kEipStatusError;
   }
 
-  /* clear the master an temp sets */
-  FD_ZERO(&master_socket);
-  FD_ZERO(&read_socket);
+  g_opener_stack->number_of_monitored_sockets = 0;
+  g_opener_stack->number_of_ready_sockets = 0;
+
+  for (int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
+    g_opener_stack->pending_tcp_replies[i].socket = kEipInvalidSocket;
+    g_opener_stack->pending_tcp_requests[i].socket = kEipInvalidSocket;
+  }
 
   /* create a new TCP socket */
-  if ((g_network_status.tcp_listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP))
-      == -1) {
+  if ((g_opener_stack->network_status.tcp_listener = g_network_transport->create_socket(
+      SOCK_STREAM, IPPROTO_TCP)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error allocating socket stream listener, %d - %s\n", error_code, error_message);
@@ -74,19 +157,19 @@ EipStatus NetworkHandlerInitialize(void) {
 
   int set_socket_option_value = 1;  //Represents true for used set socket options
   /* Activates address reuse */
-  if (setsockopt(g_network_status.tcp_listener, SOL_SOCKET, SO_REUSEADDR,
-                 (char *) &set_socket_option_value,
-                 sizeof(set_socket_option_value)) == -1) {
+  if (g_network_transport->set_socket_option(g_opener_stack->network_status.tcp_listener,
+                                             SOL_SOCKET, SO_REUSEADDR,
+                                             &set_socket_option_value,
+                                             sizeof(set_socket_option_value))
+      == -1) {
     OPENER_TRACE_ERR(
         "error setting socket option SO_REUSEADDR on tcp_listener\n");
     return kEipStatusError;
   }
 
   /* create a new UDP socket */
-  if ((g_network_status.udp_global_broadcast_listener = socket(AF_INET,
-                                                               SOCK_DGRAM,
-                                                               IPPROTO_UDP))
-      == -1) {
+  if ((g_opener_stack->network_status.udp_global_broadcast_listener = g_network_transport
+      ->create_socket(SOCK_DGRAM, IPPROTO_UDP)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error allocating UDP global broadcast listener socket, %d - %s\n",
@@ -96,8 +179,8 @@ EipStatus NetworkHandlerInitialize(void) {
   }
 
   /* create a new UDP socket */
-  if ((g_network_status.udp_unicast_listener = socket(AF_INET, SOCK_DGRAM,
-                                                      IPPROTO_UDP)) == -1) {
+  if ((g_opener_stack->network_status.udp_unicast_listener = g_network_transport
+      ->create_socket(SOCK_DGRAM, IPPROTO_UDP)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error allocating UDP unicast listener socket, %d - %s\n",
@@ -107,30 +190,30 @@ EipStatus NetworkHandlerInitialize(void) {
   }
 
   /* Activates address reuse */
-  if (setsockopt(g_network_status.udp_global_broadcast_listener, SOL_SOCKET,
-                 SO_REUSEADDR, (char *) &set_socket_option_value,
-                 sizeof(set_socket_option_value)) == -1) {
+  if (g_network_transport->set_socket_option(
+      g_opener_stack->network_status.udp_global_broadcast_listener, SOL_SOCKET, SO_REUSEADDR,
+      &set_socket_option_value, sizeof(set_socket_option_value)) == -1) {
     OPENER_TRACE_ERR(
         "error setting socket option SO_REUSEADDR on udp_broadcast_listener\n");
     return kEipStatusError;
   }
 
   /* Activates address reuse */
-  if (setsockopt(g_network_status.udp_unicast_listener, SOL_SOCKET,
-                 SO_REUSEADDR, (char *) &set_socket_option_value,
-                 sizeof(set_socket_option_value)) == -1) {
+  if (g_network_transport->set_socket_option(
+      g_opener_stack->network_status.udp_unicast_listener, SOL_SOCKET, SO_REUSEADDR,
+      &set_socket_option_value, sizeof(set_socket_option_value)) == -1) {
     OPENER_TRACE_ERR(
         "error setting socket option SO_REUSEADDR on udp_unicast_listener\n");
     return kEipStatusError;
   }
 
   struct sockaddr_in my_address = { .sin_family = AF_INET, .sin_port = htons(
-      kOpenerEthernetPort), .sin_addr.s_addr = interface_configuration_
+      kOpenerEthernetPort), .sin_addr.s_addr = g_opener_stack->interface_configuration
       .ip_address };
 
   /* bind the new socket to port 0xAF12 (CIP) */
-  if ((bind(g_network_status.tcp_listener, (struct sockaddr *) &my_address,
-            sizeof(struct sockaddr))) == -1) {
+  if ((g_network_transport->bind_socket(g_opener_stack->network_status.tcp_listener,
+                                        &my_address)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error with TCP bind: %d - %s\n", error_code, error_message);
@@ -138,8 +221,8 @@ EipStatus NetworkHandlerInitialize(void) {
     return kEipStatusError;
   }
 
-  if ((bind(g_network_status.udp_unicast_listener,
-            (struct sockaddr *) &my_address, sizeof(struct sockaddr))) == -1) {
+  if ((g_network_transport->bind_socket(g_opener_stack->network_status.udp_unicast_listener,
+                                        &my_address)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error with UDP unicast bind: %d - %s\n", error_code, GetErrorMessage(error_code));
@@ -152,8 +235,9 @@ EipStatus NetworkHandlerInitialize(void) {
 
   /* enable the UDP socket to receive broadcast messages */
    if (0
-       > setsockopt(g_network_status.udp_global_broadcast_listener, SOL_SOCKET, SO_BROADCAST,
-                    (char *) &set_socket_option_value, sizeof(int))) {
+       > g_network_transport->set_socket_option(
+           g_opener_stack->network_status.udp_global_broadcast_listener, SOL_SOCKET,
+           SO_BROADCAST, &set_socket_option_value, sizeof(int))) {
 	 int error_code = GetSocketErrorNumber();
 	 char* error_message = GetErrorMessage(error_code);
      OPENER_TRACE_ERR(
@@ -163,9 +247,9 @@ EipStatus NetworkHandlerInitialize(void) {
      return kEipStatusError;
    }
 
-  if ((bind(g_network_status.udp_global_broadcast_listener,
-            (struct sockaddr *) &global_broadcast_address,
-            sizeof(struct sockaddr))) == -1) {
+  if ((g_network_transport->bind_socket(
+      g_opener_stack->network_status.udp_global_broadcast_listener,
+      &global_broadcast_address)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("error with global broadcast UDP bind: %d - %s\n", error_code, error_message);
@@ -174,7 +258,8 @@ EipStatus NetworkHandlerInitialize(void) {
   }
 
   /* switch socket in listen mode */
-  if ((listen(g_network_status.tcp_listener, MAX_NO_OF_TCP_SOCKETS)) == -1) {
+  if ((g_network_transport->listen_socket(g_opener_stack->network_status.tcp_listener,
+                                          MAX_NO_OF_TCP_SOCKETS)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
     OPENER_TRACE_ERR("networkhandler: error with listen: %d - %s\n", error_code, error_message);
@@ -182,20 +267,20 @@ EipStatus NetworkHandlerInitialize(void) {
     return kEipStatusError;
   }
 
-  /* add the listener socket to the master set */
-  FD_SET(g_network_status.tcp_listener, &master_socket);
-  FD_SET(g_network_status.udp_unicast_listener, &master_socket);
-  FD_SET(g_network_status.udp_global_broadcast_listener, &master_socket);
-
-  /* keep track of the biggest file descriptor */
-  highest_socket_handle = GetMaxSocket(
-      g_network_status.tcp_listener,
-      g_network_status.udp_global_broadcast_listener,
-      0,
-      g_network_status.udp_unicast_listener);
+  /* monitor the listener sockets */
+  if ((kEipStatusOk
+      != AddMonitoredSocket(g_opener_stack->network_status.tcp_listener))
+      || (kEipStatusOk
+          != AddMonitoredSocket(
+              g_opener_stack->network_status.udp_unicast_listener))
+      || (kEipStatusOk
+          != AddMonitoredSocket(
+              g_opener_stack->network_status.udp_global_broadcast_listener))) {
+    return kEipStatusError;
+  }
 
-  g_last_time = GetMilliSeconds(); /* initialize time keeping */
-  g_network_status.elapsed_time = 0;
+  g_opener_stack->last_time = GetMilliSeconds(); /* initialize time keeping */
+  g_opener_stack->network_status.elapsed_time = 0;
 
   return kEipStatusOk;
 }
@@ -208,61 +293,133 @@ void IApp_CloseSocket_tcp(int socket_handle) {
   CloseSocket(socket_handle);
 }
 
-EipBool8 CheckSocketSet(int socket) {
-  EipBool8 return_value = false;
-  if (FD_ISSET(socket, &read_socket)) {
-    if (FD_ISSET(socket, &master_socket)) {
-      return_value = true;
-    } else {
+EipStatus AddMonitoredSocket(int socket) {
+  if (OPENER_MAX_MONITORED_SOCKETS
+      <= g_opener_stack->number_of_monitored_sockets) {
+    OPENER_TRACE_ERR("networkhandler: cannot monitor socket %d, limit reached\n",
+                     socket);
+    return kEipStatusError;
+  }
+  if (-1 == g_network_transport->add_socket(socket)) {
+    OPENER_TRACE_ERR("networkhandler: cannot monitor socket %d\n", socket);
+    return kEipStatusError;
+  }
+  SocketEvents *monitored_socket = &g_opener_stack->monitored_sockets[g_opener_stack
+      ->number_of_monitored_sockets++];
+  monitored_socket->socket_handle = socket;
+  monitored_socket->events = kSocketEventReadable;
+  return kEipStatusOk;
+}
+
+void SetMonitoredSocketEvents(int socket, int events) {
+  for (int i = 0; i < g_opener_stack->number_of_monitored_sockets; i++) {
+    if (socket == g_opener_stack->monitored_sockets[i].socket_handle) {
+      g_opener_stack->monitored_sockets[i].events = events;
+      g_network_transport->modify_socket(socket, events);
+      return;
+    }
+  }
+}
+
+void RemoveMonitoredSocket(int socket) {
+  for (int i = 0; i < g_opener_stack->number_of_monitored_sockets; i++) {
+    if (socket == g_opener_stack->monitored_sockets[i].socket_handle) {
+      /* the order does not matter, fill the gap with the last entry */
+      g_opener_stack->monitored_sockets[i] = g_opener_stack->monitored_sockets[
+          --g_opener_stack->number_of_monitored_sockets];
+      g_network_transport->remove_socket(socket);
+      break;
+    }
+  }
+  /* a new socket may get the same handle, drop the old socket's events */
+  for (int i = 0; i < g_opener_stack->number_of_ready_sockets; i++) {
+    if (socket == g_opener_stack->ready_sockets[i].socket_handle) {
       OPENER_TRACE_INFO("socket: %d closed with pending message\n", socket);
+      g_opener_stack->ready_sockets[i].events = 0;
     }
-    FD_CLR(socket, &read_socket);
-    /* remove it from the read set so that later checks will not find it */
   }
-  return return_value;
 }
 
 void CheckAndHandleTcpListenerSocket(void) {
   int new_socket;
-  /* see if this is a connection request to the TCP listener*/
-  if (true == CheckSocketSet(g_network_status.tcp_listener)) {
-    OPENER_TRACE_INFO("networkhandler: new TCP connection\n");
-
-    new_socket = accept(g_network_status.tcp_listener, NULL, NULL);
-    if (new_socket == -1) {
-	  int error_code = GetSocketErrorNumber();
-	  char* error_message = GetErrorMessage(error_code);
-      OPENER_TRACE_ERR("networkhandler: error on accept: %d - %s\n",
-                       error_code, error_message);
-	  free(error_message);
-      return;
-    }
+  OPENER_TRACE_INFO("networkhandler: new TCP connection\n");
+
+  new_socket = g_network_transport->accept_connection(
+      g_opener_stack->network_status.tcp_listener);
+  if (new_socket == -1) {
+    int error_code = GetSocketErrorNumber();
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: error on accept: %d - %s\n",
+                     error_code, error_message);
+    free(error_message);
+    return;
+  }
 
-    FD_SET(new_socket, &master_socket);
-    /* add newfd to master set */
-    if (new_socket > highest_socket_handle) {
-      highest_socket_handle = new_socket;
-    }
+  /* a stalled client must not block the stack */
+  if (-1 == g_network_transport->set_non_blocking(new_socket)) {
+    int error_code = GetSocketErrorNumber();
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: cannot set socket %d non-blocking: %d - %s\n",
+                     new_socket, error_code, error_message);
+    free(error_message);
+    g_network_transport->close_socket(new_socket);
+    return;
+  }
 
-    OPENER_TRACE_STATE("networkhandler: opened new TCP connection on fd %d\n",
-                       new_socket);
+  if (kEipStatusOk != AddMonitoredSocket(new_socket)) {
+    g_network_transport->close_socket(new_socket);
+    return;
   }
+
+  OPENER_TRACE_STATE("networkhandler: opened new TCP connection on fd %d\n",
+                     new_socket);
 }
 
-EipStatus NetworkHandlerProcessOnce(void) {
+void HandleReadySocket(const SocketEvents *ready_socket) {
+  int socket = ready_socket->socket_handle;
 
-  read_socket = master_socket;
+  if (0 == ready_socket->events) {
+    return; /* removed while handling an earlier socket */
+  }
+
+  if (ready_socket->events & kSocketEventWritable) {
+    /* only sockets with a pending reply are monitored for writing */
+    SendPendingTcpReply(socket);
+  } else if (socket == g_opener_stack->network_status.tcp_listener) {
+    CheckAndHandleTcpListenerSocket();
+  } else if (socket == g_opener_stack->network_status.udp_unicast_listener) {
+    CheckAndHandleUdpUnicastSocket();
+  } else if (socket
+      == g_opener_stack->network_status.udp_global_broadcast_listener) {
+    CheckAndHandleUdpGlobalBroadcastSocket();
+  } else if (true != CheckAndHandleConsumingUdpSocket(socket)) {
+    /* if it is none of the above it is a TCP receive */
+    if (kEipStatusError == HandleDataOnTcpSocket(socket)) /* if error */
+    {
+      if (kEipStatusOk != CloseSession(socket)) { /* closes the session's socket */
+        CloseSocket(socket);
+      }
+    }
+  }
+}
 
-  g_time_value.tv_sec = 0;
-  g_time_value.tv_usec = (
-      g_network_status.elapsed_time < kOpenerTimerTickInMilliSeconds ?
-          kOpenerTimerTickInMilliSeconds - g_network_status.elapsed_time : 0)
+EipStatus NetworkHandlerProcessOnce(void) {
+  g_opener_stack->time_value.tv_sec = 0;
+#ifdef OPENER_BUSY_POLL
+  g_opener_stack->time_value.tv_usec = 0; /* only poll, connection timers are checked on every pass */
+#else
+  g_opener_stack->time_value.tv_usec = (
+      g_opener_stack->network_status.elapsed_time < kOpenerTimerTickInMilliSeconds ?
+          kOpenerTimerTickInMilliSeconds - g_opener_stack->network_status.elapsed_time : 0)
       * 1000; /* 10 ms */
+#endif
 
-  int ready_socket = select(highest_socket_handle + 1, &read_socket, 0, 0,
-                            &g_time_value);
+  int number_of_ready_sockets = g_network_transport->wait_for_ready_sockets(
+      g_opener_stack->monitored_sockets,
+      g_opener_stack->number_of_monitored_sockets,
+      g_opener_stack->ready_sockets, &g_opener_stack->time_value);
 
-  if (ready_socket == kEipInvalidSocket) {
+  if (number_of_ready_sockets < 0) {
     if (EINTR == errno) /* we have somehow been interrupted. The default behavior is to go back into the select loop. */
     {
       return kEipStatusOk;
@@ -275,166 +432,175 @@ EipStatus NetworkHandlerProcessOnce(void) {
     }
   }
 
-  if (ready_socket > 0) {
+  /* the time spent waiting for the sockets is not part of the iteration time */
+  MicroSeconds iteration_start_time = GetMicroSeconds();
+  g_opener_stack->network_handler_loop_statistics.iterations++;
 
-    CheckAndHandleTcpListenerSocket();
-    CheckAndHandleUdpUnicastSocket();
-    CheckAndHandleUdpGlobalBroadcastSocket();
-    CheckAndHandleConsumingUdpSockets();
-
-    for (int socket = 0; socket <= highest_socket_handle; socket++) {
-      if (true == CheckSocketSet(socket)) {
-        /* if it is still checked it is a TCP receive */
-        if (kEipStatusError == HandleDataOnTcpSocket(socket)) /* if error */
-        {
-          CloseSocket(socket);
-          CloseSession(socket); /* clean up session and close the socket */
-        }
-      }
+  if (number_of_ready_sockets > 0) {
+    /* only the ready sockets are looked at, the handlers may remove sockets */
+    g_opener_stack->number_of_ready_sockets = number_of_ready_sockets;
+    for (int i = 0; i < number_of_ready_sockets; i++) {
+      HandleReadySocket(&g_opener_stack->ready_sockets[i]);
+    }
+    g_opener_stack->number_of_ready_sockets = 0;
+
+    MicroSeconds processing_time = GetMicroSeconds() - iteration_start_time;
+    g_opener_stack->network_handler_loop_statistics.busy_iterations++;
+    g_opener_stack->network_handler_loop_statistics.total_processing_time += processing_time;
+    if (processing_time
+        > g_opener_stack->network_handler_loop_statistics.max_processing_time) {
+      g_opener_stack->network_handler_loop_statistics.max_processing_time = processing_time;
     }
   }
 
-  g_actual_time = GetMilliSeconds();
-  g_network_status.elapsed_time += g_actual_time - g_last_time;
-  g_last_time = g_actual_time;
+  g_opener_stack->actual_time = (MilliSeconds) (GetMicroSeconds() / 1000ULL);
+  MilliSeconds elapsed_time = g_opener_stack->actual_time
+      - g_opener_stack->last_time;
+  g_opener_stack->network_status.elapsed_time += elapsed_time;
+  g_opener_stack->last_time = g_opener_stack->actual_time;
 
+#ifdef OPENER_BUSY_POLL
+  ManageConnectionTimers(elapsed_time);
+#endif
   /* check if we had been not able to update the connection manager for several OPENER_TIMER_TICK.
    * This should compensate the jitter of the windows timer
    */
-  if (g_network_status.elapsed_time >= kOpenerTimerTickInMilliSeconds) {
+  if (g_opener_stack->network_status.elapsed_time >= kOpenerTimerTickInMilliSeconds) {
     /* call manage_connections() in connection manager every OPENER_TIMER_TICK ms */
-    ManageConnections(g_network_status.elapsed_time);
-    g_network_status.elapsed_time = 0;
+    ManageConnections(g_opener_stack->network_status.elapsed_time);
+    g_opener_stack->network_status.elapsed_time = 0;
+  }
+
+  MicroSeconds iteration_time = GetMicroSeconds() - iteration_start_time;
+  if (iteration_time
+      > g_opener_stack->network_handler_loop_statistics.max_iteration_time) {
+    g_opener_stack->network_handler_loop_statistics.max_iteration_time =
+        iteration_time;
   }
   return kEipStatusOk;
 }
 
 EipStatus NetworkHandlerFinish(void) {
-  CloseSocket(g_network_status.tcp_listener);
-  CloseSocket(g_network_status.udp_unicast_listener);
-  CloseSocket(g_network_status.udp_global_broadcast_listener);
+  OPENER_TRACE_STATE(
+      "networkhandler: %"PRIu32" iterations, %"PRIu32" with data, max iteration %llu us, max processing %llu us, total processing %llu us\n",
+      g_opener_stack->network_handler_loop_statistics.iterations,
+      g_opener_stack->network_handler_loop_statistics.busy_iterations,
+      g_opener_stack->network_handler_loop_statistics.max_iteration_time,
+      g_opener_stack->network_handler_loop_statistics.max_processing_time,
+      g_opener_stack->network_handler_loop_statistics.total_processing_time);
+
+  CloseSocket(g_opener_stack->network_status.tcp_listener);
+  CloseSocket(g_opener_stack->network_status.udp_unicast_listener);
+  CloseSocket(g_opener_stack->network_status.udp_global_broadcast_listener);
+  NetworkHandlerFinishPlatform();
   return kEipStatusOk;
 }
 
 void CheckAndHandleUdpGlobalBroadcastSocket(void) {
 
   struct sockaddr_in from_address;
-  socklen_t from_address_length;
-
-  /* see if this is an unsolicited inbound UDP message */
-  if (true == CheckSocketSet(g_network_status.udp_global_broadcast_listener)) {
-
-    from_address_length = sizeof(from_address);
 
-    OPENER_TRACE_STATE(
-        "networkhandler: unsolicited UDP message on EIP global broadcast socket\n");
+  OPENER_TRACE_STATE(
+      "networkhandler: unsolicited UDP message on EIP global broadcast socket\n");
 
-    /* Handle UDP broadcast messages */
-    int received_size = recvfrom(g_network_status.udp_global_broadcast_listener,
-                                 g_ethernet_communication_buffer,
-                                 PC_OPENER_ETHERNET_BUFFER_SIZE,
-                                 0, (struct sockaddr *) &from_address,
-                                 &from_address_length);
+  /* Handle UDP broadcast messages */
+  int received_size = g_network_transport->receive_from(
+      g_opener_stack->network_status.udp_global_broadcast_listener,
+      g_opener_stack->ethernet_communication_buffer, PC_OPENER_ETHERNET_BUFFER_SIZE,
+      &from_address, NULL);
 
-    if (received_size <= 0) { /* got error */
+  if (received_size <= 0) { /* got error */
 	  int error_code = GetSocketErrorNumber();
 	  char* error_message = GetErrorMessage(error_code);
-      OPENER_TRACE_ERR(
-          "networkhandler: error on recvfrom UDP global broadcast port: %d - %s\n", error_code, error_message);
+    OPENER_TRACE_ERR(
+        "networkhandler: error on recvfrom UDP global broadcast port: %d - %s\n", error_code, error_message);
 	  free(error_message);
-      return;
-    }
+    return;
+  }
 
-    OPENER_TRACE_INFO("Data received on global broadcast UDP:\n");
+  OPENER_TRACE_INFO("Data received on global broadcast UDP:\n");
+  g_opener_stack->opener_statistics.udp_packets_received++;
 
-    EipUint8 *receive_buffer = &g_ethernet_communication_buffer[0];
-    int remaining_bytes = 0;
-    do {
-      int reply_length = HandleReceivedExplictUdpData(
-          g_network_status.udp_global_broadcast_listener, &from_address,
-          receive_buffer, received_size, &remaining_bytes, false);
+  EipUint8 *receive_buffer = &g_opener_stack->ethernet_communication_buffer[0];
+  int remaining_bytes = 0;
+  do {
+    int reply_length = HandleReceivedExplictUdpData(
+        g_opener_stack->network_status.udp_global_broadcast_listener, &from_address,
+        receive_buffer, received_size, &remaining_bytes, false);
 
-      receive_buffer += received_size - remaining_bytes;
-      received_size = remaining_bytes;
+    receive_buffer += received_size - remaining_bytes;
+    received_size = remaining_bytes;
 
-      if (reply_length > 0) {
-        OPENER_TRACE_INFO("reply sent:\n");
+    if (reply_length > 0) {
+      OPENER_TRACE_INFO("reply sent:\n");
 
-        /* if the active socket matches a registered UDP callback, handle a UDP packet */
-        if (sendto(g_network_status.udp_global_broadcast_listener,
-                   (char *) g_ethernet_communication_buffer, reply_length, 0,
-                   (struct sockaddr *) &from_address, sizeof(from_address))
-            != reply_length) {
-          OPENER_TRACE_INFO(
-              "networkhandler: UDP response was not fully sent\n");
-        }
+      /* if the active socket matches a registered UDP callback, handle a UDP packet */
+      if (g_network_transport->send_to(
+          g_opener_stack->network_status.udp_global_broadcast_listener,
+          g_opener_stack->ethernet_communication_buffer, reply_length, &from_address)
+          != reply_length) {
+        OPENER_TRACE_INFO(
+            "networkhandler: UDP response was not fully sent\n");
       }
-    } while (remaining_bytes > 0);
-  }
+    }
+  } while (remaining_bytes > 0);
 }
 
 void CheckAndHandleUdpUnicastSocket(void) {
 
   struct sockaddr_in from_address;
-  socklen_t from_address_length;
 
-  /* see if this is an unsolicited inbound UDP message */
-  if (true == CheckSocketSet(g_network_status.udp_unicast_listener)) {
+  OPENER_TRACE_STATE(
+      "networkhandler: unsolicited UDP message on EIP unicast socket\n");
 
-    from_address_length = sizeof(from_address);
+  /* Handle UDP broadcast messages */
+  int received_size = g_network_transport->receive_from(
+      g_opener_stack->network_status.udp_unicast_listener,
+      g_opener_stack->ethernet_communication_buffer,
+      PC_OPENER_ETHERNET_BUFFER_SIZE, &from_address, NULL);
 
-    OPENER_TRACE_STATE(
-        "networkhandler: unsolicited UDP message on EIP unicast socket\n");
-
-    /* Handle UDP broadcast messages */
-    int received_size = recvfrom(g_network_status.udp_unicast_listener,
-                                 g_ethernet_communication_buffer,
-                                 PC_OPENER_ETHERNET_BUFFER_SIZE,
-                                 0, (struct sockaddr *) &from_address,
-                                 &from_address_length);
-
-    if (received_size <= 0) { /* got error */
+  if (received_size <= 0) { /* got error */
 	  int error_code = GetSocketErrorNumber();
 	  char* error_message = GetErrorMessage(error_code);
 	  OPENER_TRACE_ERR(
 		  "networkhandler: error on recvfrom UDP unicast port: %d - %s\n", error_code, error_message);
 	  free(error_message);
-      return;
-    }
+    return;
+  }
 
-    OPENER_TRACE_INFO("Data received on UDP unicast:\n");
+  OPENER_TRACE_INFO("Data received on UDP unicast:\n");
+  g_opener_stack->opener_statistics.udp_packets_received++;
 
-    EipUint8 *receive_buffer = &g_ethernet_communication_buffer[0];
-    int remaining_bytes = 0;
-    do {
-      int reply_length = HandleReceivedExplictUdpData(
-          g_network_status.udp_unicast_listener, &from_address, receive_buffer,
-          received_size, &remaining_bytes, true);
+  EipUint8 *receive_buffer = &g_opener_stack->ethernet_communication_buffer[0];
+  int remaining_bytes = 0;
+  do {
+    int reply_length = HandleReceivedExplictUdpData(
+        g_opener_stack->network_status.udp_unicast_listener, &from_address, receive_buffer,
+        received_size, &remaining_bytes, true);
 
-      receive_buffer += received_size - remaining_bytes;
-      received_size = remaining_bytes;
+    receive_buffer += received_size - remaining_bytes;
+    received_size = remaining_bytes;
 
-      if (reply_length > 0) {
-        OPENER_TRACE_INFO("reply sent:\n");
+    if (reply_length > 0) {
+      OPENER_TRACE_INFO("reply sent:\n");
 
-        /* if the active socket matches a registered UDP callback, handle a UDP packet */
-        if (sendto(g_network_status.udp_unicast_listener,
-                   (char *) g_ethernet_communication_buffer, reply_length, 0,
-                   (struct sockaddr *) &from_address, sizeof(from_address))
-            != reply_length) {
-          OPENER_TRACE_INFO(
-              "networkhandler: UDP unicast response was not fully sent\n");
-        }
+      /* if the active socket matches a registered UDP callback, handle a UDP packet */
+      if (g_network_transport->send_to(g_opener_stack->network_status.udp_unicast_listener,
+                                       g_opener_stack->ethernet_communication_buffer,
+                                       reply_length, &from_address)
+          != reply_length) {
+        OPENER_TRACE_INFO(
+            "networkhandler: UDP unicast response was not fully sent\n");
       }
-    } while (remaining_bytes > 0);
-  }
+    }
+  } while (remaining_bytes > 0);
 }
 
 EipStatus SendUdpData(struct sockaddr_in *address, int socket, EipUint8 *data,
                       EipUint16 data_length) {
 
-  int sent_length = sendto(socket, (char *) data, data_length, 0,
-                           (struct sockaddr *) address, sizeof(*address));
+  int sent_length = g_network_transport->send_to(socket, data, data_length,
+                                                 address);
 
   if (sent_length < 0) {
 	int error_code = GetSocketErrorNumber();
@@ -454,130 +620,245 @@ EipStatus SendUdpData(struct sockaddr_in *address, int socket, EipUint8 *data,
   return kEipStatusOk;
 }
 
-EipStatus HandleDataOnTcpSocket(int socket) {
-  int remaining_bytes = 0;
-  long data_sent = PC_OPENER_ETHERNET_BUFFER_SIZE;
-
-  /* We will handle just one EIP packet here the rest is done by the select
-   * method which will inform us if more data is available in the socket
-   because of the current implementation of the main loop this may not be
-   the fastest way and a loop here with a non blocking socket would better
-   fit*/
-
-  /*Check how many data is here -- read the first four bytes from the connection */
-  long number_of_read_bytes = recv(socket, g_ethernet_communication_buffer, 4,
-                                   0); /*TODO we may have to set the socket to a non blocking socket */
+long ReceiveTcpData(int socket, EipUint8 *buffer, size_t buffer_size) {
+  long number_of_read_bytes = g_network_transport->receive(socket, buffer,
+                                                           buffer_size);
 
   if (number_of_read_bytes == 0) {
-	int error_code = GetSocketErrorNumber();
-	char* error_message = GetErrorMessage(error_code);
-	OPENER_TRACE_ERR("networkhandler: connection closed by client: %d - %s\n", error_code, error_message);
-	free(error_message);
-    return kEipStatusError;
+    OPENER_TRACE_ERR("networkhandler: connection closed by client\n");
+    return -1;
   }
   if (number_of_read_bytes < 0) {
-	int error_code = GetSocketErrorNumber();
-	char* error_message = GetErrorMessage(error_code);
-    OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code, error_message);
-	free(error_message);
-    return kEipStatusError;
+    int error_code = GetSocketErrorNumber();
+    if (OPENER_SOCKET_WOULD_BLOCK == error_code) {
+      return 0;
+    }
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code,
+                     error_message);
+    free(error_message);
+    return -1;
+  }
+  return number_of_read_bytes;
+}
+
+/** @brief Get the stored partial request of a TCP socket
+ *
+ *  @param socket The socket, kEipInvalidSocket for getting an unused entry
+ *  @return the stored request or NULL if there is none
+ */
+PendingTcpRequest *GetPendingTcpRequest(int socket) {
+  for (int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
+    if (socket == g_opener_stack->pending_tcp_requests[i].socket) {
+      return &g_opener_stack->pending_tcp_requests[i];
+    }
   }
+  return NULL;
+}
 
-  EipUint8 *read_buffer = &g_ethernet_communication_buffer[2]; /* at this place EIP stores the data length */
-  size_t data_size = GetIntFromMessage(&read_buffer)
-      + ENCAPSULATION_HEADER_LENGTH - 4; /* -4 is for the 4 bytes we have already read*/
-  /* (NOTE this advances the buffer pointer) */
-  if ((PC_OPENER_ETHERNET_BUFFER_SIZE - 4) < data_size) { /*TODO can this be handled in a better way?*/
+EipStatus StoreTcpRequest(int socket, const EipUint8 *data, size_t length,
+                          size_t bytes_to_drop) {
+  PendingTcpRequest *pending_request = GetPendingTcpRequest(kEipInvalidSocket);
+  if (NULL == pending_request) {
     OPENER_TRACE_ERR(
-        "too large packet received will be ignored, will drop the data\n");
-    /* Currently we will drop the whole packet */
+        "networkhandler: no space to store TCP request for socket %d\n",
+        socket);
+    return kEipStatusError;
+  }
+  pending_request->socket = socket;
+  pending_request->length = length;
+  pending_request->bytes_to_drop = bytes_to_drop;
+  if (0 < length) {
+    memcpy(pending_request->data, data, length);
+  }
+  return kEipStatusOk;
+}
 
-    do {
-      number_of_read_bytes = recv(socket, &g_ethernet_communication_buffer[0],
-                                  data_sent, 0);
+EipStatus DropTcpData(int socket, size_t bytes_to_drop) {
+  while (0 < bytes_to_drop) {
+    long number_of_read_bytes = ReceiveTcpData(
+        socket, g_opener_stack->ethernet_communication_buffer,
+        (bytes_to_drop < PC_OPENER_ETHERNET_BUFFER_SIZE) ?
+            bytes_to_drop : PC_OPENER_ETHERNET_BUFFER_SIZE);
+    if (number_of_read_bytes < 0) {
+      return kEipStatusError;
+    }
+    if (0 == number_of_read_bytes) { /* continue when the rest arrives */
+      return StoreTcpRequest(socket, NULL, 0, bytes_to_drop);
+    }
+    bytes_to_drop -= number_of_read_bytes;
+  }
+  return kEipStatusOk;
+}
 
-      if (number_of_read_bytes == 0) /* got error or connection closed by client */
-      {
-		int error_code = GetSocketErrorNumber();
-		char* error_message = GetErrorMessage(error_code);
-		OPENER_TRACE_ERR("networkhandler: connection closed by client: %d - %s\n", error_code, error_message);
-		free(error_message);
-        return kEipStatusError;
-      }
-      if (number_of_read_bytes < 0) {
-		int error_code = GetSocketErrorNumber();
-		char* error_message = GetErrorMessage(error_code);
-		OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code, error_message);
-		free(error_message);
-        return kEipStatusError;
-      }
-      data_size -= number_of_read_bytes;
-      if ((data_size < PC_OPENER_ETHERNET_BUFFER_SIZE) && (data_size != 0)) {
-        data_sent = data_size;
-      }
-    } while (0 < data_size);
-    assert(0 <= data_size);
-    return kEipStatusOk;
+EipStatus HandleDataOnTcpSocket(int socket) {
+  int remaining_bytes = 0;
+  EipUint8 *buffer = g_opener_stack->ethernet_communication_buffer;
+  size_t received_length = 0;
+
+  /* We will handle just one EIP packet here, the socket is reported again if
+   * more data is available. As the socket is non-blocking, a packet may
+   * arrive in parts; these are stored until the socket is readable again. */
+  PendingTcpRequest *pending_request = GetPendingTcpRequest(socket);
+  if (NULL != pending_request) {
+    pending_request->socket = kEipInvalidSocket;
+    if (0 < pending_request->bytes_to_drop) {
+      return DropTcpData(socket, pending_request->bytes_to_drop);
+    }
+    received_length = pending_request->length;
+    memcpy(buffer, pending_request->data, received_length);
   }
 
-  number_of_read_bytes = recv(socket, &g_ethernet_communication_buffer[4],
-                              data_size, 0);
+  for (;;) {
+    size_t message_length = ENCAPSULATION_HEADER_LENGTH;
+    if (ENCAPSULATION_HEADER_LENGTH <= received_length) {
+      EipUint8 *read_buffer = &buffer[2]; /* at this place EIP stores the data length */
+      message_length += GetIntFromMessage(&read_buffer);
+    }
 
-  if (number_of_read_bytes == 0) /* got error or connection closed by client */
-  {
-	int error_code = GetSocketErrorNumber();
-	char* error_message = GetErrorMessage(error_code);
-	OPENER_TRACE_ERR("networkhandler: connection closed by client: %d - %s\n", error_code, error_message);
-	free(error_message);
-    return kEipStatusError;
+    if (PC_OPENER_ETHERNET_BUFFER_SIZE < message_length) {
+      OPENER_TRACE_ERR(
+          "too large packet received will be ignored, will drop the data\n");
+      g_opener_stack->opener_statistics.too_large_tcp_messages++;
+      /* Currently we will drop the whole packet */
+      return DropTcpData(socket, message_length - received_length);
+    }
+
+    if (message_length == received_length) {
+      break;
+    }
+
+    /* read the encapsulation header first, then the rest of the message */
+    long number_of_read_bytes = ReceiveTcpData(
+        socket, &buffer[received_length], message_length - received_length);
+    if (number_of_read_bytes < 0) {
+      return kEipStatusError;
+    }
+    if (0 == number_of_read_bytes) { /* continue when the rest arrives */
+      return StoreTcpRequest(socket, buffer, received_length, 0);
+    }
+    received_length += number_of_read_bytes;
   }
-  if (number_of_read_bytes < 0) {
-	int error_code = GetSocketErrorNumber();
-	char* error_message = GetErrorMessage(error_code);
-	OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code, error_message);
-	free(error_message);
-    return kEipStatusError;
+
+  OPENER_TRACE_INFO("Data received on tcp:\n");
+  g_opener_stack->opener_statistics.tcp_messages_received++;
+
+  g_opener_stack->current_active_tcp_socket = socket;
+
+  int reply_length = HandleReceivedExplictTcpData(socket, buffer,
+                                                  received_length,
+                                                  &remaining_bytes);
+
+  g_opener_stack->current_active_tcp_socket = -1;
+
+  if (remaining_bytes != 0) {
+    OPENER_TRACE_WARN(
+        "Warning: received packet was to long: %d Bytes left!\n",
+        remaining_bytes);
   }
 
-  if ((unsigned) number_of_read_bytes == data_size) {
-    /*we got the right amount of data */
-    data_size += 4;
-    /*TODO handle partial packets*/
-    OPENER_TRACE_INFO("Data received on tcp:\n");
+  if (reply_length > 0) {
+    OPENER_TRACE_INFO("reply sent:\n");
 
-    g_current_active_tcp_socket = socket;
+    return SendTcpReply(socket, buffer, reply_length);
+  }
 
-    number_of_read_bytes = HandleReceivedExplictTcpData(
-        socket, g_ethernet_communication_buffer, data_size, &remaining_bytes);
+  return kEipStatusOk;
+}
 
-    g_current_active_tcp_socket = -1;
+/** @brief Get the stored reply of a TCP socket
+ *
+ *  @param socket The socket, kEipInvalidSocket for getting an unused entry
+ *  @return the stored reply or NULL if there is none
+ */
+PendingTcpReply *GetPendingTcpReply(int socket) {
+  for (int i = 0; i < OPENER_NUMBER_OF_SUPPORTED_SESSIONS; i++) {
+    if (socket == g_opener_stack->pending_tcp_replies[i].socket) {
+      return &g_opener_stack->pending_tcp_replies[i];
+    }
+  }
+  return NULL;
+}
 
-    if (remaining_bytes != 0) {
-      OPENER_TRACE_WARN(
-          "Warning: received packet was to long: %d Bytes left!\n",
-          remaining_bytes);
+/** @brief Send data on a TCP socket without blocking
+ *
+ *  @return number of bytes sent, which may be 0 if the socket is busy, or -1
+ *  on error
+ */
+long SendTcpDataNonBlocking(int socket, EipUint8 *data, size_t data_length) {
+  long data_sent = g_network_transport->send_non_blocking(socket, data,
+                                                         data_length);
+
+  if (data_sent < 0) {
+    int error_code = GetSocketErrorNumber();
+    if (OPENER_SOCKET_WOULD_BLOCK == error_code) {
+      return 0;
+    }
+    char* error_message = GetErrorMessage(error_code);
+    OPENER_TRACE_ERR("networkhandler: error on send: %d - %s\n", error_code,
+                     error_message);
+    free(error_message);
+  }
+  return data_sent;
+}
+
+EipStatus SendTcpReply(int socket, EipUint8 *data, size_t data_length) {
+  long data_sent = SendTcpDataNonBlocking(socket, data, data_length);
+
+  if (data_sent < 0) {
+    return kEipStatusError;
+  }
+
+  if ((size_t) data_sent < data_length) {
+    PendingTcpReply *pending_reply = GetPendingTcpReply(kEipInvalidSocket);
+    if (NULL == pending_reply) {
+      OPENER_TRACE_ERR(
+          "networkhandler: no space to store TCP reply for socket %d\n",
+          socket);
+      return kEipStatusError;
     }
+    OPENER_TRACE_WARN(
+        "networkhandler: TCP reply not fully sent, %lu bytes pending on socket %d\n",
+        (unsigned long) (data_length - data_sent), socket);
 
-    if (number_of_read_bytes > 0) {
-      OPENER_TRACE_INFO("reply sent:\n");
+    pending_reply->socket = socket;
+    pending_reply->offset = 0;
+    pending_reply->length = data_length - data_sent;
+    memcpy(pending_reply->data, data + data_sent, pending_reply->length);
 
-      data_sent = send(socket, (char *) &g_ethernet_communication_buffer[0],
-                       number_of_read_bytes, 0);
-      if (data_sent != number_of_read_bytes) {
-        OPENER_TRACE_WARN("TCP response was not fully sent\n");
-      }
+    /* stop reading requests from this client until the reply is out */
+    SetMonitoredSocketEvents(socket, kSocketEventWritable);
+  }
+  return kEipStatusOk;
+}
+
+void SendPendingTcpReply(int socket) {
+  PendingTcpReply *pending_reply = GetPendingTcpReply(socket);
+  if (NULL == pending_reply) {
+    SetMonitoredSocketEvents(socket, kSocketEventReadable);
+    return;
+  }
+
+  long data_sent = SendTcpDataNonBlocking(
+      socket, &pending_reply->data[pending_reply->offset],
+      pending_reply->length);
+
+  if (data_sent < 0) {
+    if (kEipStatusOk != CloseSession(socket)) { /* closes the session's socket */
+      CloseSocket(socket);
     }
+    return;
+  }
 
-    return kEipStatusOk;
-  } else {
-    /* we got a fragmented packet currently we cannot handle this will
-     * for this we would need a network buffer per TCP socket
-     *
-     * However with typical packet sizes of EIP this should't be a big issue.
-     */
-    /*TODO handle fragmented packets */
+  pending_reply->offset += data_sent;
+  pending_reply->length -= data_sent;
+  if (0 == pending_reply->length) {
+    OPENER_TRACE_INFO("networkhandler: pending TCP reply sent on socket %d\n",
+                      socket);
+    pending_reply->socket = kEipInvalidSocket;
+    /* the client may send requests again */
+    SetMonitoredSocketEvents(socket, kSocketEventReadable);
   }
-  return kEipStatusError;
 }
 
 /** @brief create a new UDP socket for the connection manager
@@ -591,11 +872,9 @@ int CreateUdpSocket(UdpCommuncationDirection communication_direction,
   struct sockaddr_in peer_address;
   int new_socket;
 
-  socklen_t peer_address_length;
-
-  peer_address_length = sizeof(struct sockaddr_in);
   /* create a new UDP socket */
-  if ((new_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1) {
+  if ((new_socket = g_network_transport->create_socket(SOCK_DGRAM,
+                                                       IPPROTO_UDP)) == -1) {
 	int error_code = GetSocketErrorNumber();
 	char* error_message = GetErrorMessage(error_code);
 	OPENER_TRACE_ERR("networkhandler: cannot create UDP socket: %d- %s\n", error_code, error_message);
@@ -608,16 +887,16 @@ int CreateUdpSocket(UdpCommuncationDirection communication_direction,
   /* check if it is sending or receiving */
   if (communication_direction == kUdpCommuncationDirectionConsuming) {
     int option_value = 1;
-    if (setsockopt(new_socket, SOL_SOCKET, SO_REUSEADDR, (char *) &option_value,
-                   sizeof(option_value)) == -1) {
+    if (g_network_transport->set_socket_option(new_socket, SOL_SOCKET,
+                                               SO_REUSEADDR, &option_value,
+                                               sizeof(option_value)) == -1) {
       OPENER_TRACE_ERR(
           "error setting socket option SO_REUSEADDR on consuming udp socket\n");
       return kEipStatusError;
     }
 
     /* bind is only for consuming necessary */
-    if ((bind(new_socket, (struct sockaddr *) socket_data,
-              sizeof(struct sockaddr))) == -1) {
+    if ((g_network_transport->bind_socket(new_socket, socket_data)) == -1) {
 		int error_code = GetSocketErrorNumber();
 		char* error_message = GetErrorMessage(error_code);
 		OPENER_TRACE_ERR("error on bind udp: %d - %s\n", error_code, error_message);
@@ -625,20 +904,41 @@ int CreateUdpSocket(UdpCommuncationDirection communication_direction,
       return kEipInvalidSocket;
     }
 
+#ifdef SO_TIMESTAMPNS
+    /* let the kernel time stamp the consumed data on arrival */
+    if (g_network_transport->set_socket_option(new_socket, SOL_SOCKET,
+                                               SO_TIMESTAMPNS, &option_value,
+                                               sizeof(option_value)) == -1) {
+      OPENER_TRACE_WARN(
+          "networkhandler: could not set SO_TIMESTAMPNS on consuming udp socket\n");
+    }
+#endif
+
+#if defined(OPENER_BUSY_POLL) && defined(SO_BUSY_POLL)
+    /* let the kernel busy wait on the device queue for consumed data */
+    int busy_poll_time = kOpenerBusyPollMicroSeconds;
+    if (g_network_transport->set_socket_option(new_socket, SOL_SOCKET,
+                                               SO_BUSY_POLL, &busy_poll_time,
+                                               sizeof(busy_poll_time)) == -1) {
+      OPENER_TRACE_WARN(
+          "networkhandler: could not set SO_BUSY_POLL on consuming udp socket\n");
+    }
+#endif
+
     OPENER_TRACE_INFO("networkhandler: bind UDP socket %d\n", new_socket);
   } else { /* we have a producing udp socket */
 
     if (socket_data->sin_addr.s_addr
-        == g_multicast_configuration.starting_multicast_address) {
-      if (1 != g_time_to_live_value) { /* we need to set a TTL value for the socket */
-        if (setsockopt(new_socket, IPPROTO_IP, IP_MULTICAST_TTL,
-                       &g_time_to_live_value,
-                       sizeof(g_time_to_live_value) < 0)) {
+        == g_opener_stack->multicast_configuration.starting_multicast_address) {
+      if (1 != g_opener_stack->time_to_live_value) { /* we need to set a TTL value for the socket */
+        if (g_network_transport->set_socket_option(
+            new_socket, IPPROTO_IP, IP_MULTICAST_TTL, &g_opener_stack->time_to_live_value,
+            sizeof(g_opener_stack->time_to_live_value) < 0)) {
 			int error_code = GetSocketErrorNumber();
 			char* error_message = GetErrorMessage(error_code);
 			OPENER_TRACE_ERR(
 				"networkhandler: could not set the TTL to: %d, error: %d - %s\n",
-				g_time_to_live_value, error_code, error_message);
+				g_opener_stack->time_to_live_value, error_code, error_message);
 			free(error_message);
           return kEipInvalidSocket;
         }
@@ -649,9 +949,8 @@ int CreateUdpSocket(UdpCommuncationDirection communication_direction,
   if ((communication_direction == kUdpCommuncationDirectionConsuming)
       || (0 == socket_data->sin_addr.s_addr)) {
     /* we have a peer to peer producer or a consuming connection*/
-    if (getpeername(g_current_active_tcp_socket,
-                    (struct sockaddr *) &peer_address, &peer_address_length)
-        < 0) {
+    if (g_network_transport->get_peer_address(g_opener_stack->current_active_tcp_socket,
+                                              &peer_address) < 0) {
 		int error_code = GetSocketErrorNumber();
 		char* error_message = GetErrorMessage(error_code);
 		OPENER_TRACE_ERR("networkhandler: could not get peername: %d - %s\n", error_code, error_message);
@@ -662,59 +961,50 @@ int CreateUdpSocket(UdpCommuncationDirection communication_direction,
     socket_data->sin_addr.s_addr = peer_address.sin_addr.s_addr;
   }
 
-  /* add new socket to the master list                                             */
-  FD_SET(new_socket, &master_socket);
-  if (new_socket > highest_socket_handle) {
-    highest_socket_handle = new_socket;
+  /* monitor the new socket */
+  if (kEipStatusOk != AddMonitoredSocket(new_socket)) {
+    g_network_transport->close_socket(new_socket);
+    return kEipInvalidSocket;
   }
   return new_socket;
 }
 
-void CheckAndHandleConsumingUdpSockets(void) {
+EipBool8 CheckAndHandleConsumingUdpSocket(int socket) {
   struct sockaddr_in from_address;
-  socklen_t from_address_length;
-
-  ConnectionObject *connection_object_iterator = g_active_connection_list;
-  ConnectionObject *current_connection_object = NULL;
-
-  /* see a message on one of the registered UDP sockets has been received     */
-  while (NULL != connection_object_iterator) {
-    current_connection_object = connection_object_iterator;
-    connection_object_iterator = connection_object_iterator
-        ->next_connection_object; /* do this at the beginning as the close function may can make the entry invalid */
-
-    if ((-1
-        != current_connection_object->socket[kUdpCommuncationDirectionConsuming])
-        && (true
-            == CheckSocketSet(
-                current_connection_object->socket[kUdpCommuncationDirectionConsuming]))) {
-      from_address_length = sizeof(from_address);
-      int received_size = recvfrom(
-          current_connection_object->socket[kUdpCommuncationDirectionConsuming],
-          g_ethernet_communication_buffer, PC_OPENER_ETHERNET_BUFFER_SIZE, 0,
-          (struct sockaddr *) &from_address, &from_address_length);
-      if (0 == received_size) {
-        OPENER_TRACE_STATE("connection closed by client\n");
-        current_connection_object->connection_close_function(
-            current_connection_object);
-        continue;
-      }
+  MicroSeconds receive_time;
 
-      if (0 > received_size) {
-		int error_code = GetSocketErrorNumber();
-		char* error_message = GetErrorMessage(error_code);
-		OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code, error_message);
-		free(error_message);
-        current_connection_object->connection_close_function(
-            current_connection_object);
-        continue;
-      }
+  ConnectionObject *connection_object = g_opener_stack->active_connection_list;
+  while ((NULL != connection_object)
+      && (socket
+          != connection_object->socket[kUdpCommuncationDirectionConsuming])) {
+    connection_object = connection_object->next_connection_object;
+  }
+  if (NULL == connection_object) {
+    return false;
+  }
 
-      HandleReceivedConnectedData(g_ethernet_communication_buffer,
-                                  received_size, &from_address);
+  int received_size = g_network_transport->receive_from(
+      socket, g_opener_stack->ethernet_communication_buffer,
+      PC_OPENER_ETHERNET_BUFFER_SIZE, &from_address, &receive_time);
+  if (0 == received_size) {
+    OPENER_TRACE_STATE("connection closed by client\n");
+    connection_object->connection_close_function(connection_object);
+    return true;
+  }
 
-    }
+  if (0 > received_size) {
+	int error_code = GetSocketErrorNumber();
+	char* error_message = GetErrorMessage(error_code);
+	OPENER_TRACE_ERR("networkhandler: error on recv: %d - %s\n", error_code, error_message);
+	free(error_message);
+    connection_object->connection_close_function(connection_object);
+    return true;
   }
+
+  g_opener_stack->opener_statistics.udp_packets_received++;
+  HandleReceivedConnectedData(g_opener_stack->ethernet_communication_buffer,
+                              received_size, &from_address, receive_time);
+  return true;
 }
 
 
@@ -722,8 +1012,16 @@ void CloseSocket(int socket_handle) {
 
   OPENER_TRACE_INFO("networkhandler: closing socket %d\n", socket_handle);
   if (kEipInvalidSocket != socket_handle) {
-    FD_CLR(socket_handle, &master_socket);
-    CloseSocketPlatform(socket_handle);
+    PendingTcpReply *pending_reply = GetPendingTcpReply(socket_handle);
+    if (NULL != pending_reply) { /* drop the reply, nobody will receive it */
+      pending_reply->socket = kEipInvalidSocket;
+    }
+    PendingTcpRequest *pending_request = GetPendingTcpRequest(socket_handle);
+    if (NULL != pending_request) {
+      pending_request->socket = kEipInvalidSocket;
+    }
+    RemoveMonitoredSocket(socket_handle);
+    g_network_transport->close_socket(socket_handle);
   }
 }
 
@@ -27,25 +27,16 @@
 
 #define MAX_NO_OF_TCP_SOCKETS 10
 
-/* values needed from the connection manager */
-extern ConnectionObject *g_active_connection_list;
-
-EipUint8 g_ethernet_communication_buffer[PC_OPENER_ETHERNET_BUFFER_SIZE]; /**< communication buffer */
-
-fd_set master_socket;
-fd_set read_socket;
-
-int highest_socket_handle; /**< temporary file descriptor for select() */
-
-/** @brief This variable holds the TCP socket the received to last explicit message.
- * It is needed for opening point to point connection to determine the peer's
- * address.
+#ifndef OPENER_MAX_MONITORED_SOCKETS
+/** @brief Number of sockets the network handler of one stack can monitor
+ *
+ *  The three listeners, a TCP connection per session and a consuming and a
+ *  producing socket per I/O connection.
  */
-int g_current_active_tcp_socket;
-
-struct timeval g_time_value;
-MilliSeconds g_actual_time;
-MilliSeconds g_last_time;
+#define OPENER_MAX_MONITORED_SOCKETS (3 + OPENER_NUMBER_OF_SUPPORTED_SESSIONS \
+    + 2 * (OPENER_CIP_NUM_EXLUSIVE_OWNER_CONNS \
+        + OPENER_CIP_NUM_INPUT_ONLY_CONNS + OPENER_CIP_NUM_LISTEN_ONLY_CONNS))
+#endif
 
 /** @brief Struct representing the current network status
  *
@@ -57,7 +48,44 @@ typedef struct {
   MilliSeconds elapsed_time;
 } NetworkStatus;
 
-NetworkStatus g_network_status; /**< Global variable holding the current network status */
+/** @brief Timing statistics of the network handler's main loop
+ *
+ *  Used to compare the latency of the select based loop with the busy-poll
+ *  mode (OPENER_BUSY_POLL). Reported while the stack runs by the OpENer
+ *  statistics object and the POSIX statistics segment.
+ */
+typedef struct {
+  EipUint32 iterations; /**< number of calls of NetworkHandlerProcessOnce */
+  EipUint32 busy_iterations; /**< iterations in which received data was handled */
+  MicroSeconds max_iteration_time; /**< longest iteration, without waiting for the sockets */
+  MicroSeconds total_processing_time; /**< accumulated time for handling received data */
+  MicroSeconds max_processing_time; /**< longest time for handling received data */
+} NetworkHandlerLoopStatistics;
+
+/** @brief Reply data of a TCP socket which could not be sent completely
+ *
+ *  While a reply is pending the socket is monitored for write readiness only
+ *  and not read from, so at most one reply per socket has to be stored.
+ */
+typedef struct {
+  int socket; /**< socket the reply belongs to, kEipInvalidSocket if unused */
+  size_t offset; /**< position of the first byte not yet sent */
+  size_t length; /**< number of bytes not yet sent */
+  EipUint8 data[PC_OPENER_ETHERNET_BUFFER_SIZE]; /**< the reply data */
+} PendingTcpReply;
+
+/** @brief Part of a request received on a TCP socket
+ *
+ *  The TCP sockets are non-blocking, a request arriving in several parts is
+ *  kept here until the rest of the encapsulation message has been received.
+ *  The rest of a message too large for the buffer is read and dropped.
+ */
+typedef struct {
+  int socket; /**< socket the request belongs to, kEipInvalidSocket if unused */
+  size_t length; /**< number of bytes received */
+  size_t bytes_to_drop; /**< bytes of a too large message still to be dropped */
+  EipUint8 data[PC_OPENER_ETHERNET_BUFFER_SIZE]; /**< the received bytes */
+} PendingTcpRequest;
 
 /** @brief The platform independent part of network handler initialization routine
  *
@@ -76,15 +104,32 @@ void IApp_CloseSocket_tcp(int socket_handle);
  */
 EipStatus NetworkHandlerInitialize(void);
 
+/** @brief Wait for the ready sockets of the active stack and handle them
+ *
+ *  All sockets of a stack, including the consuming I/O sockets on port 2222,
+ *  are serviced by this one loop on the calling thread. There is no
+ *  multi-core receive path: the received I/O data is not partitioned over
+ *  worker threads, e.g. by SO_REUSEPORT, so one stack handles its I/O
+ *  connections on one core.
+ */
 EipStatus NetworkHandlerProcessOnce(void);
 
 EipStatus NetworkHandlerFinish(void);
 
-/** @brief check if the given socket is set in the read set
- * @param socket The socket to check
- * @return true if socket is set
+/** @brief Add a socket to the sockets monitored by the network handler
+ * @param socket The socket to add
+ * @return kEipStatusOk on success, kEipStatusError if the stack or the
+ * transport cannot monitor the socket, see NetworkTransport::add_socket
+ */
+EipStatus AddMonitoredSocket(int socket);
+
+/** @brief Stop monitoring a socket without closing it
+ *
+ * A pending event of the socket reported by the last wait is dropped.
+ *
+ * @param socket The socket to remove
  */
-EipBool8 CheckSocketSet(int socket);
+void RemoveMonitoredSocket(int socket);
 
 /** @brief Returns the socket with the highest id
  * @param socket1 First socket
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file network_transport.h
+ *  @brief Socket operations used by the generic network handler
+ *
+ *  The generic network handler does not call the socket API directly but
+ *  through the transport set with SetNetworkTransport. By default this is the
+ *  BSD socket transport, which works on the kernel's sockets with the help of
+ *  the platform network handler. Simulations can replace it by a transport
+ *  delivering the data in memory, e.g. the POSIX memory transport.
+ *
+ *  The network handler keeps the sockets it monitors in a list per stack and
+ *  passes it to wait_for_ready_sockets, which returns the sockets on which
+ *  events occurred. Transports with their own readiness notification, e.g.
+ *  epoll, are kept up to date with add_socket and remove_socket instead.
+ *  Transports waiting with select refuse in add_socket the sockets an fd_set
+ *  can not hold, on POSIX the descriptors of FD_SETSIZE and above, on Windows
+ *  any socket beyond the first FD_SETSIZE ones.
+ */
+
+#ifndef OPENER_NETWORK_TRANSPORT_H_
+#define OPENER_NETWORK_TRANSPORT_H_
+
+#include "typedefs.h"
+#include "networkhandler.h"
+
+/** @brief Socket operations of a network transport
+ *
+ *  Apart from the parameter types the functions behave like the BSD socket
+ *  functions of the same name, errors are reported with a return value of -1
+ *  and the error number returned by GetSocketErrorNumber.
+ */
+typedef struct {
+  /** @brief Create an IPv4 socket
+   *  @param type SOCK_STREAM or SOCK_DGRAM
+   *  @param protocol IPPROTO_TCP or IPPROTO_UDP
+   *  @return the socket handle, -1 on error
+   */
+  int (*create_socket)(int type, int protocol);
+
+  int (*set_socket_option)(int socket_handle, int level, int option_name,
+                           const void *option_value,
+                           socklen_t option_length);
+
+  int (*bind_socket)(int socket_handle, const struct sockaddr_in *address);
+
+  int (*listen_socket)(int socket_handle, int backlog);
+
+  /** @brief Accept a connection on a listening socket
+   *  @return the socket of the new connection, -1 on error
+   */
+  int (*accept_connection)(int socket_handle);
+
+  int (*get_peer_address)(int socket_handle, struct sockaddr_in *peer_address);
+
+  /** @brief Read data from a connected socket
+   *  @return number of bytes read, 0 if the peer closed the connection, -1 on
+   *  error
+   */
+  long (*receive)(int socket_handle, EipUint8 *buffer, size_t buffer_size);
+
+  /** @brief Send data on a connected socket without blocking the stack
+   *  @return number of bytes sent, -1 on error; OPENER_SOCKET_WOULD_BLOCK is
+   *  reported if the socket cannot take any data
+   */
+  long (*send_non_blocking)(int socket_handle, const EipUint8 *data,
+                            size_t data_length);
+
+  /** @brief Receive a datagram
+   *  @param receive_time Will hold the time of arrival of the datagram, see
+   *  ReceiveFromSocketPlatform, may be NULL if it is not needed
+   *  @return number of bytes received, -1 on error
+   */
+  int (*receive_from)(int socket_handle, EipUint8 *buffer, size_t buffer_size,
+                      struct sockaddr_in *from_address,
+                      MicroSeconds *receive_time);
+
+  int (*send_to)(int socket_handle, const EipUint8 *data, size_t data_length,
+                 const struct sockaddr_in *to_address);
+
+  /** @brief Switch a socket to non-blocking mode
+   *  @return 0 on success, -1 on error
+   */
+  int (*set_non_blocking)(int socket_handle);
+
+  /** @brief Start monitoring a socket for readability, see AddSocketPlatform
+   *  @return 0 on success, -1 if the socket can not be monitored
+   */
+  int (*add_socket)(int socket_handle);
+
+  /** @brief Change the events a socket is monitored for, see
+   *  ModifySocketPlatform
+   */
+  void (*modify_socket)(int socket_handle, int events);
+
+  /** @brief Stop monitoring a socket, see RemoveSocketPlatform */
+  void (*remove_socket)(int socket_handle);
+
+  /** @brief Wait for events, see WaitForReadySocketsPlatform */
+  int (*wait_for_ready_sockets)(const SocketEvents *monitored_sockets,
+                                int number_of_monitored_sockets,
+                                SocketEvents *ready_sockets,
+                                struct timeval *timeout);
+
+  void (*close_socket)(int socket_handle);
+} NetworkTransport;
+
+/** @brief Transport working on the kernel's sockets, the default transport */
+extern const NetworkTransport g_socket_network_transport;
+
+/** @brief Transport used by the network handler */
+extern const NetworkTransport *g_network_transport;
+
+/** @brief Select the transport used by the network handler
+ *
+ *  Has to be called before NetworkHandlerInitialize, sockets created with the
+ *  previous transport are not taken over.
+ *
+ *  @param transport The transport to use, NULL for the socket transport
+ */
+void SetNetworkTransport(const NetworkTransport *transport);
+
+#endif /* OPENER_NETWORK_TRANSPORT_H_ */
@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+/** @file socket_transport.c
+ *  @brief Network transport working on the kernel's sockets
+ */
+
+#include "network_transport.h"
+
+int CreateSocketTransport(int type, int protocol) {
+  return socket(AF_INET, type, protocol);
+}
+
+int SetSocketOptionSocketTransport(int socket_handle, int level,
+                                   int option_name, const void *option_value,
+                                   socklen_t option_length) {
+  return setsockopt(socket_handle, level, option_name,
+                    (const char *) option_value, option_length);
+}
+
+int BindSocketTransport(int socket_handle, const struct sockaddr_in *address) {
+  return bind(socket_handle, (const struct sockaddr *) address,
+              sizeof(struct sockaddr));
+}
+
+int ListenSocketTransport(int socket_handle, int backlog) {
+  return listen(socket_handle, backlog);
+}
+
+int AcceptSocketTransport(int socket_handle) {
+  return accept(socket_handle, NULL, NULL);
+}
+
+int GetPeerAddressSocketTransport(int socket_handle,
+                                  struct sockaddr_in *peer_address) {
+  socklen_t peer_address_length = sizeof(struct sockaddr_in);
+  return getpeername(socket_handle, (struct sockaddr *) peer_address,
+                     &peer_address_length);
+}
+
+long ReceiveSocketTransport(int socket_handle, EipUint8 *buffer,
+                            size_t buffer_size) {
+  return recv(socket_handle, (char *) buffer, buffer_size, 0);
+}
+
+long SendNonBlockingSocketTransport(int socket_handle, const EipUint8 *data,
+                                    size_t data_length) {
+  return send(socket_handle, (const char *) data, data_length,
+              OPENER_NON_BLOCKING_SEND_FLAGS);
+}
+
+int ReceiveFromSocketTransport(int socket_handle, EipUint8 *buffer,
+                               size_t buffer_size,
+                               struct sockaddr_in *from_address,
+                               MicroSeconds *receive_time) {
+  if (NULL != receive_time) {
+    return ReceiveFromSocketPlatform(socket_handle, buffer, buffer_size,
+                                     from_address, receive_time);
+  }
+  socklen_t from_address_length = sizeof(struct sockaddr_in);
+  return recvfrom(socket_handle, (char *) buffer, buffer_size, 0,
+                  (struct sockaddr *) from_address, &from_address_length);
+}
+
+int SendToSocketTransport(int socket_handle, const EipUint8 *data,
+                          size_t data_length,
+                          const struct sockaddr_in *to_address) {
+  return sendto(socket_handle, (const char *) data, data_length, 0,
+                (const struct sockaddr *) to_address,
+                sizeof(struct sockaddr_in));
+}
+
+const NetworkTransport g_socket_network_transport = {
+    .create_socket = &CreateSocketTransport,
+    .set_socket_option = &SetSocketOptionSocketTransport,
+    .bind_socket = &BindSocketTransport,
+    .listen_socket = &ListenSocketTransport,
+    .accept_connection = &AcceptSocketTransport,
+    .get_peer_address = &GetPeerAddressSocketTransport,
+    .receive = &ReceiveSocketTransport,
+    .send_non_blocking = &SendNonBlockingSocketTransport,
+    .receive_from = &ReceiveFromSocketTransport,
+    .send_to = &SendToSocketTransport,
+    .set_non_blocking = &SetSocketToNonBlockingPlatform,
+    .add_socket = &AddSocketPlatform,
+    .modify_socket = &ModifySocketPlatform,
+    .remove_socket = &RemoveSocketPlatform,
+    .wait_for_ready_sockets = &WaitForReadySocketsPlatform,
+    .close_socket = &CloseSocketPlatform };
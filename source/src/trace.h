@@ -39,45 +39,125 @@
 #define OPENER_TRACE_LEVEL OPENER_TRACE_LEVEL_ERROR
 #endif
 
+/** @def OPENER_TRACE_MODULE_CIP Traces of the CIP objects */
+#define OPENER_TRACE_MODULE_CIP 0
+
+/** @def OPENER_TRACE_MODULE_ENCAP Traces of the encapsulation layer */
+#define OPENER_TRACE_MODULE_ENCAP 1
+
+/** @def OPENER_TRACE_MODULE_PORT Traces of the platform port and the network
+ *  handler
+ */
+#define OPENER_TRACE_MODULE_PORT 2
+
+/** @def OPENER_TRACE_MODULE_APPLICATION Traces of the application */
+#define OPENER_TRACE_MODULE_APPLICATION 3
+
+/** @def OPENER_TRACE_MODULE_OTHER Traces of code not assigned to a module */
+#define OPENER_TRACE_MODULE_OTHER 4
+
+/** @def OPENER_TRACE_MODULE The module the compiled code belongs to, set per
+ *  library by the build system
+ */
+#ifndef OPENER_TRACE_MODULE
+#define OPENER_TRACE_MODULE OPENER_TRACE_MODULE_OTHER
+#endif
+
+/** @def OPENER_TRACE_MODULE_LEVEL The trace levels compiled into the current
+ *  module. OPENER_TRACE_CIP_LEVEL, OPENER_TRACE_ENCAP_LEVEL,
+ *  OPENER_TRACE_PORT_LEVEL and OPENER_TRACE_APPLICATION_LEVEL override
+ *  OPENER_TRACE_LEVEL for a module. Traces of other levels are removed by the
+ *  preprocessor, including their arguments.
+ */
+#if (OPENER_TRACE_MODULE == OPENER_TRACE_MODULE_CIP) && defined(OPENER_TRACE_CIP_LEVEL)
+#define OPENER_TRACE_MODULE_LEVEL OPENER_TRACE_CIP_LEVEL
+#elif (OPENER_TRACE_MODULE == OPENER_TRACE_MODULE_ENCAP) && defined(OPENER_TRACE_ENCAP_LEVEL)
+#define OPENER_TRACE_MODULE_LEVEL OPENER_TRACE_ENCAP_LEVEL
+#elif (OPENER_TRACE_MODULE == OPENER_TRACE_MODULE_PORT) && defined(OPENER_TRACE_PORT_LEVEL)
+#define OPENER_TRACE_MODULE_LEVEL OPENER_TRACE_PORT_LEVEL
+#elif (OPENER_TRACE_MODULE == OPENER_TRACE_MODULE_APPLICATION) && defined(OPENER_TRACE_APPLICATION_LEVEL)
+#define OPENER_TRACE_MODULE_LEVEL OPENER_TRACE_APPLICATION_LEVEL
+#else
+#define OPENER_TRACE_MODULE_LEVEL OPENER_TRACE_LEVEL
+#endif
+
 /* @def OPENER_TRACE_ENABLED Can be used for conditional code compilation */
 #define OPENER_TRACE_ENABLED
 
+/** @def OPENER_TRACE_MASK_BIT(module, level) Bit of a module's trace level in
+ *  g_opener_trace_mask
+ */
+#define OPENER_TRACE_MASK_BIT(module, level) ((EipUint32) (level) << ((module) * 4))
+
+/** @def OPENER_TRACE_MASK_ALL All trace levels of all modules */
+#define OPENER_TRACE_MASK_ALL 0x000FFFFFU
+
+#ifdef OPENER_TRACE_RUNTIME_MASK
+/** @brief Trace levels enabled at runtime, one OPENER_TRACE_MASK_BIT per
+ *  module and level
+ *
+ *  Only the levels compiled into a module can be enabled. All of them are
+ *  enabled at startup.
+ */
+extern EipUint32 g_opener_trace_mask;
+
+#define OPENER_TRACE_LOG(level, ...)                                         \
+  do {                                                                       \
+    if (g_opener_trace_mask & OPENER_TRACE_MASK_BIT(OPENER_TRACE_MODULE,     \
+                                                    level)) {                \
+      LOG_TRACE(__VA_ARGS__);                                                \
+    }                                                                        \
+  } while (0)
+#else
+#define OPENER_TRACE_LOG(level, ...) \
+  do {                               \
+    LOG_TRACE(__VA_ARGS__);          \
+  } while (0)
+#endif
+
 /** @def OPENER_TRACE_ERR(...) Trace error messages.
  *  In order to activate this trace level set the OPENER_TRACE_LEVEL_ERROR flag
  *  in OPENER_TRACE_LEVEL.
  */
-#define OPENER_TRACE_ERR(...)                                                  \
-  do {                                                                         \
-    if (OPENER_TRACE_LEVEL_ERROR & OPENER_TRACE_LEVEL) LOG_TRACE(__VA_ARGS__); \
-  } while (0)
+#if OPENER_TRACE_LEVEL_ERROR & OPENER_TRACE_MODULE_LEVEL
+#define OPENER_TRACE_ERR(...) \
+  OPENER_TRACE_LOG(OPENER_TRACE_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define OPENER_TRACE_ERR(...)
+#endif
 
 /** @def OPENER_TRACE_WARN(...) Trace warning messages.
  *  In order to activate this trace level set the OPENER_TRACE_LEVEL_WARNING
  * flag in OPENER_TRACE_LEVEL.
  */
-#define OPENER_TRACE_WARN(...)                           \
-  do {                                                   \
-    if (OPENER_TRACE_LEVEL_WARNING & OPENER_TRACE_LEVEL) \
-      LOG_TRACE(__VA_ARGS__);                            \
-  } while (0)
+#if OPENER_TRACE_LEVEL_WARNING & OPENER_TRACE_MODULE_LEVEL
+#define OPENER_TRACE_WARN(...) \
+  OPENER_TRACE_LOG(OPENER_TRACE_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define OPENER_TRACE_WARN(...)
+#endif
 
 /** @def OPENER_TRACE_STATE(...) Trace state messages.
  *  In order to activate this trace level set the OPENER_TRACE_LEVEL_STATE flag
  *  in OPENER_TRACE_LEVEL.
  */
-#define OPENER_TRACE_STATE(...)                                                \
-  do {                                                                         \
-    if (OPENER_TRACE_LEVEL_STATE & OPENER_TRACE_LEVEL) LOG_TRACE(__VA_ARGS__); \
-  } while (0)
+#if OPENER_TRACE_LEVEL_STATE & OPENER_TRACE_MODULE_LEVEL
+#define OPENER_TRACE_STATE(...) \
+  OPENER_TRACE_LOG(OPENER_TRACE_LEVEL_STATE, __VA_ARGS__)
+#else
+#define OPENER_TRACE_STATE(...)
+#endif
 
 /** @def OPENER_TRACE_INFO(...) Trace information messages.
  *  In order to activate this trace level set the OPENER_TRACE_LEVEL_INFO flag
  *  in OPENER_TRACE_LEVEL.
  */
-#define OPENER_TRACE_INFO(...)                                                \
-  do {                                                                        \
-    if (OPENER_TRACE_LEVEL_INFO & OPENER_TRACE_LEVEL) LOG_TRACE(__VA_ARGS__); \
-  } while (0)
+#if OPENER_TRACE_LEVEL_INFO & OPENER_TRACE_MODULE_LEVEL
+#define OPENER_TRACE_INFO(...) \
+  OPENER_TRACE_LOG(OPENER_TRACE_LEVEL_INFO, __VA_ARGS__)
+#else
+#define OPENER_TRACE_INFO(...)
+#endif
 
 #else
 /* define the tracing macros empty in order to save space */
@@ -105,6 +105,22 @@ typedef enum {
   kUdpCommuncationDirectionProducing = 1 /**< Producing direction; sender */
 } UdpCommuncationDirection;
 
+/** @brief Events a socket is monitored for */
+typedef enum {
+  kSocketEventReadable = 0x01, /**< data or a connection request can be read */
+  kSocketEventWritable = 0x02 /**< data can be sent without blocking */
+} SocketEvent;
+
+/** @brief A socket together with a set of events
+ *
+ *  Describes a socket monitored by the network handler and the events it is
+ *  monitored for, or a socket reported ready and the events that occurred.
+ */
+typedef struct {
+  int socket_handle;
+  int events; /**< combination of SocketEvent flags */
+} SocketEvents;
+
 #ifndef __cplusplus
 /** @brief If we don't have C++ define a C++ -like "bool" keyword defines
  */
@@ -3,3 +3,6 @@
 IMPORT_TEST_GROUP(RandomClass);
 IMPORT_TEST_GROUP(XorShiftRandom);
 IMPORT_TEST_GROUP(EndianConversion);
+IMPORT_TEST_GROUP(CommonPacketFormat);
+IMPORT_TEST_GROUP(CipCommon);
+IMPORT_TEST_GROUP(AssemblyIndex);
@@ -0,0 +1,319 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <CppUTest/TestHarness.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+
+#include <arpa/inet.h>
+
+#include "opener_api.h"
+
+#include "ciptypes.h"
+#include "cipmessagerouter.h"
+#include "opener_stack.h"
+}
+
+/** @brief Elementary types of the descriptor table with their encoded size */
+static const struct {
+  EipUint8 cip_type;
+  int size;
+} kElementaryTypes[] = { { kCipBool, 1 }, { kCipSint, 1 }, { kCipUsint, 1 }, {
+    kCipByte, 1 }, { kCipInt, 2 }, { kCipUint, 2 }, { kCipWord, 2 }, { kCipDint,
+    4 }, { kCipUdint, 4 }, { kCipDword, 4 }, { kCipReal, 4 },
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+    { kCipLint, 8 }, { kCipUlint, 8 }, { kCipLword, 8 }, { kCipLreal, 8 },
+#endif
+    };
+
+TEST_GROUP(CipCommon) {
+
+};
+
+TEST(CipCommon, ElementaryTypesRoundTrip) {
+  for (size_t i = 0; i < sizeof(kElementaryTypes) / sizeof(kElementaryTypes[0]);
+      i++) {
+    union {
+      CipUsint usint;
+      CipUint uint;
+      CipUdint udint;
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+      CipUlint ulint;
+#endif
+    } value, returned_value;
+    CipOctet message[8];
+    CipOctet *message_pointer = message;
+    int size = kElementaryTypes[i].size;
+
+    memset(&value, 0, sizeof(value));
+    memset(&returned_value, 0, sizeof(returned_value));
+    switch (size) {
+      case 1:
+        value.usint = 0x5A;
+        break;
+      case 2:
+        value.uint = 0x5499;
+        break;
+      case 4:
+        value.udint = 0x2529351C;
+        break;
+#ifdef OPENER_SUPPORT_64BIT_DATATYPES
+      case 8:
+        value.ulint = 0x2D2AEF0B84095230;
+        break;
+#endif
+    }
+
+    LONGS_EQUAL(size,
+                GetEncodedDataSize(kElementaryTypes[i].cip_type, &value));
+    LONGS_EQUAL(size,
+                EncodeData(kElementaryTypes[i].cip_type, &value,
+                           &message_pointer));
+    POINTERS_EQUAL(message + size, message_pointer);
+
+    message_pointer = message;
+    LONGS_EQUAL(size,
+                DecodeData(kElementaryTypes[i].cip_type, &returned_value,
+                           &message_pointer));
+    POINTERS_EQUAL(message + size, message_pointer);
+    MEMCMP_EQUAL(&value, &returned_value, sizeof(value));
+  }
+}
+
+TEST(CipCommon, EncodeUintIsLittleEndian) {
+  CipUint value = 0x5499;
+  CipOctet message[2];
+  CipOctet *message_pointer = message;
+
+  EncodeData(kCipUint, &value, &message_pointer);
+
+  BYTES_EQUAL(0x99, message[0]);
+  BYTES_EQUAL(0x54, message[1]);
+}
+
+TEST(CipCommon, StringRoundTrip) {
+  /* an odd length is padded to an even number of bytes */
+  EipByte text[] = "OpENer";
+  EipByte returned_text[sizeof(text)];
+  CipString string = { 5, text };
+  CipString returned_string = { 0, returned_text };
+  CipOctet message[16];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(8, GetEncodedDataSize(kCipString, &string));
+  LONGS_EQUAL(8, EncodeData(kCipString, &string, &message_pointer));
+  POINTERS_EQUAL(message + 8, message_pointer);
+  BYTES_EQUAL(5, message[0]);
+  BYTES_EQUAL(0, message[1]);
+  MEMCMP_EQUAL(text, message + 2, 5);
+  BYTES_EQUAL(0, message[7]);
+
+  message_pointer = message;
+  LONGS_EQUAL(8, DecodeData(kCipString, &returned_string, &message_pointer));
+  POINTERS_EQUAL(message + 8, message_pointer);
+  LONGS_EQUAL(5, returned_string.length);
+  MEMCMP_EQUAL(text, returned_text, 5);
+
+  string.length = 6;
+  message_pointer = message;
+  LONGS_EQUAL(8, GetEncodedDataSize(kCipString, &string));
+  LONGS_EQUAL(8, EncodeData(kCipString, &string, &message_pointer));
+  POINTERS_EQUAL(message + 8, message_pointer);
+}
+
+TEST(CipCommon, ShortStringRoundTrip) {
+  EipByte text[] = "OpENer";
+  EipByte returned_text[sizeof(text)];
+  CipShortString short_string = { 6, text };
+  CipShortString returned_short_string = { 0, returned_text };
+  CipOctet message[8];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(7, GetEncodedDataSize(kCipShortString, &short_string));
+  LONGS_EQUAL(7, EncodeData(kCipShortString, &short_string, &message_pointer));
+  POINTERS_EQUAL(message + 7, message_pointer);
+  BYTES_EQUAL(6, message[0]);
+
+  message_pointer = message;
+  LONGS_EQUAL(
+      7, DecodeData(kCipShortString, &returned_short_string, &message_pointer));
+  POINTERS_EQUAL(message + 7, message_pointer);
+  LONGS_EQUAL(6, returned_short_string.length);
+  MEMCMP_EQUAL(text, returned_text, 6);
+}
+
+TEST(CipCommon, EncodeEpath) {
+  /* 8 bit segments take one word, 16 bit segments two */
+  CipEpath epaths[] = { { 3, 0x01, 0x01, 0x03 }, { 5, 0x100, 0x01, 0x300 } };
+  CipOctet message[16];
+
+  for (size_t i = 0; i < sizeof(epaths) / sizeof(epaths[0]); i++) {
+    CipOctet *message_pointer = message;
+    int encoded_size = 2 + epaths[i].path_size * 2;
+
+    LONGS_EQUAL(encoded_size, GetEncodedDataSize(kCipEpath, &epaths[i]));
+    LONGS_EQUAL(encoded_size,
+                EncodeData(kCipEpath, &epaths[i], &message_pointer));
+    POINTERS_EQUAL(message + encoded_size, message_pointer);
+  }
+}
+
+TEST(CipCommon, EncodeRevision) {
+  CipRevision revision = { 2, 1 };
+  CipOctet message[2];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(2, GetEncodedDataSize(kCipUsintUsint, &revision));
+  LONGS_EQUAL(2, EncodeData(kCipUsintUsint, &revision, &message_pointer));
+  POINTERS_EQUAL(message + 2, message_pointer);
+  BYTES_EQUAL(2, message[0]);
+  BYTES_EQUAL(1, message[1]);
+}
+
+TEST(CipCommon, EncodeTcpIpNetworkInterfaceConfiguration) {
+  EipByte domain_name[] = "local";
+  CipTcpIpNetworkInterfaceConfiguration configuration = { htonl(0xC0A80001),
+      htonl(0xFFFFFF00), htonl(0xC0A800FE), 0, 0, { 5, domain_name } };
+  CipOctet message[32];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(28,
+              GetEncodedDataSize(kCipUdintUdintUdintUdintUdintString,
+                                 &configuration));
+  LONGS_EQUAL(
+      28,
+      EncodeData(kCipUdintUdintUdintUdintUdintString, &configuration,
+                 &message_pointer));
+  POINTERS_EQUAL(message + 28, message_pointer);
+  BYTES_EQUAL(0x01, message[0]);
+  BYTES_EQUAL(0xC0, message[3]);
+}
+
+TEST(CipCommon, EncodeFixedWidthStructs) {
+  EipUint32 udints[12] = { 0 };
+  CipOctet message[48];
+  static const struct {
+    EipUint8 cip_type;
+    int size;
+  } kStructTypes[] = { { kCip6Usint, 6 }, { kCip11Udint, 44 }, { kCip12Udint,
+      48 }, { kInternalUint6, 12 } };
+
+  for (size_t i = 0; i < sizeof(kStructTypes) / sizeof(kStructTypes[0]); i++) {
+    CipOctet *message_pointer = message;
+
+    LONGS_EQUAL(kStructTypes[i].size,
+                GetEncodedDataSize(kStructTypes[i].cip_type, udints));
+    LONGS_EQUAL(kStructTypes[i].size,
+                EncodeData(kStructTypes[i].cip_type, udints, &message_pointer));
+    POINTERS_EQUAL(message + kStructTypes[i].size, message_pointer);
+
+    /* these types can only be encoded */
+    message_pointer = message;
+    LONGS_EQUAL(-1,
+                DecodeData(kStructTypes[i].cip_type, udints, &message_pointer));
+    POINTERS_EQUAL(message, message_pointer);
+  }
+}
+
+TEST(CipCommon, EncodeByteArray) {
+  EipByte data[] = { 1, 2, 3 };
+  CipByteArray byte_array = { 3, data };
+  CipOctet message[3];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(3, GetEncodedDataSize(kCipByteArray, &byte_array));
+  LONGS_EQUAL(3, EncodeData(kCipByteArray, &byte_array, &message_pointer));
+  POINTERS_EQUAL(message + 3, message_pointer);
+  MEMCMP_EQUAL(data, message, 3);
+}
+
+TEST(CipCommon, UnsupportedTypes) {
+  /* kCipStime lies within the table without an entry, kCipAny before it */
+  EipUint8 unsupported_types[] = { kCipStime, kCipMemberList, kCipAny };
+  CipUdint value = 0;
+  CipOctet message[4];
+
+  for (size_t i = 0; i < sizeof(unsupported_types); i++) {
+    CipOctet *message_pointer = message;
+
+    LONGS_EQUAL(0, GetEncodedDataSize(unsupported_types[i], &value));
+    LONGS_EQUAL(0, EncodeData(unsupported_types[i], &value, &message_pointer));
+    LONGS_EQUAL(-1,
+                DecodeData(unsupported_types[i], &value, &message_pointer));
+    POINTERS_EQUAL(message, message_pointer);
+  }
+}
+
+TEST(CipCommon, UdintArrayRoundTrip) {
+  CipUdint values[] = { 0x2529351C, 0x01 };
+  CipUdint returned_values[2];
+  CipOctet message[8];
+  CipOctet *message_pointer = message;
+
+  LONGS_EQUAL(8, EncodeDataArray(kCipUdint, values, 2, &message_pointer));
+  POINTERS_EQUAL(message + 8, message_pointer);
+
+  message_pointer = message;
+  LONGS_EQUAL(8,
+              DecodeDataArray(kCipUdint, returned_values, 2, &message_pointer));
+  POINTERS_EQUAL(message + 8, message_pointer);
+  MEMCMP_EQUAL(values, returned_values, sizeof(values));
+}
+
+TEST(CipCommon, ArraysOfStructsAreRejected) {
+  CipOctet message[8];
+  CipOctet *message_pointer = message;
+  EipUint8 data[8] = { 0 };
+
+  LONGS_EQUAL(-1, EncodeDataArray(kCipString, data, 1, &message_pointer));
+  LONGS_EQUAL(-1, EncodeDataArray(kCip6Usint, data, 1, &message_pointer));
+  LONGS_EQUAL(-1, DecodeDataArray(kCipUsintUsint, data, 1, &message_pointer));
+  POINTERS_EQUAL(message, message_pointer);
+}
+
+static CipUdint shared_test_value;
+
+/** @brief Attributes of the test class, one shared, one in the stack */
+static const CipAttributeDefinition kTestInstanceAttributes[] = {
+    CIP_SHARED_ATTRIBUTE(1, kCipUdint, kGetableSingleAndAll,
+        &shared_test_value),
+    CIP_STACK_ATTRIBUTE(2, kCipUdint, kGetableSingleAndAll, serial_number) };
+
+static const CipClassDefinition kTestClassDefinition = { 0x64, "test", 1, 0,
+    kTestInstanceAttributes, CIP_TABLE_ENTRIES(kTestInstanceAttributes), 2, 0,
+    NULL, 0 };
+
+TEST(CipCommon, DefinitionAttributesUseTheActiveStack) {
+  OpenerStack *stacks[] = { &g_default_opener_stack, CreateOpenerStack() };
+
+  for (size_t i = 0; i < sizeof(stacks) / sizeof(stacks[0]); i++) {
+    SetActiveOpenerStack(stacks[i]);
+    CipClass *test_class = CreateCipClassFromDefinition(&kTestClassDefinition);
+    CipInstance *instance = GetCipInstance(test_class, 1);
+
+    POINTERS_EQUAL(&shared_test_value, GetCipAttribute(instance, 1)->data);
+    POINTERS_EQUAL(&stacks[i]->serial_number,
+                   GetCipAttribute(instance, 2)->data);
+    LONGS_EQUAL(kCipUdint, GetCipAttribute(instance, 2)->type);
+    DeleteAllClasses();
+  }
+  SetActiveOpenerStack(NULL);
+  DestroyOpenerStack(stacks[1]);
+}
+
+TEST(CipCommon, GetCipAttributeDefinition) {
+  CipClass *test_class = CreateCipClassFromDefinition(&kTestClassDefinition);
+
+  POINTERS_EQUAL(&kTestInstanceAttributes[1],
+                 GetCipAttributeDefinition(test_class, 2));
+  POINTERS_EQUAL(NULL, GetCipAttributeDefinition(test_class, 3));
+  /* the metaclass holding the class attributes has no definition */
+  POINTERS_EQUAL(NULL,
+                 GetCipAttributeDefinition(test_class->m_stSuper.cip_class, 1));
+  DeleteAllClasses();
+}
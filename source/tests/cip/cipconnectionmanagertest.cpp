@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <CppUTest/TestHarness.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+
+#include "cipconnectionmanager.h"
+#include "opener_stack.h"
+
+/* internal functions of cipconnectionmanager.c */
+AssemblyIndexEntry *GetAssemblyIndexEntry(EipUint32 assembly,
+                                          EipBool8 create_entry);
+void FreeAssemblyIndexEntry(AssemblyIndexEntry *entry);
+void AddToAssemblyIndex(ConnectionObject *connection_object);
+void RemoveFromAssemblyIndex(ConnectionObject *connection_object);
+}
+
+/** @brief The slot count, assemblies differing by it share their home slot */
+static const EipUint32 kSlots = OPENER_ASSEMBLY_INDEX_SLOTS;
+
+static AssemblyIndexEntry *Slot(size_t slot) {
+  return &g_opener_stack->assembly_index[slot];
+}
+
+TEST_GROUP(AssemblyIndex) {
+  void setup() {
+    memset(g_opener_stack->assembly_index, 0,
+           sizeof(g_opener_stack->assembly_index));
+  }
+
+  void teardown() {
+    memset(g_opener_stack->assembly_index, 0,
+           sizeof(g_opener_stack->assembly_index));
+  }
+};
+
+TEST(AssemblyIndex, LookupDoesNotCreate) {
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(100, false));
+  LONGS_EQUAL(0, Slot(100 % kSlots)->assembly);
+
+  AssemblyIndexEntry *entry = GetAssemblyIndexEntry(100, true);
+  POINTERS_EQUAL(Slot(100 % kSlots), entry);
+  LONGS_EQUAL(100, entry->assembly);
+  POINTERS_EQUAL(entry, GetAssemblyIndexEntry(100, false));
+  POINTERS_EQUAL(entry, GetAssemblyIndexEntry(100, true));
+}
+
+TEST(AssemblyIndex, CollidingInstanceNumbers) {
+  AssemblyIndexEntry *first = GetAssemblyIndexEntry(100, true);
+  AssemblyIndexEntry *second = GetAssemblyIndexEntry(100 + kSlots, true);
+  AssemblyIndexEntry *third = GetAssemblyIndexEntry(100 + 2 * kSlots, true);
+
+  POINTERS_EQUAL(Slot(100 % kSlots), first);
+  POINTERS_EQUAL(Slot(100 % kSlots + 1), second);
+  POINTERS_EQUAL(Slot(100 % kSlots + 2), third);
+
+  /* the entries behind the freed one move up into the gap */
+  FreeAssemblyIndexEntry(first);
+  POINTERS_EQUAL(Slot(100 % kSlots),
+                 GetAssemblyIndexEntry(100 + kSlots, false));
+  POINTERS_EQUAL(Slot(100 % kSlots + 1),
+                 GetAssemblyIndexEntry(100 + 2 * kSlots, false));
+  LONGS_EQUAL(0, Slot(100 % kSlots + 2)->assembly);
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(100, false));
+
+  /* freeing the last one of a probe sequence moves nothing */
+  FreeAssemblyIndexEntry(GetAssemblyIndexEntry(100 + 2 * kSlots, false));
+  POINTERS_EQUAL(Slot(100 % kSlots),
+                 GetAssemblyIndexEntry(100 + kSlots, false));
+  LONGS_EQUAL(0, Slot(100 % kSlots + 1)->assembly);
+}
+
+TEST(AssemblyIndex, ProbeSequenceWrapsPastSlotZero) {
+  const EipUint32 last = kSlots - 1; /* home slot is the last slot */
+
+  GetAssemblyIndexEntry(last, true);
+  GetAssemblyIndexEntry(last + kSlots, true);
+  GetAssemblyIndexEntry(kSlots + 1, true); /* home slot 1 */
+  GetAssemblyIndexEntry(last + 2 * kSlots, true);
+
+  LONGS_EQUAL(last, Slot(last)->assembly);
+  LONGS_EQUAL(last + kSlots, Slot(0)->assembly);
+  LONGS_EQUAL(kSlots + 1, Slot(1)->assembly);
+  LONGS_EQUAL(last + 2 * kSlots, Slot(2)->assembly);
+
+  /* the entry in its home slot stays, the wrapped ones move back */
+  FreeAssemblyIndexEntry(Slot(last));
+  LONGS_EQUAL(last + kSlots, Slot(last)->assembly);
+  LONGS_EQUAL(last + 2 * kSlots, Slot(0)->assembly);
+  LONGS_EQUAL(kSlots + 1, Slot(1)->assembly);
+  LONGS_EQUAL(0, Slot(2)->assembly);
+
+  POINTERS_EQUAL(Slot(last), GetAssemblyIndexEntry(last + kSlots, false));
+  POINTERS_EQUAL(Slot(0), GetAssemblyIndexEntry(last + 2 * kSlots, false));
+  POINTERS_EQUAL(Slot(1), GetAssemblyIndexEntry(kSlots + 1, false));
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(last, false));
+}
+
+TEST(AssemblyIndex, RemoveLooksUpAgainAfterFree) {
+  /* the input point entry follows the output point entry in its probe
+   * sequence and is moved when the output point entry is freed */
+  const EipUint32 output_point = 100;
+  const EipUint32 input_point = 100 + kSlots;
+  ConnectionObject connection;
+  memset(&connection, 0, sizeof(connection));
+  connection.connection_path.connection_point[0] = output_point;
+  connection.connection_path.connection_point[1] = input_point;
+
+  AddToAssemblyIndex(&connection);
+  POINTERS_EQUAL(&connection, GetFirstConnectionOfOutputPoint(output_point));
+  POINTERS_EQUAL(&connection, GetFirstConnectionOfInputPoint(input_point));
+  POINTERS_EQUAL(Slot(100 % kSlots + 1),
+                 GetAssemblyIndexEntry(input_point, false));
+
+  RemoveFromAssemblyIndex(&connection);
+  POINTERS_EQUAL(NULL, GetFirstConnectionOfOutputPoint(output_point));
+  POINTERS_EQUAL(NULL, GetFirstConnectionOfInputPoint(input_point));
+  for (size_t slot = 0; slot < kSlots; slot++) {
+    LONGS_EQUAL(0, Slot(slot)->assembly);
+    POINTERS_EQUAL(NULL, Slot(slot)->input_point_connections);
+  }
+}
+
+TEST(AssemblyIndex, SharedConnectionPointStaysIndexed) {
+  ConnectionObject connections[2];
+  memset(connections, 0, sizeof(connections));
+  for (int i = 0; i < 2; i++) {
+    connections[i].connection_path.connection_point[0] = 150 + i;
+    connections[i].connection_path.connection_point[1] = 100;
+    AddToAssemblyIndex(&connections[i]);
+  }
+
+  RemoveFromAssemblyIndex(&connections[1]);
+  POINTERS_EQUAL(&connections[0], GetFirstConnectionOfInputPoint(100));
+  POINTERS_EQUAL(NULL, connections[0].next_connection_of_input_point);
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(151, false));
+
+  RemoveFromAssemblyIndex(&connections[0]);
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(100, false));
+  POINTERS_EQUAL(NULL, GetAssemblyIndexEntry(150, false));
+}
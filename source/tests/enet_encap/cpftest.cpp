@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * Copyright (c) 2009, Rockwell Automation, Inc.
+ * All rights reserved.
+ *
+ ******************************************************************************/
+
+#include <CppUTest/TestHarness.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+
+#include "cpf.h"
+
+#include "ciptypes.h"
+}
+
+/** @brief Builds a CPF packet, all values are encoded little endian */
+typedef struct {
+  CipOctet data[128];
+  int length;
+} CpfPacket;
+
+static void AddUint(CpfPacket *packet, CipUint value) {
+  packet->data[packet->length++] = (CipOctet) value;
+  packet->data[packet->length++] = (CipOctet) (value >> 8);
+}
+
+static void AddItem(CpfPacket *packet, CipUint type_id, CipUint length) {
+  AddUint(packet, type_id);
+  AddUint(packet, length);
+  for (int i = 0; i < length; i++) {
+    packet->data[packet->length++] = (CipOctet) i;
+  }
+}
+
+static void StartPacket(CpfPacket *packet, CipUint item_count) {
+  packet->length = 0;
+  AddUint(packet, item_count);
+}
+
+static EipStatus Parse(CpfPacket *packet, CipCommonPacketFormatData *cpf) {
+  return CreateCommonPacketFormatStructure(packet->data, packet->length, cpf);
+}
+
+TEST_GROUP(CommonPacketFormat) {
+  CpfPacket packet;
+  CipCommonPacketFormatData cpf;
+
+  void setup() {
+    memset(&packet, 0, sizeof(packet));
+    memset(&cpf, 0, sizeof(cpf));
+  }
+};
+
+TEST(CommonPacketFormat, UnconnectedMessage) {
+  StartPacket(&packet, 2);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 6);
+
+  LONGS_EQUAL(kEipStatusOk, Parse(&packet, &cpf));
+  LONGS_EQUAL(2, cpf.item_count);
+  LONGS_EQUAL(kCipItemIdNullAddress, cpf.address_item.type_id);
+  LONGS_EQUAL(kCipItemIdUnconnectedDataItem, cpf.data_item.type_id);
+  LONGS_EQUAL(6, cpf.data_item.length);
+  POINTERS_EQUAL(packet.data + 10, cpf.data_item.data);
+  LONGS_EQUAL(0, cpf.address_info_item[0].type_id);
+  LONGS_EQUAL(0, cpf.address_info_item[1].type_id);
+}
+
+TEST(CommonPacketFormat, ItemsInAnyOrder) {
+  StartPacket(&packet, 3);
+  AddItem(&packet, kCipItemIdSocketAddressInfoTargetToOriginator, 16);
+  AddItem(&packet, kCipItemIdConnectedDataItem, 2);
+  AddItem(&packet, kCipItemIdSequencedAddressItem, 8);
+
+  LONGS_EQUAL(kEipStatusOk, Parse(&packet, &cpf));
+  LONGS_EQUAL(kCipItemIdSequencedAddressItem, cpf.address_item.type_id);
+  LONGS_EQUAL(0x03020100, cpf.address_item.data.connection_identifier);
+  LONGS_EQUAL(0x07060504, cpf.address_item.data.sequence_number);
+  LONGS_EQUAL(kCipItemIdConnectedDataItem, cpf.data_item.type_id);
+  POINTERS_EQUAL(packet.data + 26, cpf.data_item.data);
+  LONGS_EQUAL(kCipItemIdSocketAddressInfoTargetToOriginator,
+              cpf.address_info_item[0].type_id);
+  BYTES_EQUAL(8, cpf.address_info_item[0].nasin_zero[0]);
+}
+
+TEST(CommonPacketFormat, NoItemCount) {
+  StartPacket(&packet, 0);
+  packet.length = 1;
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, TruncatedItemHeader) {
+  StartPacket(&packet, 2);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddUint(&packet, kCipItemIdUnconnectedDataItem);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, ItemLengthBeyondData) {
+  StartPacket(&packet, 2);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 6);
+  packet.length--;
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, DuplicateAddressItem) {
+  StartPacket(&packet, 3);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdConnectionAddress, 4);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, DuplicateDataItem) {
+  StartPacket(&packet, 3);
+  AddItem(&packet, kCipItemIdConnectedDataItem, 2);
+  AddItem(&packet, kCipItemIdConnectionAddress, 4);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, AddressItemWithWrongLength) {
+  StartPacket(&packet, 2);
+  AddItem(&packet, kCipItemIdConnectionAddress, 8);
+  AddItem(&packet, kCipItemIdConnectedDataItem, 2);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, SocketAddressInfoItemWithWrongLength) {
+  StartPacket(&packet, 3);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+  AddItem(&packet, kCipItemIdSocketAddressInfoOriginatorToTarget, 12);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, TwoSocketAddressInfoItems) {
+  StartPacket(&packet, 4);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+  AddItem(&packet, kCipItemIdSocketAddressInfoOriginatorToTarget, 16);
+  AddItem(&packet, kCipItemIdSocketAddressInfoTargetToOriginator, 16);
+
+  LONGS_EQUAL(kEipStatusOk, Parse(&packet, &cpf));
+  LONGS_EQUAL(kCipItemIdSocketAddressInfoOriginatorToTarget,
+              cpf.address_info_item[0].type_id);
+  LONGS_EQUAL(kCipItemIdSocketAddressInfoTargetToOriginator,
+              cpf.address_info_item[1].type_id);
+}
+
+TEST(CommonPacketFormat, ThirdSocketAddressInfoItem) {
+  StartPacket(&packet, 5);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+  AddItem(&packet, kCipItemIdSocketAddressInfoOriginatorToTarget, 16);
+  AddItem(&packet, kCipItemIdSocketAddressInfoTargetToOriginator, 16);
+  AddItem(&packet, kCipItemIdSocketAddressInfoOriginatorToTarget, 16);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, UnknownItemIsSkipped) {
+  StartPacket(&packet, 3);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, 0x1234, 5);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+
+  LONGS_EQUAL(kEipStatusOk, Parse(&packet, &cpf));
+  LONGS_EQUAL(kCipItemIdUnconnectedDataItem, cpf.data_item.type_id);
+  POINTERS_EQUAL(packet.data + 19, cpf.data_item.data);
+}
+
+TEST(CommonPacketFormat, MissingDataItem) {
+  StartPacket(&packet, 1);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
+
+TEST(CommonPacketFormat, TrailingBytes) {
+  StartPacket(&packet, 2);
+  AddItem(&packet, kCipItemIdNullAddress, 0);
+  AddItem(&packet, kCipItemIdUnconnectedDataItem, 2);
+  AddUint(&packet, 0);
+
+  LONGS_EQUAL(kEipStatusError, Parse(&packet, &cpf));
+}
@@ -97,12 +97,77 @@ TEST(EndianConversion, AddLintToMessage) {
   POINTERS_EQUAL(message + 8, message_pointer)
 }
 
+TEST(EndianConversion, AddIntArrayToMessage) {
+  CipUint values_to_add_to_message[] = { 0x5499, 0x0102 };
+  CipOctet message[4];
+  CipOctet *message_pointer = message;
+
+  int returned_size = AddIntArrayToMessage(values_to_add_to_message, 2,
+                                           &message_pointer);
+
+  LONGS_EQUAL(4, returned_size);
+  BYTES_EQUAL(0x99, message[0]);
+  BYTES_EQUAL(0x54, message[1]);
+  BYTES_EQUAL(0x02, message[2]);
+  BYTES_EQUAL(0x01, message[3]);
+
+  POINTERS_EQUAL(message + 4, message_pointer)
+}
+
+TEST(EndianConversion, GetDintArrayFromMessage) {
+  CipOctet test_message[] = { 28, 53, 41, 37, 0x59, 0xC4, 0xE0, 0x25 };
+  CipOctet *message = test_message;
+  CipUdint returned_values[2];
+
+  GetDintArrayFromMessage(returned_values, 2, &message);
+
+  LONGS_EQUAL(623457564, returned_values[0]);
+  LONGS_EQUAL(0x25E0C459, returned_values[1]);
+  POINTERS_EQUAL(test_message + 8, message);
+}
+
+TEST(EndianConversion, RealArrayRoundTrip) {
+  CipReal values_to_add_to_message[] = { 1.0f, -2.5f };
+  CipReal returned_values[2];
+  CipOctet message[8];
+  CipOctet *message_pointer = message;
+
+  AddRealArrayToMessage(values_to_add_to_message, 2, &message_pointer);
+
+  /* 1.0 is 0x3F800000 in IEEE 754 */
+  BYTES_EQUAL(0x00, message[0]);
+  BYTES_EQUAL(0x00, message[1]);
+  BYTES_EQUAL(0x80, message[2]);
+  BYTES_EQUAL(0x3F, message[3]);
+
+  message_pointer = message;
+  GetRealArrayFromMessage(returned_values, 2, &message_pointer);
+
+  DOUBLES_EQUAL(1.0, returned_values[0], 0.0);
+  DOUBLES_EQUAL(-2.5, returned_values[1], 0.0);
+  POINTERS_EQUAL(message + 8, message_pointer);
+}
+
+TEST(EndianConversion, AddLintArrayToMessage) {
+  CipUlint values_to_add_to_message[] = { 0x2D2AEF0B84095230, 0x01 };
+  CipOctet message[16];
+  CipOctet *message_pointer = message;
+
+  AddLintArrayToMessage(values_to_add_to_message, 2, &message_pointer);
+
+  /* same byte order as AddLintToMessage */
+  BYTES_EQUAL(0x2D, message[0]);
+  BYTES_EQUAL(0x30, message[7]);
+  BYTES_EQUAL(0x00, message[8]);
+  BYTES_EQUAL(0x01, message[15]);
+
+  POINTERS_EQUAL(message + 16, message_pointer)
+}
+
 TEST(EndianConversion, EncapsulateIpAddress) {
   CipOctet ip_message[8];
   CipOctet *ip_message_ponter = ip_message;
 
-  DetermineEndianess();
-
   EncapsulateIpAddress(0xAF12, 0x25E0C459, &ip_message_ponter);
 
   BYTES_EQUAL(AF_INET >> 8, ip_message[0]);